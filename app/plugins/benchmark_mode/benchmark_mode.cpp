@@ -18,15 +18,94 @@
 
 #include "benchmark_mode.h"
 
+#include <algorithm>
+#include <cmath>
+#include <json.hpp>
+
+#include "platform/filesystem.h"
 #include "platform/platform.h"
+#include "vulkan_sample.h"
 
 namespace plugins
 {
+namespace
+{
+struct Statistics
+{
+	size_t count{0};
+
+	float mean{0.0f};
+
+	float median{0.0f};
+
+	float p95{0.0f};
+
+	float p99{0.0f};
+
+	float max{0.0f};
+
+	float variance{0.0f};
+};
+
+Statistics compute_statistics(std::vector<float> values)
+{
+	Statistics statistics;
+	statistics.count = values.size();
+
+	if (values.empty())
+	{
+		return statistics;
+	}
+
+	std::sort(values.begin(), values.end());
+
+	// Nearest-rank percentiles
+	auto percentile = [&values](float p) {
+		auto rank = static_cast<size_t>(std::ceil(p * values.size()));
+		return values[std::min(std::max(rank, size_t{1}), values.size()) - 1];
+	};
+
+	double sum = 0.0;
+	for (auto value : values)
+	{
+		sum += value;
+	}
+	double mean = sum / values.size();
+
+	double squared_deviations = 0.0;
+	for (auto value : values)
+	{
+		squared_deviations += (value - mean) * (value - mean);
+	}
+
+	statistics.mean     = static_cast<float>(mean);
+	statistics.median   = percentile(0.5f);
+	statistics.p95      = percentile(0.95f);
+	statistics.p99      = percentile(0.99f);
+	statistics.max      = values.back();
+	statistics.variance = static_cast<float>(squared_deviations / values.size());
+
+	return statistics;
+}
+
+nlohmann::json to_json(const Statistics &statistics)
+{
+	return {{"count", statistics.count},
+	        {"mean", statistics.mean},
+	        {"median", statistics.median},
+	        {"p95", statistics.p95},
+	        {"p99", statistics.p99},
+	        {"max", statistics.max},
+	        {"variance", statistics.variance},
+	        {"std_dev", std::sqrt(statistics.variance)}};
+}
+}        // namespace
+
 BenchmarkMode::BenchmarkMode() :
     BenchmarkModeTags("Benchmark Mode",
-                      "Log frame averages after running an app.",
-                      {vkb::Hook::OnUpdate, vkb::Hook::OnAppStart, vkb::Hook::OnAppClose},
-                      {&benchmark_flag})
+                      "Log frame time statistics after running an app, and write them to a JSON report.",
+                      {vkb::Hook::OnUpdate, vkb::Hook::OnAppStart, vkb::Hook::OnAppClose, vkb::Hook::PostDraw},
+                      {&benchmark_flag, &warmup_frames_flag, &output_flag})
 {
 }
 
@@ -41,6 +120,16 @@ void BenchmarkMode::init(const vkb::CommandParser &parser)
 	// This will effect the graph outputs of framerate
 	platform->force_simulation_fps(60.0f);
 	enabled = true;
+
+	if (parser.contains(&warmup_frames_flag))
+	{
+		warmup_frames = parser.as<uint32_t>(&warmup_frames_flag);
+	}
+
+	if (parser.contains(&output_flag))
+	{
+		output_path = parser.as<std::string>(&output_flag);
+	}
 }
 
 void BenchmarkMode::on_update(float delta_time)
@@ -49,6 +138,11 @@ void BenchmarkMode::on_update(float delta_time)
 	{
 		elapsed_time += delta_time;
 		total_frames++;
+
+		// The delta time is measured before the simulation step is fixed
+		FrameRecord frame;
+		frame.frame_time = delta_time * 1000.0f;
+		frames.push_back(frame);
 	}
 }
 
@@ -56,12 +150,138 @@ void BenchmarkMode::on_app_start(const std::string &app_id)
 {
 	elapsed_time = 0;
 	total_frames = 0;
+	frames.clear();
+
+	if (auto *vulkan_app = dynamic_cast<vkb::VulkanSample *>(&platform->get_app()))
+	{
+		vulkan_app->set_frame_timings_enabled(true);
+	}
+
 	LOGI("Starting Benchmark for {}", app_id);
 }
 
 void BenchmarkMode::on_app_close(const std::string &app_id)
 {
 	LOGI("Benchmark for {} completed in {} seconds (ran {} frames, averaged {} fps)", app_id, elapsed_time, total_frames, total_frames / elapsed_time);
+
+	if (enabled)
+	{
+		write_report(app_id);
+	}
+}
+
+void BenchmarkMode::on_post_draw(vkb::RenderContext &context)
+{
+	auto *vulkan_app = dynamic_cast<vkb::VulkanSample *>(&platform->get_app());
+	if (!enabled || !vulkan_app || frames.empty())
+	{
+		return;
+	}
+
+	auto &timings = vulkan_app->get_frame_timings();
+
+	// Samples which do not render through vkb::VulkanSample::update() only report the frame time
+	if (timings.frame_number != frames.size() - 1)
+	{
+		return;
+	}
+
+	auto &frame           = frames.back();
+	frame.has_cpu_timings = true;
+	frame.wait            = timings.wait;
+	frame.update          = timings.update;
+	frame.record          = timings.record;
+	frame.submit          = timings.submit;
+
+	// GPU timings belong to a frame rendered earlier
+	if (timings.has_gpu_time && timings.gpu_frame_number < frames.size())
+	{
+		frames[timings.gpu_frame_number].has_gpu_time = true;
+		frames[timings.gpu_frame_number].gpu          = timings.gpu;
+	}
+}
+
+void BenchmarkMode::write_report(const std::string &app_id)
+{
+	std::vector<float> frame_times;
+	std::vector<float> wait_times;
+	std::vector<float> update_times;
+	std::vector<float> record_times;
+	std::vector<float> submit_times;
+	std::vector<float> gpu_times;
+
+	nlohmann::json frame_timelines = nlohmann::json::array();
+
+	for (size_t i = warmup_frames; i < frames.size(); ++i)
+	{
+		auto &frame = frames[i];
+
+		nlohmann::json frame_json = {{"frame", i}, {"frame_time", frame.frame_time}};
+
+		frame_times.push_back(frame.frame_time);
+
+		if (frame.has_cpu_timings)
+		{
+			wait_times.push_back(frame.wait);
+			update_times.push_back(frame.update);
+			record_times.push_back(frame.record);
+			submit_times.push_back(frame.submit);
+
+			frame_json["wait"]   = frame.wait;
+			frame_json["update"] = frame.update;
+			frame_json["record"] = frame.record;
+			frame_json["submit"] = frame.submit;
+		}
+
+		if (frame.has_gpu_time)
+		{
+			gpu_times.push_back(frame.gpu);
+
+			frame_json["gpu"] = frame.gpu;
+		}
+
+		frame_timelines.push_back(frame_json);
+	}
+
+	auto frame_time_statistics = compute_statistics(frame_times);
+
+	LOGI("Benchmark for {}: frame time over {} frames (after {} warm-up frames): mean {:.3f} ms, median {:.3f} ms, p95 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms, variance {:.3f} ms^2",
+	     app_id, frame_time_statistics.count, warmup_frames, frame_time_statistics.mean, frame_time_statistics.median,
+	     frame_time_statistics.p95, frame_time_statistics.p99, frame_time_statistics.max, frame_time_statistics.variance);
+
+	nlohmann::json summary = {{"frame_time", to_json(frame_time_statistics)}};
+
+	if (!wait_times.empty())
+	{
+		summary["wait"]   = to_json(compute_statistics(wait_times));
+		summary["update"] = to_json(compute_statistics(update_times));
+		summary["record"] = to_json(compute_statistics(record_times));
+		summary["submit"] = to_json(compute_statistics(submit_times));
+	}
+
+	if (!gpu_times.empty())
+	{
+		auto gpu_statistics = compute_statistics(gpu_times);
+		summary["gpu"]      = to_json(gpu_statistics);
+
+		LOGI("Benchmark for {}: GPU time mean {:.3f} ms, median {:.3f} ms, p95 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms",
+		     app_id, gpu_statistics.mean, gpu_statistics.median, gpu_statistics.p95, gpu_statistics.p99, gpu_statistics.max);
+	}
+
+	nlohmann::json report = {{"app", app_id},
+	                         {"unit", "ms"},
+	                         {"total_frames", total_frames},
+	                         {"warmup_frames", warmup_frames},
+	                         {"elapsed_time", elapsed_time},
+	                         {"summary", summary},
+	                         {"frames", frame_timelines}};
+
+	std::string filename = output_path.empty() ? "benchmark_" + app_id + ".json" : output_path;
+
+	if (vkb::fs::write_json(report, filename))
+	{
+		LOGI("Benchmark report written to {}", vkb::fs::path::get(vkb::fs::path::Type::Graphs) + filename);
+	}
 }
 
 void BenchmarkMode::set_enabled(bool is_enabled)
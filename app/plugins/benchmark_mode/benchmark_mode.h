@@ -18,6 +18,9 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "platform/plugins/plugin_base.h"
 
 namespace plugins
@@ -31,7 +34,12 @@ using BenchmarkModeTags = vkb::PluginBase<BenchmarkMode, vkb::tags::Passive>;
  *
  * When enabled frame time statistics of a samples run will be printed to the console when an application closes. The simulation frame time (delta time) is also locked to 60FPS so that statistics can be compared more accurately across different devices.
  *
- * Usage: vulkan_samples sample afbc --benchmark
+ * Besides the wall clock frame time, samples rendering through vkb::VulkanSample::update() report how long each frame
+ * spent waiting for its render frame, updating, recording, submitting and executing on the GPU (with timestamp queries).
+ * Warm-up frames are discarded, then the mean, median, 95th and 99th percentiles, maximum and variance of each timeline
+ * are logged and written with the per-frame timelines to a JSON report in the graphs directory.
+ *
+ * Usage: vulkan_samples sample afbc --benchmark --benchmark-warmup-frames 30 --benchmark-output afbc.json
  *
  */
 class BenchmarkMode : public BenchmarkModeTags
@@ -51,15 +59,51 @@ class BenchmarkMode : public BenchmarkModeTags
 
 	virtual void on_app_close(const std::string &app_info) override;
 
+	virtual void on_post_draw(vkb::RenderContext &context) override;
+
 	void set_enabled(bool is_enabled);
 
 	vkb::FlagCommand benchmark_flag = {vkb::FlagType::FlagOnly, "benchmark", "", "Enable benchmark mode"};
 
+	vkb::FlagCommand warmup_frames_flag = {vkb::FlagType::OneValue, "benchmark-warmup-frames", "", "Number of frames excluded from the benchmark statistics (default 10)"};
+
+	vkb::FlagCommand output_flag = {vkb::FlagType::OneValue, "benchmark-output", "", "Name of the JSON benchmark report written to the graphs directory"};
+
   private:
+	/**
+	 * @brief Timings of a frame in milliseconds, see vkb::FrameTimings
+	 */
+	struct FrameRecord
+	{
+		float frame_time{0.0f};
+
+		bool has_cpu_timings{false};
+
+		float wait{0.0f};
+
+		float update{0.0f};
+
+		float record{0.0f};
+
+		float submit{0.0f};
+
+		bool has_gpu_time{false};
+
+		float gpu{0.0f};
+	};
+
+	void write_report(const std::string &app_id);
+
 	bool enabled{false};
 
 	uint32_t total_frames{0};
 
 	float elapsed_time{0.0f};
+
+	uint32_t warmup_frames{10};
+
+	std::string output_path;
+
+	std::vector<FrameRecord> frames;
 };
 }        // namespace plugins
\ No newline at end of file
@@ -79,6 +79,21 @@ void WindowOptions::init(const vkb::CommandParser &parser)
 		properties.mode = vkb::Window::Mode::FullscreenStretch;
 	}
 
+	if (parser.contains(&headless_images_flag))
+	{
+		properties.headless_image_count = std::max(parser.as<uint32_t>(&headless_images_flag), 1u);
+	}
+
+	if (parser.contains(&headless_latency_flag))
+	{
+		properties.headless_latency = parser.as<uint32_t>(&headless_latency_flag);
+	}
+
+	if (parser.contains(&frames_in_flight_flag))
+	{
+		properties.frames_in_flight = parser.as<uint32_t>(&frames_in_flight_flag);
+	}
+
 	if (parser.contains(&vsync_flag))
 	{
 		std::string value = parser.as<std::string>(&vsync_flag);
@@ -44,14 +44,17 @@ class WindowOptions : public WindowOptionsTags
 
 	virtual void init(const vkb::CommandParser &options) override;
 
-	vkb::FlagCommand width_flag      = {vkb::FlagType::OneValue, "width", "", "Initial window width"};
-	vkb::FlagCommand height_flag     = {vkb::FlagType::OneValue, "height", "", "Initial window height"};
-	vkb::FlagCommand fullscreen_flag = {vkb::FlagType::FlagOnly, "fullscreen", "", "Run in fullscreen mode"};
-	vkb::FlagCommand headless_flag   = {vkb::FlagType::FlagOnly, "headless", "", "Run in headless mode"};
-	vkb::FlagCommand borderless_flag = {vkb::FlagType::FlagOnly, "borderless", "", "Run in borderless mode"};
-	vkb::FlagCommand stretch_flag    = {vkb::FlagType::FlagOnly, "stretch", "", "Stretch window to fullscreen (direct-to-display only)"};
-	vkb::FlagCommand vsync_flag      = {vkb::FlagType::OneValue, "vsync", "", "Force vsync {ON | OFF}. If not set samples decide how vsync is set"};
-
-	vkb::CommandGroup window_options_group = {"Window Options", {&width_flag, &height_flag, &vsync_flag, &fullscreen_flag, &borderless_flag, &stretch_flag, &headless_flag}};
+	vkb::FlagCommand width_flag            = {vkb::FlagType::OneValue, "width", "", "Initial window width"};
+	vkb::FlagCommand height_flag           = {vkb::FlagType::OneValue, "height", "", "Initial window height"};
+	vkb::FlagCommand fullscreen_flag       = {vkb::FlagType::FlagOnly, "fullscreen", "", "Run in fullscreen mode"};
+	vkb::FlagCommand headless_flag         = {vkb::FlagType::FlagOnly, "headless", "", "Run in headless mode"};
+	vkb::FlagCommand headless_images_flag  = {vkb::FlagType::OneValue, "headless-images", "", "Number of offscreen images used in headless mode without VK_EXT_headless_surface (default 3)"};
+	vkb::FlagCommand headless_latency_flag = {vkb::FlagType::OneValue, "headless-latency", "", "Maximum frames in flight with offscreen images in headless mode (default 2)"};
+	vkb::FlagCommand frames_in_flight_flag = {vkb::FlagType::OneValue, "frames-in-flight", "", "Number of frames recorded ahead of the GPU, independently of the swapchain images (default: one per image)"};
+	vkb::FlagCommand borderless_flag       = {vkb::FlagType::FlagOnly, "borderless", "", "Run in borderless mode"};
+	vkb::FlagCommand stretch_flag          = {vkb::FlagType::FlagOnly, "stretch", "", "Stretch window to fullscreen (direct-to-display only)"};
+	vkb::FlagCommand vsync_flag            = {vkb::FlagType::OneValue, "vsync", "", "Force vsync {ON | OFF}. If not set samples decide how vsync is set"};
+
+	vkb::CommandGroup window_options_group = {"Window Options", {&width_flag, &height_flag, &vsync_flag, &fullscreen_flag, &borderless_flag, &stretch_flag, &headless_flag, &headless_images_flag, &headless_latency_flag, &frames_in_flight_flag}};
 };
 }        // namespace plugins
\ No newline at end of file
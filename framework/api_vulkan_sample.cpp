@@ -182,6 +182,9 @@ void ApiVulkanSample::create_render_context(vkb::Platform &platform)
 
 void ApiVulkanSample::prepare_render_context()
 {
+	// These samples record a command buffer per image and synchronize the frames themselves
+	render_context->request_frames_in_flight(0);
+
 	VulkanSample::prepare_render_context();
 }
 
@@ -1274,8 +1277,9 @@ Texture ApiVulkanSample::load_texture_cubemap(const std::string &file, vkb::sg::
 std::unique_ptr<vkb::sg::SubMesh> ApiVulkanSample::load_model(const std::string &file, uint32_t index, bool mesh_shader_buffer)
 {
 	vkb::GLTFLoader loader{get_device()};
+	loader.set_job_system(&get_job_system());
 
-	std::unique_ptr<vkb::sg::SubMesh> model = loader.read_model_from_file(file, index, mesh_shader_buffer);
+	std::unique_ptr<vkb::sg::SubMesh> model = loader.read_model_from_file(file, index, false, mesh_shader_buffer);
 
 	if (!model)
 	{
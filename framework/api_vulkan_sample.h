@@ -95,6 +95,19 @@ struct Meshlet
 	uint32_t primitive_index_count;
 };
 
+/**
+ * @brief The bounds of a meshlet for culling, stored in a buffer parallel to the meshlets
+ */
+struct MeshletBounds
+{
+	/// Center (xyz) and radius (w) of the bounding sphere of the meshlet
+	glm::vec4 sphere;
+
+	/// Axis (xyz) and cutoff (w) of the cone of the triangle normals. The meshlet faces away from a camera at c
+	/// if dot(center - c, axis) >= cutoff * length(center - c) + radius. A cutoff of 1 means it never does.
+	glm::vec4 cone;
+};
+
 /**
  * @brief Sascha Willems base class for use in his ported samples into the framework
  *
@@ -236,6 +249,7 @@ class ApiVulkanSample : public vkb::VulkanSample
 	 * @brief Loads in a single model from a GLTF file
 	 * @param file The filename of the model to load
 	 * @param index The index of the model to load from the GLTF file (default: 0)
+	 * @param mesh_shader_buffer Loads the model as meshlets and their bounds for mesh shading (default: false)
 	 */
 	std::unique_ptr<vkb::sg::SubMesh> load_model(const std::string &file, uint32_t index = 0, bool mesh_shader_buffer = false);
 
@@ -17,6 +17,7 @@
 
 #include "buffer_pool.h"
 
+#include <algorithm>
 #include <cstddef>
 
 #include "common/logging.h"
@@ -27,26 +28,25 @@ namespace vkb
 BufferBlock::BufferBlock(Device &device, VkDeviceSize size, VkBufferUsageFlags usage, VmaMemoryUsage memory_usage) :
     buffer{device, size, usage, memory_usage}
 {
-	if (usage == VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
-	{
-		alignment = device.get_gpu().get_properties().limits.minUniformBufferOffsetAlignment;
-	}
-	else if (usage == VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
-	{
-		alignment = device.get_gpu().get_properties().limits.minStorageBufferOffsetAlignment;
-	}
-	else if (usage == VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT)
+	auto &limits = device.get_gpu().get_properties().limits;
+
+	// Used to calculate the offset, required when allocating memory (its value should be power of 2).
+	// Every alignment is a power of 2, so the largest one satisfies all the usages of the block.
+	alignment = 16;
+
+	if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
 	{
-		alignment = device.get_gpu().get_properties().limits.minTexelBufferOffsetAlignment;
+		alignment = std::max(alignment, limits.minUniformBufferOffsetAlignment);
 	}
-	else if (usage == VK_BUFFER_USAGE_INDEX_BUFFER_BIT || usage == VK_BUFFER_USAGE_VERTEX_BUFFER_BIT || usage == VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT)
+
+	if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
 	{
-		// Used to calculate the offset, required when allocating memory (its value should be power of 2)
-		alignment = 16;
+		alignment = std::max(alignment, limits.minStorageBufferOffsetAlignment);
 	}
-	else
+
+	if (usage & (VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT))
 	{
-		throw std::runtime_error("Usage not recognised");
+		alignment = std::max(alignment, limits.minTexelBufferOffsetAlignment);
 	}
 }
 
@@ -72,6 +72,11 @@ VkDeviceSize BufferBlock::get_size() const
 	return buffer.get_size();
 }
 
+VkDeviceSize BufferBlock::get_used_size() const
+{
+	return offset;
+}
+
 void BufferBlock::reset()
 {
 	offset = 0;
@@ -87,6 +92,26 @@ BufferPool::BufferPool(Device &device, VkDeviceSize block_size, VkBufferUsageFla
 
 BufferBlock &BufferPool::request_buffer_block(const VkDeviceSize minimum_size, bool minimal)
 {
+	if (minimum_size > block_size)
+	{
+		// Recycle the first inactive dedicated block which is large enough
+		auto it = std::find_if(dedicated_blocks.begin() + active_dedicated_block_count, dedicated_blocks.end(),
+		                       [minimum_size](const std::unique_ptr<BufferBlock> &block) { return block->get_size() >= minimum_size; });
+
+		if (it == dedicated_blocks.end())
+		{
+			LOGD("Building #{} dedicated buffer block ({}) of {} KB", dedicated_blocks.size(), usage, minimum_size / 1024);
+
+			dedicated_blocks.emplace_back(std::make_unique<BufferBlock>(device, minimum_size, usage, memory_usage));
+			it = dedicated_blocks.end() - 1;
+		}
+
+		// Keep the active blocks at the front
+		std::iter_swap(dedicated_blocks.begin() + active_dedicated_block_count, it);
+
+		return *dedicated_blocks[active_dedicated_block_count++];
+	}
+
 	// Find the first block in the range of the inactive blocks
 	// which can fit the minimum size
 	auto it = std::upper_bound(buffer_blocks.begin() + active_buffer_block_count, buffer_blocks.end(), minimum_size,
@@ -101,7 +126,7 @@ BufferBlock &BufferPool::request_buffer_block(const VkDeviceSize minimum_size, b
 
 	LOGD("Building #{} buffer block ({})", buffer_blocks.size(), usage);
 
-	VkDeviceSize new_block_size = minimal ? minimum_size : std::max(block_size, minimum_size);
+	VkDeviceSize new_block_size = minimal ? minimum_size : block_size;
 
 	// Create a new block, store and return it
 	buffer_blocks.emplace_back(std::make_unique<BufferBlock>(device, new_block_size, usage, memory_usage));
@@ -113,12 +138,52 @@ BufferBlock &BufferPool::request_buffer_block(const VkDeviceSize minimum_size, b
 
 void BufferPool::reset()
 {
+	auto stats = get_stats();
+
+	peak_used_size   = stats.peak_used_size;
+	peak_block_count = stats.peak_block_count;
+
 	for (auto &buffer_block : buffer_blocks)
 	{
 		buffer_block->reset();
 	}
 
-	active_buffer_block_count = 0;
+	for (auto &buffer_block : dedicated_blocks)
+	{
+		buffer_block->reset();
+	}
+
+	active_buffer_block_count    = 0;
+	active_dedicated_block_count = 0;
+}
+
+VkDeviceSize BufferPool::get_block_size() const
+{
+	return block_size;
+}
+
+BufferPoolStats BufferPool::get_stats() const
+{
+	VkDeviceSize used_size = 0;
+
+	for (auto &buffer_block : buffer_blocks)
+	{
+		used_size += buffer_block->get_used_size();
+	}
+
+	for (auto &buffer_block : dedicated_blocks)
+	{
+		used_size += buffer_block->get_used_size();
+	}
+
+	BufferPoolStats stats;
+	stats.usage                 = usage;
+	stats.block_size            = block_size;
+	stats.peak_used_size        = std::max(peak_used_size, used_size);
+	stats.peak_block_count      = std::max(peak_block_count, active_buffer_block_count);
+	stats.dedicated_block_count = to_u32(dedicated_blocks.size());
+
+	return stats;
 }
 
 BufferAllocation::BufferAllocation(core::Buffer &buffer, VkDeviceSize size, VkDeviceSize offset) :
@@ -132,9 +197,16 @@ void BufferAllocation::update(const std::vector<uint8_t> &data, uint32_t offset)
 {
 	assert(buffer && "Invalid buffer pointer");
 
-	if (offset + data.size() <= size)
+	update(data.data(), data.size(), offset);
+}
+
+void BufferAllocation::update(const uint8_t *data, size_t data_size, uint32_t offset)
+{
+	assert(buffer && "Invalid buffer pointer");
+
+	if (offset + data_size <= size)
 	{
-		buffer->update(data, to_u32(base_offset) + offset);
+		buffer->update(data, data_size, to_u32(base_offset) + offset);
 	}
 	else
 	{
@@ -142,6 +214,18 @@ void BufferAllocation::update(const std::vector<uint8_t> &data, uint32_t offset)
 	}
 }
 
+uint8_t *BufferAllocation::get_data()
+{
+	assert(buffer && "Invalid buffer pointer");
+	return buffer->map() + base_offset;
+}
+
+void BufferAllocation::flush()
+{
+	assert(buffer && "Invalid buffer pointer");
+	buffer->flush();
+}
+
 bool BufferAllocation::empty() const
 {
 	return size == 0 || buffer == nullptr;
@@ -45,12 +45,28 @@ class BufferAllocation
 
 	void update(const std::vector<uint8_t> &data, uint32_t offset = 0);
 
+	/**
+	 * @brief Copies data into the allocation, without going through an intermediate vector
+	 * @param data Pointer to the data to copy
+	 * @param size Number of bytes to copy
+	 * @param offset Offset from the start of the allocation
+	 */
+	void update(const uint8_t *data, size_t size, uint32_t offset = 0);
+
 	template <class T>
 	void update(const T &value, uint32_t offset = 0)
 	{
-		update(to_bytes(value), offset);
+		update(reinterpret_cast<const uint8_t *>(&value), sizeof(T), offset);
 	}
 
+	/**
+	 * @brief Host address of the allocation inside its mapped buffer, to write data in place.
+	 *        Call flush() once writing is done, in case the memory is not host coherent.
+	 */
+	uint8_t *get_data();
+
+	void flush();
+
 	bool empty() const;
 
 	VkDeviceSize get_size() const;
@@ -82,6 +98,11 @@ class BufferBlock
 
 	VkDeviceSize get_size() const;
 
+	/**
+	 * @return Number of bytes allocated from the block since it was reset, including alignment padding
+	 */
+	VkDeviceSize get_used_size() const;
+
 	void reset();
 
   private:
@@ -94,6 +115,25 @@ class BufferBlock
 	VkDeviceSize offset{0};
 };
 
+/**
+ * @brief Usage of a buffer pool, to tune its block size for a workload
+ */
+struct BufferPoolStats
+{
+	VkBufferUsageFlags usage{0};
+
+	VkDeviceSize block_size{0};
+
+	/// Highest number of bytes allocated between two resets
+	VkDeviceSize peak_used_size{0};
+
+	/// Highest number of regular blocks in use between two resets
+	uint32_t peak_block_count{0};
+
+	/// Number of blocks created for allocations larger than the block size
+	uint32_t dedicated_block_count{0};
+};
+
 /**
  * @brief A pool of buffer blocks for a specific usage.
  * It may contain inactive blocks that can be recycled.
@@ -105,7 +145,7 @@ class BufferBlock
  *
  * When a new frame starts, buffer blocks are returned: the offset is reset and contents are
  * overwritten. The minimum allocation size is 256 kb, if you ask for more you get a dedicated
- * buffer allocation.
+ * buffer block, which is kept and recycled for later allocations which fit in it.
  *
  * We re-use descriptor sets: we only need one for the corresponding buffer infos (and we only
  * have one VkBuffer per BufferBlock), then it is bound and we use dynamic offsets.
@@ -115,16 +155,34 @@ class BufferPool
   public:
 	BufferPool(Device &device, VkDeviceSize block_size, VkBufferUsageFlags usage, VmaMemoryUsage memory_usage = VMA_MEMORY_USAGE_CPU_TO_GPU);
 
+	/**
+	 * @param minimum_size Size the block must be able to allocate
+	 * @param minimal Whether the block should have exactly the minimum size
+	 * @return A block to allocate from, dedicated if the minimum size is larger than the block size
+	 */
 	BufferBlock &request_buffer_block(VkDeviceSize minimum_size, bool minimal = false);
 
 	void reset();
 
+	VkDeviceSize get_block_size() const;
+
+	BufferPoolStats get_stats() const;
+
   private:
 	Device &device;
 
 	/// List of blocks requested
 	std::vector<std::unique_ptr<BufferBlock>> buffer_blocks;
 
+	/// Blocks created for allocations larger than the block size, the active ones first
+	std::vector<std::unique_ptr<BufferBlock>> dedicated_blocks;
+
+	uint32_t active_dedicated_block_count{0};
+
+	VkDeviceSize peak_used_size{0};
+
+	uint32_t peak_block_count{0};
+
 	/// Minimum size of the blocks
 	VkDeviceSize block_size{0};
 
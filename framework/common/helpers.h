@@ -175,6 +175,48 @@ inline void hash_combine(size_t &seed, const T &v)
 	glm::detail::hash_combine(seed, hasher(v));
 }
 
+/**
+ * @brief FNV-1a, used instead of std::hash as keys must be stable across runs and builds
+ */
+class Fnv1a
+{
+  public:
+	Fnv1a(uint64_t seed) :
+	    value{seed}
+	{}
+
+	void add(const void *data, size_t size)
+	{
+		auto bytes = reinterpret_cast<const uint8_t *>(data);
+
+		for (size_t i = 0; i < size; ++i)
+		{
+			value ^= bytes[i];
+			value *= 0x100000001b3ull;
+		}
+	}
+
+	void add(const std::string &str)
+	{
+		uint64_t size = str.size();
+		add(&size, sizeof(size));
+		add(str.data(), str.size());
+	}
+
+	void add(uint32_t data)
+	{
+		add(&data, sizeof(data));
+	}
+
+	uint64_t get() const
+	{
+		return value;
+	}
+
+  private:
+	uint64_t value;
+};
+
 /**
  * @brief Helper function to convert a data type
  *        to string using output stream operator.
@@ -453,78 +453,120 @@ struct hash<vkb::RenderTarget>
 };
 
 template <>
-struct hash<vkb::PipelineState>
+struct hash<vkb::VertexInputState>
 {
-	std::size_t operator()(const vkb::PipelineState &pipeline_state) const
+	std::size_t operator()(const vkb::VertexInputState &vertex_input_state) const
 	{
 		std::size_t result = 0;
 
-		vkb::hash_combine(result, pipeline_state.get_pipeline_layout().get_handle());
+		for (auto &attribute : vertex_input_state.attributes)
+		{
+			vkb::hash_combine(result, attribute);
+		}
 
-		// For graphics only
-		if (auto render_pass = pipeline_state.get_render_pass())
+		for (auto &binding : vertex_input_state.bindings)
 		{
-			vkb::hash_combine(result, render_pass->get_handle());
+			vkb::hash_combine(result, binding);
 		}
 
-		vkb::hash_combine(result, pipeline_state.get_specialization_constant_state());
+		return result;
+	}
+};
 
-		vkb::hash_combine(result, pipeline_state.get_subpass_index());
+template <>
+struct hash<vkb::InputAssemblyState>
+{
+	std::size_t operator()(const vkb::InputAssemblyState &input_assembly_state) const
+	{
+		std::size_t result = 0;
 
-		for (auto shader_module : pipeline_state.get_pipeline_layout().get_shader_modules())
-		{
-			vkb::hash_combine(result, shader_module->get_id());
-		}
+		vkb::hash_combine(result, input_assembly_state.primitive_restart_enable);
+		vkb::hash_combine(result, static_cast<std::underlying_type<VkPrimitiveTopology>::type>(input_assembly_state.topology));
 
-		// VkPipelineVertexInputStateCreateInfo
-		for (auto &attribute : pipeline_state.get_vertex_input_state().attributes)
-		{
-			vkb::hash_combine(result, attribute);
-		}
+		return result;
+	}
+};
 
-		for (auto &binding : pipeline_state.get_vertex_input_state().bindings)
-		{
-			vkb::hash_combine(result, binding);
-		}
+template <>
+struct hash<vkb::ViewportState>
+{
+	std::size_t operator()(const vkb::ViewportState &viewport_state) const
+	{
+		std::size_t result = 0;
+
+		vkb::hash_combine(result, viewport_state.viewport_count);
+		vkb::hash_combine(result, viewport_state.scissor_count);
+
+		return result;
+	}
+};
+
+template <>
+struct hash<vkb::RasterizationState>
+{
+	std::size_t operator()(const vkb::RasterizationState &rasterization_state) const
+	{
+		std::size_t result = 0;
+
+		vkb::hash_combine(result, rasterization_state.cull_mode);
+		vkb::hash_combine(result, rasterization_state.depth_bias_enable);
+		vkb::hash_combine(result, rasterization_state.depth_clamp_enable);
+		vkb::hash_combine(result, static_cast<std::underlying_type<VkFrontFace>::type>(rasterization_state.front_face));
+		vkb::hash_combine(result, static_cast<std::underlying_type<VkPolygonMode>::type>(rasterization_state.polygon_mode));
+		vkb::hash_combine(result, rasterization_state.rasterizer_discard_enable);
 
-		// VkPipelineInputAssemblyStateCreateInfo
-		vkb::hash_combine(result, pipeline_state.get_input_assembly_state().primitive_restart_enable);
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkPrimitiveTopology>::type>(pipeline_state.get_input_assembly_state().topology));
-
-		//VkPipelineViewportStateCreateInfo
-		vkb::hash_combine(result, pipeline_state.get_viewport_state().viewport_count);
-		vkb::hash_combine(result, pipeline_state.get_viewport_state().scissor_count);
-
-		// VkPipelineRasterizationStateCreateInfo
-		vkb::hash_combine(result, pipeline_state.get_rasterization_state().cull_mode);
-		vkb::hash_combine(result, pipeline_state.get_rasterization_state().depth_bias_enable);
-		vkb::hash_combine(result, pipeline_state.get_rasterization_state().depth_clamp_enable);
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkFrontFace>::type>(pipeline_state.get_rasterization_state().front_face));
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkPolygonMode>::type>(pipeline_state.get_rasterization_state().polygon_mode));
-		vkb::hash_combine(result, pipeline_state.get_rasterization_state().rasterizer_discard_enable);
-
-		// VkPipelineMultisampleStateCreateInfo
-		vkb::hash_combine(result, pipeline_state.get_multisample_state().alpha_to_coverage_enable);
-		vkb::hash_combine(result, pipeline_state.get_multisample_state().alpha_to_one_enable);
-		vkb::hash_combine(result, pipeline_state.get_multisample_state().min_sample_shading);
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkSampleCountFlagBits>::type>(pipeline_state.get_multisample_state().rasterization_samples));
-		vkb::hash_combine(result, pipeline_state.get_multisample_state().sample_shading_enable);
-		vkb::hash_combine(result, pipeline_state.get_multisample_state().sample_mask);
-
-		// VkPipelineDepthStencilStateCreateInfo
-		vkb::hash_combine(result, pipeline_state.get_depth_stencil_state().back);
-		vkb::hash_combine(result, pipeline_state.get_depth_stencil_state().depth_bounds_test_enable);
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkCompareOp>::type>(pipeline_state.get_depth_stencil_state().depth_compare_op));
-		vkb::hash_combine(result, pipeline_state.get_depth_stencil_state().depth_test_enable);
-		vkb::hash_combine(result, pipeline_state.get_depth_stencil_state().depth_write_enable);
-		vkb::hash_combine(result, pipeline_state.get_depth_stencil_state().front);
-		vkb::hash_combine(result, pipeline_state.get_depth_stencil_state().stencil_test_enable);
-
-		// VkPipelineColorBlendStateCreateInfo
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkLogicOp>::type>(pipeline_state.get_color_blend_state().logic_op));
-		vkb::hash_combine(result, pipeline_state.get_color_blend_state().logic_op_enable);
-
-		for (auto &attachment : pipeline_state.get_color_blend_state().attachments)
+		return result;
+	}
+};
+
+template <>
+struct hash<vkb::MultisampleState>
+{
+	std::size_t operator()(const vkb::MultisampleState &multisample_state) const
+	{
+		std::size_t result = 0;
+
+		vkb::hash_combine(result, multisample_state.alpha_to_coverage_enable);
+		vkb::hash_combine(result, multisample_state.alpha_to_one_enable);
+		vkb::hash_combine(result, multisample_state.min_sample_shading);
+		vkb::hash_combine(result, static_cast<std::underlying_type<VkSampleCountFlagBits>::type>(multisample_state.rasterization_samples));
+		vkb::hash_combine(result, multisample_state.sample_shading_enable);
+		vkb::hash_combine(result, multisample_state.sample_mask);
+
+		return result;
+	}
+};
+
+template <>
+struct hash<vkb::DepthStencilState>
+{
+	std::size_t operator()(const vkb::DepthStencilState &depth_stencil_state) const
+	{
+		std::size_t result = 0;
+
+		vkb::hash_combine(result, depth_stencil_state.back);
+		vkb::hash_combine(result, depth_stencil_state.depth_bounds_test_enable);
+		vkb::hash_combine(result, static_cast<std::underlying_type<VkCompareOp>::type>(depth_stencil_state.depth_compare_op));
+		vkb::hash_combine(result, depth_stencil_state.depth_test_enable);
+		vkb::hash_combine(result, depth_stencil_state.depth_write_enable);
+		vkb::hash_combine(result, depth_stencil_state.front);
+		vkb::hash_combine(result, depth_stencil_state.stencil_test_enable);
+
+		return result;
+	}
+};
+
+template <>
+struct hash<vkb::ColorBlendState>
+{
+	std::size_t operator()(const vkb::ColorBlendState &color_blend_state) const
+	{
+		std::size_t result = 0;
+
+		vkb::hash_combine(result, static_cast<std::underlying_type<VkLogicOp>::type>(color_blend_state.logic_op));
+		vkb::hash_combine(result, color_blend_state.logic_op_enable);
+
+		for (auto &attachment : color_blend_state.attachments)
 		{
 			vkb::hash_combine(result, attachment);
 		}
@@ -532,6 +574,16 @@ struct hash<vkb::PipelineState>
 		return result;
 	}
 };
+
+template <>
+struct hash<vkb::PipelineState>
+{
+	std::size_t operator()(const vkb::PipelineState &pipeline_state) const
+	{
+		// Combined from the sub-state hashes kept up to date by the setters of the pipeline state
+		return pipeline_state.get_hash();
+	}
+};
 }        // namespace std
 
 namespace vkb
@@ -78,7 +78,7 @@ void screenshot(RenderContext &render_context, const std::string &filename)
 		memory_barrier.src_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
 		memory_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
 
-		cmd_buf.buffer_memory_barrier(dst_buffer, 0, dst_size, memory_barrier);
+		cmd_buf.add_buffer_memory_barrier(dst_buffer, 0, dst_size, memory_barrier);
 	}
 
 	// Enable framebuffer image view to be read from
@@ -89,7 +89,7 @@ void screenshot(RenderContext &render_context, const std::string &filename)
 		memory_barrier.src_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT;
 		memory_barrier.dst_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT;
 
-		cmd_buf.image_memory_barrier(src_image_view, memory_barrier);
+		cmd_buf.add_image_memory_barrier(src_image_view, memory_barrier);
 	}
 
 	// Check if framebuffer images are in a BGR format
@@ -116,7 +116,7 @@ void screenshot(RenderContext &render_context, const std::string &filename)
 		memory_barrier.src_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
 		memory_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_HOST_BIT;
 
-		cmd_buf.buffer_memory_barrier(dst_buffer, 0, dst_size, memory_barrier);
+		cmd_buf.add_buffer_memory_barrier(dst_buffer, 0, dst_size, memory_barrier);
 	}
 
 	// Revert back the framebuffer image view from transfer to present
@@ -127,7 +127,7 @@ void screenshot(RenderContext &render_context, const std::string &filename)
 		memory_barrier.src_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT;
 		memory_barrier.dst_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT;
 
-		cmd_buf.image_memory_barrier(src_image_view, memory_barrier);
+		cmd_buf.add_image_memory_barrier(src_image_view, memory_barrier);
 	}
 
 	cmd_buf.end();
@@ -137,6 +137,36 @@ struct BufferMemoryBarrier
 	VkAccessFlags dst_access_mask{0};
 };
 
+/**
+* @brief Global memory barrier structure used to define
+*        memory access for all resources during command recording.
+*/
+struct GlobalMemoryBarrier
+{
+	VkPipelineStageFlags src_stage_mask{VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT};
+
+	VkPipelineStageFlags dst_stage_mask{VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT};
+
+	VkAccessFlags src_access_mask{0};
+
+	VkAccessFlags dst_access_mask{0};
+};
+
+/**
+* @brief Counts of the barriers recorded in command buffers
+*/
+struct BarrierStatistics
+{
+	/// Number of vkCmdPipelineBarrier or vkCmdPipelineBarrier2KHR
+	uint32_t pipeline_barrier_count{0};
+
+	uint32_t image_barrier_count{0};
+
+	uint32_t buffer_barrier_count{0};
+
+	uint32_t memory_barrier_count{0};
+};
+
 /**
 * @brief Put an image memory barrier for setting an image layout on the sub resource into the given command buffer
 */
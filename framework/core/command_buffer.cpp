@@ -29,11 +29,44 @@ VKBP_ENABLE_WARNINGS()
 
 namespace vkb
 {
+namespace
+{
+/**
+ * @brief Finds the layout an image is read from by a descriptor type
+ * @return Whether the descriptor type reads images
+ */
+bool get_descriptor_image_layout(VkDescriptorType descriptor_type, const core::ImageView &image_view, VkImageLayout &image_layout)
+{
+	switch (descriptor_type)
+	{
+		case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+			image_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			return true;
+		case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+			if (is_depth_stencil_format(image_view.get_format()))
+			{
+				image_layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+			}
+			else
+			{
+				image_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			}
+			return true;
+		case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+			image_layout = VK_IMAGE_LAYOUT_GENERAL;
+			return true;
+		default:
+			return false;
+	}
+}
+}        // namespace
+
 CommandBuffer::CommandBuffer(CommandPool &command_pool, VkCommandBufferLevel level) :
     VulkanResource{VK_NULL_HANDLE, &command_pool.get_device()},
     command_pool{command_pool},
     max_push_constants_size{device->get_gpu().get_properties().limits.maxPushConstantsSize},
-    level{level}
+    level{level},
+    synchronization_2{command_pool.get_device().is_enabled(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME)}
 {
 	VkCommandBufferAllocateInfo allocate_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
 
@@ -63,7 +96,8 @@ CommandBuffer::CommandBuffer(CommandBuffer &&other) :
     command_pool{other.command_pool},
     level{other.level},
     state{other.state},
-    update_after_bind{other.update_after_bind}
+    update_after_bind{other.update_after_bind},
+    synchronization_2{other.synchronization_2}
 {
 	other.state = State::Invalid;
 }
@@ -75,6 +109,8 @@ bool CommandBuffer::is_recording() const
 
 void CommandBuffer::clear(VkClearAttachment attachment, VkClearRect rect)
 {
+	flush_barriers();
+
 	vkCmdClearAttachments(handle, 1, &attachment, 1, &rect);
 }
 
@@ -108,6 +144,11 @@ VkResult CommandBuffer::begin(VkCommandBufferUsageFlags flags, const RenderPass
 	descriptor_set_layout_binding_state.clear();
 	stored_push_constants.clear();
 
+	pending_image_barriers.clear();
+	pending_buffer_barriers.clear();
+	pending_memory_barriers.clear();
+	barrier_statistics = {};
+
 	VkCommandBufferBeginInfo       begin_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
 	VkCommandBufferInheritanceInfo inheritance = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO};
 	begin_info.flags                           = flags;
@@ -138,6 +179,13 @@ VkResult CommandBuffer::end()
 		return VK_NOT_READY;
 	}
 
+	flush_barriers();
+
+	if (auto render_frame = command_pool.get_render_frame())
+	{
+		render_frame->add_barrier_statistics(barrier_statistics);
+	}
+
 	vkEndCommandBuffer(get_handle());
 
 	state = State::Executable;
@@ -147,6 +195,8 @@ VkResult CommandBuffer::end()
 
 void CommandBuffer::flush(VkPipelineBindPoint pipeline_bind_point)
 {
+	flush_barriers();
+
 	flush_pipeline_state(pipeline_bind_point);
 
 	flush_push_constants();
@@ -196,6 +246,8 @@ void CommandBuffer::begin_render_pass(const RenderTarget &render_target, const R
 		last_render_area_extent = begin_info.renderArea.extent;
 	}
 
+	flush_barriers();
+
 	vkCmdBeginRenderPass(get_handle(), &begin_info, contents);
 
 	// Update blend state attachments for first subpass
@@ -221,16 +273,22 @@ void CommandBuffer::next_subpass()
 	// Clear stored push constants
 	stored_push_constants.clear();
 
+	flush_barriers();
+
 	vkCmdNextSubpass(get_handle(), VK_SUBPASS_CONTENTS_INLINE);
 }
 
 void CommandBuffer::execute_commands(CommandBuffer &secondary_command_buffer)
 {
+	flush_barriers();
+
 	vkCmdExecuteCommands(get_handle(), 1, &secondary_command_buffer.get_handle());
 }
 
 void CommandBuffer::execute_commands(std::vector<CommandBuffer *> &secondary_command_buffers)
 {
+	flush_barriers();
+
 	std::vector<VkCommandBuffer> sec_cmd_buf_handles(secondary_command_buffers.size(), VK_NULL_HANDLE);
 	std::transform(secondary_command_buffers.begin(), secondary_command_buffers.end(), sec_cmd_buf_handles.begin(),
 	               [](const vkb::CommandBuffer *sec_cmd_buf) { return sec_cmd_buf->get_handle(); });
@@ -239,6 +297,8 @@ void CommandBuffer::execute_commands(std::vector<CommandBuffer *> &secondary_com
 
 void CommandBuffer::end_render_pass()
 {
+	flush_barriers();
+
 	vkCmdEndRenderPass(get_handle());
 }
 
@@ -395,6 +455,13 @@ void CommandBuffer::draw_indexed_indirect(const core::Buffer &buffer, VkDeviceSi
 	vkCmdDrawIndexedIndirect(get_handle(), buffer.get_handle(), offset, draw_count, stride);
 }
 
+void CommandBuffer::draw_indexed_indirect_count(const core::Buffer &buffer, VkDeviceSize offset, const core::Buffer &count_buffer, VkDeviceSize count_buffer_offset, uint32_t max_draw_count, uint32_t stride)
+{
+	flush(VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+	vkCmdDrawIndexedIndirectCountKHR(get_handle(), buffer.get_handle(), offset, count_buffer.get_handle(), count_buffer_offset, max_draw_count, stride);
+}
+
 void CommandBuffer::dispatch(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z)
 {
 	flush(VK_PIPELINE_BIND_POINT_COMPUTE);
@@ -411,11 +478,15 @@ void CommandBuffer::dispatch_indirect(const core::Buffer &buffer, VkDeviceSize o
 
 void CommandBuffer::update_buffer(const core::Buffer &buffer, VkDeviceSize offset, const std::vector<uint8_t> &data)
 {
+	flush_barriers();
+
 	vkCmdUpdateBuffer(get_handle(), buffer.get_handle(), offset, data.size(), data.data());
 }
 
 void CommandBuffer::blit_image(const core::Image &src_img, const core::Image &dst_img, const std::vector<VkImageBlit> &regions)
 {
+	flush_barriers();
+
 	vkCmdBlitImage(get_handle(), src_img.get_handle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
 	               dst_img.get_handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 	               to_u32(regions.size()), regions.data(), VK_FILTER_NEAREST);
@@ -423,6 +494,8 @@ void CommandBuffer::blit_image(const core::Image &src_img, const core::Image &ds
 
 void CommandBuffer::resolve_image(const core::Image &src_img, const core::Image &dst_img, const std::vector<VkImageResolve> &regions)
 {
+	flush_barriers();
+
 	vkCmdResolveImage(get_handle(), src_img.get_handle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
 	                  dst_img.get_handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 	                  to_u32(regions.size()), regions.data());
@@ -430,13 +503,24 @@ void CommandBuffer::resolve_image(const core::Image &src_img, const core::Image
 
 void CommandBuffer::copy_buffer(const core::Buffer &src_buffer, const core::Buffer &dst_buffer, VkDeviceSize size)
 {
+	flush_barriers();
+
 	VkBufferCopy copy_region = {};
 	copy_region.size         = size;
 	vkCmdCopyBuffer(get_handle(), src_buffer.get_handle(), dst_buffer.get_handle(), 1, &copy_region);
 }
 
+void CommandBuffer::copy_buffer(const core::Buffer &src_buffer, const core::Buffer &dst_buffer, const std::vector<VkBufferCopy> &regions)
+{
+	flush_barriers();
+
+	vkCmdCopyBuffer(get_handle(), src_buffer.get_handle(), dst_buffer.get_handle(), to_u32(regions.size()), regions.data());
+}
+
 void CommandBuffer::copy_image(const core::Image &src_img, const core::Image &dst_img, const std::vector<VkImageCopy> &regions)
 {
+	flush_barriers();
+
 	vkCmdCopyImage(get_handle(), src_img.get_handle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
 	               dst_img.get_handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 	               to_u32(regions.size()), regions.data());
@@ -444,6 +528,8 @@ void CommandBuffer::copy_image(const core::Image &src_img, const core::Image &ds
 
 void CommandBuffer::copy_buffer_to_image(const core::Buffer &buffer, const core::Image &image, const std::vector<VkBufferImageCopy> &regions)
 {
+	flush_barriers();
+
 	vkCmdCopyBufferToImage(get_handle(), buffer.get_handle(),
 	                       image.get_handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 	                       to_u32(regions.size()), regions.data());
@@ -451,11 +537,27 @@ void CommandBuffer::copy_buffer_to_image(const core::Buffer &buffer, const core:
 
 void CommandBuffer::copy_image_to_buffer(const core::Image &image, VkImageLayout image_layout, const core::Buffer &buffer, const std::vector<VkBufferImageCopy> &regions)
 {
+	flush_barriers();
+
 	vkCmdCopyImageToBuffer(get_handle(), image.get_handle(), image_layout,
 	                       buffer.get_handle(), to_u32(regions.size()), regions.data());
 }
 
-void CommandBuffer::image_memory_barrier(const core::ImageView &image_view, const ImageMemoryBarrier &memory_barrier) const
+void CommandBuffer::image_memory_barrier(const core::ImageView &image_view, const ImageMemoryBarrier &memory_barrier)
+{
+	add_image_memory_barrier(image_view, memory_barrier);
+
+	flush_barriers();
+}
+
+void CommandBuffer::buffer_memory_barrier(const core::Buffer &buffer, VkDeviceSize offset, VkDeviceSize size, const BufferMemoryBarrier &memory_barrier)
+{
+	add_buffer_memory_barrier(buffer, offset, size, memory_barrier);
+
+	flush_barriers();
+}
+
+void CommandBuffer::add_image_memory_barrier(const core::ImageView &image_view, const ImageMemoryBarrier &memory_barrier)
 {
 	// Adjust barrier's subresource range for depth images
 	auto subresource_range = image_view.get_subresource_range();
@@ -469,50 +571,149 @@ void CommandBuffer::image_memory_barrier(const core::ImageView &image_view, cons
 		subresource_range.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
 	}
 
-	VkImageMemoryBarrier image_memory_barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
-	image_memory_barrier.oldLayout           = memory_barrier.old_layout;
-	image_memory_barrier.newLayout           = memory_barrier.new_layout;
-	image_memory_barrier.image               = image_view.get_image().get_handle();
-	image_memory_barrier.subresourceRange    = subresource_range;
+	VkImageMemoryBarrier2KHR image_memory_barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR};
+	image_memory_barrier.srcStageMask        = memory_barrier.src_stage_mask;
+	image_memory_barrier.dstStageMask        = memory_barrier.dst_stage_mask;
 	image_memory_barrier.srcAccessMask       = memory_barrier.src_access_mask;
 	image_memory_barrier.dstAccessMask       = memory_barrier.dst_access_mask;
+	image_memory_barrier.oldLayout           = memory_barrier.old_layout;
+	image_memory_barrier.newLayout           = memory_barrier.new_layout;
 	image_memory_barrier.srcQueueFamilyIndex = memory_barrier.old_queue_family;
 	image_memory_barrier.dstQueueFamilyIndex = memory_barrier.new_queue_family;
+	image_memory_barrier.image               = image_view.get_image().get_handle();
+	image_memory_barrier.subresourceRange    = subresource_range;
 
-	VkPipelineStageFlags src_stage_mask = memory_barrier.src_stage_mask;
-	VkPipelineStageFlags dst_stage_mask = memory_barrier.dst_stage_mask;
+	pending_image_barriers.push_back(image_memory_barrier);
+}
+
+void CommandBuffer::add_buffer_memory_barrier(const core::Buffer &buffer, VkDeviceSize offset, VkDeviceSize size, const BufferMemoryBarrier &memory_barrier)
+{
+	VkBufferMemoryBarrier2KHR buffer_memory_barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR};
+	buffer_memory_barrier.srcStageMask        = memory_barrier.src_stage_mask;
+	buffer_memory_barrier.dstStageMask        = memory_barrier.dst_stage_mask;
+	buffer_memory_barrier.srcAccessMask       = memory_barrier.src_access_mask;
+	buffer_memory_barrier.dstAccessMask       = memory_barrier.dst_access_mask;
+	buffer_memory_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	buffer_memory_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	buffer_memory_barrier.buffer              = buffer.get_handle();
+	buffer_memory_barrier.offset              = offset;
+	buffer_memory_barrier.size                = size;
 
-	vkCmdPipelineBarrier(
-	    get_handle(),
-	    src_stage_mask,
-	    dst_stage_mask,
-	    0,
-	    0, nullptr,
-	    0, nullptr,
-	    1,
-	    &image_memory_barrier);
+	pending_buffer_barriers.push_back(buffer_memory_barrier);
 }
 
-void CommandBuffer::buffer_memory_barrier(const core::Buffer &buffer, VkDeviceSize offset, VkDeviceSize size, const BufferMemoryBarrier &memory_barrier)
+void CommandBuffer::add_memory_barrier(const GlobalMemoryBarrier &memory_barrier)
+{
+	VkMemoryBarrier2KHR global_memory_barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER_2_KHR};
+	global_memory_barrier.srcStageMask  = memory_barrier.src_stage_mask;
+	global_memory_barrier.dstStageMask  = memory_barrier.dst_stage_mask;
+	global_memory_barrier.srcAccessMask = memory_barrier.src_access_mask;
+	global_memory_barrier.dstAccessMask = memory_barrier.dst_access_mask;
+
+	pending_memory_barriers.push_back(global_memory_barrier);
+}
+
+void CommandBuffer::flush_barriers()
 {
-	VkBufferMemoryBarrier buffer_memory_barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
-	buffer_memory_barrier.srcAccessMask = memory_barrier.src_access_mask;
-	buffer_memory_barrier.dstAccessMask = memory_barrier.dst_access_mask;
-	buffer_memory_barrier.buffer        = buffer.get_handle();
-	buffer_memory_barrier.offset        = offset;
-	buffer_memory_barrier.size          = size;
+	if (pending_image_barriers.empty() && pending_buffer_barriers.empty() && pending_memory_barriers.empty())
+	{
+		return;
+	}
+
+	if (synchronization_2)
+	{
+		VkDependencyInfoKHR dependency_info{VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR};
+		dependency_info.memoryBarrierCount       = to_u32(pending_memory_barriers.size());
+		dependency_info.pMemoryBarriers          = pending_memory_barriers.data();
+		dependency_info.bufferMemoryBarrierCount = to_u32(pending_buffer_barriers.size());
+		dependency_info.pBufferMemoryBarriers    = pending_buffer_barriers.data();
+		dependency_info.imageMemoryBarrierCount  = to_u32(pending_image_barriers.size());
+		dependency_info.pImageMemoryBarriers     = pending_image_barriers.data();
+
+		vkCmdPipelineBarrier2KHR(get_handle(), &dependency_info);
+	}
+	else
+	{
+		// The barriers only hold legacy stages and accesses, which have the same bits in both APIs
+		VkPipelineStageFlags src_stage_mask = 0;
+		VkPipelineStageFlags dst_stage_mask = 0;
 
-	VkPipelineStageFlags src_stage_mask = memory_barrier.src_stage_mask;
-	VkPipelineStageFlags dst_stage_mask = memory_barrier.dst_stage_mask;
+		std::vector<VkMemoryBarrier> memory_barriers;
+		memory_barriers.reserve(pending_memory_barriers.size());
 
-	vkCmdPipelineBarrier(
-	    get_handle(),
-	    src_stage_mask,
-	    dst_stage_mask,
-	    0,
-	    0, nullptr,
-	    1, &buffer_memory_barrier,
-	    0, nullptr);
+		for (auto &barrier : pending_memory_barriers)
+		{
+			src_stage_mask |= static_cast<VkPipelineStageFlags>(barrier.srcStageMask);
+			dst_stage_mask |= static_cast<VkPipelineStageFlags>(barrier.dstStageMask);
+
+			VkMemoryBarrier memory_barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+			memory_barrier.srcAccessMask = static_cast<VkAccessFlags>(barrier.srcAccessMask);
+			memory_barrier.dstAccessMask = static_cast<VkAccessFlags>(barrier.dstAccessMask);
+			memory_barriers.push_back(memory_barrier);
+		}
+
+		std::vector<VkBufferMemoryBarrier> buffer_memory_barriers;
+		buffer_memory_barriers.reserve(pending_buffer_barriers.size());
+
+		for (auto &barrier : pending_buffer_barriers)
+		{
+			src_stage_mask |= static_cast<VkPipelineStageFlags>(barrier.srcStageMask);
+			dst_stage_mask |= static_cast<VkPipelineStageFlags>(barrier.dstStageMask);
+
+			VkBufferMemoryBarrier buffer_memory_barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+			buffer_memory_barrier.srcAccessMask       = static_cast<VkAccessFlags>(barrier.srcAccessMask);
+			buffer_memory_barrier.dstAccessMask       = static_cast<VkAccessFlags>(barrier.dstAccessMask);
+			buffer_memory_barrier.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+			buffer_memory_barrier.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+			buffer_memory_barrier.buffer              = barrier.buffer;
+			buffer_memory_barrier.offset              = barrier.offset;
+			buffer_memory_barrier.size                = barrier.size;
+			buffer_memory_barriers.push_back(buffer_memory_barrier);
+		}
+
+		std::vector<VkImageMemoryBarrier> image_memory_barriers;
+		image_memory_barriers.reserve(pending_image_barriers.size());
+
+		for (auto &barrier : pending_image_barriers)
+		{
+			src_stage_mask |= static_cast<VkPipelineStageFlags>(barrier.srcStageMask);
+			dst_stage_mask |= static_cast<VkPipelineStageFlags>(barrier.dstStageMask);
+
+			VkImageMemoryBarrier image_memory_barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+			image_memory_barrier.srcAccessMask       = static_cast<VkAccessFlags>(barrier.srcAccessMask);
+			image_memory_barrier.dstAccessMask       = static_cast<VkAccessFlags>(barrier.dstAccessMask);
+			image_memory_barrier.oldLayout           = barrier.oldLayout;
+			image_memory_barrier.newLayout           = barrier.newLayout;
+			image_memory_barrier.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+			image_memory_barrier.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+			image_memory_barrier.image               = barrier.image;
+			image_memory_barrier.subresourceRange    = barrier.subresourceRange;
+			image_memory_barriers.push_back(image_memory_barrier);
+		}
+
+		vkCmdPipelineBarrier(
+		    get_handle(),
+		    src_stage_mask,
+		    dst_stage_mask,
+		    0,
+		    to_u32(memory_barriers.size()), memory_barriers.data(),
+		    to_u32(buffer_memory_barriers.size()), buffer_memory_barriers.data(),
+		    to_u32(image_memory_barriers.size()), image_memory_barriers.data());
+	}
+
+	barrier_statistics.pipeline_barrier_count++;
+	barrier_statistics.image_barrier_count += to_u32(pending_image_barriers.size());
+	barrier_statistics.buffer_barrier_count += to_u32(pending_buffer_barriers.size());
+	barrier_statistics.memory_barrier_count += to_u32(pending_memory_barriers.size());
+
+	pending_image_barriers.clear();
+	pending_buffer_barriers.clear();
+	pending_memory_barriers.clear();
+}
+
+const BarrierStatistics &CommandBuffer::get_barrier_statistics() const
+{
+	return barrier_statistics;
 }
 
 void CommandBuffer::flush_pipeline_state(VkPipelineBindPoint pipeline_bind_point)
@@ -618,11 +819,33 @@ void CommandBuffer::flush_descriptor_state(VkPipelineBindPoint pipeline_bind_poi
 			// Make descriptor set layout bound for current set
 			descriptor_set_layout_binding_state[descriptor_set_id] = &descriptor_set_layout;
 
+			std::vector<uint32_t> dynamic_offsets;
+
+			// Write a flat payload with the update template of the layout, instead of building binding maps
+			if (command_pool.get_render_frame()->get_descriptor_update_strategy() == DescriptorUpdateStrategy::UseUpdateTemplates &&
+			    descriptor_set_layout.get_update_template() != VK_NULL_HANDLE && !update_after_bind)
+			{
+				VkDescriptorSet descriptor_set_handle = request_template_descriptor_set(descriptor_set_layout, resource_set, dynamic_offsets);
+
+				if (descriptor_set_handle != VK_NULL_HANDLE)
+				{
+					vkCmdBindDescriptorSets(get_handle(),
+					                        pipeline_bind_point,
+					                        pipeline_layout.get_handle(),
+					                        descriptor_set_id,
+					                        1, &descriptor_set_handle,
+					                        to_u32(dynamic_offsets.size()),
+					                        dynamic_offsets.data());
+					continue;
+				}
+
+				// Some descriptors are not bound, only write the bound ones
+				dynamic_offsets.clear();
+			}
+
 			BindingMap<VkDescriptorBufferInfo> buffer_infos;
 			BindingMap<VkDescriptorImageInfo>  image_infos;
 
-			std::vector<uint32_t> dynamic_offsets;
-
 			// Iterate over all resource bindings
 			for (auto &binding_it : resource_set.get_resource_bindings())
 			{
@@ -670,31 +893,10 @@ void CommandBuffer::flush_descriptor_state(VkPipelineBindPoint pipeline_bind_poi
 							image_info.sampler   = sampler ? sampler->get_handle() : VK_NULL_HANDLE;
 							image_info.imageView = image_view->get_handle();
 
-							if (image_view != nullptr)
+							// Add image layout info based on descriptor type
+							if (image_view != nullptr && !get_descriptor_image_layout(binding_info->descriptorType, *image_view, image_info.imageLayout))
 							{
-								// Add image layout info based on descriptor type
-								switch (binding_info->descriptorType)
-								{
-									case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
-										image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-										break;
-									case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
-										if (is_depth_stencil_format(image_view->get_format()))
-										{
-											image_info.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
-										}
-										else
-										{
-											image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-										}
-										break;
-									case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
-										image_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-										break;
-
-									default:
-										continue;
-								}
+								continue;
 							}
 
 							image_infos[binding_index][array_element] = image_info;
@@ -726,6 +928,79 @@ void CommandBuffer::flush_descriptor_state(VkPipelineBindPoint pipeline_bind_poi
 	}
 }
 
+VkDescriptorSet CommandBuffer::request_template_descriptor_set(const DescriptorSetLayout &descriptor_set_layout, const ResourceSet &resource_set, std::vector<uint32_t> &dynamic_offsets)
+{
+	std::vector<DescriptorTemplateElement> payload(descriptor_set_layout.get_template_element_count());
+
+	uint32_t written_count = 0;
+
+	for (auto &binding_it : resource_set.get_resource_bindings())
+	{
+		auto  binding_index     = binding_it.first;
+		auto &binding_resources = binding_it.second;
+
+		auto binding_info    = descriptor_set_layout.get_layout_binding(binding_index);
+		auto template_offset = descriptor_set_layout.get_template_offset(binding_index);
+
+		if (!binding_info || template_offset < 0)
+		{
+			continue;
+		}
+
+		for (auto &element_it : binding_resources)
+		{
+			auto  array_element = element_it.first;
+			auto &resource_info = element_it.second;
+
+			if (array_element >= binding_info->descriptorCount)
+			{
+				continue;
+			}
+
+			// Members are set one by one, so that padding stays zeroed and payloads can be hashed bytewise
+			auto &element = payload[template_offset + array_element];
+
+			if (resource_info.buffer != nullptr && is_buffer_descriptor_type(binding_info->descriptorType))
+			{
+				element.buffer_info.buffer = resource_info.buffer->get_handle();
+				element.buffer_info.offset = resource_info.offset;
+				element.buffer_info.range  = resource_info.range;
+
+				if (is_dynamic_buffer_descriptor_type(binding_info->descriptorType))
+				{
+					dynamic_offsets.push_back(to_u32(element.buffer_info.offset));
+
+					element.buffer_info.offset = 0;
+				}
+			}
+			else if (resource_info.image_view != nullptr || resource_info.sampler != nullptr)
+			{
+				element.image_info.sampler   = resource_info.sampler ? resource_info.sampler->get_handle() : VK_NULL_HANDLE;
+				element.image_info.imageView = resource_info.image_view ? resource_info.image_view->get_handle() : VK_NULL_HANDLE;
+
+				if (resource_info.image_view != nullptr && !get_descriptor_image_layout(binding_info->descriptorType, *resource_info.image_view, element.image_info.imageLayout))
+				{
+					continue;
+				}
+			}
+			else
+			{
+				continue;
+			}
+
+			++written_count;
+		}
+	}
+
+	// A template writes every descriptor of the layout, so it cannot be used if some are missing
+	if (written_count != payload.size())
+	{
+		return VK_NULL_HANDLE;
+	}
+
+	return command_pool.get_render_frame()->request_descriptor_set(descriptor_set_layout, payload, command_pool.get_thread_index());
+}
+
 void CommandBuffer::flush_push_constants()
 {
 	if (stored_push_constants.empty())
@@ -780,22 +1055,30 @@ const bool CommandBuffer::is_render_size_optimal(const VkExtent2D &framebuffer_e
 
 void CommandBuffer::reset_query_pool(const QueryPool &query_pool, uint32_t first_query, uint32_t query_count)
 {
+	flush_barriers();
+
 	vkCmdResetQueryPool(get_handle(), query_pool.get_handle(), first_query, query_count);
 }
 
 void CommandBuffer::begin_query(const QueryPool &query_pool, uint32_t query, VkQueryControlFlags flags)
 {
+	flush_barriers();
+
 	vkCmdBeginQuery(get_handle(), query_pool.get_handle(), query, flags);
 }
 
 void CommandBuffer::end_query(const QueryPool &query_pool, uint32_t query)
 {
+	flush_barriers();
+
 	vkCmdEndQuery(get_handle(), query_pool.get_handle(), query);
 }
 
 void CommandBuffer::write_timestamp(VkPipelineStageFlagBits pipeline_stage,
                                     const QueryPool &query_pool, uint32_t query)
 {
+	flush_barriers();
+
 	vkCmdWriteTimestamp(get_handle(), pipeline_stage, query_pool.get_handle(), query);
 }
 
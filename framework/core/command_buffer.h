@@ -35,6 +35,7 @@ namespace vkb
 {
 class CommandPool;
 class DescriptorSet;
+class DescriptorSetLayout;
 class Framebuffer;
 class Pipeline;
 class PipelineLayout;
@@ -208,6 +209,11 @@ class CommandBuffer : public core::VulkanResource<VkCommandBuffer, VK_OBJECT_TYP
 
 	void draw_indexed_indirect(const core::Buffer &buffer, VkDeviceSize offset, uint32_t draw_count, uint32_t stride);
 
+	/**
+	 * @brief Draws with a draw count read from a buffer, requires VK_KHR_draw_indirect_count
+	 */
+	void draw_indexed_indirect_count(const core::Buffer &buffer, VkDeviceSize offset, const core::Buffer &count_buffer, VkDeviceSize count_buffer_offset, uint32_t max_draw_count, uint32_t stride);
+
 	void dispatch(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z);
 
 	void dispatch_indirect(const core::Buffer &buffer, VkDeviceSize offset);
@@ -220,16 +226,53 @@ class CommandBuffer : public core::VulkanResource<VkCommandBuffer, VK_OBJECT_TYP
 
 	void copy_buffer(const core::Buffer &src_buffer, const core::Buffer &dst_buffer, VkDeviceSize size);
 
+	void copy_buffer(const core::Buffer &src_buffer, const core::Buffer &dst_buffer, const std::vector<VkBufferCopy> &regions);
+
 	void copy_image(const core::Image &src_img, const core::Image &dst_img, const std::vector<VkImageCopy> &regions);
 
 	void copy_buffer_to_image(const core::Buffer &buffer, const core::Image &image, const std::vector<VkBufferImageCopy> &regions);
 
 	void copy_image_to_buffer(const core::Image &image, VkImageLayout image_layout, const core::Buffer &buffer, const std::vector<VkBufferImageCopy> &regions);
 
-	void image_memory_barrier(const core::ImageView &image_view, const ImageMemoryBarrier &memory_barrier) const;
+	/**
+	 * @brief Records an image memory barrier straight away, after the pending barriers
+	 */
+	void image_memory_barrier(const core::ImageView &image_view, const ImageMemoryBarrier &memory_barrier);
 
+	/**
+	 * @brief Records a buffer memory barrier straight away, after the pending barriers
+	 */
 	void buffer_memory_barrier(const core::Buffer &buffer, VkDeviceSize offset, VkDeviceSize size, const BufferMemoryBarrier &memory_barrier);
 
+	/**
+	 * @brief Adds an image memory barrier to the pending barriers, which are recorded together before
+	 *        the next command recorded through this CommandBuffer. Commands recorded directly on the
+	 *        handle must be preceded by a call to flush_barriers().
+	 */
+	void add_image_memory_barrier(const core::ImageView &image_view, const ImageMemoryBarrier &memory_barrier);
+
+	/**
+	 * @brief Adds a buffer memory barrier to the pending barriers
+	 */
+	void add_buffer_memory_barrier(const core::Buffer &buffer, VkDeviceSize offset, VkDeviceSize size, const BufferMemoryBarrier &memory_barrier);
+
+	/**
+	 * @brief Adds a global memory barrier to the pending barriers
+	 */
+	void add_memory_barrier(const GlobalMemoryBarrier &memory_barrier);
+
+	/**
+	 * @brief Records the pending barriers with a single vkCmdPipelineBarrier2KHR if VK_KHR_synchronization2
+	 *        is enabled, which keeps the stages of each barrier, or else with a single vkCmdPipelineBarrier
+	 *        waiting for the stages of all of them
+	 */
+	void flush_barriers();
+
+	/**
+	 * @return The barriers recorded since the command buffer began recording
+	 */
+	const BarrierStatistics &get_barrier_statistics() const;
+
 	const State get_state() const;
 
 	void set_update_after_bind(bool update_after_bind_);
@@ -277,6 +320,18 @@ class CommandBuffer : public core::VulkanResource<VkCommandBuffer, VK_OBJECT_TYP
 
 	std::unordered_map<uint32_t, DescriptorSetLayout *> descriptor_set_layout_binding_state;
 
+	/// Whether barriers are recorded with VK_KHR_synchronization2
+	bool synchronization_2{false};
+
+	/// Barriers waiting to be recorded, with the stages of each of them
+	std::vector<VkImageMemoryBarrier2KHR> pending_image_barriers;
+
+	std::vector<VkBufferMemoryBarrier2KHR> pending_buffer_barriers;
+
+	std::vector<VkMemoryBarrier2KHR> pending_memory_barriers;
+
+	BarrierStatistics barrier_statistics;
+
 	const RenderPassBinding &get_current_render_pass() const;
 
 	const uint32_t get_current_subpass_index() const;
@@ -296,6 +351,15 @@ class CommandBuffer : public core::VulkanResource<VkCommandBuffer, VK_OBJECT_TYP
 	 */
 	void flush_descriptor_state(VkPipelineBindPoint pipeline_bind_point);
 
+	/**
+	 * @brief Requests a descriptor set written from a flat payload with the update template of its layout
+	 * @param descriptor_set_layout A layout which has an update template
+	 * @param resource_set The resources bound to the set
+	 * @param dynamic_offsets Receives the offsets of dynamic buffers, in binding order
+	 * @return The descriptor set, or VK_NULL_HANDLE if the resources do not cover every descriptor of the layout
+	 */
+	VkDescriptorSet request_template_descriptor_set(const DescriptorSetLayout &descriptor_set_layout, const ResourceSet &resource_set, std::vector<uint32_t> &dynamic_offsets);
+
 	/**
 	 * @brief Flush the push constant state
 	 */
@@ -22,11 +22,13 @@
 
 namespace vkb
 {
-DescriptorPool::DescriptorPool(Device &                   device,
-                               const DescriptorSetLayout &descriptor_set_layout,
-                               uint32_t                   pool_size) :
+DescriptorPool::DescriptorPool(Device &                    device,
+                               const DescriptorSetLayout & descriptor_set_layout,
+                               uint32_t                    pool_size,
+                               VkDescriptorPoolCreateFlags flags) :
     device{device},
-    descriptor_set_layout{&descriptor_set_layout}
+    descriptor_set_layout{&descriptor_set_layout},
+    pool_flags{flags}
 {
 	const auto &bindings = descriptor_set_layout.get_bindings();
 
@@ -130,7 +132,7 @@ VkResult DescriptorPool::free(VkDescriptorSet descriptor_set)
 	// Get the pool index of the descriptor set
 	auto it = set_pool_mapping.find(descriptor_set);
 
-	if (it == set_pool_mapping.end())
+	if (it == set_pool_mapping.end() || !(pool_flags & VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT))
 	{
 		return VK_INCOMPLETE;
 	}
@@ -163,8 +165,7 @@ std::uint32_t DescriptorPool::find_available_pool(std::uint32_t search_index)
 		create_info.pPoolSizes    = pool_sizes.data();
 		create_info.maxSets       = pool_max_sets;
 
-		// We do not set FREE_DESCRIPTOR_SET_BIT as we do not need to free individual descriptor sets
-		create_info.flags = 0;
+		create_info.flags = pool_flags;
 
 		// Check descriptor set layout and enable the required flags
 		auto &binding_flags = descriptor_set_layout->get_binding_flags();
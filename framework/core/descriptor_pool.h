@@ -35,9 +35,17 @@ class DescriptorPool
   public:
 	static const uint32_t MAX_SETS_PER_POOL = 16;
 
-	DescriptorPool(Device &                   device,
-	               const DescriptorSetLayout &descriptor_set_layout,
-	               uint32_t                   pool_size = MAX_SETS_PER_POOL);
+	/**
+	 * @param device A valid Vulkan device
+	 * @param descriptor_set_layout Layout of the sets allocated from the pool
+	 * @param pool_size Number of sets of each VkDescriptorPool
+	 * @param flags Flags of the VkDescriptorPool, which need VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT
+	 *              for free() to be used. Pools which are only reset do not need it.
+	 */
+	DescriptorPool(Device &                    device,
+	               const DescriptorSetLayout & descriptor_set_layout,
+	               uint32_t                    pool_size = MAX_SETS_PER_POOL,
+	               VkDescriptorPoolCreateFlags flags     = 0);
 
 	DescriptorPool(const DescriptorPool &) = delete;
 
@@ -70,6 +78,9 @@ class DescriptorPool
 	// Number of sets to allocate for each pool
 	uint32_t pool_max_sets{0};
 
+	// Flags of the pools to create
+	VkDescriptorPoolCreateFlags pool_flags{0};
+
 	// Total descriptor pools created
 	std::vector<VkDescriptorPool> pools;
 
@@ -186,6 +186,67 @@ DescriptorSetLayout::DescriptorSetLayout(Device &                           devi
 	{
 		throw VulkanException{result, "Cannot create DescriptorSetLayout"};
 	}
+
+	if (device.is_enabled(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME))
+	{
+		create_update_template();
+	}
+}
+
+void DescriptorSetLayout::create_update_template()
+{
+	// Update-after-bind and partially bound bindings are written individually
+	if (std::find_if(binding_flags.begin(), binding_flags.end(), [](VkDescriptorBindingFlagsEXT flags) { return flags != 0; }) != binding_flags.end())
+	{
+		return;
+	}
+
+	// Lay out every descriptor of the set contiguously, binding after binding
+	std::vector<VkDescriptorUpdateTemplateEntryKHR> entries;
+
+	for (auto &binding : bindings)
+	{
+		if (binding.descriptorCount == 0)
+		{
+			continue;
+		}
+
+		VkDescriptorUpdateTemplateEntryKHR entry{};
+		entry.dstBinding      = binding.binding;
+		entry.dstArrayElement = 0;
+		entry.descriptorCount = binding.descriptorCount;
+		entry.descriptorType  = binding.descriptorType;
+		entry.offset          = template_element_count * sizeof(DescriptorTemplateElement);
+		entry.stride          = sizeof(DescriptorTemplateElement);
+
+		entries.push_back(entry);
+
+		template_offsets.emplace(binding.binding, template_element_count);
+
+		template_element_count += binding.descriptorCount;
+	}
+
+	if (entries.empty())
+	{
+		return;
+	}
+
+	VkDescriptorUpdateTemplateCreateInfoKHR create_info{VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO_KHR};
+	create_info.descriptorUpdateEntryCount = to_u32(entries.size());
+	create_info.pDescriptorUpdateEntries   = entries.data();
+	create_info.templateType               = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET_KHR;
+	create_info.descriptorSetLayout        = handle;
+
+	VkResult result = vkCreateDescriptorUpdateTemplateKHR(device.get_handle(), &create_info, nullptr, &update_template);
+
+	if (result != VK_SUCCESS)
+	{
+		LOGW("Cannot create descriptor update template, descriptors will be written individually");
+
+		update_template = VK_NULL_HANDLE;
+		template_offsets.clear();
+		template_element_count = 0;
+	}
 }
 
 DescriptorSetLayout::DescriptorSetLayout(DescriptorSetLayout &&other) :
@@ -197,13 +258,22 @@ DescriptorSetLayout::DescriptorSetLayout(DescriptorSetLayout &&other) :
     binding_flags{std::move(other.binding_flags)},
     bindings_lookup{std::move(other.bindings_lookup)},
     binding_flags_lookup{std::move(other.binding_flags_lookup)},
-    resources_lookup{std::move(other.resources_lookup)}
+    resources_lookup{std::move(other.resources_lookup)},
+    update_template{other.update_template},
+    template_offsets{std::move(other.template_offsets)},
+    template_element_count{other.template_element_count}
 {
-	other.handle = VK_NULL_HANDLE;
+	other.handle          = VK_NULL_HANDLE;
+	other.update_template = VK_NULL_HANDLE;
 }
 
 DescriptorSetLayout::~DescriptorSetLayout()
 {
+	if (update_template != VK_NULL_HANDLE)
+	{
+		vkDestroyDescriptorUpdateTemplateKHR(device.get_handle(), update_template, nullptr);
+	}
+
 	// Destroy descriptor set layout
 	if (handle != VK_NULL_HANDLE)
 	{
@@ -272,4 +342,25 @@ const std::vector<ShaderModule *> &DescriptorSetLayout::get_shader_modules() con
 	return shader_modules;
 }
 
+VkDescriptorUpdateTemplate DescriptorSetLayout::get_update_template() const
+{
+	return update_template;
+}
+
+int32_t DescriptorSetLayout::get_template_offset(uint32_t binding_index) const
+{
+	auto it = template_offsets.find(binding_index);
+
+	if (it == template_offsets.end())
+	{
+		return -1;
+	}
+
+	return static_cast<int32_t>(it->second);
+}
+
+uint32_t DescriptorSetLayout::get_template_element_count() const
+{
+	return template_element_count;
+}
 }        // namespace vkb
@@ -28,6 +28,16 @@ class ShaderModule;
 
 struct ShaderResource;
 
+/**
+ * @brief One descriptor of the flat payload written with a descriptor update template
+ */
+union DescriptorTemplateElement
+{
+	VkDescriptorBufferInfo buffer_info;
+
+	VkDescriptorImageInfo image_info;
+};
+
 /**
  * @brief Caches DescriptorSet objects for the shader's set index.
  *        Creates a DescriptorPool to allocate the DescriptorSet objects
@@ -73,6 +83,22 @@ class DescriptorSetLayout
 
 	const std::vector<ShaderModule *> &get_shader_modules() const;
 
+	/**
+	 * @return The descriptor update template writing every binding of the layout from a flat payload,
+	 *         or VK_NULL_HANDLE if VK_KHR_descriptor_update_template is not enabled or the layout has binding flags
+	 */
+	VkDescriptorUpdateTemplate get_update_template() const;
+
+	/**
+	 * @return Index of the first element of a binding in the update template payload, or -1 if the binding does not exist
+	 */
+	int32_t get_template_offset(uint32_t binding_index) const;
+
+	/**
+	 * @return Number of elements of the update template payload, one per descriptor of the layout
+	 */
+	uint32_t get_template_element_count() const;
+
   private:
 	Device &device;
 
@@ -91,5 +117,13 @@ class DescriptorSetLayout
 	std::unordered_map<std::string, uint32_t> resources_lookup;
 
 	std::vector<ShaderModule *> shader_modules;
+
+	VkDescriptorUpdateTemplate update_template{VK_NULL_HANDLE};
+
+	std::unordered_map<uint32_t, uint32_t> template_offsets;
+
+	uint32_t template_element_count{0};
+
+	void create_update_template();
 };
 }        // namespace vkb
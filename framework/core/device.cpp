@@ -258,6 +258,8 @@ Device::~Device()
 {
 	resource_cache.clear();
 
+	queue_timelines.clear();
+
 	command_pool.reset();
 	fence_pool.reset();
 
@@ -367,7 +369,7 @@ uint32_t Device::get_memory_type(uint32_t bits, VkMemoryPropertyFlags properties
 	}
 }
 
-const Queue &Device::get_queue(uint32_t queue_family_index, uint32_t queue_index)
+const Queue &Device::get_queue(uint32_t queue_family_index, uint32_t queue_index) const
 {
 	return queues[queue_family_index][queue_index];
 }
@@ -648,6 +650,29 @@ void Device::create_internal_command_pool()
 	command_pool = std::make_unique<CommandPool>(*this, get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT, 0).get_family_index());
 }
 
+void Device::create_queue_timelines()
+{
+	for (auto &queue_family : queues)
+	{
+		for (auto &queue : queue_family)
+		{
+			queue_timelines[&queue] = std::make_unique<QueueTimeline>(*this, queue);
+		}
+	}
+}
+
+bool Device::has_queue_timelines() const
+{
+	return !queue_timelines.empty();
+}
+
+QueueTimeline &Device::get_queue_timeline(const Queue &queue) const
+{
+	auto it = queue_timelines.find(&queue);
+	assert(it != queue_timelines.end() && "Queue has no timeline, call create_queue_timelines()");
+	return *it->second;
+}
+
 void Device::prepare_memory_allocator()
 {
 	bool can_get_memory_requirements = is_extension_supported("VK_KHR_get_memory_requirements2");
@@ -37,6 +37,7 @@
 #include "core/swapchain.h"
 #include "core/vulkan_resource.h"
 #include "fence_pool.h"
+#include "queue_timeline.h"
 #include "rendering/pipeline_state.h"
 #include "rendering/render_target.h"
 #include "resource_cache.h"
@@ -107,7 +108,7 @@ class Device : public core::VulkanResource<VkDevice, VK_OBJECT_TYPE_DEVICE>
 	 */
 	bool is_image_format_supported(VkFormat format) const;
 
-	const Queue &get_queue(uint32_t queue_family_index, uint32_t queue_index);
+	const Queue &get_queue(uint32_t queue_family_index, uint32_t queue_index) const;
 
 	const Queue &get_queue_by_flags(VkQueueFlags queue_flags, uint32_t queue_index) const;
 
@@ -210,6 +211,22 @@ class Device : public core::VulkanResource<VkDevice, VK_OBJECT_TYPE_DEVICE>
 	 */
 	void create_internal_command_pool();
 
+	/**
+	 * @brief Creates a timeline semaphore for each queue of this device, which must have been
+	 *        created with the timelineSemaphore feature of VK_KHR_timeline_semaphore
+	 */
+	void create_queue_timelines();
+
+	/**
+	 * @return Whether the queues have timeline semaphores, see create_queue_timelines()
+	 */
+	bool has_queue_timelines() const;
+
+	/**
+	 * @return The timeline semaphore of a queue of this device
+	 */
+	QueueTimeline &get_queue_timeline(const Queue &queue) const;
+
 	/**
 	 * @brief Creates and sets up the Vulkan memory allocator
 	 */
@@ -246,6 +263,9 @@ class Device : public core::VulkanResource<VkDevice, VK_OBJECT_TYPE_DEVICE>
 	/// A fence pool associated to the primary queue
 	std::unique_ptr<FencePool> fence_pool;
 
+	/// Timeline semaphores of the queues, if created
+	std::unordered_map<const Queue *, std::unique_ptr<QueueTimeline>> queue_timelines;
+
 	ResourceCache resource_cache;
 };
 }        // namespace vkb
@@ -83,6 +83,8 @@ inline EShLanguage FindShaderLanguage(VkShaderStageFlagBits stage)
 
 glslang::EShTargetLanguage        GLSLCompiler::env_target_language         = glslang::EShTargetLanguage::EShTargetNone;
 glslang::EShTargetLanguageVersion GLSLCompiler::env_target_language_version = static_cast<glslang::EShTargetLanguageVersion>(0);
+SpirvCache                        GLSLCompiler::spirv_cache;
+bool                              GLSLCompiler::spirv_cache_enabled = true;
 
 void GLSLCompiler::set_target_environment(glslang::EShTargetLanguage target_language, glslang::EShTargetLanguageVersion target_language_version)
 {
@@ -96,6 +98,16 @@ void GLSLCompiler::reset_target_environment()
 	GLSLCompiler::env_target_language_version = static_cast<glslang::EShTargetLanguageVersion>(0);
 }
 
+void GLSLCompiler::set_spirv_cache_enabled(bool enabled)
+{
+	GLSLCompiler::spirv_cache_enabled = enabled;
+}
+
+SpirvCache &GLSLCompiler::get_spirv_cache()
+{
+	return GLSLCompiler::spirv_cache;
+}
+
 bool GLSLCompiler::compile_to_spirv(VkShaderStageFlagBits       stage,
                                     const std::vector<uint8_t> &glsl_source,
                                     const std::string          &entry_point,
@@ -103,6 +115,26 @@ bool GLSLCompiler::compile_to_spirv(VkShaderStageFlagBits       stage,
                                     std::vector<std::uint32_t> &spirv,
                                     std::string                &info_log)
 {
+	SpirvCache::Key cache_key;
+
+	if (GLSLCompiler::spirv_cache_enabled)
+	{
+		static const std::string compiler_version = [] {
+			auto version = glslang::GetVersion();
+			return fmt::format("glslang {}.{}.{}{}", version.major, version.minor, version.patch, version.flavor);
+		}();
+
+		cache_key = SpirvCache::make_key(compiler_version, stage, glsl_source, entry_point,
+		                                 shader_variant.get_preamble(), shader_variant.get_processes(),
+		                                 static_cast<uint32_t>(GLSLCompiler::env_target_language),
+		                                 static_cast<uint32_t>(GLSLCompiler::env_target_language_version));
+
+		if (GLSLCompiler::spirv_cache.load(cache_key, spirv))
+		{
+			return true;
+		}
+	}
+
 	// Initialize glslang library.
 	glslang::InitializeProcess();
 
@@ -171,6 +203,11 @@ bool GLSLCompiler::compile_to_spirv(VkShaderStageFlagBits       stage,
 	// Shutdown glslang library.
 	glslang::FinalizeProcess();
 
+	if (GLSLCompiler::spirv_cache_enabled)
+	{
+		GLSLCompiler::spirv_cache.store(cache_key, spirv);
+	}
+
 	return true;
 }
 }        // namespace vkb
@@ -28,6 +28,7 @@ VKBP_ENABLE_WARNINGS()
 
 #include "common/vk_common.h"
 #include "core/shader_module.h"
+#include "spirv_cache.h"
 
 namespace vkb
 {
@@ -39,6 +40,10 @@ class GLSLCompiler
 	static glslang::EShTargetLanguage        env_target_language;
 	static glslang::EShTargetLanguageVersion env_target_language_version;
 
+	static SpirvCache spirv_cache;
+
+	static bool spirv_cache_enabled;
+
   public:
 	/**
 	 * @brief Set the glslang target environment to translate to when generating code
@@ -53,6 +58,15 @@ class GLSLCompiler
 	 */
 	static void reset_target_environment();
 
+	/**
+	 * @brief Enables or disables the persistent SPIR-V cache, enabled by default.
+	 *        When enabled, compilations whose inputs were already compiled in a previous
+	 *        run load the SPIR-V from the temporary directory instead of invoking glslang.
+	 */
+	static void set_spirv_cache_enabled(bool enabled);
+
+	static SpirvCache &get_spirv_cache();
+
 	/**
 	 * @brief Compiles GLSL to SPIRV code
 	 * @param stage The Vulkan shader stage flag
@@ -20,13 +20,21 @@
 #define TINYGLTF_IMPLEMENTATION
 #include "gltf_loader.h"
 
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <exception>
+#include <functional>
 #include <limits>
+#include <mutex>
+#include <numeric>
 #include <queue>
 
 #include "common/error.h"
 
 VKBP_DISABLE_WARNINGS()
 #include "common/glm_common.h"
+#include <glm/gtc/packing.hpp>
 #include <glm/gtc/type_ptr.hpp>
 VKBP_ENABLE_WARNINGS()
 
@@ -36,6 +44,7 @@ VKBP_ENABLE_WARNINGS()
 #include "common/vk_common.h"
 #include "core/device.h"
 #include "core/image.h"
+#include "mesh_optimizer.h"
 #include "platform/filesystem.h"
 #include "scene_graph/components/camera.h"
 #include "scene_graph/components/image.h"
@@ -51,8 +60,7 @@ VKBP_ENABLE_WARNINGS()
 #include "scene_graph/node.h"
 #include "scene_graph/scene.h"
 #include "scene_graph/scripts/animation.h"
-
-#include <ctpl_stl.h>
+#include "staging_ring.h"
 
 namespace vkb
 {
@@ -286,23 +294,8 @@ inline std::vector<uint8_t> convert_underlying_data_stride(const std::vector<uin
 	return result;
 }
 
-inline void upload_image_to_gpu(CommandBuffer &command_buffer, core::Buffer &staging_buffer, sg::Image &image)
+inline std::vector<VkBufferImageCopy> get_image_copy_regions(sg::Image &image)
 {
-	// Clean up the image data, as they are copied in the staging buffer
-	image.clear_data();
-
-	{
-		ImageMemoryBarrier memory_barrier{};
-		memory_barrier.old_layout      = VK_IMAGE_LAYOUT_UNDEFINED;
-		memory_barrier.new_layout      = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-		memory_barrier.src_access_mask = 0;
-		memory_barrier.dst_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		memory_barrier.src_stage_mask  = VK_PIPELINE_STAGE_HOST_BIT;
-		memory_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
-
-		command_buffer.image_memory_barrier(image.get_vk_image_view(), memory_barrier);
-	}
-
 	// Create a buffer image copy for every mip level
 	auto &mipmaps = image.get_mipmaps();
 
@@ -320,81 +313,691 @@ inline void upload_image_to_gpu(CommandBuffer &command_buffer, core::Buffer &sta
 		copy_region.imageExtent               = mipmap.extent;
 	}
 
-	command_buffer.copy_buffer_to_image(staging_buffer, image.get_vk_image(), buffer_copy_regions);
+	return buffer_copy_regions;
+}
+
+/**
+ * @brief Greedily groups a range of triangles into meshlets. A meshlet grows with the triangle adjacent to its last
+ *        triangle which adds the fewest vertices, the closest to its center first. If there is none, any triangle
+ *        adjacent to the meshlet is taken, then the next triangle of the range. A new meshlet starts from the chosen
+ *        triangle when it does not fit, so consecutive meshlets stay close to each other.
+ */
+void build_meshlets(const uint32_t *indices, size_t triangle_count, const float *positions, size_t vertex_count, std::vector<Meshlet> &meshlets)
+{
+	constexpr uint32_t max_vertices  = 64;
+	constexpr uint32_t max_triangles = 126;
+	constexpr uint32_t no_triangle   = std::numeric_limits<uint32_t>::max();
+	constexpr uint8_t  no_slot       = std::numeric_limits<uint8_t>::max();
+
+	// Triangles of each vertex, in compressed rows
+	std::vector<uint32_t> triangle_offsets(vertex_count + 1, 0);
+	for (size_t i = 0; i < triangle_count * 3; ++i)
+	{
+		assert(indices[i] < vertex_count);
+		triangle_offsets[indices[i] + 1]++;
+	}
+	std::partial_sum(triangle_offsets.begin(), triangle_offsets.end(), triangle_offsets.begin());
+
+	std::vector<uint32_t> vertex_triangles(triangle_count * 3);
+	{
+		std::vector<uint32_t> fill_offsets(triangle_offsets.begin(), triangle_offsets.end() - 1);
+		for (size_t i = 0; i < triangle_count * 3; ++i)
+		{
+			vertex_triangles[fill_offsets[indices[i]]++] = to_u32(i / 3);
+		}
+	}
+
+	// Slot of each vertex in the current meshlet, used instead of a map for deduplication
+	std::vector<uint8_t> vertex_slots(vertex_count, no_slot);
+	std::vector<bool>    emitted(triangle_count, false);
+
+	auto get_position = [positions](uint32_t vertex) {
+		return glm::make_vec3(&positions[vertex * 3]);
+	};
+
+	auto get_centroid = [&](uint32_t triangle) {
+		return (get_position(indices[triangle * 3]) + get_position(indices[triangle * 3 + 1]) + get_position(indices[triangle * 3 + 2])) / 3.0f;
+	};
+
+	auto get_new_vertex_count = [&](uint32_t triangle) {
+		const uint32_t *corners = &indices[triangle * 3];
+
+		uint32_t count = 0;
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			count += vertex_slots[corners[i]] == no_slot && (i == 0 || corners[i] != corners[0]) && (i < 2 || corners[2] != corners[1]);
+		}
+		return count;
+	};
+
+	Meshlet   meshlet{};
+	glm::vec3 centroid_sum{0.0f};
+
+	auto finish_meshlet = [&]() {
+		for (uint32_t i = 0; i < meshlet.unique_index_count; ++i)
+		{
+			vertex_slots[meshlet.unique_indices[i]] = no_slot;
+		}
+
+		meshlets.push_back(meshlet);
+
+		meshlet.unique_index_count    = 0;
+		meshlet.primitive_index_count = 0;
+		centroid_sum                  = glm::vec3{0.0f};
+	};
 
+	uint32_t last_triangle = no_triangle;
+	size_t   scan_position = 0;
+
+	for (size_t emitted_count = 0; emitted_count < triangle_count; ++emitted_count)
 	{
-		ImageMemoryBarrier memory_barrier{};
-		memory_barrier.old_layout      = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-		memory_barrier.new_layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		memory_barrier.src_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		memory_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
-		memory_barrier.src_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
-		memory_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		uint32_t meshlet_triangle_count = meshlet.primitive_index_count / 3;
+		glm::vec3 center                = meshlet_triangle_count > 0 ? centroid_sum / static_cast<float>(meshlet_triangle_count) : glm::vec3{0.0f};
+
+		uint32_t best_triangle     = no_triangle;
+		uint32_t best_new_vertices = 4;
+		float    best_distance     = std::numeric_limits<float>::max();
+
+		auto consider_vertex_triangles = [&](uint32_t vertex) {
+			for (uint32_t i = triangle_offsets[vertex]; i < triangle_offsets[vertex + 1]; ++i)
+			{
+				uint32_t triangle = vertex_triangles[i];
+
+				if (emitted[triangle])
+				{
+					continue;
+				}
+
+				uint32_t new_vertices = get_new_vertex_count(triangle);
+				float    distance     = glm::length(get_centroid(triangle) - center);
+
+				if (new_vertices < best_new_vertices || (new_vertices == best_new_vertices && distance < best_distance))
+				{
+					best_triangle     = triangle;
+					best_new_vertices = new_vertices;
+					best_distance     = distance;
+				}
+			}
+		};
+
+		if (last_triangle != no_triangle)
+		{
+			for (uint32_t i = 0; i < 3; ++i)
+			{
+				consider_vertex_triangles(indices[last_triangle * 3 + i]);
+			}
+		}
+
+		if (best_triangle == no_triangle)
+		{
+			for (uint32_t i = 0; i < meshlet.unique_index_count; ++i)
+			{
+				consider_vertex_triangles(meshlet.unique_indices[i]);
+			}
+		}
+
+		if (best_triangle == no_triangle)
+		{
+			while (emitted[scan_position])
+			{
+				++scan_position;
+			}
+
+			best_triangle = to_u32(scan_position);
+		}
+
+		if (meshlet.unique_index_count + get_new_vertex_count(best_triangle) > max_vertices || meshlet_triangle_count + 1 > max_triangles)
+		{
+			finish_meshlet();
+		}
+
+		emitted[best_triangle] = true;
 
-		command_buffer.image_memory_barrier(image.get_vk_image_view(), memory_barrier);
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			uint32_t vertex = indices[best_triangle * 3 + i];
+
+			if (vertex_slots[vertex] == no_slot)
+			{
+				vertex_slots[vertex]                                = static_cast<uint8_t>(meshlet.unique_index_count);
+				meshlet.unique_indices[meshlet.unique_index_count++] = vertex;
+			}
+
+			meshlet.primitive_indices[meshlet.primitive_index_count++] = vertex_slots[vertex];
+		}
+
+		centroid_sum += get_centroid(best_triangle);
+		last_triangle = best_triangle;
+	}
+
+	if (meshlet.primitive_index_count > 0)
+	{
+		finish_meshlet();
 	}
 }
 
-std::vector<Meshlet> prepare_meshlets(const std::unique_ptr<vkb::sg::SubMesh> &submesh, const std::vector<unsigned char> &index_data)
+MeshletBounds compute_meshlet_bounds(const Meshlet &meshlet, const float *positions)
 {
-	std::vector<Meshlet> all_meshlets;
+	glm::vec3 min{std::numeric_limits<float>::max()};
+	glm::vec3 max{std::numeric_limits<float>::lowest()};
+
+	for (uint32_t i = 0; i < meshlet.unique_index_count; ++i)
+	{
+		glm::vec3 position = glm::make_vec3(&positions[meshlet.unique_indices[i] * 3]);
+
+		min = glm::min(min, position);
+		max = glm::max(max, position);
+	}
 
-	Meshlet meshlet {};
-	meshlet.unique_index_count = 0;
-	meshlet.primitive_index_count  = 0;
+	glm::vec3 center = (min + max) * 0.5f;
+	float     radius = 0.0f;
 
-	std::map<uint32_t, uint32_t> vertices_indices;
+	for (uint32_t i = 0; i < meshlet.unique_index_count; ++i)
+	{
+		radius = std::max(radius, glm::length(glm::make_vec3(&positions[meshlet.unique_indices[i] * 3]) - center));
+	}
 
-	uint32_t triangle_check = 0; // each meshlet needs to contain full primitives
+	std::array<glm::vec3, 126> normals;
+	uint32_t                   normal_count = 0;
+	glm::vec3                  normal_sum{0.0f};
 
-	for (uint32_t i = 0; i < submesh->vertex_indices; i++)
+	for (uint32_t i = 0; i < meshlet.primitive_index_count; i += 3)
 	{
-		uint32_t index = *(reinterpret_cast<const uint32_t *>(index_data.data()) + i);
+		glm::vec3 p0 = glm::make_vec3(&positions[meshlet.unique_indices[meshlet.primitive_indices[i]] * 3]);
+		glm::vec3 p1 = glm::make_vec3(&positions[meshlet.unique_indices[meshlet.primitive_indices[i + 1]] * 3]);
+		glm::vec3 p2 = glm::make_vec3(&positions[meshlet.unique_indices[meshlet.primitive_indices[i + 2]] * 3]);
 
-		std::map<uint32_t, uint32_t>::iterator it = vertices_indices.find(index);
+		glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+		float     length = glm::length(normal);
 
-		if (it != vertices_indices.end())
+		// Degenerate triangles face nowhere
+		if (length > 0.0f)
 		{
-			meshlet.primitive_indices[meshlet.primitive_index_count] = (*it).second;
+			normals[normal_count++] = normal / length;
+			normal_sum += normal / length;
 		}
-		else
+	}
+
+	MeshletBounds bounds;
+	bounds.sphere = glm::vec4(center, radius);
+	bounds.cone   = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+	float axis_length = glm::length(normal_sum);
+
+	if (normal_count > 0 && axis_length > 0.0f)
+	{
+		glm::vec3 axis = normal_sum / axis_length;
+
+		float min_dot = 1.0f;
+		for (uint32_t i = 0; i < normal_count; ++i)
 		{
-			vertices_indices.insert(std::make_pair(index, meshlet.unique_index_count));
-			meshlet.primitive_indices[meshlet.primitive_index_count] = meshlet.unique_index_count;
-			meshlet.unique_indices[meshlet.unique_index_count] = index;
-			++meshlet.unique_index_count;
+			min_dot = std::min(min_dot, glm::dot(axis, normals[i]));
 		}
 
-		meshlet.primitive_index_count++;
-		triangle_check = triangle_check < 3 ? ++triangle_check : 1;
+		// The sine of the half angle of the cone, normals spread over a half space can not all face away
+		bounds.cone = glm::vec4(axis, min_dot <= 0.0f ? 1.0f : std::sqrt(1.0f - min_dot * min_dot));
+	}
+
+	return bounds;
+}
+
+/**
+ * @brief Builds the meshlets of a submesh and their bounds. Large submeshes are split in ranges of triangles
+ *        which are built in parallel, by jobs of the job system.
+ * @param index_data Indices of the submesh, as uint32
+ * @param positions Positions of the vertices, as tightly packed floats
+ */
+std::vector<Meshlet> prepare_meshlets(JobSystem &job_system, const std::vector<unsigned char> &index_data, const float *positions, size_t vertex_count, std::vector<MeshletBounds> &meshlet_bounds)
+{
+	constexpr size_t range_triangle_count = 64 * 1024;
+
+	auto   indices        = reinterpret_cast<const uint32_t *>(index_data.data());
+	size_t triangle_count = index_data.size() / (3 * sizeof(uint32_t));
+	size_t range_count    = (triangle_count + range_triangle_count - 1) / range_triangle_count;
+
+	auto build_range = [=](size_t range) {
+		size_t first_triangle = range * range_triangle_count;
 
-		if ((meshlet.unique_index_count == 64) || (meshlet.primitive_index_count == 126 * 3) || (i == submesh->vertex_indices - 1))
+		std::vector<Meshlet> meshlets;
+		build_meshlets(indices + first_triangle * 3, std::min(range_triangle_count, triangle_count - first_triangle), positions, vertex_count, meshlets);
+
+		std::vector<MeshletBounds> bounds;
+		bounds.reserve(meshlets.size());
+		for (auto &meshlet : meshlets)
 		{
-			if (i == submesh->vertex_indices - 1)
+			bounds.push_back(compute_meshlet_bounds(meshlet, positions));
+		}
+
+		return std::make_pair(std::move(meshlets), std::move(bounds));
+	};
+
+	std::vector<std::pair<std::vector<Meshlet>, std::vector<MeshletBounds>>> range_results(range_count);
+
+	if (range_count > 1)
+	{
+		job_system.wait(job_system.parallel_for(range_count, 1, [&build_range, &range_results](size_t begin, size_t end, size_t) {
+			for (size_t range = begin; range < end; ++range)
 			{
-				assert(triangle_check == 3);
+				range_results[range] = build_range(range);
 			}
+		}));
+	}
+
+	std::vector<Meshlet> all_meshlets;
+	meshlet_bounds.clear();
+
+	for (size_t range = 0; range < range_count; ++range)
+	{
+		auto result = range_count > 1 ? std::move(range_results[range]) : build_range(range);
+
+		all_meshlets.insert(all_meshlets.end(), result.first.begin(), result.first.end());
+		meshlet_bounds.insert(meshlet_bounds.end(), result.second.begin(), result.second.end());
+	}
+
+	return all_meshlets;
+}
+
+inline bool has_position_bounds(const tinygltf::Accessor &accessor)
+{
+	return accessor.minValues.size() == 3 && accessor.maxValues.size() == 3;
+}
+
+/**
+ * @brief Maps a unit vector onto the octahedron, unfolded into [-1, 1]^2
+ * See https://knarkowicz.wordpress.com/2014/04/16/octahedron-normal-vector-encoding/
+ */
+inline glm::vec2 encode_octahedral_normal(const glm::vec3 &normal)
+{
+	float l1_norm = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+
+	if (l1_norm == 0.0f)
+	{
+		return glm::vec2(0.0f);
+	}
+
+	glm::vec3 n = normal / l1_norm;
+
+	if (n.z >= 0.0f)
+	{
+		return glm::vec2(n.x, n.y);
+	}
+
+	// Fold the lower hemisphere over the diagonals
+	return glm::vec2((1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+	                 (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+}
 
-			uint32_t counter = 0;
+/**
+ * @brief An attribute of an interleaved vertex, and how it is encoded from the glTF data
+ */
+struct InterleavedAttribute
+{
+	enum class Encoding
+	{
+		Copy,
+		UnormPosition,
+		OctahedralNormal,
+		HalfFloat
+	};
+
+	std::string name;
+
+	uint32_t accessor;
+
+	Encoding encoding;
+
+	VkFormat format;
+
+	uint32_t offset;
+
+	uint32_t size;
+};
+
+/**
+ * @brief Lays out the attributes of a primitive in an interleaved vertex, quantizing those the layout asks for
+ * @param stride Set to the size of the interleaved vertex
+ */
+std::vector<InterleavedAttribute> get_interleaved_attributes(const tinygltf::Model &model, const tinygltf::Primitive &primitive, const GLTFLoader::VertexLayout &layout, uint32_t &stride)
+{
+	std::vector<InterleavedAttribute> attributes;
+
+	stride = 0;
+
+	for (auto &attribute : primitive.attributes)
+	{
+		InterleavedAttribute interleaved{};
+		interleaved.name = attribute.first;
+		std::transform(interleaved.name.begin(), interleaved.name.end(), interleaved.name.begin(), ::tolower);
+
+		interleaved.accessor = to_u32(attribute.second);
+		interleaved.encoding = InterleavedAttribute::Encoding::Copy;
+		interleaved.format   = get_attribute_format(&model, attribute.second);
+
+		bool float3 = interleaved.format == VK_FORMAT_R32G32B32_SFLOAT;
+
+		// Positions are quantized relative to the mesh bounds, which need the bounds of the accessor
+		if (interleaved.name == "position" && layout.quantized_positions && float3 && has_position_bounds(model.accessors[attribute.second]))
+		{
+			interleaved.encoding = InterleavedAttribute::Encoding::UnormPosition;
+			interleaved.format   = VK_FORMAT_R16G16B16A16_UNORM;
+		}
+		else if (interleaved.name == "normal" && layout.octahedral_normals && float3)
+		{
+			interleaved.encoding = InterleavedAttribute::Encoding::OctahedralNormal;
+			interleaved.format   = VK_FORMAT_R16G16_SNORM;
+		}
+		else if (interleaved.name.compare(0, 9, "texcoord_") == 0 && layout.half_texcoords && interleaved.format == VK_FORMAT_R32G32_SFLOAT)
+		{
+			interleaved.encoding = InterleavedAttribute::Encoding::HalfFloat;
+			interleaved.format   = VK_FORMAT_R16G16_SFLOAT;
+		}
+
+		// Keep every attribute 4 byte aligned
+		interleaved.size   = (to_u32(get_bits_per_pixel(interleaved.format)) / 8 + 3) & ~3u;
+		interleaved.offset = stride;
+
+		stride += interleaved.size;
+
+		attributes.push_back(std::move(interleaved));
+	}
+
+	return attributes;
+}
 
-			if (triangle_check != 3)
+std::vector<uint8_t> interleave_vertices(const tinygltf::Model &model, const std::vector<InterleavedAttribute> &attributes, uint32_t stride, size_t vertex_count, const sg::AABB &bounds)
+{
+	std::vector<uint8_t> vertices(vertex_count * stride);
+
+	glm::vec3 extent = bounds.get_max() - bounds.get_min();
+
+	// Flat axes decode to the minimum whatever the quantized value is
+	glm::vec3 inverse_extent{extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+	                         extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+	                         extent.z > 0.0f ? 1.0f / extent.z : 0.0f};
+
+	for (auto &attribute : attributes)
+	{
+		auto data = get_attribute_data(&model, attribute.accessor);
+
+		size_t src_stride = get_attribute_stride(&model, attribute.accessor);
+		size_t copy_size  = to_u32(get_bits_per_pixel(attribute.format)) / 8;
+
+		assert(get_attribute_size(&model, attribute.accessor) >= vertex_count);
+
+		for (size_t i = 0; i < vertex_count; ++i)
+		{
+			const uint8_t *src = data.data() + i * src_stride;
+			uint8_t       *dst = vertices.data() + i * stride + attribute.offset;
+
+			switch (attribute.encoding)
 			{
-				meshlet.primitive_index_count -= triangle_check;
-				i -= triangle_check;
-				triangle_check = 0;
+				case InterleavedAttribute::Encoding::Copy:
+				{
+					std::memcpy(dst, src, copy_size);
+					break;
+				}
+				case InterleavedAttribute::Encoding::UnormPosition:
+				{
+					glm::vec3 position;
+					std::memcpy(&position, src, sizeof(position));
+
+					uint64_t packed = glm::packUnorm4x16(glm::vec4((position - bounds.get_min()) * inverse_extent, 0.0f));
+					std::memcpy(dst, &packed, sizeof(packed));
+					break;
+				}
+				case InterleavedAttribute::Encoding::OctahedralNormal:
+				{
+					glm::vec3 normal;
+					std::memcpy(&normal, src, sizeof(normal));
+
+					uint32_t packed = glm::packSnorm2x16(encode_octahedral_normal(normal));
+					std::memcpy(dst, &packed, sizeof(packed));
+					break;
+				}
+				case InterleavedAttribute::Encoding::HalfFloat:
+				{
+					glm::vec2 value;
+					std::memcpy(&value, src, sizeof(value));
+
+					uint32_t packed = glm::packHalf2x16(value);
+					std::memcpy(dst, &packed, sizeof(packed));
+					break;
+				}
 			}
+		}
+	}
+
+	return vertices;
+}
+
+/**
+ * @brief Optimizes the triangle order of an indexed triangle list primitive, then renumbers its vertices in that order
+ * @param index_data Indices of the primitive, reordered and renumbered in place
+ * @return The new number of each vertex of the primitive, empty if the primitive could not be optimized
+ */
+std::vector<uint32_t> optimize_triangle_list(const tinygltf::Model &model, const tinygltf::Primitive &primitive, std::vector<uint8_t> &index_data, VkIndexType index_type,
+                                             const GLTFLoader::MeshOptimization &optimization, const std::string &name)
+{
+	uint32_t position_accessor = to_u32(primitive.attributes.at("POSITION"));
+	size_t   vertex_count      = get_attribute_size(&model, position_accessor);
+
+	std::vector<uint32_t> indices;
+
+	if (index_type == VK_INDEX_TYPE_UINT16)
+	{
+		std::vector<uint16_t> indices_16(index_data.size() / sizeof(uint16_t));
+		std::memcpy(indices_16.data(), index_data.data(), indices_16.size() * sizeof(uint16_t));
 
-			all_meshlets.push_back(meshlet);
+		indices.assign(indices_16.begin(), indices_16.end());
+	}
+	else
+	{
+		indices.resize(index_data.size() / sizeof(uint32_t));
+		std::memcpy(indices.data(), index_data.data(), indices.size() * sizeof(uint32_t));
+	}
 
-			meshlet.unique_index_count = 0;
-			meshlet.primitive_index_count  = 0;
-			vertices_indices.clear();
+	// The optimizer indexes per-vertex tables with the indices, which a malformed file could make overflow
+	for (auto &attribute : primitive.attributes)
+	{
+		if (get_attribute_size(&model, attribute.second) != vertex_count)
+		{
+			LOGW("{}: not optimized, its vertex attributes do not have the same number of elements", name);
+			return {};
 		}
 	}
 
-	return all_meshlets;
+	if (std::any_of(indices.begin(), indices.end(), [vertex_count](uint32_t index) { return index >= vertex_count; }))
+	{
+		LOGW("{}: not optimized, an index is out of the {} vertices", name, vertex_count);
+		return {};
+	}
+
+	auto before = analyze_vertex_cache(indices, vertex_count);
+
+	optimize_vertex_cache(indices, vertex_count);
+
+	if (optimization.overdraw && get_attribute_format(&model, position_accessor) == VK_FORMAT_R32G32B32_SFLOAT)
+	{
+		auto   position_data   = get_attribute_data(&model, position_accessor);
+		size_t position_stride = get_attribute_stride(&model, position_accessor);
+
+		std::vector<glm::vec3> positions(vertex_count);
+		for (size_t i = 0; i < vertex_count; ++i)
+		{
+			std::memcpy(&positions[i], position_data.data() + i * position_stride, sizeof(glm::vec3));
+		}
+
+		optimize_overdraw(indices, positions, optimization.overdraw_threshold);
+	}
+
+	auto after = analyze_vertex_cache(indices, vertex_count);
+
+	LOGI("{}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", name, before.acmr, after.acmr, before.atvr, after.atvr);
+
+	auto remap = optimize_vertex_fetch(indices, vertex_count);
+
+	if (index_type == VK_INDEX_TYPE_UINT16)
+	{
+		std::vector<uint16_t> indices_16(indices.begin(), indices.end());
+		std::memcpy(index_data.data(), indices_16.data(), indices_16.size() * sizeof(uint16_t));
+	}
+	else
+	{
+		std::memcpy(index_data.data(), indices.data(), indices.size() * sizeof(uint32_t));
+	}
+
+	return remap;
+}
+
+/**
+ * @brief Describes the loader options which change the data stored in a SceneCache
+ */
+std::string get_scene_cache_configuration(const GLTFLoader::VertexLayout &layout, const GLTFLoader::MeshOptimization &optimization)
+{
+	return fmt::format("interleaved {} quantized_positions {} octahedral_normals {} half_texcoords {} vertex_cache {} overdraw {} overdraw_threshold {}",
+	                   layout.interleaved, layout.quantized_positions, layout.octahedral_normals, layout.half_texcoords,
+	                   optimization.vertex_cache, optimization.overdraw, optimization.overdraw_threshold);
 }
 
+/**
+ * @brief Hashes the size and modification time of a glTF file and of the files it references: its buffers,
+ *        and the images stored in separate files, which the loader reads itself.
+ *        The content of a file is only hashed if its stamp cannot be read.
+ */
+uint64_t hash_source_files(const std::string &file_name, const tinygltf::Model &model, const std::string &model_path)
+{
+	Fnv1a hash{0xcbf29ce484222325ull};
+
+	auto add_file = [&hash](const std::string &path, const std::function<std::vector<uint8_t>()> &read_content) {
+		hash.add(path);
+
+		uint64_t size{0};
+		int64_t  modification_time{0};
+
+		if (fs::get_asset_stamp(path, size, modification_time))
+		{
+			hash.add(&size, sizeof(size));
+			hash.add(&modification_time, sizeof(modification_time));
+			return;
+		}
+
+		std::vector<uint8_t> content;
+
+		try
+		{
+			content = read_content();
+		}
+		catch (const std::exception &)
+		{
+			// Reported when the file is loaded
+		}
+
+		size = content.size();
+		hash.add(&size, sizeof(size));
+		hash.add(content.data(), content.size());
+	};
+
+	auto is_external = [](const std::string &uri) {
+		return !uri.empty() && uri.compare(0, 5, "data:") != 0;
+	};
+
+	add_file(file_name, [&file_name]() { return fs::read_asset(file_name); });
+
+	// Embedded buffers and images are covered by the glTF file
+	for (auto &buffer : model.buffers)
+	{
+		if (is_external(buffer.uri))
+		{
+			add_file(model_path + "/" + buffer.uri, [&buffer]() { return buffer.data; });
+		}
+	}
+
+	for (auto &image : model.images)
+	{
+		if (image.image.empty() && is_external(image.uri))
+		{
+			auto image_path = model_path + "/" + image.uri;
+			add_file(image_path, [&image_path]() { return fs::read_asset(image_path); });
+		}
+	}
+
+	return hash.get();
+}
+
+/**
+ * @brief Suballocates the geometry of a scene from device local buffers of bounded size.
+ *        Every allocation is reserved up front, so that each buffer is created with its final size.
+ */
+class GeometryArena
+{
+  public:
+	static constexpr VkDeviceSize MAX_BUFFER_SIZE = 256 * 1024 * 1024;
+
+	GeometryArena(VkBufferUsageFlags usage, VkDeviceSize alignment) :
+	    usage{usage},
+	    alignment{alignment}
+	{}
+
+	void reserve(VkDeviceSize size)
+	{
+		VkDeviceSize offset = buffer_sizes.empty() ? 0 : (buffer_sizes.back() + alignment - 1) & ~(alignment - 1);
+
+		if (buffer_sizes.empty() || (offset > 0 && offset + size > MAX_BUFFER_SIZE))
+		{
+			buffer_sizes.push_back(0);
+			offset = 0;
+		}
+
+		placements.emplace_back(to_u32(buffer_sizes.size() - 1), offset);
+		buffer_sizes.back() = offset + size;
+	}
+
+	void create_buffers(const Device &device, const std::string &name)
+	{
+		for (size_t i = 0; i < buffer_sizes.size(); ++i)
+		{
+			auto buffer = std::make_shared<core::Buffer>(device,
+			                                             std::max(buffer_sizes[i], alignment),
+			                                             usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			                                             VMA_MEMORY_USAGE_GPU_ONLY,
+			                                             0);
+			buffer->set_debug_name(fmt::format("{} #{}", name, i));
+
+			buffers.push_back(std::move(buffer));
+		}
+	}
+
+	/**
+	 * @brief Returns the next reserved range, allocations must be made in the order they were reserved
+	 */
+	sg::BufferRange allocate(VkDeviceSize size)
+	{
+		assert(next_placement < placements.size());
+		auto &placement = placements[next_placement++];
+
+		return {buffers[placement.first], placement.second, size};
+	}
+
+	size_t get_buffer_count() const
+	{
+		return buffers.size();
+	}
+
+  private:
+	VkBufferUsageFlags usage;
+
+	VkDeviceSize alignment;
+
+	std::vector<VkDeviceSize> buffer_sizes;
+
+	std::vector<std::shared_ptr<core::Buffer>> buffers;
+
+	/// Buffer index and offset of each reserved range
+	std::vector<std::pair<uint32_t, VkDeviceSize>> placements;
+
+	size_t next_placement{0};
+};
+
 static inline bool texture_needs_srgb_colorspace(const std::string &name)
 {
 	// The gltf spec states that the base and emissive textures MUST be encoded with the sRGB
@@ -419,6 +1022,51 @@ GLTFLoader::GLTFLoader(Device const &device) :
 {
 }
 
+void GLTFLoader::set_geometry_streaming(bool enabled)
+{
+	geometry_streaming = enabled;
+}
+
+void GLTFLoader::set_dedicated_transfer_queue(bool enabled)
+{
+	dedicated_transfer_queue = enabled;
+}
+
+void GLTFLoader::set_vertex_layout(const VertexLayout &layout)
+{
+	vertex_layout = layout;
+}
+
+void GLTFLoader::set_mesh_optimization(const MeshOptimization &optimization)
+{
+	mesh_optimization = optimization;
+}
+
+void GLTFLoader::set_scene_cache(bool enabled)
+{
+	scene_cache_enabled = enabled;
+}
+
+void GLTFLoader::set_job_system(JobSystem *job_system_)
+{
+	job_system = job_system_;
+}
+
+JobSystem &GLTFLoader::get_job_system()
+{
+	if (job_system)
+	{
+		return *job_system;
+	}
+
+	if (!own_job_system)
+	{
+		own_job_system = std::make_unique<JobSystem>();
+	}
+
+	return *own_job_system;
+}
+
 std::unique_ptr<sg::Scene> GLTFLoader::read_scene_from_file(const std::string &file_name, int scene_index)
 {
 	std::string err;
@@ -458,7 +1106,52 @@ std::unique_ptr<sg::Scene> GLTFLoader::read_scene_from_file(const std::string &f
 		model_path.clear();
 	}
 
-	return std::make_unique<sg::Scene>(load_scene(scene_index));
+	scene_cache.reset();
+	scene_cache_hit = false;
+
+	if (scene_cache_enabled)
+	{
+		scene_cache_key = SceneCache::make_key(file_name, hash_source_files(file_name, model, model_path), get_scene_cache_configuration(vertex_layout, mesh_optimization));
+
+		scene_cache     = std::make_unique<SceneCache>();
+		scene_cache_hit = scene_cache->load(scene_cache_key);
+
+		size_t primitive_count = 0;
+		for (auto &gltf_mesh : model.meshes)
+		{
+			primitive_count += gltf_mesh.primitives.size();
+		}
+
+		scene_cache_hit = scene_cache_hit && scene_cache->images.size() == model.images.size() && scene_cache->primitives.size() == primitive_count;
+
+		// ASTC images are cached decoded if the device that wrote the cache did not support them
+		for (auto &image : scene_cache->images)
+		{
+			scene_cache_hit = scene_cache_hit && (!sg::is_astc(image.format) || device.is_image_format_supported(image.format));
+		}
+
+		if (scene_cache_hit)
+		{
+			LOGI("Loading {} from the scene cache", file_name);
+		}
+		else
+		{
+			// Filled while the scene is loaded
+			scene_cache = std::make_unique<SceneCache>();
+			scene_cache->images.resize(model.images.size());
+		}
+	}
+
+	auto scene = std::make_unique<sg::Scene>(load_scene(scene_index));
+
+	if (scene_cache && !scene_cache_hit)
+	{
+		scene_cache->save(scene_cache_key);
+	}
+
+	scene_cache.reset();
+
+	return scene;
 }
 
 std::unique_ptr<sg::SubMesh> GLTFLoader::read_model_from_file(const std::string &file_name, uint32_t index, bool add_flat_vertices, bool mesh_shader_buffer)
@@ -556,88 +1249,128 @@ sg::Scene GLTFLoader::load_scene(int scene_index)
 	Timer timer;
 	timer.start();
 
+	// Stages the images and, if streamed, the geometry. Copies run while the next uploads are staged.
+	StagingRing staging_ring{device, StagingRing::DEFAULT_SLOT_SIZE, 3, dedicated_transfer_queue};
+
 	// Load images
-	auto thread_count = std::thread::hardware_concurrency();
-	thread_count      = thread_count == 0 ? 1 : thread_count;
-	ctpl::thread_pool thread_pool(thread_count);
+	auto &jobs = get_job_system();
 
 	auto image_count = to_u32(model.images.size());
 
-	std::vector<std::future<std::unique_ptr<sg::Image>>> image_component_futures;
+	// Indices of the images in the order they finish decoding
+	std::mutex              decoded_mutex;
+	std::condition_variable decoded_condition;
+	std::queue<size_t>      decoded_indices;
+
+	std::vector<std::unique_ptr<sg::Image>> decoded_images(image_count);
+	std::vector<std::exception_ptr>         decode_exceptions(image_count);
+
+	std::vector<JobSystem::JobHandle> image_jobs;
 	for (size_t image_index = 0; image_index < image_count; image_index++)
 	{
-		auto fut = thread_pool.push(
-		    [this, image_index](size_t) {
-			    auto image = parse_image(model.images[image_index]);
+		auto job = jobs.schedule(
+		    [this, image_index, &decoded_mutex, &decoded_condition, &decoded_indices, &decoded_images, &decode_exceptions](size_t) {
+			    auto notify_decoded = [&]() {
+				    {
+					    std::lock_guard<std::mutex> lock{decoded_mutex};
+					    decoded_indices.push(image_index);
+				    }
+				    decoded_condition.notify_one();
+			    };
+
+			    std::unique_ptr<sg::Image> image;
+
+			    try
+			    {
+				    if (scene_cache_hit)
+				    {
+					    // Cached images are ready for upload, their data is copied straight from the cache
+					    auto &cached_image = scene_cache->images[image_index];
+					    auto  mipmaps      = cached_image.mipmaps;
+
+					    image = std::make_unique<sg::Image>(cached_image.name, std::vector<uint8_t>{}, std::move(mipmaps), cached_image.format);
+					    image->create_vk_image(device);
+				    }
+				    else
+				    {
+					    image = parse_image(model.images[image_index]);
+				    }
+			    }
+			    catch (...)
+			    {
+				    // Let the uploading thread rethrow the exception
+				    decode_exceptions[image_index] = std::current_exception();
+				    notify_decoded();
+				    return;
+			    }
 
 			    LOGI("Loaded gltf image #{} ({})", image_index, model.images[image_index].uri.c_str());
 
-			    return image;
+			    decoded_images[image_index] = std::move(image);
+
+			    notify_decoded();
 		    });
 
-		image_component_futures.push_back(std::move(fut));
+		image_jobs.push_back(std::move(job));
 	}
 
-	std::vector<std::unique_ptr<sg::Image>> image_components;
-
-	// Upload images to GPU. We do this in batches of 64MB of data to avoid needing
-	// double the amount of memory (all the images and all the corresponding buffers).
-	// This helps keep memory footprint lower which is helpful on smaller devices.
-	size_t image_index = 0;
-	while (image_index < image_count)
+	// Upload images as soon as they are decoded, instead of waiting for them in order
+	try
 	{
-		std::vector<core::Buffer> transient_buffers;
-
-		auto &command_buffer = device.request_command_buffer();
-
-		command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, 0);
-
-		size_t batch_size = 0;
-
-		// Deal with 64MB of image data at a time to keep memory footprint low
-		while (image_index < image_count && batch_size < 64 * 1024 * 1024)
+		for (uint32_t uploaded_count = 0; uploaded_count < image_count; uploaded_count++)
 		{
-			// Wait for this image to complete loading, then stage for upload
-			image_components.push_back(image_component_futures[image_index].get());
-
-			auto &image = image_components[image_index];
+			size_t image_index;
 
-			core::Buffer stage_buffer{device,
-			                          image->get_data().size(),
-			                          VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			                          VMA_MEMORY_USAGE_CPU_ONLY};
-
-			batch_size += image->get_data().size();
-
-			stage_buffer.update(image->get_data());
-
-			upload_image_to_gpu(command_buffer, stage_buffer, *image);
+			{
+				std::unique_lock<std::mutex> lock{decoded_mutex};
+				decoded_condition.wait(lock, [&decoded_indices]() { return !decoded_indices.empty(); });
 
-			transient_buffers.push_back(std::move(stage_buffer));
+				image_index = decoded_indices.front();
+				decoded_indices.pop();
+			}
 
-			image_index++;
-		}
+			if (decode_exceptions[image_index])
+			{
+				std::rethrow_exception(decode_exceptions[image_index]);
+			}
 
-		command_buffer.end();
+			auto &image = decoded_images[image_index];
 
-		auto &queue = device.get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0);
+			if (scene_cache_hit)
+			{
+				auto &cached_data = scene_cache->images[image_index].data;
 
-		queue.submit(command_buffer, device.request_fence());
+				staging_ring.copy_to_image(scene_cache->get_data(cached_data), cached_data.size, image->get_vk_image_view(), get_image_copy_regions(*image));
+			}
+			else
+			{
+				if (scene_cache)
+				{
+					scene_cache->images[image_index] = {image->get_name(), image->get_format(), image->get_mipmaps(),
+					                                    scene_cache->add_data(image->get_data().data(), image->get_data().size())};
+				}
 
-		device.get_fence_pool().wait();
-		device.get_fence_pool().reset();
-		device.get_command_pool().reset_pool();
-		device.wait_idle();
+				staging_ring.copy_to_image(image->get_data().data(), image->get_data().size(), image->get_vk_image_view(), get_image_copy_regions(*image));
+			}
 
-		// Remove the staging buffers for the batch we just processed
-		transient_buffers.clear();
+			// Clean up the image data, as they are copied in the staging memory
+			image->clear_data();
+		}
+	}
+	catch (...)
+	{
+		// The jobs use the locals of this function until they return
+		jobs.wait(image_jobs);
+		throw;
 	}
 
-	scene.set_components(std::move(image_components));
+	jobs.wait(image_jobs);
+
+	scene.set_components(std::move(decoded_images));
 
 	auto elapsed_time = timer.stop();
 
-	LOGI("Time spent loading images: {} seconds across {} threads.", vkb::to_string(elapsed_time), thread_count);
+	LOGI("Time spent loading images: {} seconds across {} threads.", vkb::to_string(elapsed_time), jobs.get_thread_count());
 
 	// Load textures
 	auto images          = scene.get_components<sg::Image>();
@@ -726,10 +1459,138 @@ sg::Scene GLTFLoader::load_scene(int scene_index)
 	// Load meshes
 	auto materials = scene.get_components<sg::PBRMaterial>();
 
+	GeometryArena vertex_arena{VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 16};
+	GeometryArena index_arena{VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, 4};
+
+	if (geometry_streaming)
+	{
+		// Reserve the geometry in the same order it is loaded below
+		size_t primitive_index = 0;
+
+		for (auto &gltf_mesh : model.meshes)
+		{
+			for (auto &gltf_primitive : gltf_mesh.primitives)
+			{
+				auto *cached_primitive = scene_cache_hit ? &scene_cache->primitives[primitive_index++] : nullptr;
+
+				if (cached_primitive)
+				{
+					for (auto &vertex_buffer : cached_primitive->vertex_buffers)
+					{
+						vertex_arena.reserve(vertex_buffer.data.size);
+					}
+				}
+				else if (vertex_layout.interleaved && !gltf_primitive.attributes.empty())
+				{
+					uint32_t stride;
+					get_interleaved_attributes(model, gltf_primitive, vertex_layout, stride);
+
+					vertex_arena.reserve(get_attribute_size(&model, gltf_primitive.attributes.begin()->second) * stride);
+				}
+				else
+				{
+					for (auto &attribute : gltf_primitive.attributes)
+					{
+						vertex_arena.reserve(get_attribute_size(&model, attribute.second) * get_attribute_stride(&model, attribute.second));
+					}
+				}
+
+				if (cached_primitive && gltf_primitive.indices >= 0)
+				{
+					index_arena.reserve(cached_primitive->indices.size);
+				}
+				else if (gltf_primitive.indices >= 0)
+				{
+					// uint8 indices are converted to uint16
+					auto index_stride = get_attribute_format(&model, gltf_primitive.indices) == VK_FORMAT_R8_UINT ? 2 : get_attribute_stride(&model, gltf_primitive.indices);
+
+					index_arena.reserve(get_attribute_size(&model, gltf_primitive.indices) * index_stride);
+				}
+			}
+		}
+
+		vertex_arena.create_buffers(device, "scene vertex buffer");
+		index_arena.create_buffers(device, "scene index buffer");
+	}
+
+	// Stores vertex data in a buffer of the submesh, or in the shared vertex buffers if geometry is streamed
+	auto store_vertex_data = [&](sg::SubMesh &submesh, const std::string &buffer_name, const uint8_t *vertex_data, size_t size) {
+		if (geometry_streaming)
+		{
+			auto range = vertex_arena.allocate(size);
+			staging_ring.copy_to_buffer(vertex_data, size, *range.buffer, range.offset);
+
+			submesh.vertex_buffer_ranges[buffer_name] = std::move(range);
+		}
+		else
+		{
+			core::Buffer buffer{device,
+			                    size,
+			                    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			                    VMA_MEMORY_USAGE_GPU_TO_CPU};
+			buffer.update(vertex_data, size);
+			buffer.set_debug_name(fmt::format("{}: '{}' vertex buffer", submesh.get_name(), buffer_name));
+
+			submesh.vertex_buffers.insert(std::make_pair(buffer_name, std::move(buffer)));
+		}
+
+		if (scene_cache && !scene_cache_hit)
+		{
+			scene_cache->primitives.back().vertex_buffers.push_back({buffer_name, scene_cache->add_data(vertex_data, size)});
+		}
+	};
+
+	// Stores index data in a buffer of the submesh, or in the shared index buffers if geometry is streamed
+	auto store_index_data = [&](sg::SubMesh &submesh, const uint8_t *index_data, size_t size) {
+		if (geometry_streaming)
+		{
+			auto range = index_arena.allocate(size);
+			staging_ring.copy_to_buffer(index_data, size, *range.buffer, range.offset);
+
+			submesh.index_buffer_range = std::move(range);
+		}
+		else
+		{
+			submesh.index_buffer = std::make_unique<core::Buffer>(device,
+			                                                      size,
+			                                                      VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+			                                                      VMA_MEMORY_USAGE_GPU_TO_CPU);
+			submesh.index_buffer->set_debug_name(fmt::format("{}: index buffer", submesh.get_name()));
+
+			submesh.index_buffer->update(index_data, size);
+		}
+
+		if (scene_cache && !scene_cache_hit)
+		{
+			scene_cache->primitives.back().indices = scene_cache->add_data(index_data, size);
+		}
+	};
+
+	// Sizes of the vertex data as stored in the glTF file and once interleaved
+	size_t source_vertex_size      = 0;
+	size_t interleaved_vertex_size = 0;
+
+	// Index of the primitive in the scene cache
+	size_t primitive_index = 0;
+
 	for (auto &gltf_mesh : model.meshes)
 	{
 		auto mesh = parse_mesh(gltf_mesh);
 
+		// glTF requires the bounds of position accessors, which also bound the mesh
+		for (auto &gltf_primitive : gltf_mesh.primitives)
+		{
+			auto position_it = gltf_primitive.attributes.find("POSITION");
+
+			if (position_it != gltf_primitive.attributes.end() && has_position_bounds(model.accessors[position_it->second]))
+			{
+				auto &accessor = model.accessors[position_it->second];
+
+				mesh->update_bounds({glm::vec3(accessor.minValues[0], accessor.minValues[1], accessor.minValues[2]),
+				                     glm::vec3(accessor.maxValues[0], accessor.maxValues[1], accessor.maxValues[2])});
+			}
+		}
+
 		for (size_t i_primitive = 0; i_primitive < gltf_mesh.primitives.size(); i_primitive++)
 		{
 			const auto &gltf_primitive = gltf_mesh.primitives[i_primitive];
@@ -737,76 +1598,179 @@ sg::Scene GLTFLoader::load_scene(int scene_index)
 			auto submesh_name = fmt::format("'{}' mesh, primitive #{}", gltf_mesh.name, i_primitive);
 			auto submesh      = std::make_unique<sg::SubMesh>(std::move(submesh_name));
 
-			for (auto &attribute : gltf_primitive.attributes)
+			if (scene_cache_hit)
 			{
-				std::string attrib_name = attribute.first;
-				std::transform(attrib_name.begin(), attrib_name.end(), attrib_name.begin(), ::tolower);
+				auto &cached_primitive = scene_cache->primitives[primitive_index];
 
-				auto vertex_data = get_attribute_data(&model, attribute.second);
+				for (auto &vertex_buffer : cached_primitive.vertex_buffers)
+				{
+					store_vertex_data(*submesh, vertex_buffer.name, scene_cache->get_data(vertex_buffer.data), vertex_buffer.data.size);
+				}
 
-				if (attrib_name == "position")
+				for (auto &attribute : cached_primitive.attributes)
 				{
-					assert(attribute.second < model.accessors.size());
-					submesh->vertices_count = to_u32(model.accessors[attribute.second].count);
+					submesh->set_attribute(attribute.name, attribute.attribute);
 				}
 
-				core::Buffer buffer{device,
-				                    vertex_data.size(),
-				                    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-				                    VMA_MEMORY_USAGE_GPU_TO_CPU};
-				buffer.update(vertex_data);
-				buffer.set_debug_name(fmt::format("'{}' mesh, primitive #{}: '{}' vertex buffer",
-				                                  gltf_mesh.name, i_primitive, attrib_name));
+				if (gltf_primitive.indices >= 0)
+				{
+					store_index_data(*submesh, scene_cache->get_data(cached_primitive.indices), cached_primitive.indices.size);
+				}
 
-				submesh->vertex_buffers.insert(std::make_pair(attrib_name, std::move(buffer)));
+				submesh->vertices_count  = cached_primitive.vertices_count;
+				submesh->vertex_indices  = cached_primitive.vertex_indices;
+				submesh->index_type      = cached_primitive.index_type;
+				submesh->position_offset = cached_primitive.position_offset;
+				submesh->position_scale  = cached_primitive.position_scale;
+			}
+			else
+			{
+				if (scene_cache)
+				{
+					scene_cache->primitives.emplace_back();
+				}
 
-				sg::VertexAttribute attrib;
-				attrib.format = get_attribute_format(&model, attribute.second);
-				attrib.stride = to_u32(get_attribute_stride(&model, attribute.second));
+				auto position_it = gltf_primitive.attributes.find("POSITION");
 
-				submesh->set_attribute(attrib_name, attrib);
-			}
+				if (position_it != gltf_primitive.attributes.end())
+				{
+					assert(position_it->second < model.accessors.size());
+					submesh->vertices_count = to_u32(model.accessors[position_it->second].count);
+				}
 
-			if (gltf_primitive.indices >= 0)
-			{
-				submesh->vertex_indices = to_u32(get_attribute_size(&model, gltf_primitive.indices));
+				// Indices are read before the vertices, as optimizing them renumbers the vertices
+				std::vector<uint8_t>  index_data;
+				std::vector<uint32_t> vertex_remap;
+
+				if (gltf_primitive.indices >= 0)
+				{
+					submesh->vertex_indices = to_u32(get_attribute_size(&model, gltf_primitive.indices));
+
+					auto format = get_attribute_format(&model, gltf_primitive.indices);
+
+					index_data = get_attribute_data(&model, gltf_primitive.indices);
+
+					switch (format)
+					{
+						case VK_FORMAT_R8_UINT:
+							// Converts uint8 data into uint16 data, still represented by a uint8 vector
+							index_data          = convert_underlying_data_stride(index_data, 1, 2);
+							submesh->index_type = VK_INDEX_TYPE_UINT16;
+							break;
+						case VK_FORMAT_R16_UINT:
+							submesh->index_type = VK_INDEX_TYPE_UINT16;
+							break;
+						case VK_FORMAT_R32_UINT:
+							submesh->index_type = VK_INDEX_TYPE_UINT32;
+							break;
+						default:
+							LOGE("gltf primitive has invalid format type");
+							break;
+					}
 
-				auto format = get_attribute_format(&model, gltf_primitive.indices);
+					bool triangle_list = gltf_primitive.mode == TINYGLTF_MODE_TRIANGLES || gltf_primitive.mode == -1;
 
-				auto index_data = get_attribute_data(&model, gltf_primitive.indices);
+					if (mesh_optimization.vertex_cache && triangle_list && position_it != gltf_primitive.attributes.end() && submesh->vertex_indices % 3 == 0)
+					{
+						vertex_remap = optimize_triangle_list(model, gltf_primitive, index_data, submesh->index_type, mesh_optimization, submesh->get_name());
+					}
+				}
 
-				switch (format)
+				if (vertex_layout.interleaved && !gltf_primitive.attributes.empty())
 				{
-					case VK_FORMAT_R8_UINT:
-						// Converts uint8 data into uint16 data, still represented by a uint8 vector
-						index_data          = convert_underlying_data_stride(index_data, 1, 2);
-						submesh->index_type = VK_INDEX_TYPE_UINT16;
-						break;
-					case VK_FORMAT_R16_UINT:
-						submesh->index_type = VK_INDEX_TYPE_UINT16;
-						break;
-					case VK_FORMAT_R32_UINT:
-						submesh->index_type = VK_INDEX_TYPE_UINT32;
-						break;
-					default:
-						LOGE("gltf primitive has invalid format type");
-						break;
+					uint32_t stride;
+					auto     interleaved_attributes = get_interleaved_attributes(model, gltf_primitive, vertex_layout, stride);
+
+					size_t vertex_count = get_attribute_size(&model, gltf_primitive.attributes.begin()->second);
+
+					auto vertex_data = interleave_vertices(model, interleaved_attributes, stride, vertex_count, mesh->get_bounds());
+
+					if (!vertex_remap.empty())
+					{
+						vertex_data = remap_vertices(vertex_data, stride, vertex_remap);
+					}
+
+					store_vertex_data(*submesh, sg::INTERLEAVED_VERTEX_BUFFER, vertex_data.data(), vertex_data.size());
+
+					for (auto &interleaved : interleaved_attributes)
+					{
+						sg::VertexAttribute attrib;
+						attrib.format = interleaved.format;
+						attrib.stride = stride;
+						attrib.offset = interleaved.offset;
+
+						submesh->set_attribute(interleaved.name, attrib);
+
+						if (interleaved.encoding == InterleavedAttribute::Encoding::UnormPosition)
+						{
+							submesh->position_offset = mesh->get_bounds().get_min();
+							submesh->position_scale  = mesh->get_bounds().get_max() - mesh->get_bounds().get_min();
+						}
+
+						source_vertex_size += vertex_count * get_bits_per_pixel(get_attribute_format(&model, interleaved.accessor)) / 8;
+					}
+
+					interleaved_vertex_size += vertex_data.size();
 				}
+				else
+				{
+					for (auto &attribute : gltf_primitive.attributes)
+					{
+						std::string attrib_name = attribute.first;
+						std::transform(attrib_name.begin(), attrib_name.end(), attrib_name.begin(), ::tolower);
 
-				submesh->index_buffer = std::make_unique<core::Buffer>(device,
-				                                                       index_data.size(),
-				                                                       VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-				                                                       VMA_MEMORY_USAGE_GPU_TO_CPU);
-				submesh->index_buffer->set_debug_name(fmt::format("'{}' mesh, primitive #{}: index buffer",
-				                                                  gltf_mesh.name, i_primitive));
+						auto vertex_data = get_attribute_data(&model, attribute.second);
 
-				submesh->index_buffer->update(index_data);
-			}
-			else
-			{
-				submesh->vertices_count = to_u32(get_attribute_size(&model, gltf_primitive.attributes.at("POSITION")));
+						if (!vertex_remap.empty())
+						{
+							vertex_data = remap_vertices(vertex_data, get_attribute_stride(&model, attribute.second), vertex_remap);
+						}
+
+						store_vertex_data(*submesh, attrib_name, vertex_data.data(), vertex_data.size());
+
+						sg::VertexAttribute attrib;
+						attrib.format = get_attribute_format(&model, attribute.second);
+						attrib.stride = to_u32(get_attribute_stride(&model, attribute.second));
+
+						submesh->set_attribute(attrib_name, attrib);
+					}
+				}
+
+				if (gltf_primitive.indices >= 0)
+				{
+					store_index_data(*submesh, index_data.data(), index_data.size());
+				}
+				else
+				{
+					submesh->vertices_count = to_u32(get_attribute_size(&model, gltf_primitive.attributes.at("POSITION")));
+				}
+
+				if (scene_cache)
+				{
+					auto &cached_primitive = scene_cache->primitives.back();
+
+					for (auto &attribute : gltf_primitive.attributes)
+					{
+						std::string attrib_name = attribute.first;
+						std::transform(attrib_name.begin(), attrib_name.end(), attrib_name.begin(), ::tolower);
+
+						SceneCache::VertexAttribute cached_attribute{attrib_name};
+						if (submesh->get_attribute(attrib_name, cached_attribute.attribute))
+						{
+							cached_primitive.attributes.push_back(std::move(cached_attribute));
+						}
+					}
+
+					cached_primitive.vertices_count  = submesh->vertices_count;
+					cached_primitive.vertex_indices  = submesh->vertex_indices;
+					cached_primitive.index_type      = submesh->index_type;
+					cached_primitive.position_offset = submesh->position_offset;
+					cached_primitive.position_scale  = submesh->position_scale;
+				}
 			}
 
+			primitive_index++;
+
 			if (gltf_primitive.material < 0)
 			{
 				submesh->set_material(*default_material);
@@ -825,6 +1789,24 @@ sg::Scene GLTFLoader::load_scene(int scene_index)
 		scene.add_component(std::move(mesh));
 	}
 
+	staging_ring.finish();
+
+	LOGI("Uploaded {:.1f} MB of images and geometry in {} batches on the {} queue, waited {} seconds for staging memory.",
+	     staging_ring.get_uploaded_size() / (1024.0 * 1024.0),
+	     staging_ring.get_submission_count(),
+	     staging_ring.is_using_transfer_queue() ? "transfer" : "graphics",
+	     vkb::to_string(staging_ring.get_wait_time()));
+
+	if (geometry_streaming)
+	{
+		LOGI("Packed the scene geometry into {} device local buffers.", vertex_arena.get_buffer_count() + index_arena.get_buffer_count());
+	}
+
+	if (vertex_layout.interleaved && !scene_cache_hit)
+	{
+		LOGI("Interleaved vertices take {:.1f} MB instead of {:.1f} MB.", interleaved_vertex_size / (1024.0 * 1024.0), source_vertex_size / (1024.0 * 1024.0));
+	}
+
 	device.get_fence_pool().wait();
 	device.get_fence_pool().reset();
 	device.get_command_pool().reset_pool();
@@ -1254,7 +2236,8 @@ std::unique_ptr<sg::SubMesh> GLTFLoader::load_model(uint32_t index, bool add_fla
 		if (mesh_shader_buffer)
 		{
 			// prepare meshlets
-			std::vector<Meshlet> meshlets = prepare_meshlets(submesh, index_data);
+			std::vector<MeshletBounds> meshlet_bounds;
+			std::vector<Meshlet>       meshlets = prepare_meshlets(get_job_system(), index_data, pos, vertex_count, meshlet_bounds);
 
 			// vertex_indices and index_buffer are used for meshlets now
 			submesh->vertex_indices = vkb::to_u32(meshlets.size());
@@ -1274,6 +2257,25 @@ std::unique_ptr<sg::SubMesh> GLTFLoader::load_model(uint32_t index, bool add_fla
 			command_buffer.copy_buffer(stage_buffer, *submesh->index_buffer, meshlets.size() * sizeof(Meshlet));
 
 			transient_buffers.push_back(std::move(stage_buffer));
+
+			// Bounds of each meshlet, in the same order, for culling before the mesh shader runs
+			core::Buffer bounds_stage_buffer{device,
+											 meshlet_bounds.size() * sizeof(MeshletBounds),
+											 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+											 VMA_MEMORY_USAGE_CPU_ONLY};
+
+			bounds_stage_buffer.update(meshlet_bounds.data(), meshlet_bounds.size() * sizeof(MeshletBounds));
+
+			core::Buffer bounds_buffer{device,
+									   meshlet_bounds.size() * sizeof(MeshletBounds),
+									   VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+									   VMA_MEMORY_USAGE_GPU_ONLY};
+
+			command_buffer.copy_buffer(bounds_stage_buffer, bounds_buffer, meshlet_bounds.size() * sizeof(MeshletBounds));
+
+			submesh->vertex_buffers.insert(std::make_pair("meshlet_bounds", std::move(bounds_buffer)));
+
+			transient_buffers.push_back(std::move(bounds_stage_buffer));
 		}
 		else
 		{
@@ -1499,7 +2501,7 @@ std::unique_ptr<sg::Image> GLTFLoader::parse_image(tinygltf::Image &gltf_image)
 		{
 			LOGW("ASTC not supported: decoding {}", image->get_name());
 			image = std::make_unique<sg::Astc>(*image);
-			image->generate_mipmaps();
+			image->generate_mipmaps(job_system ? job_system : own_job_system.get());
 		}
 	}
 
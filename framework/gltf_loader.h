@@ -27,6 +27,8 @@
 #define TINYGLTF_NO_EXTERNAL_IMAGE
 #include <tiny_gltf.h>
 
+#include "job_system.h"
+#include "scene_cache.h"
 #include "timer.h"
 
 #define KHR_LIGHTS_PUNCTUAL_EXTENSION "KHR_lights_punctual"
@@ -70,12 +72,83 @@ struct TypeCast
 class GLTFLoader
 {
   public:
+	/**
+	 * @brief How the loader lays out the vertices of scenes
+	 */
+	struct VertexLayout
+	{
+		/// Stores all attributes of a submesh in a single interleaved vertex buffer (sg::INTERLEAVED_VERTEX_BUFFER)
+		bool interleaved{false};
+
+		/// Stores positions as 16-bit normalized values relative to the mesh bounds (QUANTIZED_POSITION shader variant)
+		bool quantized_positions{false};
+
+		/// Stores normals as 16-bit octahedral encoded vectors (OCTAHEDRAL_NORMAL shader variant)
+		bool octahedral_normals{false};
+
+		/// Stores texture coordinates as half floats
+		bool half_texcoords{false};
+	};
+
+	/**
+	 * @brief Optimizations of the indexed triangle lists of scenes
+	 */
+	struct MeshOptimization
+	{
+		/// Reorders triangles for the post-transform vertex cache, and vertices in the order the triangles use them
+		bool vertex_cache{false};
+
+		/// Then reorders clusters of triangles to reduce overdraw, for primitives with float positions
+		bool overdraw{false};
+
+		/// How much worse the vertex cache efficiency of a cluster can be than the cache optimized order
+		float overdraw_threshold{1.05f};
+	};
+
 	GLTFLoader(Device const &device);
 
 	virtual ~GLTFLoader() = default;
 
 	std::unique_ptr<sg::Scene> read_scene_from_file(const std::string &file_name, int scene_index = -1);
 
+	/**
+	 * @brief Packs the geometry of scenes into a few device local buffers shared between submeshes,
+	 *        uploaded through a staging ring, instead of a host visible buffer per attribute.
+	 *        Submeshes then reference their data with vertex_buffer_ranges and index_buffer_range.
+	 */
+	void set_geometry_streaming(bool enabled);
+
+	/**
+	 * @brief Copies the images and streamed geometry of scenes on a dedicated transfer queue if the device has one,
+	 *        so that the copies can run concurrently with graphics work
+	 */
+	void set_dedicated_transfer_queue(bool enabled);
+
+	/**
+	 * @brief Sets the vertex layout of the scenes read afterwards. Quantization only applies to interleaved vertices,
+	 *        and the vertex shaders drawing them must implement the shader variants the layout lists.
+	 */
+	void set_vertex_layout(const VertexLayout &layout);
+
+	/**
+	 * @brief Sets the optimizations of the triangle lists of the scenes read afterwards,
+	 *        the vertex cache efficiency of each optimized primitive is logged before and after
+	 */
+	void set_mesh_optimization(const MeshOptimization &optimization);
+
+	/**
+	 * @brief Loads the images and geometry of scenes from a SceneCache, written by the first load of each glTF file
+	 *        and reused by the next loads as long as the glTF file, the files it references and the loader
+	 *        configuration are unchanged.
+	 */
+	void set_scene_cache(bool enabled);
+
+	/**
+	 * @brief Decodes images and builds meshlets with jobs of a job system shared with the rest of the application.
+	 *        Without one, the loader starts a job system of its own for each load which needs one.
+	 */
+	void set_job_system(JobSystem *job_system);
+
 	/**
 	 * @brief Loads the first model from a GLTF file for use in simpler samples
 	 *        makes use of the Vertex struct in vulkan_example_base.h
@@ -135,6 +208,30 @@ class GLTFLoader
   private:
 	sg::Scene load_scene(int scene_index = -1);
 
+	bool geometry_streaming{false};
+
+	bool dedicated_transfer_queue{false};
+
+	VertexLayout vertex_layout;
+
+	MeshOptimization mesh_optimization;
+
+	bool scene_cache_enabled{false};
+
+	/// Cache of the scene being loaded, read from disk on a hit or filled by load_scene otherwise
+	std::unique_ptr<SceneCache> scene_cache;
+
+	SceneCache::Key scene_cache_key;
+
+	bool scene_cache_hit{false};
+
+	JobSystem *job_system{nullptr};
+
+	/// Started when no job system was set, until the loader is destroyed
+	std::unique_ptr<JobSystem> own_job_system;
+
+	JobSystem &get_job_system();
+
 	std::unique_ptr<sg::SubMesh> load_model(uint32_t index, bool add_flat_vertices, bool mesh_shader_buffer=false);
 };
 }        // namespace vkb
@@ -30,6 +30,8 @@ namespace vkb
 class HPPBufferAllocation : private vkb::BufferAllocation
 {
   public:
+	using vkb::BufferAllocation::flush;
+	using vkb::BufferAllocation::get_data;
 	using vkb::BufferAllocation::update;
 
   public:
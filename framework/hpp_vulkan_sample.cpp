@@ -103,7 +103,7 @@ bool HPPVulkanSample::prepare(vkb::platform::HPPPlatform &platform)
 
 	// Getting a valid vulkan surface from the platform
 	surface = platform.get_window().create_surface(*instance);
-	if (!surface)
+	if (!surface && !headless)
 	{
 		throw std::runtime_error("Failed to create window surface.");
 	}
@@ -0,0 +1,360 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "job_system.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <exception>
+
+#include "common/logging.h"
+
+namespace vkb
+{
+namespace
+{
+/// Job system the calling thread is a worker of, and its index in it
+thread_local const JobSystem *current_job_system{nullptr};
+
+thread_local size_t current_thread_index{0};
+}        // namespace
+
+class JobSystem::Job
+{
+  public:
+	JobFunc func;
+
+	/// Dependencies which did not complete yet, plus one until the job is scheduled
+	std::atomic<uint32_t> pending_count{1};
+
+	std::mutex mutex;
+
+	std::condition_variable completed_condition;
+
+	bool complete{false};
+
+	std::exception_ptr exception;
+
+	/// Jobs depending on this one, queued once it completes
+	std::vector<JobHandle> continuations;
+};
+
+JobSystem::JobSystem(uint32_t worker_count) :
+    owner_thread{std::this_thread::get_id()}
+{
+	if (worker_count == 0)
+	{
+		auto core_count = std::thread::hardware_concurrency();
+		worker_count    = core_count > 1 ? core_count - 1 : 1;
+	}
+
+	// Index 0 is the thread which created the job system
+	for (uint32_t i = 0; i <= worker_count; ++i)
+	{
+		queues.push_back(std::make_unique<JobQueue>());
+	}
+
+	for (uint32_t i = 1; i <= worker_count; ++i)
+	{
+		workers.emplace_back(&JobSystem::worker_loop, this, i);
+	}
+
+	LOGI("Job system started with {} workers", worker_count);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock{wake_mutex};
+		stopping = true;
+	}
+
+	wake_condition.notify_all();
+
+	for (auto &worker : workers)
+	{
+		worker.join();
+	}
+}
+
+uint32_t JobSystem::get_thread_count() const
+{
+	return static_cast<uint32_t>(queues.size());
+}
+
+size_t JobSystem::get_thread_index() const
+{
+	return current_job_system == this ? current_thread_index : 0;
+}
+
+JobSystem::JobHandle JobSystem::schedule(JobFunc &&func, const std::vector<JobHandle> &dependencies)
+{
+	auto job  = std::make_shared<Job>();
+	job->func = std::move(func);
+
+	for (auto &dependency : dependencies)
+	{
+		if (!dependency)
+		{
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lock{dependency->mutex};
+
+		if (!dependency->complete)
+		{
+			job->pending_count++;
+			dependency->continuations.push_back(job);
+		}
+	}
+
+	if (--job->pending_count == 0)
+	{
+		enqueue(job);
+	}
+
+	return job;
+}
+
+JobSystem::JobHandle JobSystem::parallel_for(size_t count, size_t batch_size, BatchFunc &&func, const std::vector<JobHandle> &dependencies)
+{
+	assert(batch_size > 0 && "Batches must have at least one item");
+
+	// Shared by the batches instead of being copied in each of them
+	auto batch_func = std::make_shared<BatchFunc>(std::move(func));
+
+	std::vector<JobHandle> batches;
+	batches.reserve((count + batch_size - 1) / batch_size);
+
+	for (size_t begin = 0; begin < count; begin += batch_size)
+	{
+		size_t end = std::min(count, begin + batch_size);
+
+		batches.push_back(schedule([batch_func, begin, end](size_t thread_index) { (*batch_func)(begin, end, thread_index); }, dependencies));
+	}
+
+	if (batches.empty())
+	{
+		return schedule([](size_t) {}, dependencies);
+	}
+
+	// Completes with the last batch, and carries the exception of the first batch which threw one
+	return schedule(
+	    [batches](size_t) {
+		    for (auto &batch : batches)
+		    {
+			    if (batch->exception)
+			    {
+				    std::rethrow_exception(batch->exception);
+			    }
+		    }
+	    },
+	    batches);
+}
+
+bool JobSystem::is_complete(const JobHandle &job) const
+{
+	if (!job)
+	{
+		return true;
+	}
+
+	std::lock_guard<std::mutex> lock{job->mutex};
+
+	return job->complete;
+}
+
+void JobSystem::wait(const JobHandle &job)
+{
+	if (!job)
+	{
+		return;
+	}
+
+	// Only the threads of the job system run jobs while waiting, so that thread indices stay exclusive
+	bool   helping      = current_job_system == this || std::this_thread::get_id() == owner_thread;
+	size_t thread_index = get_thread_index();
+
+	while (!is_complete(job))
+	{
+		if (helping)
+		{
+			if (auto other_job = take_job(thread_index))
+			{
+				run(*other_job, thread_index);
+				continue;
+			}
+		}
+
+		std::unique_lock<std::mutex> lock{job->mutex};
+
+		if (helping)
+		{
+			// Wakes up regularly to run the jobs the awaited job may have scheduled
+			job->completed_condition.wait_for(lock, std::chrono::milliseconds(1), [&job]() { return job->complete; });
+		}
+		else
+		{
+			job->completed_condition.wait(lock, [&job]() { return job->complete; });
+		}
+	}
+
+	if (job->exception)
+	{
+		std::rethrow_exception(job->exception);
+	}
+}
+
+void JobSystem::wait(const std::vector<JobHandle> &jobs)
+{
+	std::exception_ptr exception;
+
+	for (auto &job : jobs)
+	{
+		try
+		{
+			wait(job);
+		}
+		catch (...)
+		{
+			if (!exception)
+			{
+				exception = std::current_exception();
+			}
+		}
+	}
+
+	if (exception)
+	{
+		std::rethrow_exception(exception);
+	}
+}
+
+void JobSystem::worker_loop(size_t thread_index)
+{
+	current_job_system   = this;
+	current_thread_index = thread_index;
+
+	while (true)
+	{
+		if (auto job = take_job(thread_index))
+		{
+			run(*job, thread_index);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock{wake_mutex};
+
+		wake_condition.wait(lock, [this]() { return stopping || queued_count > 0; });
+
+		if (stopping && queued_count == 0)
+		{
+			break;
+		}
+	}
+}
+
+void JobSystem::enqueue(JobHandle job)
+{
+	auto &queue = *queues[get_thread_index()];
+
+	{
+		std::lock_guard<std::mutex> lock{queue.mutex};
+		queue.jobs.push_back(std::move(job));
+	}
+
+	{
+		// Counted under the lock, so that a worker about to sleep sees the job
+		std::lock_guard<std::mutex> lock{wake_mutex};
+		queued_count++;
+	}
+
+	wake_condition.notify_one();
+}
+
+JobSystem::JobHandle JobSystem::take_job(size_t thread_index)
+{
+	JobHandle job;
+
+	{
+		auto &queue = *queues[thread_index];
+
+		std::lock_guard<std::mutex> lock{queue.mutex};
+
+		if (!queue.jobs.empty())
+		{
+			job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+		}
+	}
+
+	for (size_t i = 1; !job && i < queues.size(); ++i)
+	{
+		auto &queue = *queues[(thread_index + i) % queues.size()];
+
+		std::lock_guard<std::mutex> lock{queue.mutex};
+
+		if (!queue.jobs.empty())
+		{
+			job = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+		}
+	}
+
+	if (job)
+	{
+		queued_count--;
+	}
+
+	return job;
+}
+
+void JobSystem::run(Job &job, size_t thread_index)
+{
+	try
+	{
+		job.func(thread_index);
+	}
+	catch (...)
+	{
+		job.exception = std::current_exception();
+	}
+
+	// Releases what the job captured
+	job.func = nullptr;
+
+	std::vector<JobHandle> continuations;
+
+	{
+		std::lock_guard<std::mutex> lock{job.mutex};
+
+		job.complete = true;
+		continuations.swap(job.continuations);
+	}
+
+	job.completed_condition.notify_all();
+
+	for (auto &continuation : continuations)
+	{
+		if (--continuation->pending_count == 0)
+		{
+			enqueue(std::move(continuation));
+		}
+	}
+}
+}        // namespace vkb
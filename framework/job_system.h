@@ -0,0 +1,174 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vkb
+{
+/**
+ * @brief Runs jobs on a fixed set of worker threads, so that loading, culling, animation and command
+ *        recording share the cores instead of each creating threads of their own.
+ *
+ *        Every thread of the job system has a deque of jobs. A thread pushes the jobs it schedules to its
+ *        own deque and runs them newest first, while the threads out of work steal the oldest jobs of the
+ *        others. A job may depend on other jobs, in which case it is only queued once they all completed.
+ *
+ *        Jobs are given the index of the thread running them: 0 for the thread which created the job system,
+ *        usually the main thread, and 1 to get_thread_count() - 1 for the workers. Each index is only used by
+ *        one thread at a time, so it can be used as the thread index of a RenderFrame to allocate command
+ *        buffers, buffers and descriptor sets without locking, if the RenderContext was prepared with
+ *        get_thread_count() threads.
+ *
+ *        Waiting for a job from a thread of the job system runs other jobs in the meantime. Other threads
+ *        may schedule and wait for jobs too, but only block while waiting.
+ */
+class JobSystem
+{
+  public:
+	class Job;
+
+	/**
+	 * @brief A scheduled job, which can be waited for or used as a dependency
+	 */
+	using JobHandle = std::shared_ptr<Job>;
+
+	/**
+	 * @param thread_index Index of the thread running the job
+	 */
+	using JobFunc = std::function<void(size_t thread_index)>;
+
+	/**
+	 * @param begin First item of the batch
+	 * @param end Item after the last one of the batch
+	 * @param thread_index Index of the thread running the batch
+	 */
+	using BatchFunc = std::function<void(size_t begin, size_t end, size_t thread_index)>;
+
+	/**
+	 * @brief Starts the workers
+	 * @param worker_count Number of worker threads, one less than the number of cores if 0, and at least one
+	 */
+	explicit JobSystem(uint32_t worker_count = 0);
+
+	JobSystem(const JobSystem &) = delete;
+
+	JobSystem(JobSystem &&) = delete;
+
+	/**
+	 * @brief Runs the jobs left, then stops the workers. Jobs must not be scheduled anymore.
+	 */
+	~JobSystem();
+
+	JobSystem &operator=(const JobSystem &) = delete;
+
+	JobSystem &operator=(JobSystem &&) = delete;
+
+	/**
+	 * @return The number of thread indices given to jobs, i.e. the workers and the thread which created the job system
+	 */
+	uint32_t get_thread_count() const;
+
+	/**
+	 * @return The index of the calling thread, 0 if it is not a thread of this job system
+	 */
+	size_t get_thread_index() const;
+
+	/**
+	 * @brief Schedules a job, which runs once all its dependencies completed
+	 * @param func The job, an exception it throws is rethrown by wait()
+	 * @param dependencies Jobs to complete first
+	 */
+	JobHandle schedule(JobFunc &&func, const std::vector<JobHandle> &dependencies = {});
+
+	/**
+	 * @brief Splits a range of items in batches, each run by a job
+	 * @param count Number of items
+	 * @param batch_size Maximum number of items of a batch
+	 * @param func Called for each batch, concurrently
+	 * @param dependencies Jobs to complete before any batch
+	 * @return A job completing once all the batches completed
+	 */
+	JobHandle parallel_for(size_t count, size_t batch_size, BatchFunc &&func, const std::vector<JobHandle> &dependencies = {});
+
+	/**
+	 * @return Whether a job completed, without waiting
+	 */
+	bool is_complete(const JobHandle &job) const;
+
+	/**
+	 * @brief Waits for a job to complete, running other jobs meanwhile if called from a thread of the
+	 *        job system, then rethrows the exception the job threw if any
+	 */
+	void wait(const JobHandle &job);
+
+	/**
+	 * @brief Waits for jobs to complete, then rethrows the first exception they threw if any
+	 */
+	void wait(const std::vector<JobHandle> &jobs);
+
+  private:
+	/// Jobs queued by a thread, the owner takes the newest ones and the other threads steal the oldest ones
+	struct JobQueue
+	{
+		std::mutex mutex;
+
+		std::deque<JobHandle> jobs;
+	};
+
+	void worker_loop(size_t thread_index);
+
+	/**
+	 * @brief Queues a job whose dependencies completed, on the deque of the calling thread
+	 */
+	void enqueue(JobHandle job);
+
+	/**
+	 * @brief Takes a job from the deque of a thread, or else steals one from another thread
+	 */
+	JobHandle take_job(size_t thread_index);
+
+	/**
+	 * @brief Runs a job, then queues the jobs which were only waiting for it
+	 */
+	void run(Job &job, size_t thread_index);
+
+	/// The thread which created the job system, which uses thread index 0
+	std::thread::id owner_thread;
+
+	std::vector<std::unique_ptr<JobQueue>> queues;
+
+	std::vector<std::thread> workers;
+
+	/// Number of jobs in the deques, workers sleep while it is 0
+	std::atomic<size_t> queued_count{0};
+
+	std::mutex wake_mutex;
+
+	std::condition_variable wake_condition;
+
+	bool stopping{false};
+};
+}        // namespace vkb
@@ -0,0 +1,463 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mesh_optimizer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+#include "common/helpers.h"
+
+namespace vkb
+{
+namespace
+{
+constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+/// Size of the cache modelled by the vertex scores
+constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+
+float get_vertex_score(int32_t cache_position, uint32_t remaining_triangles)
+{
+	// Vertices without triangles left are not worth keeping
+	if (remaining_triangles == 0)
+	{
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+
+	if (cache_position >= 0)
+	{
+		if (cache_position < 3)
+		{
+			// The vertices of the last triangle get a fixed score, so that the next triangle does not
+			// always share an edge with it, which would favor long strips
+			score = 0.75f;
+		}
+		else
+		{
+			float scale = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+			score       = std::pow(1.0f - (cache_position - 3) * scale, 1.5f);
+		}
+	}
+
+	// Favor the vertices with few triangles left, to finish them off before they leave the cache
+	score += 2.0f * std::pow(static_cast<float>(remaining_triangles), -0.5f);
+
+	return score;
+}
+
+/**
+ * @brief A FIFO cache simulated with timestamps: a vertex is in the cache if it was added
+ *        less than cache_size misses ago
+ */
+class FifoCacheSimulator
+{
+  public:
+	FifoCacheSimulator(size_t vertex_count, uint32_t cache_size) :
+	    timestamps(vertex_count, 0),
+	    cache_size{cache_size},
+	    timestamp{cache_size + 1}
+	{}
+
+	/**
+	 * @return The number of vertices of the triangle which were not in the cache
+	 */
+	uint32_t add_triangle(const uint32_t *triangle)
+	{
+		uint32_t misses = 0;
+
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			if (timestamp - timestamps[triangle[i]] > cache_size)
+			{
+				timestamps[triangle[i]] = timestamp++;
+				++misses;
+			}
+		}
+
+		return misses;
+	}
+
+	void flush()
+	{
+		timestamp += cache_size + 1;
+	}
+
+  private:
+	std::vector<uint32_t> timestamps;
+
+	uint32_t cache_size;
+
+	uint32_t timestamp;
+};
+}        // namespace
+
+VertexCacheStatistics analyze_vertex_cache(const std::vector<uint32_t> &indices, size_t vertex_count, uint32_t cache_size)
+{
+	VertexCacheStatistics statistics;
+
+	size_t triangle_count = indices.size() / 3;
+
+	if (triangle_count == 0 || vertex_count == 0)
+	{
+		return statistics;
+	}
+
+	FifoCacheSimulator cache{vertex_count, cache_size};
+
+	size_t misses = 0;
+
+	for (size_t i = 0; i < triangle_count; ++i)
+	{
+		misses += cache.add_triangle(&indices[i * 3]);
+	}
+
+	statistics.acmr = static_cast<float>(misses) / triangle_count;
+	statistics.atvr = static_cast<float>(misses) / vertex_count;
+
+	return statistics;
+}
+
+void optimize_vertex_cache(std::vector<uint32_t> &indices, size_t vertex_count)
+{
+	size_t triangle_count = indices.size() / 3;
+
+	if (triangle_count == 0)
+	{
+		return;
+	}
+
+	// Triangles using each vertex, the first remaining_triangles[v] of them are not emitted yet
+	std::vector<uint32_t> triangle_offsets(vertex_count + 1, 0);
+	for (auto index : indices)
+	{
+		assert(index < vertex_count);
+		triangle_offsets[index + 1]++;
+	}
+	std::partial_sum(triangle_offsets.begin(), triangle_offsets.end(), triangle_offsets.begin());
+
+	std::vector<uint32_t> vertex_triangles(indices.size());
+	std::vector<uint32_t> remaining_triangles(vertex_count, 0);
+
+	for (size_t i = 0; i < indices.size(); ++i)
+	{
+		uint32_t vertex = indices[i];
+		vertex_triangles[triangle_offsets[vertex] + remaining_triangles[vertex]++] = to_u32(i / 3);
+	}
+
+	std::vector<int32_t> cache_positions(vertex_count, -1);
+	std::vector<float>   vertex_scores(vertex_count);
+
+	for (size_t v = 0; v < vertex_count; ++v)
+	{
+		vertex_scores[v] = get_vertex_score(-1, remaining_triangles[v]);
+	}
+
+	auto get_triangle_score = [&](uint32_t triangle) {
+		return vertex_scores[indices[triangle * 3]] + vertex_scores[indices[triangle * 3 + 1]] + vertex_scores[indices[triangle * 3 + 2]];
+	};
+
+	// Start with the best triangle overall
+	uint32_t best_triangle = 0;
+	float    best_score    = get_triangle_score(0);
+
+	for (uint32_t t = 1; t < triangle_count; ++t)
+	{
+		float score = get_triangle_score(t);
+
+		if (score > best_score)
+		{
+			best_triangle = t;
+			best_score    = score;
+		}
+	}
+
+	std::vector<bool> emitted(triangle_count, false);
+
+	// The cache holds up to 3 more vertices while a triangle is added, those are then evicted
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> next_cache;
+	cache.reserve(FORSYTH_CACHE_SIZE + 3);
+	next_cache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+
+	size_t scan_position = 0;
+
+	while (result.size() < indices.size())
+	{
+		// When no triangle uses a cached vertex, continue with the next triangle which was not emitted
+		if (best_triangle == INVALID_INDEX)
+		{
+			while (emitted[scan_position])
+			{
+				++scan_position;
+			}
+
+			best_triangle = to_u32(scan_position);
+		}
+
+		emitted[best_triangle] = true;
+
+		const uint32_t *triangle = &indices[best_triangle * 3];
+
+		next_cache.clear();
+
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			uint32_t vertex = triangle[i];
+
+			result.push_back(vertex);
+
+			// Remove the triangle from the remaining triangles of the vertex
+			uint32_t *first = &vertex_triangles[triangle_offsets[vertex]];
+			uint32_t *last  = first + remaining_triangles[vertex] - 1;
+			*std::find(first, last + 1, best_triangle) = *last;
+			--remaining_triangles[vertex];
+
+			if (std::find(next_cache.begin(), next_cache.end(), vertex) == next_cache.end())
+			{
+				next_cache.push_back(vertex);
+			}
+		}
+
+		size_t triangle_vertex_count = next_cache.size();
+
+		for (auto vertex : cache)
+		{
+			if (std::find(next_cache.begin(), next_cache.begin() + triangle_vertex_count, vertex) == next_cache.begin() + triangle_vertex_count)
+			{
+				next_cache.push_back(vertex);
+			}
+		}
+
+		for (size_t i = 0; i < next_cache.size(); ++i)
+		{
+			uint32_t vertex         = next_cache[i];
+			cache_positions[vertex] = i < FORSYTH_CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+			vertex_scores[vertex]   = get_vertex_score(cache_positions[vertex], remaining_triangles[vertex]);
+		}
+
+		// Only the triangles of the vertices which moved in the cache changed score
+		best_triangle = INVALID_INDEX;
+		best_score    = std::numeric_limits<float>::lowest();
+
+		for (auto vertex : next_cache)
+		{
+			for (uint32_t i = 0; i < remaining_triangles[vertex]; ++i)
+			{
+				uint32_t t     = vertex_triangles[triangle_offsets[vertex] + i];
+				float    score = get_triangle_score(t);
+
+				if (score > best_score)
+				{
+					best_triangle = t;
+					best_score    = score;
+				}
+			}
+		}
+
+		next_cache.resize(std::min<size_t>(next_cache.size(), FORSYTH_CACHE_SIZE));
+		std::swap(cache, next_cache);
+	}
+
+	indices.swap(result);
+}
+
+void optimize_overdraw(std::vector<uint32_t> &indices, const std::vector<glm::vec3> &positions, float threshold)
+{
+	constexpr uint32_t cache_size = 16;
+
+	size_t triangle_count = indices.size() / 3;
+
+	if (triangle_count == 0)
+	{
+		return;
+	}
+
+	// Hard boundaries are where the cache holds none of the vertices of the next triangle,
+	// so that the order of the clusters does not matter to the cache
+	std::vector<uint32_t> hard_boundaries;
+	{
+		FifoCacheSimulator cache{positions.size(), cache_size};
+
+		for (uint32_t t = 0; t < triangle_count; ++t)
+		{
+			if (cache.add_triangle(&indices[t * 3]) == 3 || t == 0)
+			{
+				hard_boundaries.push_back(t);
+			}
+		}
+	}
+	hard_boundaries.push_back(to_u32(triangle_count));
+
+	// Soft boundaries split each hard cluster as soon as the ACMR of the cluster so far
+	// gets close to the ACMR of the whole hard cluster
+	std::vector<uint32_t> clusters;
+	{
+		FifoCacheSimulator cache{positions.size(), cache_size};
+
+		for (size_t c = 0; c + 1 < hard_boundaries.size(); ++c)
+		{
+			uint32_t start = hard_boundaries[c];
+			uint32_t end   = hard_boundaries[c + 1];
+
+			cache.flush();
+
+			uint32_t misses = 0;
+			for (uint32_t t = start; t < end; ++t)
+			{
+				misses += cache.add_triangle(&indices[t * 3]);
+			}
+
+			float target_acmr = static_cast<float>(misses) / (end - start) * threshold;
+
+			cache.flush();
+
+			uint32_t cluster_start  = start;
+			uint32_t cluster_misses = 0;
+
+			clusters.push_back(start);
+
+			for (uint32_t t = start; t < end; ++t)
+			{
+				cluster_misses += cache.add_triangle(&indices[t * 3]);
+
+				if (t + 1 < end && static_cast<float>(cluster_misses) / (t + 1 - cluster_start) <= target_acmr)
+				{
+					clusters.push_back(t + 1);
+
+					cluster_start  = t + 1;
+					cluster_misses = 0;
+
+					cache.flush();
+				}
+			}
+		}
+	}
+	clusters.push_back(to_u32(triangle_count));
+
+	size_t cluster_count = clusters.size() - 1;
+
+	// Centroid of each cluster and of the whole mesh, weighted by triangle area
+	std::vector<glm::vec3> cluster_centroids(cluster_count, glm::vec3(0.0f));
+	std::vector<glm::vec3> cluster_normals(cluster_count, glm::vec3(0.0f));
+
+	glm::vec3 mesh_centroid(0.0f);
+	float     mesh_area = 0.0f;
+
+	for (size_t c = 0; c < cluster_count; ++c)
+	{
+		float cluster_area = 0.0f;
+
+		for (uint32_t t = clusters[c]; t < clusters[c + 1]; ++t)
+		{
+			const glm::vec3 &p0 = positions[indices[t * 3]];
+			const glm::vec3 &p1 = positions[indices[t * 3 + 1]];
+			const glm::vec3 &p2 = positions[indices[t * 3 + 2]];
+
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float     area   = glm::length(normal);
+
+			cluster_centroids[c] += (p0 + p1 + p2) * (area / 3.0f);
+			cluster_normals[c] += normal;
+			cluster_area += area;
+		}
+
+		mesh_centroid += cluster_centroids[c];
+		mesh_area += cluster_area;
+
+		cluster_centroids[c] = cluster_area > 0.0f ? cluster_centroids[c] / cluster_area : positions[indices[clusters[c] * 3]];
+	}
+
+	mesh_centroid = mesh_area > 0.0f ? mesh_centroid / mesh_area : glm::vec3(0.0f);
+
+	// Clusters far from the center and facing outwards are likely to occlude the others
+	std::vector<float> sort_keys(cluster_count);
+
+	for (size_t c = 0; c < cluster_count; ++c)
+	{
+		float normal_length = glm::length(cluster_normals[c]);
+
+		sort_keys[c] = normal_length > 0.0f ? glm::dot(cluster_centroids[c] - mesh_centroid, cluster_normals[c] / normal_length) : 0.0f;
+	}
+
+	std::vector<uint32_t> cluster_order(cluster_count);
+	std::iota(cluster_order.begin(), cluster_order.end(), 0);
+	std::stable_sort(cluster_order.begin(), cluster_order.end(), [&](uint32_t a, uint32_t b) { return sort_keys[a] > sort_keys[b]; });
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+
+	for (auto c : cluster_order)
+	{
+		result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+	}
+
+	indices.swap(result);
+}
+
+std::vector<uint32_t> optimize_vertex_fetch(std::vector<uint32_t> &indices, size_t vertex_count)
+{
+	std::vector<uint32_t> remap(vertex_count, INVALID_INDEX);
+
+	uint32_t next_vertex = 0;
+
+	for (auto &index : indices)
+	{
+		assert(index < vertex_count);
+
+		if (remap[index] == INVALID_INDEX)
+		{
+			remap[index] = next_vertex++;
+		}
+
+		index = remap[index];
+	}
+
+	for (auto &new_vertex : remap)
+	{
+		if (new_vertex == INVALID_INDEX)
+		{
+			new_vertex = next_vertex++;
+		}
+	}
+
+	return remap;
+}
+
+std::vector<uint8_t> remap_vertices(const std::vector<uint8_t> &vertices, size_t stride, const std::vector<uint32_t> &remap)
+{
+	assert(vertices.size() == remap.size() * stride);
+
+	std::vector<uint8_t> result(vertices.size());
+
+	for (size_t v = 0; v < remap.size(); ++v)
+	{
+		std::memcpy(result.data() + remap[v] * stride, vertices.data() + v * stride, stride);
+	}
+
+	return result;
+}
+}        // namespace vkb
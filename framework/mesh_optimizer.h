@@ -0,0 +1,85 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/error.h"
+
+VKBP_DISABLE_WARNINGS()
+#include "common/glm_common.h"
+VKBP_ENABLE_WARNINGS()
+
+namespace vkb
+{
+/**
+ * @brief Post-transform vertex cache efficiency of a triangle list
+ */
+struct VertexCacheStatistics
+{
+	/// Average number of vertices transformed per triangle, 3 at worst and around 0.5 for a regular grid
+	float acmr{0.0f};
+
+	/// Average number of times each vertex is transformed, 1 at best
+	float atvr{0.0f};
+};
+
+/**
+ * @brief Simulates a FIFO post-transform vertex cache over a triangle list
+ * @param indices Indices of the triangle list
+ * @param vertex_count Number of vertices the indices refer to
+ * @param cache_size Number of entries of the simulated cache
+ */
+VertexCacheStatistics analyze_vertex_cache(const std::vector<uint32_t> &indices, size_t vertex_count, uint32_t cache_size = 16);
+
+/**
+ * @brief Reorders the triangles of a triangle list so that they reuse the vertices recently transformed.
+ *        Implements Tom Forsyth's "Linear-Speed Vertex Cache Optimisation", which does not depend on the cache size.
+ * @param indices Indices of the triangle list, reordered in place
+ * @param vertex_count Number of vertices the indices refer to
+ */
+void optimize_vertex_cache(std::vector<uint32_t> &indices, size_t vertex_count);
+
+/**
+ * @brief Reorders clusters of triangles so that the triangles likely to occlude others are drawn first.
+ *        The triangle list is split where reordering costs little vertex cache efficiency, then clusters
+ *        facing away from the center of the mesh are moved first, see Sander et al. "Fast Triangle
+ *        Reordering for Vertex Locality and Reduced Overdraw". Call it after optimize_vertex_cache().
+ * @param indices Indices of the triangle list, reordered in place
+ * @param positions Positions of the vertices
+ * @param threshold How much worse than the whole list the ACMR of a cluster can be, 1.05 is a good trade-off
+ */
+void optimize_overdraw(std::vector<uint32_t> &indices, const std::vector<glm::vec3> &positions, float threshold = 1.05f);
+
+/**
+ * @brief Renumbers the vertices in the order the triangles first use them, so that vertex fetches are sequential
+ * @param indices Indices of the triangle list, rewritten with the new vertex numbers
+ * @param vertex_count Number of vertices the indices refer to
+ * @return The new number of each vertex. Vertices no triangle uses are kept, after all others.
+ */
+std::vector<uint32_t> optimize_vertex_fetch(std::vector<uint32_t> &indices, size_t vertex_count);
+
+/**
+ * @brief Moves vertices to the position a remap gives them
+ * @param vertices Vertex data, made of remap.size() vertices
+ * @param stride Size in bytes of a vertex
+ * @param remap The new number of each vertex, as returned by optimize_vertex_fetch()
+ */
+std::vector<uint8_t> remap_vertices(const std::vector<uint8_t> &vertices, size_t stride, const std::vector<uint32_t> &remap);
+}        // namespace vkb
@@ -0,0 +1,229 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "meshlet_renderer.h"
+
+#include <array>
+#include <cstring>
+
+#include "common/vk_initializers.h"
+#include "core/device.h"
+#include "rendering/scene_culler.h"
+#include "scene_graph/components/sub_mesh.h"
+
+namespace vkb
+{
+namespace
+{
+/// Meshlets tested by a task shader workgroup, must match the local size of meshlet_renderer/meshlet.task
+constexpr uint32_t task_workgroup_size = 32;
+
+enum Binding : uint32_t
+{
+	UniformsBinding,
+	MeshletsBinding,
+	VerticesBinding,
+	BoundsBinding,
+	StatisticsBinding
+};
+}        // namespace
+
+MeshletRenderer::MeshletRenderer(Device &device, sg::SubMesh &submesh, VkRenderPass render_pass, VkPipelineCache pipeline_cache, uint32_t frame_count) :
+    device{device},
+    meshlet_count{submesh.vertex_indices}
+{
+	if (!submesh.index_buffer || submesh.vertex_buffers.find("meshlet_bounds") == submesh.vertex_buffers.end())
+	{
+		throw std::runtime_error("Submesh was not loaded for mesh shading");
+	}
+
+	prepare_descriptors(submesh, frame_count);
+	prepare_pipeline(render_pass, pipeline_cache);
+}
+
+MeshletRenderer::~MeshletRenderer()
+{
+	vkDestroyPipeline(device.get_handle(), pipeline, nullptr);
+	vkDestroyPipelineLayout(device.get_handle(), pipeline_layout, nullptr);
+	vkDestroyDescriptorSetLayout(device.get_handle(), descriptor_set_layout, nullptr);
+	vkDestroyDescriptorPool(device.get_handle(), descriptor_pool, nullptr);
+}
+
+void MeshletRenderer::prepare_descriptors(sg::SubMesh &submesh, uint32_t frame_count)
+{
+	std::vector<VkDescriptorPoolSize> pool_sizes = {
+	    initializers::descriptor_pool_size(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, frame_count),
+	    initializers::descriptor_pool_size(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4 * frame_count)};
+
+	VkDescriptorPoolCreateInfo pool_create_info = initializers::descriptor_pool_create_info(pool_sizes, frame_count);
+	VK_CHECK(vkCreateDescriptorPool(device.get_handle(), &pool_create_info, nullptr, &descriptor_pool));
+
+	std::vector<VkDescriptorSetLayoutBinding> bindings = {
+	    initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, UniformsBinding),
+	    initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_MESH_BIT_EXT, MeshletsBinding),
+	    initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_MESH_BIT_EXT, VerticesBinding),
+	    initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_TASK_BIT_EXT, BoundsBinding),
+	    initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_TASK_BIT_EXT, StatisticsBinding)};
+
+	VkDescriptorSetLayoutCreateInfo layout_create_info = initializers::descriptor_set_layout_create_info(bindings);
+	VK_CHECK(vkCreateDescriptorSetLayout(device.get_handle(), &layout_create_info, nullptr, &descriptor_set_layout));
+
+	VkDescriptorBufferInfo meshlets_descriptor{submesh.index_buffer->get_handle(), 0, VK_WHOLE_SIZE};
+	VkDescriptorBufferInfo vertices_descriptor{submesh.vertex_buffers.at("vertex_buffer").get_handle(), 0, VK_WHOLE_SIZE};
+	VkDescriptorBufferInfo bounds_descriptor{submesh.vertex_buffers.at("meshlet_bounds").get_handle(), 0, VK_WHOLE_SIZE};
+
+	frames.resize(frame_count);
+
+	for (auto &frame : frames)
+	{
+		frame.uniform_buffer = std::make_unique<core::Buffer>(device,
+		                                                      sizeof(Uniforms),
+		                                                      VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+		                                                      VMA_MEMORY_USAGE_CPU_TO_GPU);
+
+		frame.statistics_buffer = std::make_unique<core::Buffer>(device,
+		                                                         sizeof(Statistics),
+		                                                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		                                                         VMA_MEMORY_USAGE_GPU_TO_CPU);
+
+		frame.statistics_buffer->convert_and_update(Statistics{});
+
+		VkDescriptorSetAllocateInfo allocate_info = initializers::descriptor_set_allocate_info(descriptor_pool, &descriptor_set_layout, 1);
+		VK_CHECK(vkAllocateDescriptorSets(device.get_handle(), &allocate_info, &frame.descriptor_set));
+
+		VkDescriptorBufferInfo uniforms_descriptor{frame.uniform_buffer->get_handle(), 0, VK_WHOLE_SIZE};
+		VkDescriptorBufferInfo statistics_descriptor{frame.statistics_buffer->get_handle(), 0, VK_WHOLE_SIZE};
+
+		std::array<VkWriteDescriptorSet, 5> writes = {
+		    initializers::write_descriptor_set(frame.descriptor_set, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, UniformsBinding, &uniforms_descriptor),
+		    initializers::write_descriptor_set(frame.descriptor_set, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, MeshletsBinding, &meshlets_descriptor),
+		    initializers::write_descriptor_set(frame.descriptor_set, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VerticesBinding, &vertices_descriptor),
+		    initializers::write_descriptor_set(frame.descriptor_set, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, BoundsBinding, &bounds_descriptor),
+		    initializers::write_descriptor_set(frame.descriptor_set, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, StatisticsBinding, &statistics_descriptor)};
+
+		vkUpdateDescriptorSets(device.get_handle(), to_u32(writes.size()), writes.data(), 0, nullptr);
+	}
+}
+
+void MeshletRenderer::prepare_pipeline(VkRenderPass render_pass, VkPipelineCache pipeline_cache)
+{
+	VkPipelineLayoutCreateInfo layout_create_info = initializers::pipeline_layout_create_info(&descriptor_set_layout, 1);
+	VK_CHECK(vkCreatePipelineLayout(device.get_handle(), &layout_create_info, nullptr, &pipeline_layout));
+
+	VkPipelineRasterizationStateCreateInfo rasterization_state =
+	    initializers::pipeline_rasterization_state_create_info(VK_POLYGON_MODE_FILL, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_CLOCKWISE, 0);
+
+	VkPipelineColorBlendAttachmentState blend_attachment = initializers::pipeline_color_blend_attachment_state(0xf, VK_FALSE);
+
+	VkPipelineColorBlendStateCreateInfo blend_state = initializers::pipeline_color_blend_state_create_info(1, &blend_attachment);
+
+	VkPipelineDepthStencilStateCreateInfo depth_stencil_state =
+	    initializers::pipeline_depth_stencil_state_create_info(VK_TRUE, VK_TRUE, VK_COMPARE_OP_GREATER);
+
+	VkPipelineViewportStateCreateInfo viewport_state = initializers::pipeline_viewport_state_create_info(1, 1, 0);
+
+	VkPipelineMultisampleStateCreateInfo multisample_state = initializers::pipeline_multisample_state_create_info(VK_SAMPLE_COUNT_1_BIT, 0);
+
+	std::vector<VkDynamicState> dynamic_states = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+
+	VkPipelineDynamicStateCreateInfo dynamic_state = initializers::pipeline_dynamic_state_create_info(dynamic_states.data(), to_u32(dynamic_states.size()));
+
+	std::array<VkPipelineShaderStageCreateInfo, 3> shader_stages{};
+
+	const std::array<std::pair<const char *, VkShaderStageFlagBits>, 3> shaders = {{{"meshlet_renderer/meshlet.task", VK_SHADER_STAGE_TASK_BIT_EXT},
+	                                                                                {"meshlet_renderer/meshlet.mesh", VK_SHADER_STAGE_MESH_BIT_EXT},
+	                                                                                {"meshlet_renderer/meshlet.frag", VK_SHADER_STAGE_FRAGMENT_BIT}}};
+
+	for (size_t i = 0; i < shaders.size(); ++i)
+	{
+		shader_stages[i].sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shader_stages[i].stage  = shaders[i].second;
+		shader_stages[i].module = load_shader(shaders[i].first, device.get_handle(), shaders[i].second);
+		shader_stages[i].pName  = "main";
+	}
+
+	VkGraphicsPipelineCreateInfo pipeline_create_info = initializers::pipeline_create_info(pipeline_layout, render_pass, 0);
+
+	pipeline_create_info.pVertexInputState   = nullptr;
+	pipeline_create_info.pInputAssemblyState = nullptr;
+	pipeline_create_info.pRasterizationState = &rasterization_state;
+	pipeline_create_info.pColorBlendState    = &blend_state;
+	pipeline_create_info.pMultisampleState   = &multisample_state;
+	pipeline_create_info.pViewportState      = &viewport_state;
+	pipeline_create_info.pDepthStencilState  = &depth_stencil_state;
+	pipeline_create_info.pDynamicState       = &dynamic_state;
+	pipeline_create_info.stageCount          = to_u32(shader_stages.size());
+	pipeline_create_info.pStages             = shader_stages.data();
+
+	VkResult result = vkCreateGraphicsPipelines(device.get_handle(), pipeline_cache, 1, &pipeline_create_info, nullptr, &pipeline);
+
+	// The modules are not needed once the pipeline is created
+	for (auto &shader_stage : shader_stages)
+	{
+		vkDestroyShaderModule(device.get_handle(), shader_stage.module, nullptr);
+	}
+
+	VK_CHECK(result);
+}
+
+void MeshletRenderer::update(uint32_t frame_index, const glm::mat4 &model, const glm::mat4 &view, const glm::mat4 &projection)
+{
+	Uniforms uniforms{};
+	uniforms.model_view            = view * model;
+	uniforms.model_view_projection = projection * uniforms.model_view;
+
+	// Planes of the model space frustum, the culling then works with the bounds as they were built
+	Frustum frustum{uniforms.model_view_projection};
+	std::copy(frustum.planes.begin(), frustum.planes.end(), uniforms.frustum_planes);
+
+	uniforms.camera_position = glm::inverse(uniforms.model_view) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	uniforms.meshlet_count   = meshlet_count;
+	uniforms.frustum_culling = frustum_culling;
+	uniforms.cone_culling    = cone_culling;
+
+	frames.at(frame_index).uniform_buffer->convert_and_update(uniforms);
+}
+
+void MeshletRenderer::draw(VkCommandBuffer command_buffer, uint32_t frame_index) const
+{
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1, &frames.at(frame_index).descriptor_set, 0, nullptr);
+
+	vkCmdDrawMeshTasksEXT(command_buffer, (meshlet_count + task_workgroup_size - 1) / task_workgroup_size, 1, 1);
+}
+
+MeshletRenderer::Statistics MeshletRenderer::read_statistics(uint32_t frame_index)
+{
+	auto &statistics_buffer = *frames.at(frame_index).statistics_buffer;
+
+	Statistics statistics{};
+
+	VK_CHECK(vmaInvalidateAllocation(device.get_memory_allocator(), statistics_buffer.get_allocation(), 0, VK_WHOLE_SIZE));
+	std::memcpy(&statistics, statistics_buffer.map(), sizeof(statistics));
+	statistics_buffer.unmap();
+
+	// The task shader accumulates, so the counters start from zero again for the next draw
+	statistics_buffer.convert_and_update(Statistics{});
+
+	return statistics;
+}
+
+uint32_t MeshletRenderer::get_meshlet_count() const
+{
+	return meshlet_count;
+}
+}        // namespace vkb
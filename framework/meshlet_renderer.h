@@ -0,0 +1,161 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/error.h"
+
+VKBP_DISABLE_WARNINGS()
+#include "common/glm_common.h"
+VKBP_ENABLE_WARNINGS()
+
+#include "common/vk_common.h"
+#include "core/buffer.h"
+
+namespace vkb
+{
+class Device;
+
+namespace sg
+{
+class SubMesh;
+}
+
+/**
+ * @brief Draws a submesh loaded with GLTFLoader::read_model_from_file(..., mesh_shader_buffer = true) with
+ *        VK_EXT_mesh_shader. A task shader tests the bounds of 32 meshlets per workgroup against the view
+ *        frustum and their normal cone against the camera position, then launches one mesh workgroup per
+ *        visible meshlet. The culled meshlets are counted on the GPU.
+ *
+ *        The pipeline uses the depth convention of the ApiVulkanSample samples, with the far plane at 0.
+ *        Resources are duplicated per frame so that a frame can be updated while the others are in flight.
+ */
+class MeshletRenderer
+{
+  public:
+	/**
+	 * @brief Meshlet counts of a frame
+	 */
+	struct Statistics
+	{
+		uint32_t visible{0};
+
+		uint32_t frustum_culled{0};
+
+		uint32_t cone_culled{0};
+	};
+
+	/**
+	 * @brief Creates the pipeline and the per frame resources
+	 * @param device The device to create the resources on
+	 * @param submesh The submesh to draw, whose meshlets and bounds are read in place
+	 * @param render_pass The render pass the submesh is drawn in, at subpass 0
+	 * @param pipeline_cache The pipeline cache to create the pipeline with
+	 * @param frame_count Number of frames which can be in flight
+	 */
+	MeshletRenderer(Device &device, sg::SubMesh &submesh, VkRenderPass render_pass, VkPipelineCache pipeline_cache, uint32_t frame_count);
+
+	MeshletRenderer(const MeshletRenderer &) = delete;
+
+	MeshletRenderer(MeshletRenderer &&) = delete;
+
+	~MeshletRenderer();
+
+	MeshletRenderer &operator=(const MeshletRenderer &) = delete;
+
+	MeshletRenderer &operator=(MeshletRenderer &&) = delete;
+
+	/**
+	 * @brief Updates the transforms of a frame. Must not be called while the frame is in flight.
+	 */
+	void update(uint32_t frame_index, const glm::mat4 &model, const glm::mat4 &view, const glm::mat4 &projection);
+
+	/**
+	 * @brief Records the draw of a frame inside the render pass
+	 */
+	void draw(VkCommandBuffer command_buffer, uint32_t frame_index) const;
+
+	/**
+	 * @brief Reads the statistics of the last completed draw of a frame and resets them.
+	 *        Must not be called while the frame is in flight.
+	 */
+	Statistics read_statistics(uint32_t frame_index);
+
+	uint32_t get_meshlet_count() const;
+
+	/// Toggles the frustum culling, effective on the next update()
+	bool frustum_culling{true};
+
+	/// Toggles the normal cone culling, effective on the next update()
+	bool cone_culling{true};
+
+  private:
+	/**
+	 * @brief Uniforms of the task and mesh shaders, laid out as std140
+	 */
+	struct alignas(16) Uniforms
+	{
+		glm::mat4 model_view_projection;
+
+		glm::mat4 model_view;
+
+		/// Frustum planes in model space, so that bounds do not need to be transformed
+		glm::vec4 frustum_planes[6];
+
+		/// Camera position in model space
+		glm::vec4 camera_position;
+
+		uint32_t meshlet_count;
+
+		uint32_t frustum_culling;
+
+		uint32_t cone_culling;
+	};
+
+	struct Frame
+	{
+		std::unique_ptr<core::Buffer> uniform_buffer;
+
+		/// Statistics written by the task shader, read back by the host
+		std::unique_ptr<core::Buffer> statistics_buffer;
+
+		VkDescriptorSet descriptor_set{VK_NULL_HANDLE};
+	};
+
+	void prepare_descriptors(sg::SubMesh &submesh, uint32_t frame_count);
+
+	void prepare_pipeline(VkRenderPass render_pass, VkPipelineCache pipeline_cache);
+
+	Device &device;
+
+	uint32_t meshlet_count{0};
+
+	std::vector<Frame> frames;
+
+	VkDescriptorPool descriptor_pool{VK_NULL_HANDLE};
+
+	VkDescriptorSetLayout descriptor_set_layout{VK_NULL_HANDLE};
+
+	VkPipelineLayout pipeline_layout{VK_NULL_HANDLE};
+
+	VkPipeline pipeline{VK_NULL_HANDLE};
+};
+}        // namespace vkb
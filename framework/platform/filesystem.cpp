@@ -183,6 +183,20 @@ std::vector<uint8_t> read_asset(const std::string &filename, const uint32_t coun
 	return read_binary_file(path::get(path::Type::Assets) + filename, count);
 }
 
+bool get_asset_stamp(const std::string &filename, uint64_t &size, int64_t &modification_time)
+{
+	struct stat info;
+	if (stat((path::get(path::Type::Assets) + filename).c_str(), &info) != 0)
+	{
+		return false;
+	}
+
+	size              = static_cast<uint64_t>(info.st_size);
+	modification_time = static_cast<int64_t>(info.st_mtime);
+
+	return true;
+}
+
 std::string read_shader(const std::string &filename)
 {
 	return read_text_file(path::get(path::Type::Shaders) + filename);
@@ -100,6 +100,16 @@ void create_path(const std::string &root, const std::string &path);
  */
 std::vector<uint8_t> read_asset(const std::string &filename, const uint32_t count = 0);
 
+/**
+ * @brief Helper to get the size and last modification time of an asset file, without reading it
+ *
+ * @param filename The path to the file (relative to the assets directory)
+ * @param[out] size The size of the file in bytes
+ * @param[out] modification_time The time of the last modification of the file
+ * @return True if the file was found, false if not
+ */
+bool get_asset_stamp(const std::string &filename, uint64_t &size, int64_t &modification_time);
+
 /**
  * @brief Helper to read a shader file into a single string
  *
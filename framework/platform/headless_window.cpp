@@ -26,7 +26,17 @@ HeadlessWindow::HeadlessWindow(const Window::Properties &properties) :
 
 VkSurfaceKHR HeadlessWindow::create_surface(Instance &instance)
 {
-	return VK_NULL_HANDLE;
+	if (!instance.is_enabled(VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME))
+	{
+		return VK_NULL_HANDLE;
+	}
+
+	VkHeadlessSurfaceCreateInfoEXT info{VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT};
+
+	VkSurfaceKHR surface{VK_NULL_HANDLE};
+	VK_CHECK(vkCreateHeadlessSurfaceEXT(instance.get_handle(), &info, nullptr, &surface));
+
+	return surface;
 }
 
 VkSurfaceKHR HeadlessWindow::create_surface(VkInstance, VkPhysicalDevice)
@@ -32,8 +32,8 @@ class HeadlessWindow : public Window
 	virtual ~HeadlessWindow() = default;
 
 	/**
-	 * @brief A direct window doesn't have a surface
-	 * @returns VK_NULL_HANDLE
+	 * @brief Creates a headless surface if VK_EXT_headless_surface is enabled on the instance
+	 * @returns The surface, or VK_NULL_HANDLE to render to offscreen images instead of a swapchain
 	 */
 	VkSurfaceKHR create_surface(Instance &instance) override;
 
@@ -31,6 +31,7 @@
 
 #include "common/logging.h"
 #include "force_close/force_close.h"
+#include "glsl_compiler.h"
 #include "platform/filesystem.h"
 #include "platform/parsers/CLI11.h"
 #include "platform/plugins/plugin.h"
@@ -236,6 +237,9 @@ void Platform::terminate(ExitCode code)
 	active_app.reset();
 	window.reset();
 
+	// Stores only write the SPIR-V cache index in batches
+	GLSLCompiler::get_spirv_cache().flush();
+
 	spdlog::drop_all();
 
 	on_platform_close();
@@ -285,6 +289,10 @@ void Platform::set_window_properties(const Window::OptionalProperties &propertie
 	window_properties.vsync         = properties.vsync.has_value() ? properties.vsync.value() : window_properties.vsync;
 	window_properties.extent.width  = properties.extent.width.has_value() ? properties.extent.width.value() : window_properties.extent.width;
 	window_properties.extent.height = properties.extent.height.has_value() ? properties.extent.height.value() : window_properties.extent.height;
+
+	window_properties.headless_image_count = properties.headless_image_count.has_value() ? properties.headless_image_count.value() : window_properties.headless_image_count;
+	window_properties.headless_latency     = properties.headless_latency.has_value() ? properties.headless_latency.value() : window_properties.headless_latency;
+	window_properties.frames_in_flight     = properties.frames_in_flight.has_value() ? properties.frames_in_flight.value() : window_properties.frames_in_flight;
 }
 
 const std::string &Platform::get_external_storage_directory()
@@ -56,6 +56,11 @@ Window::Mode Window::get_window_mode() const
 	return properties.mode;
 }
 
+const Window::Properties &Window::get_properties() const
+{
+	return properties;
+}
+
 bool Window::get_display_present_info(VkDisplayPresentInfoKHR *info,
                                       uint32_t src_width, uint32_t src_height) const
 {
@@ -64,6 +64,9 @@ class Window
 		Optional<bool>        resizable;
 		Optional<Vsync>       vsync;
 		OptionalExtent        extent;
+		Optional<uint32_t>    headless_image_count;
+		Optional<uint32_t>    headless_latency;
+		Optional<uint32_t>    frames_in_flight;
 	};
 
 	struct Properties
@@ -73,6 +76,15 @@ class Window
 		bool        resizable = true;
 		Vsync       vsync     = Vsync::Default;
 		Extent      extent    = {1280, 720};
+
+		/// Number of offscreen images standing in for swapchain images, when headless without a surface
+		uint32_t headless_image_count = 3;
+
+		/// Maximum number of frames in flight with offscreen images, 0 to only wait for the image being reused
+		uint32_t headless_latency = 2;
+
+		/// Number of frames the CPU can record ahead of the GPU, 0 for one per swapchain or offscreen image
+		uint32_t frames_in_flight = 0;
 	};
 
 	/**
@@ -147,6 +159,8 @@ class Window
 
 	Mode get_window_mode() const;
 
+	const Properties &get_properties() const;
+
   protected:
 	Properties properties;
 };
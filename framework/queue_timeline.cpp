@@ -0,0 +1,151 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "queue_timeline.h"
+
+#include "core/device.h"
+
+namespace vkb
+{
+QueueTimeline::QueueTimeline(const Device &device, const Queue &queue) :
+    device{device},
+    queue{queue}
+{
+	VkSemaphoreTypeCreateInfoKHR type_create_info{VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR};
+	type_create_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+	type_create_info.initialValue  = 0;
+
+	VkSemaphoreCreateInfo create_info{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+	create_info.pNext = &type_create_info;
+
+	VkResult result = vkCreateSemaphore(device.get_handle(), &create_info, nullptr, &handle);
+
+	if (result != VK_SUCCESS)
+	{
+		throw VulkanException(result, "Failed to create timeline semaphore.");
+	}
+}
+
+QueueTimeline::~QueueTimeline()
+{
+	if (handle != VK_NULL_HANDLE)
+	{
+		wait(submitted_value);
+
+		vkDestroySemaphore(device.get_handle(), handle, nullptr);
+	}
+}
+
+const Queue &QueueTimeline::get_queue() const
+{
+	return queue;
+}
+
+VkSemaphore QueueTimeline::get_handle() const
+{
+	return handle;
+}
+
+TimelineTicket QueueTimeline::submit(const std::vector<VkSubmitInfo> &submit_infos, VkFence fence)
+{
+	assert(!submit_infos.empty() && "Nothing to submit");
+
+	std::lock_guard<std::mutex> lock{submit_mutex};
+
+	uint64_t value = submitted_value + 1;
+
+	auto  infos     = submit_infos;
+	auto &last_info = infos.back();
+
+	std::vector<VkSemaphore> signal_semaphores(last_info.pSignalSemaphores, last_info.pSignalSemaphores + last_info.signalSemaphoreCount);
+	signal_semaphores.push_back(handle);
+
+	// Binary semaphores ignore their value, but every signaled semaphore needs one
+	std::vector<uint64_t> signal_values(signal_semaphores.size(), 0);
+	signal_values.back() = value;
+
+	VkTimelineSemaphoreSubmitInfoKHR timeline_info{VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR};
+	timeline_info.pNext                     = last_info.pNext;
+	timeline_info.signalSemaphoreValueCount = to_u32(signal_values.size());
+	timeline_info.pSignalSemaphoreValues    = signal_values.data();
+
+	last_info.pNext                = &timeline_info;
+	last_info.signalSemaphoreCount = to_u32(signal_semaphores.size());
+	last_info.pSignalSemaphores    = signal_semaphores.data();
+
+	VkResult result = queue.submit(infos, fence);
+
+	if (result != VK_SUCCESS)
+	{
+		throw VulkanException(result, "Failed to submit to the queue timeline.");
+	}
+
+	submitted_value = value;
+
+	return {&queue, value};
+}
+
+TimelineTicket QueueTimeline::get_last_ticket() const
+{
+	return {&queue, submitted_value};
+}
+
+uint64_t QueueTimeline::get_completed_value()
+{
+	uint64_t value = completed_value;
+
+	if (value < submitted_value)
+	{
+		VK_CHECK(vkGetSemaphoreCounterValueKHR(device.get_handle(), handle, &value));
+
+		completed_value = value;
+	}
+
+	return value;
+}
+
+bool QueueTimeline::is_complete(uint64_t value)
+{
+	return value <= completed_value || value <= get_completed_value();
+}
+
+VkResult QueueTimeline::wait(uint64_t value, uint64_t timeout)
+{
+	if (value <= completed_value)
+	{
+		return VK_SUCCESS;
+	}
+
+	VkSemaphoreWaitInfoKHR wait_info{VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR};
+	wait_info.semaphoreCount = 1;
+	wait_info.pSemaphores    = &handle;
+	wait_info.pValues        = &value;
+
+	VkResult result = vkWaitSemaphoresKHR(device.get_handle(), &wait_info, timeout);
+
+	if (result == VK_SUCCESS)
+	{
+		// Another thread may have seen a later value in the meantime
+		uint64_t previous = completed_value;
+		while (previous < value && !completed_value.compare_exchange_weak(previous, value))
+		{
+		}
+	}
+
+	return result;
+}
+}        // namespace vkb
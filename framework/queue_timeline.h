@@ -0,0 +1,119 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include "common/helpers.h"
+#include "common/vk_common.h"
+
+namespace vkb
+{
+class Device;
+class Queue;
+
+/**
+ * @brief A point on the timeline of a queue, reached once a submission and all the previous
+ *        ones on the queue completed. A default ticket refers to no work and is always complete.
+ */
+struct TimelineTicket
+{
+	const Queue *queue{nullptr};
+
+	uint64_t value{0};
+};
+
+/**
+ * @brief Timeline semaphore of a queue, signaled with increasing values by the submissions made through it.
+ *
+ *        Each submission returns a ticket, and a single wait on the semaphore covers all the work submitted
+ *        up to that ticket. This replaces a fence per submission, which has to be waited for and reset,
+ *        and lets the host check which work completed with one query.
+ *
+ *        Requires the timelineSemaphore feature of VK_KHR_timeline_semaphore.
+ */
+class QueueTimeline
+{
+  public:
+	QueueTimeline(const Device &device, const Queue &queue);
+
+	QueueTimeline(const QueueTimeline &) = delete;
+
+	QueueTimeline(QueueTimeline &&) = delete;
+
+	/**
+	 * @brief Waits for the work submitted through the timeline
+	 */
+	~QueueTimeline();
+
+	QueueTimeline &operator=(const QueueTimeline &) = delete;
+
+	QueueTimeline &operator=(QueueTimeline &&) = delete;
+
+	const Queue &get_queue() const;
+
+	VkSemaphore get_handle() const;
+
+	/**
+	 * @brief Submits to the queue, with the last submit info also signaling the next value of the timeline.
+	 *        The submit infos must not chain a VkTimelineSemaphoreSubmitInfo of their own.
+	 * @param submit_infos The submit infos, passed to Queue::submit
+	 * @param fence An optional fence to signal as well
+	 * @return The ticket of the submission
+	 */
+	TimelineTicket submit(const std::vector<VkSubmitInfo> &submit_infos, VkFence fence = VK_NULL_HANDLE);
+
+	/**
+	 * @return The ticket of the last submission, reached once all the work submitted so far completed
+	 */
+	TimelineTicket get_last_ticket() const;
+
+	/**
+	 * @return The last value signaled by the device. The semaphore is only queried if the value seen
+	 *         by a previous call is lower than the last submitted one.
+	 */
+	uint64_t get_completed_value();
+
+	/**
+	 * @return Whether a value was reached, without waiting
+	 */
+	bool is_complete(uint64_t value);
+
+	/**
+	 * @brief Waits until a value is reached
+	 */
+	VkResult wait(uint64_t value, uint64_t timeout = std::numeric_limits<uint64_t>::max());
+
+  private:
+	const Device &device;
+
+	const Queue &queue;
+
+	VkSemaphore handle{VK_NULL_HANDLE};
+
+	/// Serializes the submissions, so that values are signaled in order
+	std::mutex submit_mutex;
+
+	std::atomic<uint64_t> submitted_value{0};
+
+	std::atomic<uint64_t> completed_value{0};
+};
+}        // namespace vkb
@@ -17,6 +17,8 @@
 
 #include "pipeline_state.h"
 
+#include "common/resource_caching.h"
+
 bool operator==(const VkVertexInputAttributeDescription &lhs, const VkVertexInputAttributeDescription &rhs)
 {
 	return std::tie(lhs.binding, lhs.format, lhs.location, lhs.offset) == std::tie(rhs.binding, rhs.format, rhs.location, rhs.offset);
@@ -84,11 +86,30 @@ bool operator!=(const vkb::ColorBlendState &lhs, const vkb::ColorBlendState &rhs
 
 namespace vkb
 {
+namespace
+{
+std::size_t hash_pipeline_layout(const PipelineLayout &pipeline_layout)
+{
+	std::size_t result = 0;
+
+	hash_combine(result, pipeline_layout.get_handle());
+
+	for (auto shader_module : pipeline_layout.get_shader_modules())
+	{
+		hash_combine(result, shader_module->get_id());
+	}
+
+	return result;
+}
+}        // namespace
+
 void SpecializationConstantState::reset()
 {
 	if (dirty)
 	{
 		specialization_constant_state.clear();
+
+		update_hash();
 	}
 
 	dirty = false;
@@ -116,11 +137,15 @@ void SpecializationConstantState::set_constant(uint32_t constant_id, const std::
 	dirty = true;
 
 	specialization_constant_state[constant_id] = value;
+
+	update_hash();
 }
 
 void SpecializationConstantState::set_specialization_constant_state(const std::map<uint32_t, std::vector<uint8_t>> &state)
 {
 	specialization_constant_state = state;
+
+	update_hash();
 }
 
 const std::map<uint32_t, std::vector<uint8_t>> &SpecializationConstantState::get_specialization_constant_state() const
@@ -128,6 +153,21 @@ const std::map<uint32_t, std::vector<uint8_t>> &SpecializationConstantState::get
 	return specialization_constant_state;
 }
 
+std::size_t SpecializationConstantState::get_hash() const
+{
+	return hash;
+}
+
+void SpecializationConstantState::update_hash()
+{
+	hash = std::hash<SpecializationConstantState>{}(*this);
+}
+
+PipelineState::PipelineState()
+{
+	update_hashes();
+}
+
 void PipelineState::reset()
 {
 	clear_dirty();
@@ -151,6 +191,8 @@ void PipelineState::reset()
 	color_blend_state = {};
 
 	subpass_index = {0U};
+
+	update_hashes();
 }
 
 void PipelineState::set_pipeline_layout(PipelineLayout &new_pipeline_layout)
@@ -161,6 +203,8 @@ void PipelineState::set_pipeline_layout(PipelineLayout &new_pipeline_layout)
 		{
 			pipeline_layout = &new_pipeline_layout;
 
+			pipeline_layout_hash = hash_pipeline_layout(*pipeline_layout);
+
 			dirty = true;
 		}
 	}
@@ -168,6 +212,8 @@ void PipelineState::set_pipeline_layout(PipelineLayout &new_pipeline_layout)
 	{
 		pipeline_layout = &new_pipeline_layout;
 
+		pipeline_layout_hash = hash_pipeline_layout(*pipeline_layout);
+
 		dirty = true;
 	}
 }
@@ -180,6 +226,8 @@ void PipelineState::set_render_pass(const RenderPass &new_render_pass)
 		{
 			render_pass = &new_render_pass;
 
+			render_pass_hash = std::hash<VkRenderPass>{}(render_pass->get_handle());
+
 			dirty = true;
 		}
 	}
@@ -187,6 +235,8 @@ void PipelineState::set_render_pass(const RenderPass &new_render_pass)
 	{
 		render_pass = &new_render_pass;
 
+		render_pass_hash = std::hash<VkRenderPass>{}(render_pass->get_handle());
+
 		dirty = true;
 	}
 }
@@ -207,6 +257,8 @@ void PipelineState::set_vertex_input_state(const VertexInputState &new_vertex_in
 	{
 		vertex_input_state = new_vertex_input_state;
 
+		vertex_input_state_hash = std::hash<VertexInputState>{}(vertex_input_state);
+
 		dirty = true;
 	}
 }
@@ -217,6 +269,8 @@ void PipelineState::set_input_assembly_state(const InputAssemblyState &new_input
 	{
 		input_assembly_state = new_input_assembly_state;
 
+		input_assembly_state_hash = std::hash<InputAssemblyState>{}(input_assembly_state);
+
 		dirty = true;
 	}
 }
@@ -227,6 +281,8 @@ void PipelineState::set_rasterization_state(const RasterizationState &new_raster
 	{
 		rasterization_state = new_rasterization_state;
 
+		rasterization_state_hash = std::hash<RasterizationState>{}(rasterization_state);
+
 		dirty = true;
 	}
 }
@@ -237,6 +293,8 @@ void PipelineState::set_viewport_state(const ViewportState &new_viewport_state)
 	{
 		viewport_state = new_viewport_state;
 
+		viewport_state_hash = std::hash<ViewportState>{}(viewport_state);
+
 		dirty = true;
 	}
 }
@@ -247,6 +305,8 @@ void PipelineState::set_multisample_state(const MultisampleState &new_multisampl
 	{
 		multisample_state = new_multisample_state;
 
+		multisample_state_hash = std::hash<MultisampleState>{}(multisample_state);
+
 		dirty = true;
 	}
 }
@@ -257,6 +317,8 @@ void PipelineState::set_depth_stencil_state(const DepthStencilState &new_depth_s
 	{
 		depth_stencil_state = new_depth_stencil_state;
 
+		depth_stencil_state_hash = std::hash<DepthStencilState>{}(depth_stencil_state);
+
 		dirty = true;
 	}
 }
@@ -267,6 +329,8 @@ void PipelineState::set_color_blend_state(const ColorBlendState &new_color_blend
 	{
 		color_blend_state = new_color_blend_state;
 
+		color_blend_state_hash = std::hash<ColorBlendState>{}(color_blend_state);
+
 		dirty = true;
 	}
 }
@@ -347,4 +411,55 @@ void PipelineState::clear_dirty()
 	dirty = false;
 	specialization_constant_state.clear_dirty();
 }
+
+std::size_t PipelineState::get_hash() const
+{
+	std::size_t result = 0;
+
+	hash_combine(result, pipeline_layout_hash);
+
+	// For graphics only
+	hash_combine(result, render_pass_hash);
+
+	hash_combine(result, specialization_constant_state.get_hash());
+
+	hash_combine(result, subpass_index);
+
+	hash_combine(result, vertex_input_state_hash);
+
+	hash_combine(result, input_assembly_state_hash);
+
+	hash_combine(result, viewport_state_hash);
+
+	hash_combine(result, rasterization_state_hash);
+
+	hash_combine(result, multisample_state_hash);
+
+	hash_combine(result, depth_stencil_state_hash);
+
+	hash_combine(result, color_blend_state_hash);
+
+	return result;
+}
+
+void PipelineState::update_hashes()
+{
+	pipeline_layout_hash = pipeline_layout ? hash_pipeline_layout(*pipeline_layout) : 0U;
+
+	render_pass_hash = render_pass ? std::hash<VkRenderPass>{}(render_pass->get_handle()) : 0U;
+
+	vertex_input_state_hash = std::hash<VertexInputState>{}(vertex_input_state);
+
+	input_assembly_state_hash = std::hash<InputAssemblyState>{}(input_assembly_state);
+
+	rasterization_state_hash = std::hash<RasterizationState>{}(rasterization_state);
+
+	viewport_state_hash = std::hash<ViewportState>{}(viewport_state);
+
+	multisample_state_hash = std::hash<MultisampleState>{}(multisample_state);
+
+	depth_stencil_state_hash = std::hash<DepthStencilState>{}(depth_stencil_state);
+
+	color_blend_state_hash = std::hash<ColorBlendState>{}(color_blend_state);
+}
 }        // namespace vkb
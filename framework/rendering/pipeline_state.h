@@ -152,10 +152,19 @@ class SpecializationConstantState
 
 	const std::map<uint32_t, std::vector<uint8_t>> &get_specialization_constant_state() const;
 
+	/**
+	 * @return Hash of the constants, updated whenever they change
+	 */
+	std::size_t get_hash() const;
+
   private:
 	bool dirty{false};
 	// Map tracking state of the Specialization Constants
 	std::map<uint32_t, std::vector<uint8_t>> specialization_constant_state;
+
+	std::size_t hash{0U};
+
+	void update_hash();
 };
 
 template <class T>
@@ -170,9 +179,16 @@ inline void SpecializationConstantState::set_constant<bool>(std::uint32_t consta
 	set_constant(constant_id, to_bytes(static_cast<std::uint32_t>(data)));
 }
 
+/**
+ * @brief The state of a pipeline, used as the key to request pipelines from the resource cache.
+ *        The hash of every sub-state is updated by its setter when it changes, so hashing the
+ *        whole state only combines a handful of values instead of walking every sub-state.
+ */
 class PipelineState
 {
   public:
+	PipelineState();
+
 	void reset();
 
 	void set_pipeline_layout(PipelineLayout &pipeline_layout);
@@ -223,6 +239,11 @@ class PipelineState
 
 	void clear_dirty();
 
+	/**
+	 * @return Hash of the whole state, combined in constant time from the hashes of its sub-states
+	 */
+	std::size_t get_hash() const;
+
   private:
 	bool dirty{false};
 
@@ -247,5 +268,27 @@ class PipelineState
 	ColorBlendState color_blend_state{};
 
 	uint32_t subpass_index{0U};
+
+	// Hashes of the sub-states, updated whenever one of them changes
+
+	std::size_t pipeline_layout_hash{0U};
+
+	std::size_t render_pass_hash{0U};
+
+	std::size_t vertex_input_state_hash{0U};
+
+	std::size_t input_assembly_state_hash{0U};
+
+	std::size_t rasterization_state_hash{0U};
+
+	std::size_t viewport_state_hash{0U};
+
+	std::size_t multisample_state_hash{0U};
+
+	std::size_t depth_stencil_state_hash{0U};
+
+	std::size_t color_blend_state_hash{0U};
+
+	void update_hashes();
 };
 }        // namespace vkb
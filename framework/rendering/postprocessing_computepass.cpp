@@ -125,7 +125,7 @@ void PostProcessingComputePass::transition_images(CommandBuffer &command_buffer,
 			barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
 
 			assert(*attachment < sampled_rt->get_views().size());
-			command_buffer.image_memory_barrier(sampled_rt->get_views()[*attachment], barrier);
+			command_buffer.add_image_memory_barrier(sampled_rt->get_views()[*attachment], barrier);
 			sampled_rt->set_layout(*attachment, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 		}
 	}
@@ -183,7 +183,7 @@ void PostProcessingComputePass::transition_images(CommandBuffer &command_buffer,
 			}
 
 			assert(*attachment < storage_rt->get_views().size());
-			command_buffer.image_memory_barrier(storage_rt->get_views()[*attachment], barrier);
+			command_buffer.add_image_memory_barrier(storage_rt->get_views()[*attachment], barrier);
 			storage_rt->set_layout(*attachment, barrier.new_layout);
 		}
 	}
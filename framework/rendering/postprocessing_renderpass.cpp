@@ -355,7 +355,7 @@ void PostProcessingRenderPass::transition_attachments(
 		barrier.dst_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
 
 		assert(input < views.size());
-		command_buffer.image_memory_barrier(views[input], barrier);
+		command_buffer.add_image_memory_barrier(views[input], barrier);
 		render_target.set_layout(input, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 	}
 
@@ -404,7 +404,7 @@ void PostProcessingRenderPass::transition_attachments(
 		barrier.dst_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
 
 		assert(attachment < sampled_rt->get_views().size());
-		command_buffer.image_memory_barrier(sampled_rt->get_views()[attachment], barrier);
+		command_buffer.add_image_memory_barrier(sampled_rt->get_views()[attachment], barrier);
 		sampled_rt->set_layout(attachment, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 	}
 
@@ -437,7 +437,7 @@ void PostProcessingRenderPass::transition_attachments(
 			barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 		}
 
-		command_buffer.image_memory_barrier(views[output], barrier);
+		command_buffer.add_image_memory_barrier(views[output], barrier);
 		render_target.set_layout(output, output_layout);
 	}
 
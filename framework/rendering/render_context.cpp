@@ -27,7 +27,8 @@ RenderContext::RenderContext(Device &device, VkSurfaceKHR surface, const Window
     device{device},
     window{window},
     queue{device.get_suitable_graphics_queue()},
-    surface_extent{window.get_extent().width, window.get_extent().height}
+    surface_extent{window.get_extent().width, window.get_extent().height},
+    frames_in_flight{window.get_properties().frames_in_flight}
 {
 	if (surface != VK_NULL_HANDLE)
 	{
@@ -47,6 +48,17 @@ RenderContext::RenderContext(Device &device, VkSurfaceKHR surface, const Window
 	}
 }
 
+RenderContext::~RenderContext()
+{
+	for (auto semaphore : present_semaphores)
+	{
+		if (semaphore != VK_NULL_HANDLE)
+		{
+			vkDestroySemaphore(device.get_handle(), semaphore, nullptr);
+		}
+	}
+}
+
 void RenderContext::request_present_mode(const VkPresentModeKHR present_mode)
 {
 	if (swapchain)
@@ -65,10 +77,20 @@ void RenderContext::request_image_format(const VkFormat format)
 	}
 }
 
+void RenderContext::request_frames_in_flight(uint32_t count)
+{
+	frames_in_flight = count;
+}
+
 void RenderContext::prepare(size_t thread_count, RenderTarget::CreateFunc create_render_target_func)
 {
 	device.wait_idle();
 
+	this->create_render_target_func = create_render_target_func;
+	this->thread_count              = thread_count;
+
+	std::vector<std::unique_ptr<RenderTarget>> render_targets;
+
 	if (swapchain)
 	{
 		swapchain->set_present_mode_priority(present_mode_priority_list);
@@ -78,37 +100,102 @@ void RenderContext::prepare(size_t thread_count, RenderTarget::CreateFunc create
 
 		surface_extent = swapchain->get_extent();
 
-		VkExtent3D extent{surface_extent.width, surface_extent.height, 1};
+		render_targets = create_swapchain_render_targets();
+	}
+	else
+	{
+		// Otherwise, create a ring of offscreen images standing in for swapchain images
+		swapchain = nullptr;
+
+		uint32_t image_count = std::max(window.get_properties().headless_image_count, 1u);
+
+		for (uint32_t i = 0; i < image_count; ++i)
+		{
+			auto color_image = core::Image{device,
+			                               VkExtent3D{surface_extent.width, surface_extent.height, 1},
+			                               DEFAULT_VK_FORMAT,        // We can use any format here that we like
+			                               VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+			                               VMA_MEMORY_USAGE_GPU_ONLY};
+
+			render_targets.push_back(create_render_target_func(std::move(color_image)));
+		}
+	}
 
-		for (auto &image_handle : swapchain->get_images())
+	if (frames_in_flight == 0)
+	{
+		// One frame per image, which owns the render target of the image
+		for (auto &render_target : render_targets)
 		{
-			auto swapchain_image = core::Image{
-			    device, image_handle,
-			    extent,
-			    swapchain->get_format(),
-			    swapchain->get_usage()};
-			auto render_target = create_render_target_func(std::move(swapchain_image));
 			frames.emplace_back(std::make_unique<RenderFrame>(device, std::move(render_target), thread_count));
 		}
 	}
 	else
 	{
-		// Otherwise, create a single RenderFrame
-		swapchain = nullptr;
+		image_render_targets = std::move(render_targets);
 
-		auto color_image = core::Image{device,
-		                               VkExtent3D{surface_extent.width, surface_extent.height, 1},
-		                               DEFAULT_VK_FORMAT,        // We can use any format here that we like
-		                               VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-		                               VMA_MEMORY_USAGE_GPU_ONLY};
+		for (uint32_t i = 0; i < frames_in_flight; ++i)
+		{
+			frames.emplace_back(std::make_unique<RenderFrame>(device, nullptr, thread_count));
+		}
 
-		auto render_target = create_render_target_func(std::move(color_image));
-		frames.emplace_back(std::make_unique<RenderFrame>(device, std::move(render_target), thread_count));
+		bind_image_render_targets();
 	}
 
-	this->create_render_target_func = create_render_target_func;
-	this->thread_count              = thread_count;
-	this->prepared                  = true;
+	this->prepared = true;
+}
+
+std::vector<std::unique_ptr<RenderTarget>> RenderContext::create_swapchain_render_targets()
+{
+	VkExtent2D swapchain_extent = swapchain->get_extent();
+	VkExtent3D extent{swapchain_extent.width, swapchain_extent.height, 1};
+
+	std::vector<std::unique_ptr<RenderTarget>> render_targets;
+
+	for (auto &image_handle : swapchain->get_images())
+	{
+		core::Image swapchain_image{device, image_handle,
+		                            extent,
+		                            swapchain->get_format(),
+		                            swapchain->get_usage()};
+
+		render_targets.push_back(create_render_target_func(std::move(swapchain_image)));
+	}
+
+	return render_targets;
+}
+
+void RenderContext::update_render_targets(std::vector<std::unique_ptr<RenderTarget>> &&render_targets)
+{
+	if (frames_in_flight > 0)
+	{
+		image_render_targets = std::move(render_targets);
+		bind_image_render_targets();
+		return;
+	}
+
+	for (size_t i = 0; i < render_targets.size(); ++i)
+	{
+		if (i < frames.size())
+		{
+			frames[i]->update_render_target(std::move(render_targets[i]));
+		}
+		else
+		{
+			// Create a new frame if the new swapchain has more images than current frames
+			frames.emplace_back(std::make_unique<RenderFrame>(device, std::move(render_targets[i]), thread_count));
+		}
+	}
+}
+
+void RenderContext::bind_image_render_targets()
+{
+	// Until they acquire an image, frames render to the image of the same index
+	image_frames.assign(image_render_targets.size(), ~0u);
+
+	for (size_t i = 0; i < frames.size(); ++i)
+	{
+		frames[i]->set_render_target(*image_render_targets[i % image_render_targets.size()]);
+	}
 }
 
 void RenderContext::set_present_mode_priority(const std::vector<VkPresentModeKHR> &new_present_mode_priority_list)
@@ -212,32 +299,7 @@ void RenderContext::recreate()
 {
 	LOGI("Recreated swapchain");
 
-	VkExtent2D swapchain_extent = swapchain->get_extent();
-	VkExtent3D extent{swapchain_extent.width, swapchain_extent.height, 1};
-
-	auto frame_it = frames.begin();
-
-	for (auto &image_handle : swapchain->get_images())
-	{
-		core::Image swapchain_image{device, image_handle,
-		                            extent,
-		                            swapchain->get_format(),
-		                            swapchain->get_usage()};
-
-		auto render_target = create_render_target_func(std::move(swapchain_image));
-
-		if (frame_it != frames.end())
-		{
-			(*frame_it)->update_render_target(std::move(render_target));
-		}
-		else
-		{
-			// Create a new frame if the new swapchain has more images than current frames
-			frames.emplace_back(std::make_unique<RenderFrame>(device, std::move(render_target), thread_count));
-		}
-
-		++frame_it;
-	}
+	update_render_targets(create_swapchain_render_targets());
 
 	device.get_resource_cache().clear_framebuffers();
 }
@@ -312,7 +374,7 @@ void RenderContext::submit(const std::vector<CommandBuffer *> &command_buffers)
 	if (swapchain)
 	{
 		assert(acquired_semaphore && "We do not have acquired_semaphore, it was probably consumed?\n");
-		render_semaphore = submit(queue, command_buffers, acquired_semaphore, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+		render_semaphore = submit(queue, command_buffers, acquired_semaphore, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, request_present_semaphore());
 	}
 	else
 	{
@@ -341,7 +403,7 @@ void RenderContext::begin_frame()
 
 	if (swapchain)
 	{
-		auto result = swapchain->acquire_next_image(active_frame_index, acquired_semaphore, VK_NULL_HANDLE);
+		auto result = swapchain->acquire_next_image(active_image_index, acquired_semaphore, VK_NULL_HANDLE);
 
 		if (result == VK_SUBOPTIMAL_KHR || result == VK_ERROR_OUT_OF_DATE_KHR)
 		{
@@ -349,7 +411,7 @@ void RenderContext::begin_frame()
 
 			if (swapchain_updated)
 			{
-				result = swapchain->acquire_next_image(active_frame_index, acquired_semaphore, VK_NULL_HANDLE);
+				result = swapchain->acquire_next_image(active_image_index, acquired_semaphore, VK_NULL_HANDLE);
 			}
 		}
 
@@ -359,22 +421,99 @@ void RenderContext::begin_frame()
 			return;
 		}
 	}
+	else
+	{
+		acquire_offscreen_image();
+	}
+
+	select_frame();
 
 	// Now the frame is active again
 	frame_active = true;
 
 	// Wait on all resource to be freed from the previous render to this frame
 	wait_frame();
+
+	begin_cache_generation();
+}
+
+void RenderContext::acquire_offscreen_image()
+{
+	auto image_count = to_u32(frames_in_flight > 0 ? image_render_targets.size() : frames.size());
+
+	// Offscreen images are acquired in order, like a FIFO swapchain
+	active_image_index = (active_image_index + 1) % image_count;
+}
+
+void RenderContext::select_frame()
+{
+	auto frame_count = to_u32(frames.size());
+
+	if (frames_in_flight == 0)
+	{
+		// Each frame renders to its own image
+		active_frame_index = active_image_index;
+	}
+	else
+	{
+		// Frames are used in turn whatever the image, the next one is waited for in wait_frame()
+		active_frame_index = (active_frame_index + 1) % frame_count;
+
+		// The attachments of the image other than the swapchain image may still be in use by
+		// the last frame which rendered to it
+		auto &image_frame = image_frames[active_image_index];
+		if (image_frame < frame_count && image_frame != active_frame_index)
+		{
+			frames[image_frame]->wait();
+		}
+		image_frame = active_frame_index;
+
+		frames[active_frame_index]->set_render_target(*image_render_targets[active_image_index]);
+	}
+
+	if (!swapchain)
+	{
+		// Bound the frames in flight as a presentation engine holding on to images would,
+		// the active frame itself is waited for in wait_frame()
+		uint32_t latency = window.get_properties().headless_latency;
+		if (latency > 0 && latency < frame_count)
+		{
+			frames[(active_frame_index + frame_count - latency) % frame_count]->wait();
+		}
+	}
+}
+
+void RenderContext::begin_cache_generation()
+{
+	auto &resource_cache = device.get_resource_cache();
+
+	// Frames may have been added or removed when the swapchain was recreated
+	frame_generations.resize(frames.size(), 0);
+
+	// The active frame was just waited for, so every generation older than the
+	// oldest one still used by another frame has finished executing
+	auto completed_generation = resource_cache.get_generation();
+	for (size_t i = 0; i < frame_generations.size(); ++i)
+	{
+		if (i != active_frame_index && frame_generations[i] != 0)
+		{
+			completed_generation = std::min(completed_generation, frame_generations[i] - 1);
+		}
+	}
+
+	frame_generations[active_frame_index] = resource_cache.begin_frame(completed_generation);
 }
 
-VkSemaphore RenderContext::submit(const Queue &queue, const std::vector<CommandBuffer *> &command_buffers, VkSemaphore wait_semaphore, VkPipelineStageFlags wait_pipeline_stage)
+VkSemaphore RenderContext::submit(const Queue &queue, const std::vector<CommandBuffer *> &command_buffers, VkSemaphore wait_semaphore, VkPipelineStageFlags wait_pipeline_stage,
+                                  VkSemaphore signal_semaphore)
 {
 	std::vector<VkCommandBuffer> cmd_buf_handles(command_buffers.size(), VK_NULL_HANDLE);
 	std::transform(command_buffers.begin(), command_buffers.end(), cmd_buf_handles.begin(), [](const CommandBuffer *cmd_buf) { return cmd_buf->get_handle(); });
 
-	RenderFrame &frame = get_active_frame();
-
-	VkSemaphore signal_semaphore = frame.request_semaphore();
+	if (signal_semaphore == VK_NULL_HANDLE)
+	{
+		signal_semaphore = get_active_frame().request_semaphore();
+	}
 
 	VkSubmitInfo submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
 
@@ -391,9 +530,7 @@ VkSemaphore RenderContext::submit(const Queue &queue, const std::vector<CommandB
 	submit_info.signalSemaphoreCount = 1;
 	submit_info.pSignalSemaphores    = &signal_semaphore;
 
-	VkFence fence = frame.request_fence();
-
-	queue.submit({submit_info}, fence);
+	submit_frame(queue, submit_info);
 
 	return signal_semaphore;
 }
@@ -403,16 +540,29 @@ void RenderContext::submit(const Queue &queue, const std::vector<CommandBuffer *
 	std::vector<VkCommandBuffer> cmd_buf_handles(command_buffers.size(), VK_NULL_HANDLE);
 	std::transform(command_buffers.begin(), command_buffers.end(), cmd_buf_handles.begin(), [](const CommandBuffer *cmd_buf) { return cmd_buf->get_handle(); });
 
-	RenderFrame &frame = get_active_frame();
-
 	VkSubmitInfo submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
 
 	submit_info.commandBufferCount = to_u32(cmd_buf_handles.size());
 	submit_info.pCommandBuffers    = cmd_buf_handles.data();
 
-	VkFence fence = frame.request_fence();
+	submit_frame(queue, submit_info);
+}
+
+void RenderContext::submit_frame(const Queue &queue, const VkSubmitInfo &submit_info)
+{
+	RenderFrame &frame = get_active_frame();
 
-	queue.submit({submit_info}, fence);
+	if (device.has_queue_timelines())
+	{
+		// The frame waits for the submission on the timeline of the queue, no fence is needed
+		frame.add_ticket(device.get_queue_timeline(queue).submit({submit_info}));
+	}
+	else
+	{
+		VkFence fence = frame.request_fence();
+
+		queue.submit({submit_info}, fence);
+	}
 }
 
 void RenderContext::wait_frame()
@@ -435,7 +585,7 @@ void RenderContext::end_frame(VkSemaphore semaphore)
 		present_info.pWaitSemaphores    = &semaphore;
 		present_info.swapchainCount     = 1;
 		present_info.pSwapchains        = &vk_swapchain;
-		present_info.pImageIndices      = &active_frame_index;
+		present_info.pImageIndices      = &active_image_index;
 
 		VkDisplayPresentInfoKHR disp_present_info{};
 		if (device.is_extension_supported(VK_KHR_DISPLAY_SWAPCHAIN_EXTENSION_NAME) &&
@@ -508,6 +658,34 @@ void RenderContext::release_owned_semaphore(VkSemaphore semaphore)
 	frame.release_owned_semaphore(semaphore);
 }
 
+VkSemaphore RenderContext::request_present_semaphore()
+{
+	if (!swapchain || frames_in_flight == 0)
+	{
+		// The frame is only reused once its image is acquired again
+		return request_semaphore();
+	}
+
+	assert(frame_active && "Frame is not active, please call begin_frame");
+
+	// Images may be added when the swapchain is recreated, semaphores are kept until the context is destroyed
+	if (active_image_index >= present_semaphores.size())
+	{
+		present_semaphores.resize(active_image_index + 1, VK_NULL_HANDLE);
+	}
+
+	auto &semaphore = present_semaphores[active_image_index];
+
+	if (semaphore == VK_NULL_HANDLE)
+	{
+		VkSemaphoreCreateInfo create_info{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+
+		VK_CHECK(vkCreateSemaphore(device.get_handle(), &create_info, nullptr, &semaphore));
+	}
+
+	return semaphore;
+}
+
 Device &RenderContext::get_device()
 {
 	return device;
@@ -518,23 +696,7 @@ void RenderContext::recreate_swapchain()
 	device.wait_idle();
 	device.get_resource_cache().clear_framebuffers();
 
-	VkExtent2D swapchain_extent = swapchain->get_extent();
-	VkExtent3D extent{swapchain_extent.width, swapchain_extent.height, 1};
-
-	auto frame_it = frames.begin();
-
-	for (auto &image_handle : swapchain->get_images())
-	{
-		core::Image swapchain_image{device, image_handle,
-		                            extent,
-		                            swapchain->get_format(),
-		                            swapchain->get_usage()};
-
-		auto render_target = create_render_target_func(std::move(swapchain_image));
-		(*frame_it)->update_render_target(std::move(render_target));
-
-		++frame_it;
-	}
+	update_render_targets(create_swapchain_render_targets());
 }
 
 bool RenderContext::has_swapchain()
@@ -558,6 +720,11 @@ uint32_t RenderContext::get_active_frame_index() const
 	return active_frame_index;
 }
 
+uint32_t RenderContext::get_active_image_index() const
+{
+	return active_image_index;
+}
+
 std::vector<std::unique_ptr<RenderFrame>> &RenderContext::get_render_frames()
 {
 	return frames;
@@ -51,8 +51,21 @@ class Window;
  * For normal rendering (using a swapchain), the RenderContext can be created by passing in a
  * swapchain. A RenderFrame will then be created for each Swapchain image.
  *
+ * The number of frames in flight can instead be set independently of the number of images, with
+ * request_frames_in_flight() or the frames_in_flight property of the window. The RenderContext then
+ * owns a RenderTarget per image, and frames are used in turn, each rendering to the RenderTarget of
+ * the image acquired for it. This allows e.g. double buffering the CPU work with a triple buffered
+ * swapchain, without more latency or per-frame memory than needed. The semaphores waited for by
+ * presentation then belong to the images, see request_present_semaphore().
+ *
  * For headless rendering (no swapchain), the RenderContext can be given a valid Device, and
- * a width and height. A single RenderFrame will then be created.
+ * a width and height. A ring of RenderFrames with offscreen images will then be created, which are
+ * acquired in turn like swapchain images. Their number and the maximum number of frames in flight
+ * come from the headless properties of the window.
+ *
+ * If the device has queue timelines (see Device::create_queue_timelines), frames are submitted
+ * through the timeline semaphore of their queue instead of with fences, and each frame waits for
+ * the last value it signaled before its resources are reused.
  */
 class RenderContext
 {
@@ -72,7 +85,7 @@ class RenderContext
 
 	RenderContext(RenderContext &&) = delete;
 
-	virtual ~RenderContext() = default;
+	virtual ~RenderContext();
 
 	RenderContext &operator=(const RenderContext &) = delete;
 
@@ -98,6 +111,12 @@ class RenderContext
 	 */
 	void set_surface_format_priority(const std::vector<VkSurfaceFormatKHR> &surface_format_priority_list);
 
+	/**
+	 * @brief Requests a number of frames in flight independent of the number of images, must be called before prepare
+	 * @param count The number of frames, 0 to create one frame per image
+	 */
+	void request_frames_in_flight(uint32_t count);
+
 	/**
 	 * @brief Prepares the RenderFrames for rendering
 	 * @param thread_count The number of threads in the application, necessary to allocate this many resource pools for each RenderFrame
@@ -170,13 +189,26 @@ class RenderContext
 	 */
 	void begin_frame();
 
-	VkSemaphore submit(const Queue &queue, const std::vector<CommandBuffer *> &command_buffers, VkSemaphore wait_semaphore, VkPipelineStageFlags wait_pipeline_stage);
+	/**
+	 * @brief Submits command buffers related to a frame to a queue, after a semaphore
+	 * @param signal_semaphore The semaphore to signal, one of the frame if VK_NULL_HANDLE
+	 * @return The semaphore signaled by the submission
+	 */
+	VkSemaphore submit(const Queue &queue, const std::vector<CommandBuffer *> &command_buffers, VkSemaphore wait_semaphore, VkPipelineStageFlags wait_pipeline_stage,
+	                   VkSemaphore signal_semaphore = VK_NULL_HANDLE);
 
 	/**
 	 * @brief Submits a command buffer related to a frame to a queue
 	 */
 	void submit(const Queue &queue, const std::vector<CommandBuffer *> &command_buffers);
 
+	/**
+	 * @brief Submits work of the active frame, which waits for it on the timeline of the queue
+	 *        if the device has queue timelines, or on a fence otherwise.
+	 *        Used for submissions with custom semaphores, so that the frame still waits for them.
+	 */
+	void submit_frame(const Queue &queue, const VkSubmitInfo &submit_info);
+
 	/**
 	 * @brief Waits a frame to finish its rendering
 	 */
@@ -209,6 +241,13 @@ class RenderContext
 	VkSemaphore request_semaphore_with_ownership();
 	void        release_owned_semaphore(VkSemaphore semaphore);
 
+	/**
+	 * @brief Requests the semaphore to signal for the presentation of the active frame, to be passed to end_frame().
+	 *        A present may still wait on it once the frame which signaled it completed, so if frames are not
+	 *        tied to images it belongs to the acquired image, and is only reused when that image is acquired again.
+	 */
+	VkSemaphore request_present_semaphore();
+
 	Device &get_device();
 
 	/**
@@ -222,6 +261,12 @@ class RenderContext
 
 	uint32_t get_active_frame_index() const;
 
+	/**
+	 * @return The index of the swapchain or offscreen image acquired for the active frame,
+	 *         which is the active frame index unless frames in flight were requested
+	 */
+	uint32_t get_active_image_index() const;
+
 	std::vector<std::unique_ptr<RenderFrame>> &get_render_frames();
 
 	/**
@@ -269,6 +314,21 @@ class RenderContext
 	/// Current active frame index
 	uint32_t active_frame_index{0};
 
+	/// Index of the image acquired for the active frame
+	uint32_t active_image_index{0};
+
+	/// Number of frames in flight, 0 for one frame per image
+	uint32_t frames_in_flight{0};
+
+	/// Render targets of the images, owned by the context rather than by the frames if frames_in_flight is not 0
+	std::vector<std::unique_ptr<RenderTarget>> image_render_targets;
+
+	/// Index of the frame which last rendered to each image, ~0u if none did
+	std::vector<uint32_t> image_frames;
+
+	/// Semaphores waited for by the presentation of each swapchain image if frames_in_flight is not 0, created on first use
+	std::vector<VkSemaphore> present_semaphores;
+
 	/// Whether a frame is active or not
 	bool frame_active{false};
 
@@ -277,6 +337,39 @@ class RenderContext
 	VkSurfaceTransformFlagBitsKHR pre_transform{VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR};
 
 	size_t thread_count{1};
+
+	/// Resource cache generation last begun by each frame, 0 if the frame was never used
+	std::vector<uint64_t> frame_generations;
+
+	/**
+	 * @brief Starts a new resource cache generation for the active frame, which was just waited for
+	 */
+	void begin_cache_generation();
+
+	/**
+	 * @brief Acquires the next offscreen image, in place of acquiring a swapchain image
+	 */
+	void acquire_offscreen_image();
+
+	/**
+	 * @brief Makes the frame which renders to the acquired image active
+	 */
+	void select_frame();
+
+	/**
+	 * @brief Creates a RenderTarget for each image of the swapchain
+	 */
+	std::vector<std::unique_ptr<RenderTarget>> create_swapchain_render_targets();
+
+	/**
+	 * @brief Replaces the render targets of the images after the swapchain was recreated
+	 */
+	void update_render_targets(std::vector<std::unique_ptr<RenderTarget>> &&render_targets);
+
+	/**
+	 * @brief Points every frame to an image render target, before they acquire images
+	 */
+	void bind_image_render_targets();
 };
 
 }        // namespace vkb
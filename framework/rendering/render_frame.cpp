@@ -17,6 +17,8 @@
 
 #include "render_frame.h"
 
+#include <cstring>
+
 #include "common/logging.h"
 #include "common/utils.h"
 
@@ -29,19 +31,13 @@ RenderFrame::RenderFrame(Device &device, std::unique_ptr<RenderTarget> &&render_
     swapchain_render_target{std::move(render_target)},
     thread_count{thread_count}
 {
-	for (auto &usage_it : supported_usage_map)
-	{
-		std::vector<std::pair<BufferPool, BufferBlock *>> usage_buffer_pools;
-		for (size_t i = 0; i < thread_count; ++i)
-		{
-			usage_buffer_pools.push_back(std::make_pair(BufferPool{device, BUFFER_POOL_BLOCK_SIZE * 1024 * usage_it.second, usage_it.first}, nullptr));
-		}
+	buffer_pools.resize(thread_count);
 
-		auto res_ins_it = buffer_pools.emplace(usage_it.first, std::move(usage_buffer_pools));
-
-		if (!res_ins_it.second)
+	for (size_t i = 0; i < thread_count; ++i)
+	{
+		for (auto &usage_it : usage_block_multipliers)
 		{
-			throw std::runtime_error("Failed to insert buffer pool");
+			get_buffer_pool(usage_it.first, i);
 		}
 	}
 
@@ -49,6 +45,7 @@ RenderFrame::RenderFrame(Device &device, std::unique_ptr<RenderTarget> &&render_
 	{
 		descriptor_pools.push_back(std::make_unique<std::unordered_map<std::size_t, DescriptorPool>>());
 		descriptor_sets.push_back(std::make_unique<std::unordered_map<std::size_t, DescriptorSet>>());
+		template_descriptor_sets.push_back(std::make_unique<std::unordered_map<std::size_t, VkDescriptorSet>>());
 	}
 }
 
@@ -60,14 +57,28 @@ Device &RenderFrame::get_device()
 void RenderFrame::update_render_target(std::unique_ptr<RenderTarget> &&render_target)
 {
 	swapchain_render_target = std::move(render_target);
+	image_render_target     = nullptr;
+}
+
+void RenderFrame::set_render_target(RenderTarget &render_target)
+{
+	image_render_target = &render_target;
 }
 
 void RenderFrame::reset()
 {
-	VK_CHECK(fence_pool.wait());
+	wait();
 
 	fence_pool.reset();
 
+	tickets.clear();
+
+	{
+		std::lock_guard<std::mutex> lock{barrier_statistics_mutex};
+
+		barrier_statistics = {};
+	}
+
 	for (auto &command_pools_per_queue : command_pools)
 	{
 		for (auto &command_pool : command_pools_per_queue.second)
@@ -76,12 +87,12 @@ void RenderFrame::reset()
 		}
 	}
 
-	for (auto &buffer_pools_per_usage : buffer_pools)
+	for (auto &thread_buffer_pools : buffer_pools)
 	{
-		for (auto &buffer_pool : buffer_pools_per_usage.second)
+		for (auto &buffer_pool : thread_buffer_pools)
 		{
-			buffer_pool.first.reset();
-			buffer_pool.second = nullptr;
+			buffer_pool.second.first.reset();
+			buffer_pool.second.second = nullptr;
 		}
 	}
 
@@ -93,6 +104,48 @@ void RenderFrame::reset()
 	}
 }
 
+void RenderFrame::wait() const
+{
+	VK_CHECK(fence_pool.wait());
+
+	for (auto &ticket : tickets)
+	{
+		VK_CHECK(device.get_queue_timeline(*ticket.queue).wait(ticket.value));
+	}
+}
+
+void RenderFrame::add_ticket(const TimelineTicket &ticket)
+{
+	// Work on a queue completes in order, so only the last ticket of each queue is needed
+	auto it = std::find_if(tickets.begin(), tickets.end(), [&ticket](const TimelineTicket &other) { return other.queue == ticket.queue; });
+
+	if (it != tickets.end())
+	{
+		it->value = std::max(it->value, ticket.value);
+	}
+	else
+	{
+		tickets.push_back(ticket);
+	}
+}
+
+void RenderFrame::add_barrier_statistics(const BarrierStatistics &statistics)
+{
+	std::lock_guard<std::mutex> lock{barrier_statistics_mutex};
+
+	barrier_statistics.pipeline_barrier_count += statistics.pipeline_barrier_count;
+	barrier_statistics.image_barrier_count += statistics.image_barrier_count;
+	barrier_statistics.buffer_barrier_count += statistics.buffer_barrier_count;
+	barrier_statistics.memory_barrier_count += statistics.memory_barrier_count;
+}
+
+BarrierStatistics RenderFrame::get_barrier_statistics() const
+{
+	std::lock_guard<std::mutex> lock{barrier_statistics_mutex};
+
+	return barrier_statistics;
+}
+
 std::vector<std::unique_ptr<CommandPool>> &RenderFrame::get_command_pools(const Queue &queue, CommandBuffer::ResetMode reset_mode)
 {
 	auto command_pool_it = command_pools.find(queue.get_family_index());
@@ -185,12 +238,12 @@ void RenderFrame::release_owned_semaphore(VkSemaphore semaphore)
 
 RenderTarget &RenderFrame::get_render_target()
 {
-	return *swapchain_render_target;
+	return image_render_target ? *image_render_target : *swapchain_render_target;
 }
 
 const RenderTarget &RenderFrame::get_render_target_const() const
 {
-	return *swapchain_render_target;
+	return image_render_target ? *image_render_target : *swapchain_render_target;
 }
 
 CommandBuffer &RenderFrame::request_command_buffer(const Queue &queue, CommandBuffer::ResetMode reset_mode, VkCommandBufferLevel level, size_t thread_index)
@@ -235,6 +288,54 @@ VkDescriptorSet RenderFrame::request_descriptor_set(const DescriptorSetLayout &d
 	}
 }
 
+VkDescriptorSet RenderFrame::request_descriptor_set(const DescriptorSetLayout &descriptor_set_layout, const std::vector<DescriptorTemplateElement> &payload, size_t thread_index)
+{
+	assert(thread_index < thread_count && "Thread index is out of bounds");
+	assert(descriptor_set_layout.get_update_template() != VK_NULL_HANDLE && "Descriptor set layout has no update template");
+	assert(payload.size() == descriptor_set_layout.get_template_element_count() && "Payload does not match the update template");
+
+	assert(thread_index < descriptor_pools.size());
+	auto &descriptor_pool = request_resource(device, nullptr, *descriptor_pools[thread_index], descriptor_set_layout);
+
+	auto write_descriptor_set = [&]() {
+		VkDescriptorSet handle = descriptor_pool.allocate();
+		vkUpdateDescriptorSetWithTemplateKHR(device.get_handle(), handle, descriptor_set_layout.get_update_template(), payload.data());
+		return handle;
+	};
+
+	if (descriptor_management_strategy == DescriptorManagementStrategy::CreateDirectly)
+	{
+		return write_descriptor_set();
+	}
+
+	// The payload is a flat array of handles and integers, so it is hashed word by word
+	std::size_t hash{0U};
+	hash_combine(hash, descriptor_set_layout.get_handle());
+
+	static_assert(sizeof(DescriptorTemplateElement) % sizeof(uint64_t) == 0, "Descriptor template elements must be made of whole words");
+	auto bytes = reinterpret_cast<const uint8_t *>(payload.data());
+	for (size_t offset = 0; offset < payload.size() * sizeof(DescriptorTemplateElement); offset += sizeof(uint64_t))
+	{
+		uint64_t word;
+		std::memcpy(&word, bytes + offset, sizeof(word));
+		hash_combine(hash, word);
+	}
+
+	assert(thread_index < template_descriptor_sets.size());
+	auto &thread_descriptor_sets = *template_descriptor_sets[thread_index];
+
+	auto descriptor_set_it = thread_descriptor_sets.find(hash);
+	if (descriptor_set_it != thread_descriptor_sets.end())
+	{
+		return descriptor_set_it->second;
+	}
+
+	VkDescriptorSet handle = write_descriptor_set();
+	thread_descriptor_sets.emplace(hash, handle);
+
+	return handle;
+}
+
 void RenderFrame::update_descriptor_sets(size_t thread_index)
 {
 	assert(thread_index < descriptor_sets.size());
@@ -252,6 +353,11 @@ void RenderFrame::clear_descriptors()
 		desc_sets_per_thread->clear();
 	}
 
+	for (auto &desc_sets_per_thread : template_descriptor_sets)
+	{
+		desc_sets_per_thread->clear();
+	}
+
 	for (auto &desc_pools_per_thread : descriptor_pools)
 	{
 		for (auto &desc_pool : *desc_pools_per_thread)
@@ -261,6 +367,16 @@ void RenderFrame::clear_descriptors()
 	}
 }
 
+void RenderFrame::set_descriptor_update_strategy(DescriptorUpdateStrategy new_strategy)
+{
+	descriptor_update_strategy = new_strategy;
+}
+
+DescriptorUpdateStrategy RenderFrame::get_descriptor_update_strategy() const
+{
+	return descriptor_update_strategy;
+}
+
 void RenderFrame::set_buffer_allocation_strategy(BufferAllocationStrategy new_strategy)
 {
 	buffer_allocation_strategy = new_strategy;
@@ -271,29 +387,45 @@ void RenderFrame::set_descriptor_management_strategy(DescriptorManagementStrateg
 	descriptor_management_strategy = new_strategy;
 }
 
-BufferAllocation RenderFrame::allocate_buffer(const VkBufferUsageFlags usage, const VkDeviceSize size, size_t thread_index)
+std::pair<BufferPool, BufferBlock *> &RenderFrame::get_buffer_pool(const VkBufferUsageFlags usage, size_t thread_index)
 {
-	assert(thread_index < thread_count && "Thread index is out of bounds");
-
-	uint32_t block_multiplier = supported_usage_map.at(usage);
+	// Each thread owns its pools, so they can be created on first use without locking
+	auto &thread_buffer_pools = buffer_pools[thread_index];
 
-	if (size > BUFFER_POOL_BLOCK_SIZE * 1024 * block_multiplier)
+	auto buffer_pool_it = thread_buffer_pools.find(usage);
+	if (buffer_pool_it != thread_buffer_pools.end())
 	{
-		LOGE("Trying to allocate {} buffer of size {}KB which is larger than the buffer pool block size ({} KB)!", buffer_usage_to_string(usage), size / 1024, BUFFER_POOL_BLOCK_SIZE * block_multiplier);
-		throw std::runtime_error("Couldn't allocate render frame buffer.");
+		return buffer_pool_it->second;
 	}
 
-	// Find a pool for this usage
-	auto buffer_pool_it = buffer_pools.find(usage);
-	if (buffer_pool_it == buffer_pools.end())
+	auto     multiplier_it    = usage_block_multipliers.find(usage);
+	uint32_t block_multiplier = multiplier_it != usage_block_multipliers.end() ? multiplier_it->second : 1;
+
+	auto res_ins_it = thread_buffer_pools.emplace(usage, std::make_pair(BufferPool{device, BUFFER_POOL_BLOCK_SIZE * 1024 * block_multiplier, usage}, nullptr));
+
+	if (!res_ins_it.second)
 	{
-		LOGE("No buffer pool for buffer usage {}", usage);
-		return BufferAllocation{};
+		throw std::runtime_error("Failed to insert buffer pool");
 	}
 
-	assert(thread_index < buffer_pool_it->second.size());
-	auto &buffer_pool  = buffer_pool_it->second[thread_index].first;
-	auto &buffer_block = buffer_pool_it->second[thread_index].second;
+	return res_ins_it.first->second;
+}
+
+BufferAllocation RenderFrame::allocate_buffer(const VkBufferUsageFlags usage, const VkDeviceSize size, size_t thread_index)
+{
+	assert(thread_index < thread_count && "Thread index is out of bounds");
+
+	auto &buffer_pool_entry = get_buffer_pool(usage, thread_index);
+	auto &buffer_pool       = buffer_pool_entry.first;
+	auto &buffer_block      = buffer_pool_entry.second;
+
+	if (size > buffer_pool.get_block_size())
+	{
+		// Oversized allocations get a dedicated block, the current block keeps serving the others
+		LOGD("Allocating {} buffer of size {}KB from a dedicated block, larger than the buffer pool block size ({} KB)", buffer_usage_to_string(usage), size / 1024, buffer_pool.get_block_size() / 1024);
+
+		return buffer_pool.request_buffer_block(size, true).allocate(to_u32(size));
+	}
 
 	bool want_minimal_block = buffer_allocation_strategy == BufferAllocationStrategy::OneAllocationPerBuffer;
 
@@ -316,4 +448,18 @@ BufferAllocation RenderFrame::allocate_buffer(const VkBufferUsageFlags usage, co
 
 	return data;
 }
+
+std::vector<BufferPoolStats> RenderFrame::get_buffer_pool_stats(size_t thread_index) const
+{
+	assert(thread_index < thread_count && "Thread index is out of bounds");
+
+	std::vector<BufferPoolStats> stats;
+
+	for (auto &buffer_pool : buffer_pools[thread_index])
+	{
+		stats.push_back(buffer_pool.second.first.get_stats());
+	}
+
+	return stats;
+}
 }        // namespace vkb
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "buffer_pool.h"
 #include "common/helpers.h"
 #include "common/resource_caching.h"
@@ -29,6 +31,7 @@
 #include "core/query_pool.h"
 #include "core/queue.h"
 #include "fence_pool.h"
+#include "queue_timeline.h"
 #include "rendering/render_target.h"
 #include "semaphore_pool.h"
 
@@ -46,10 +49,19 @@ enum DescriptorManagementStrategy
 	CreateDirectly
 };
 
+enum DescriptorUpdateStrategy
+{
+	WriteDescriptorSets,
+	UseUpdateTemplates
+};
+
 /**
  * @brief RenderFrame is a container for per-frame data, including BufferPool objects,
  * synchronization primitives (semaphores, fences) and the swapchain RenderTarget.
  *
+ * When the number of frames in flight differs from the number of swapchain images, the frame
+ * does not own a RenderTarget and renders to the one of the image it acquired instead.
+ *
  * When creating a RenderTarget, we need to provide images that will be used as attachments
  * within a RenderPass. The RenderFrame is responsible for creating a RenderTarget using
  * RenderTarget::CreateFunc. A custom RenderTarget::CreateFunc can be provided if a different
@@ -67,8 +79,9 @@ class RenderFrame
 	 */
 	static constexpr uint32_t BUFFER_POOL_BLOCK_SIZE = 256;
 
-	// A map of the supported usages to a multiplier for the BUFFER_POOL_BLOCK_SIZE
-	const std::unordered_map<VkBufferUsageFlags, uint32_t> supported_usage_map = {
+	// A map of common usages to a multiplier for the BUFFER_POOL_BLOCK_SIZE, their pools are created upfront.
+	// Pools for any other combination of usages are created on first use, with a multiplier of 1.
+	const std::unordered_map<VkBufferUsageFlags, uint32_t> usage_block_multipliers = {
 	    {VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 1},
 	    {VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 2},        // x2 the size of BUFFER_POOL_BLOCK_SIZE since SSBOs are normally much larger than other types of buffers
 	    {VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 1},
@@ -84,14 +97,38 @@ class RenderFrame
 
 	RenderFrame &operator=(RenderFrame &&) = delete;
 
+	/**
+	 * @brief Waits for the submissions of the frame, then makes its resources available again
+	 */
 	void reset();
 
+	/**
+	 * @brief Waits for the submissions of the frame, on their fences or their timeline tickets
+	 */
+	void wait() const;
+
 	Device &get_device();
 
 	const FencePool &get_fence_pool() const;
 
 	VkFence request_fence();
 
+	/**
+	 * @brief Records a submission of the frame made through a QueueTimeline. It is waited for
+	 *        on its timeline semaphore, in place of a fence.
+	 */
+	void add_ticket(const TimelineTicket &ticket);
+
+	/**
+	 * @brief Adds the barriers of a command buffer of the frame, called when it ends recording
+	 */
+	void add_barrier_statistics(const BarrierStatistics &statistics);
+
+	/**
+	 * @return The barriers recorded in the command buffers of the frame since it was last reset
+	 */
+	BarrierStatistics get_barrier_statistics() const;
+
 	const SemaphorePool &get_semaphore_pool() const;
 
 	VkSemaphore request_semaphore();
@@ -104,6 +141,12 @@ class RenderFrame
 	 */
 	void update_render_target(std::unique_ptr<RenderTarget> &&render_target);
 
+	/**
+	 * @brief Makes the frame render to a render target owned by the RenderContext, until the next call
+	 *        or update_render_target()
+	 */
+	void set_render_target(RenderTarget &render_target);
+
 	RenderTarget &get_render_target();
 
 	const RenderTarget &get_render_target_const() const;
@@ -129,6 +172,16 @@ class RenderFrame
 	                                       bool                                      update_after_bind,
 	                                       size_t                                    thread_index = 0);
 
+	/**
+	 * @brief Requests a descriptor set written from a flat payload with the update template of its layout
+	 * @param descriptor_set_layout A layout which has an update template
+	 * @param payload One element per descriptor of the layout, laid out as DescriptorSetLayout::get_template_offset describes
+	 * @param thread_index Selects the thread's descriptor pools and cache
+	 */
+	VkDescriptorSet request_descriptor_set(const DescriptorSetLayout &                   descriptor_set_layout,
+	                                       const std::vector<DescriptorTemplateElement> &payload,
+	                                       size_t                                        thread_index = 0);
+
 	void clear_descriptors();
 
 	/**
@@ -144,13 +197,29 @@ class RenderFrame
 	void set_descriptor_management_strategy(DescriptorManagementStrategy new_strategy);
 
 	/**
-	 * @param usage Usage of the buffer
+	 * @brief Sets a new descriptor update strategy, update templates are only used for layouts which have one
+	 * @param new_strategy The new descriptor update strategy
+	 */
+	void set_descriptor_update_strategy(DescriptorUpdateStrategy new_strategy);
+
+	DescriptorUpdateStrategy get_descriptor_update_strategy() const;
+
+	/**
+	 * @brief Allocates memory for the frame from the linear allocator of a thread.
+	 *        Allocations larger than a block get a dedicated block, which is recycled in later frames.
+	 * @param usage Usage of the buffer, any combination of flags
 	 * @param size Amount of memory required
 	 * @param thread_index Index of the buffer pool to be used by the current thread
 	 * @return The requested allocation, it may be empty
 	 */
 	BufferAllocation allocate_buffer(VkBufferUsageFlags usage, VkDeviceSize size, size_t thread_index = 0);
 
+	/**
+	 * @param thread_index Index of the thread whose buffer pools are queried
+	 * @return The high-water marks of every buffer pool of the thread, to tune their block sizes
+	 */
+	std::vector<BufferPoolStats> get_buffer_pool_stats(size_t thread_index = 0) const;
+
 	/**
 	 * @brief Updates all the descriptor sets in the current frame at a specific thread index
 	 */
@@ -177,18 +246,36 @@ class RenderFrame
 	/// Descriptor sets for the frame
 	std::vector<std::unique_ptr<std::unordered_map<std::size_t, DescriptorSet>>> descriptor_sets;
 
+	/// Descriptor sets written with update templates, keyed by the hash of their layout and payload
+	std::vector<std::unique_ptr<std::unordered_map<std::size_t, VkDescriptorSet>>> template_descriptor_sets;
+
 	FencePool fence_pool;
 
+	/// Last submission of the frame on each queue timeline it submitted to
+	std::vector<TimelineTicket> tickets;
+
+	/// Command buffers of several threads may end recording at the same time
+	mutable std::mutex barrier_statistics_mutex;
+
+	BarrierStatistics barrier_statistics;
+
 	SemaphorePool semaphore_pool;
 
 	size_t thread_count;
 
 	std::unique_ptr<RenderTarget> swapchain_render_target;
 
+	/// Render target of the image acquired for the frame, if it does not own one
+	RenderTarget *image_render_target{nullptr};
+
 	BufferAllocationStrategy     buffer_allocation_strategy{BufferAllocationStrategy::MultipleAllocationsPerBuffer};
 	DescriptorManagementStrategy descriptor_management_strategy{DescriptorManagementStrategy::StoreInCache};
+	DescriptorUpdateStrategy     descriptor_update_strategy{DescriptorUpdateStrategy::WriteDescriptorSets};
+
+	/// Buffer pools of each thread, with the block currently allocated from, per usage
+	std::vector<std::map<VkBufferUsageFlags, std::pair<BufferPool, BufferBlock *>>> buffer_pools;
 
-	std::map<VkBufferUsageFlags, std::vector<std::pair<BufferPool, BufferBlock *>>> buffer_pools;
+	std::pair<BufferPool, BufferBlock *> &get_buffer_pool(VkBufferUsageFlags usage, size_t thread_index);
 
 	static std::vector<uint32_t> collect_bindings_to_update(const DescriptorSetLayout &descriptor_set_layout, const BindingMap<VkDescriptorBufferInfo> &buffer_infos, const BindingMap<VkDescriptorImageInfo> &image_infos);
 };
@@ -0,0 +1,831 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render_graph.h"
+
+#include <algorithm>
+
+#include "core/command_buffer.h"
+#include "core/device.h"
+#include "rendering/render_pipeline.h"
+
+namespace vkb
+{
+namespace
+{
+constexpr VkAccessFlags write_access_mask = VK_ACCESS_SHADER_WRITE_BIT |
+                                            VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                            VK_ACCESS_TRANSFER_WRITE_BIT |
+                                            VK_ACCESS_HOST_WRITE_BIT |
+                                            VK_ACCESS_MEMORY_WRITE_BIT;
+
+/// Stage mask standing for every stage when comparing masks, unlike VK_PIPELINE_STAGE_ALL_COMMANDS_BIT
+constexpr VkPipelineStageFlags any_stage_mask = ~VkPipelineStageFlags{0};
+
+struct AccessInfo
+{
+	VkPipelineStageFlags stages;
+
+	VkAccessFlags access;
+
+	VkImageLayout layout;
+
+	VkImageUsageFlags usage;
+};
+
+VkPipelineStageFlags get_shader_stages(RenderGraph::PassType type)
+{
+	switch (type)
+	{
+		case RenderGraph::PassType::Graphics:
+			return VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		case RenderGraph::PassType::Compute:
+			return VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		default:
+			return VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+	}
+}
+
+AccessInfo get_image_access_info(RenderGraph::ImageAccess access, bool write, VkFormat format, RenderGraph::PassType type)
+{
+	bool depth = is_depth_stencil_format(format);
+
+	switch (access)
+	{
+		case RenderGraph::ImageAccess::Attachment:
+			if (!write)
+			{
+				// In the layout RenderPass gives input attachments
+				return {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+				        VK_ACCESS_INPUT_ATTACHMENT_READ_BIT,
+				        depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				        VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT};
+			}
+			if (depth)
+			{
+				return {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+				        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+				        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+				        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT};
+			}
+			return {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			        VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+			        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT};
+		case RenderGraph::ImageAccess::Sampled:
+			assert(!write && "Sampled images are read only");
+			return {get_shader_stages(type),
+			        VK_ACCESS_SHADER_READ_BIT,
+			        depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			        VK_IMAGE_USAGE_SAMPLED_BIT};
+		case RenderGraph::ImageAccess::Storage:
+			return {get_shader_stages(type),
+			        VK_ACCESS_SHADER_READ_BIT | (write ? VK_ACCESS_SHADER_WRITE_BIT : 0),
+			        VK_IMAGE_LAYOUT_GENERAL,
+			        VK_IMAGE_USAGE_STORAGE_BIT};
+		case RenderGraph::ImageAccess::Transfer:
+		default:
+			return {VK_PIPELINE_STAGE_TRANSFER_BIT,
+			        write ? VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_TRANSFER_READ_BIT,
+			        write ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			        write ? VK_IMAGE_USAGE_TRANSFER_DST_BIT : VK_IMAGE_USAGE_TRANSFER_SRC_BIT};
+	}
+}
+
+AccessInfo get_buffer_access_info(RenderGraph::BufferAccess access, bool write, RenderGraph::PassType type)
+{
+	switch (access)
+	{
+		case RenderGraph::BufferAccess::Uniform:
+			assert(!write && "Uniform buffers are read only");
+			return {get_shader_stages(type), VK_ACCESS_UNIFORM_READ_BIT};
+		case RenderGraph::BufferAccess::Storage:
+			return {get_shader_stages(type), VK_ACCESS_SHADER_READ_BIT | (write ? VK_ACCESS_SHADER_WRITE_BIT : 0)};
+		case RenderGraph::BufferAccess::Vertex:
+			assert(!write && "Vertex buffers are read only");
+			return {VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT};
+		case RenderGraph::BufferAccess::Index:
+			assert(!write && "Index buffers are read only");
+			return {VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT};
+		case RenderGraph::BufferAccess::Indirect:
+			assert(!write && "Indirect buffers are read only");
+			return {VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT};
+		case RenderGraph::BufferAccess::Transfer:
+		default:
+			return {VK_PIPELINE_STAGE_TRANSFER_BIT, write ? VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_TRANSFER_READ_BIT};
+	}
+}
+
+/**
+ * @brief Whether a read only needs the last write to be made visible, as the resource is in the right layout
+ */
+template <typename State>
+bool is_visible(const State &state, const AccessInfo &info)
+{
+	return (info.stages & ~state.visible_stages) == 0 && (info.access & ~state.visible_access) == 0;
+}
+
+/**
+ * @brief Updates the state of a resource after a barrier before an access
+ */
+template <typename State>
+void update_state(State &state, const AccessInfo &info, bool write)
+{
+	state.layout = info.layout;
+
+	// A read which transitions the layout is ordered after the transition, which later accesses chain with
+	state.write_stages   = info.stages;
+	state.write_access   = write ? info.access & write_access_mask : 0;
+	state.read_stages    = write ? 0 : info.stages;
+	state.visible_stages = info.stages;
+	state.visible_access = info.access;
+}
+}        // namespace
+
+RenderGraph::Pass::Pass(const std::string &name, PassType type, ExecuteFunc &&execute) :
+    name{name},
+    type{type},
+    execute{std::move(execute)}
+{
+}
+
+RenderGraph::Pass &RenderGraph::Pass::read(ImageHandle image, ImageAccess access)
+{
+	image_uses.push_back({image, access, false});
+	return *this;
+}
+
+RenderGraph::Pass &RenderGraph::Pass::write(ImageHandle image, ImageAccess access)
+{
+	image_uses.push_back({image, access, true});
+	return *this;
+}
+
+RenderGraph::Pass &RenderGraph::Pass::read(BufferHandle buffer, BufferAccess access)
+{
+	buffer_uses.push_back({buffer, access, false});
+	return *this;
+}
+
+RenderGraph::Pass &RenderGraph::Pass::write(BufferHandle buffer, BufferAccess access)
+{
+	buffer_uses.push_back({buffer, access, true});
+	return *this;
+}
+
+RenderGraph::Pass &RenderGraph::Pass::set_side_effects()
+{
+	side_effects = true;
+	return *this;
+}
+
+const std::string &RenderGraph::Pass::get_name() const
+{
+	return name;
+}
+
+RenderGraph::RenderGraph(Device &device) :
+    device{device}
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+	destroy_transient_images();
+}
+
+RenderGraph::ImageHandle RenderGraph::create_image(const std::string &name, const ImageDesc &desc)
+{
+	ImageResource image;
+	image.name = name;
+	image.desc = desc;
+
+	images.push_back(std::move(image));
+	compiled = false;
+
+	return {to_u32(images.size() - 1)};
+}
+
+RenderGraph::ImageHandle RenderGraph::import_image(const std::string &name, core::Image &imported, VkImageLayout initial_layout, VkImageLayout final_layout)
+{
+	ImageResource image;
+	image.name           = name;
+	image.desc.extent    = {imported.get_extent().width, imported.get_extent().height};
+	image.desc.format    = imported.get_format();
+	image.desc.samples   = imported.get_sample_count();
+	image.imported       = &imported;
+	image.initial_layout = initial_layout;
+	image.final_layout   = final_layout;
+
+	images.push_back(std::move(image));
+	compiled = false;
+
+	return {to_u32(images.size() - 1)};
+}
+
+RenderGraph::ImageHandle RenderGraph::import_image(const std::string &name, const core::ImageView &view, VkImageLayout initial_layout, VkImageLayout final_layout)
+{
+	// The graph creates views of its own on the image
+	return import_image(name, const_cast<core::Image &>(view.get_image()), initial_layout, final_layout);
+}
+
+RenderGraph::BufferHandle RenderGraph::import_buffer(const std::string &name, const core::Buffer &buffer)
+{
+	buffers.push_back({name, &buffer});
+	compiled = false;
+
+	return {to_u32(buffers.size() - 1)};
+}
+
+RenderGraph::Pass &RenderGraph::add_pass(const std::string &name, PassType type, ExecuteFunc &&execute)
+{
+	passes.push_back(std::make_unique<Pass>(name, type, std::move(execute)));
+	compiled = false;
+
+	return *passes.back();
+}
+
+RenderGraph::Pass &RenderGraph::add_pass(const std::string &name, RenderPipeline &render_pipeline)
+{
+	return add_pass(name, PassType::Graphics, [&render_pipeline](CommandBuffer &command_buffer, RenderTarget *render_target) {
+		assert(render_target && "A render pipeline pass needs attachments");
+
+		render_pipeline.draw(command_buffer, *render_target);
+
+		command_buffer.end_render_pass();
+	});
+}
+
+void RenderGraph::compile()
+{
+	destroy_transient_images();
+
+	statistics = {};
+
+	cull_passes();
+
+	create_transient_images();
+
+	compute_barriers();
+
+	compiled = true;
+
+	LOGD("Render graph: {} passes ({} culled), {} barriers, {} transient images in {} KB ({} KB without aliasing)",
+	     statistics.pass_count, statistics.culled_pass_count, statistics.barrier_batch_count,
+	     statistics.transient_image_count, statistics.transient_memory_size / 1024, statistics.unaliased_memory_size / 1024);
+}
+
+void RenderGraph::execute(CommandBuffer &command_buffer)
+{
+	assert(compiled && "Render graph not compiled, call compile()");
+
+	for (size_t i = 0; i < live_passes.size(); ++i)
+	{
+		auto &pass = *passes[live_passes[i]];
+
+		ScopedDebugLabel debug_label{command_buffer, pass.name.c_str()};
+
+		record_barriers(command_buffer, pass_barriers[i]);
+
+		if (pass.execute)
+		{
+			pass.execute(command_buffer, pass.render_target.get());
+		}
+	}
+
+	record_barriers(command_buffer, final_barriers);
+}
+
+void RenderGraph::reset()
+{
+	destroy_transient_images();
+
+	images.clear();
+	buffers.clear();
+	passes.clear();
+	live_passes.clear();
+	pass_barriers.clear();
+	final_barriers = {};
+	statistics     = {};
+	compiled       = false;
+}
+
+core::ImageView &RenderGraph::get_image_view(ImageHandle image)
+{
+	assert(image.index < images.size() && images[image.index].view && "Image not used by the compiled graph");
+	return *images[image.index].view;
+}
+
+const core::Buffer &RenderGraph::get_buffer(BufferHandle buffer) const
+{
+	assert(buffer.index < buffers.size());
+	return *buffers[buffer.index].buffer;
+}
+
+const RenderGraph::Statistics &RenderGraph::get_statistics() const
+{
+	return statistics;
+}
+
+void RenderGraph::cull_passes()
+{
+	for (auto &pass : passes)
+	{
+		for (size_t i = 0; i < pass->image_uses.size(); ++i)
+		{
+			auto index = pass->image_uses[i].handle.index;
+
+			if (index >= images.size())
+			{
+				throw std::runtime_error("Pass " + pass->name + " uses an invalid image");
+			}
+
+			for (size_t j = 0; j < i; ++j)
+			{
+				if (pass->image_uses[j].handle.index == index)
+				{
+					throw std::runtime_error("Pass " + pass->name + " uses image " + images[index].name + " more than once");
+				}
+			}
+		}
+
+		for (auto &use : pass->buffer_uses)
+		{
+			if (use.handle.index >= buffers.size())
+			{
+				throw std::runtime_error("Pass " + pass->name + " uses an invalid buffer");
+			}
+		}
+	}
+
+	// Walk the passes backwards from the imported resources, which are the outputs of the graph.
+	// Writes count as uses too, since a later write may not overwrite everything.
+	std::vector<bool> image_used(images.size());
+	for (size_t i = 0; i < images.size(); ++i)
+	{
+		image_used[i] = images[i].imported != nullptr;
+	}
+
+	std::vector<bool> pass_live(passes.size(), false);
+
+	for (size_t i = passes.size(); i-- > 0;)
+	{
+		auto &pass = *passes[i];
+
+		// Buffers are all imported, so writing one keeps the pass
+		bool live = pass.side_effects || std::any_of(pass.buffer_uses.begin(), pass.buffer_uses.end(), [](auto &use) { return use.write; });
+
+		for (auto &use : pass.image_uses)
+		{
+			live = live || (use.write && image_used[use.handle.index]);
+		}
+
+		if (live)
+		{
+			pass_live[i] = true;
+
+			for (auto &use : pass.image_uses)
+			{
+				image_used[use.handle.index] = true;
+			}
+		}
+	}
+
+	live_passes.clear();
+
+	for (uint32_t i = 0; i < to_u32(passes.size()); ++i)
+	{
+		if (pass_live[i])
+		{
+			live_passes.push_back(i);
+		}
+	}
+
+	statistics.pass_count        = to_u32(live_passes.size());
+	statistics.culled_pass_count = to_u32(passes.size() - live_passes.size());
+
+	// Lifetimes and usage of the images, over the live passes
+	for (auto &image : images)
+	{
+		image.first_pass = ~0u;
+		image.last_pass  = 0;
+		image.usage      = 0;
+	}
+
+	for (uint32_t p = 0; p < to_u32(live_passes.size()); ++p)
+	{
+		auto &pass = *passes[live_passes[p]];
+
+		for (auto &use : pass.image_uses)
+		{
+			auto &image = images[use.handle.index];
+
+			image.first_pass = std::min(image.first_pass, p);
+			image.last_pass  = std::max(image.last_pass, p);
+			image.usage |= get_image_access_info(use.access, use.write, image.desc.format, pass.type).usage;
+		}
+	}
+}
+
+void RenderGraph::create_transient_images()
+{
+	std::vector<uint32_t> transient_images;
+
+	for (uint32_t i = 0; i < to_u32(images.size()); ++i)
+	{
+		if (!images[i].imported && images[i].first_pass != ~0u)
+		{
+			transient_images.push_back(i);
+		}
+	}
+
+	std::sort(transient_images.begin(), transient_images.end(), [this](uint32_t a, uint32_t b) {
+		return images[a].first_pass < images[b].first_pass;
+	});
+
+	for (auto index : transient_images)
+	{
+		auto &image = images[index];
+
+		VkImageCreateInfo create_info{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+		create_info.imageType     = VK_IMAGE_TYPE_2D;
+		create_info.format        = image.desc.format;
+		create_info.extent        = {image.desc.extent.width, image.desc.extent.height, 1};
+		create_info.mipLevels     = 1;
+		create_info.arrayLayers   = 1;
+		create_info.samples       = image.desc.samples;
+		create_info.tiling        = VK_IMAGE_TILING_OPTIMAL;
+		create_info.usage         = image.usage;
+		create_info.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+		create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		VkImage handle{VK_NULL_HANDLE};
+		VK_CHECK(vkCreateImage(device.get_handle(), &create_info, nullptr, &handle));
+
+		// The wrapper does not own the image nor its memory, which are released by the graph
+		image.transient = std::make_unique<core::Image>(device, handle, create_info.extent, image.desc.format, image.usage, image.desc.samples);
+		image.transient->set_debug_name(image.name);
+
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(device.get_handle(), handle, &requirements);
+
+		statistics.unaliased_memory_size += requirements.size;
+
+		// Among the blocks no longer used when the image is first used, pick the smallest one
+		// that is large enough, or else the largest one
+		MemoryBlock *best_block = nullptr;
+
+		for (auto &block : memory_blocks)
+		{
+			if (block.last_pass >= image.first_pass ||
+			    (block.requirements.memoryTypeBits & requirements.memoryTypeBits) == 0)
+			{
+				continue;
+			}
+
+			if (!best_block)
+			{
+				best_block = &block;
+				continue;
+			}
+
+			bool fits      = block.requirements.size >= requirements.size;
+			bool best_fits = best_block->requirements.size >= requirements.size;
+
+			if (fits != best_fits ? fits : (fits ? block.requirements.size < best_block->requirements.size : block.requirements.size > best_block->requirements.size))
+			{
+				best_block = &block;
+			}
+		}
+
+		if (!best_block)
+		{
+			memory_blocks.emplace_back();
+			best_block               = &memory_blocks.back();
+			best_block->requirements = requirements;
+		}
+		else
+		{
+			best_block->requirements.size      = std::max(best_block->requirements.size, requirements.size);
+			best_block->requirements.alignment = std::max(best_block->requirements.alignment, requirements.alignment);
+			best_block->requirements.memoryTypeBits &= requirements.memoryTypeBits;
+		}
+
+		best_block->last_pass = image.last_pass;
+		best_block->images.push_back(index);
+	}
+
+	VmaAllocationCreateInfo allocation_info{};
+	allocation_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+	for (auto &block : memory_blocks)
+	{
+		VK_CHECK(vmaAllocateMemory(device.get_memory_allocator(), &block.requirements, &allocation_info, &block.allocation, nullptr));
+
+		statistics.transient_memory_size += block.requirements.size;
+
+		for (size_t i = 0; i < block.images.size(); ++i)
+		{
+			auto &image = images[block.images[i]];
+
+			VK_CHECK(vmaBindImageMemory(device.get_memory_allocator(), block.allocation, image.transient->get_handle()));
+
+			// The first image of the block follows the last one of the previous execution
+			image.alias_predecessor = block.images[(i + block.images.size() - 1) % block.images.size()];
+		}
+	}
+
+	statistics.transient_image_count = to_u32(transient_images.size());
+
+	for (auto &image : images)
+	{
+		if (image.first_pass != ~0u)
+		{
+			image.view = std::make_unique<core::ImageView>(image.imported ? *image.imported : *image.transient, VK_IMAGE_VIEW_TYPE_2D);
+		}
+	}
+
+	for (auto pass_index : live_passes)
+	{
+		auto &pass = *passes[pass_index];
+
+		std::vector<core::ImageView> attachments;
+
+		for (auto &use : pass.image_uses)
+		{
+			auto &image = images[use.handle.index];
+
+			if (pass.type == PassType::Graphics && use.access == ImageAccess::Attachment)
+			{
+				attachments.emplace_back(image.imported ? *image.imported : *image.transient, VK_IMAGE_VIEW_TYPE_2D);
+			}
+		}
+
+		if (!attachments.empty())
+		{
+			pass.render_target = std::make_unique<RenderTarget>(std::move(attachments));
+		}
+	}
+}
+
+void RenderGraph::compute_barriers()
+{
+	pass_barriers.assign(live_passes.size(), {});
+	final_barriers = {};
+
+	std::vector<ResourceState> image_states(images.size());
+	std::vector<ResourceState> buffer_states(buffers.size());
+
+	// Imported resources may have been written before the execution, and are assumed
+	// to be visible to reads in their initial layout
+	ResourceState imported_state;
+	imported_state.write_stages   = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+	imported_state.write_access   = VK_ACCESS_MEMORY_WRITE_BIT;
+	imported_state.visible_stages = any_stage_mask;
+	imported_state.visible_access = ~write_access_mask;
+
+	for (size_t i = 0; i < images.size(); ++i)
+	{
+		if (images[i].imported)
+		{
+			image_states[i]        = imported_state;
+			image_states[i].layout = images[i].initial_layout;
+		}
+	}
+
+	std::fill(buffer_states.begin(), buffer_states.end(), imported_state);
+
+	// Barriers of the first use of transient images, which wait for the last use of the image
+	// previously bound to the same memory once its state is known
+	struct FirstUse
+	{
+		uint32_t pass;
+
+		size_t barrier;
+
+		uint32_t image;
+	};
+
+	std::vector<FirstUse> first_uses;
+
+	for (uint32_t p = 0; p < to_u32(live_passes.size()); ++p)
+	{
+		auto &pass  = *passes[live_passes[p]];
+		auto &batch = pass_barriers[p];
+
+		for (auto &use : pass.image_uses)
+		{
+			auto &image = images[use.handle.index];
+			auto &state = image_states[use.handle.index];
+
+			auto info       = get_image_access_info(use.access, use.write, image.desc.format, pass.type);
+			bool first_use  = !image.imported && image.first_pass == p;
+			bool transition = first_use || state.layout != info.layout;
+
+			if (!use.write && !transition && is_visible(state, info))
+			{
+				// Reads after reads need no barrier
+				state.read_stages |= info.stages;
+				continue;
+			}
+
+			ImageMemoryBarrier barrier;
+			barrier.src_stage_mask  = 0;
+			barrier.dst_stage_mask  = info.stages;
+			barrier.src_access_mask = state.write_access;
+			barrier.dst_access_mask = info.access;
+			barrier.old_layout      = first_use ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+			barrier.new_layout      = info.layout;
+
+			if (first_use)
+			{
+				first_uses.push_back({p, batch.image_barriers.size(), use.handle.index});
+			}
+			else if (!use.write && !transition)
+			{
+				// The write only needs to be made visible to more stages
+				barrier.src_stage_mask = state.write_stages;
+				batch.image_barriers.push_back({use.handle.index, barrier});
+
+				state.read_stages |= info.stages;
+				state.visible_stages |= info.stages;
+				state.visible_access |= info.access;
+				continue;
+			}
+			else
+			{
+				// Writes and layout transitions wait for the reads as well
+				barrier.src_stage_mask = state.write_stages | state.read_stages;
+			}
+
+			batch.image_barriers.push_back({use.handle.index, barrier});
+
+			update_state(state, info, use.write);
+		}
+
+		for (auto &use : pass.buffer_uses)
+		{
+			auto &state = buffer_states[use.handle.index];
+
+			auto info = get_buffer_access_info(use.access, use.write, pass.type);
+
+			if (!use.write && is_visible(state, info))
+			{
+				state.read_stages |= info.stages;
+				continue;
+			}
+
+			// Buffer dependencies are merged into one global memory barrier
+			batch.has_memory_barrier = true;
+			batch.memory_barrier.src_access_mask |= state.write_access;
+			batch.memory_barrier.dst_access_mask |= info.access;
+			batch.memory_barrier.src_stage_mask |= state.write_stages | (use.write ? state.read_stages : 0);
+			batch.memory_barrier.dst_stage_mask |= info.stages;
+
+			if (use.write)
+			{
+				update_state(state, info, true);
+			}
+			else
+			{
+				state.read_stages |= info.stages;
+				state.visible_stages |= info.stages;
+				state.visible_access |= info.access;
+			}
+		}
+	}
+
+	for (auto &first_use : first_uses)
+	{
+		auto &predecessor = image_states[images[first_use.image].alias_predecessor];
+		auto &batch       = pass_barriers[first_use.pass];
+
+		auto &barrier           = batch.image_barriers[first_use.barrier].barrier;
+		barrier.src_access_mask = predecessor.write_access;
+		barrier.src_stage_mask  = predecessor.write_stages | predecessor.read_stages;
+	}
+
+	for (size_t i = 0; i < images.size(); ++i)
+	{
+		auto &image = images[i];
+		auto &state = image_states[i];
+
+		if (!image.imported || !image.view || image.final_layout == VK_IMAGE_LAYOUT_UNDEFINED || image.final_layout == state.layout)
+		{
+			continue;
+		}
+
+		bool present = image.final_layout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+		ImageMemoryBarrier barrier;
+		barrier.src_stage_mask  = state.write_stages | state.read_stages;
+		barrier.dst_stage_mask  = present ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		barrier.src_access_mask = state.write_access;
+		barrier.dst_access_mask = present ? 0 : VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+		barrier.old_layout      = state.layout;
+		barrier.new_layout      = image.final_layout;
+
+		final_barriers.image_barriers.push_back({to_u32(i), barrier});
+	}
+
+	auto count_batch = [this](const BarrierBatch &batch) {
+		if (batch.has_memory_barrier || !batch.image_barriers.empty())
+		{
+			statistics.barrier_batch_count++;
+			statistics.image_barrier_count += to_u32(batch.image_barriers.size());
+		}
+	};
+
+	std::for_each(pass_barriers.begin(), pass_barriers.end(), count_batch);
+	count_batch(final_barriers);
+}
+
+void RenderGraph::destroy_transient_images()
+{
+	// Views do not unregister from their image when destroyed, but imported images outlive them
+	auto unregister_view = [](core::ImageView &view) {
+		const_cast<core::Image &>(view.get_image()).get_views().erase(&view);
+	};
+
+	for (auto &pass : passes)
+	{
+		if (pass->render_target)
+		{
+			for (auto &view : pass->render_target->get_views())
+			{
+				unregister_view(const_cast<core::ImageView &>(view));
+			}
+
+			pass->render_target.reset();
+		}
+	}
+
+	for (auto &image : images)
+	{
+		if (image.view)
+		{
+			unregister_view(*image.view);
+			image.view.reset();
+		}
+
+		if (image.transient)
+		{
+			vkDestroyImage(device.get_handle(), image.transient->get_handle(), nullptr);
+			image.transient.reset();
+		}
+	}
+
+	for (auto &block : memory_blocks)
+	{
+		vmaFreeMemory(device.get_memory_allocator(), block.allocation);
+	}
+
+	memory_blocks.clear();
+}
+
+void RenderGraph::record_barriers(CommandBuffer &command_buffer, const BarrierBatch &batch) const
+{
+	if (!batch.has_memory_barrier && batch.image_barriers.empty())
+	{
+		return;
+	}
+
+	// Barriers added to the command buffer by the previous pass come first, as they may access the same images
+	command_buffer.flush_barriers();
+
+	for (auto &image_barrier : batch.image_barriers)
+	{
+		auto barrier = image_barrier.barrier;
+
+		// The first use of an image which is not aliased waits for nothing
+		if (barrier.src_stage_mask == 0)
+		{
+			barrier.src_stage_mask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		}
+
+		command_buffer.add_image_memory_barrier(*images[image_barrier.image].view, barrier);
+	}
+
+	if (batch.has_memory_barrier)
+	{
+		command_buffer.add_memory_barrier(batch.memory_barrier);
+	}
+
+	command_buffer.flush_barriers();
+}
+}        // namespace vkb
@@ -0,0 +1,387 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/helpers.h"
+#include "common/vk_common.h"
+#include "core/buffer.h"
+#include "core/image.h"
+#include "core/image_view.h"
+#include "rendering/render_target.h"
+
+namespace vkb
+{
+class CommandBuffer;
+class Device;
+class RenderPipeline;
+
+/**
+ * @brief A frame described as a list of passes, which declare the images and buffers they read and write.
+ *
+ *        Once compiled, the graph:
+ *        - culls the passes whose results are never used, i.e. which write no imported resource and
+ *          nothing read by a later pass, unless they are marked as having side effects
+ *        - creates the transient images, with the usage of all their accesses, and places those whose
+ *          lifetimes do not overlap in the same memory
+ *        - computes the barriers between passes from the declared accesses, which are flushed by the
+ *          CommandBuffer as a single pipeline barrier before each pass that needs one
+ *
+ *        Passes are executed in the order they were added. A graphics pass which accesses attachments
+ *        is given a RenderTarget made of them, in the order they were declared, to begin its render pass on.
+ *        The graph transitions the attachments to their attachment layouts before the pass, and expects the
+ *        render pass to leave them in these layouts, as render passes created from a RenderTarget do.
+ *
+ *        Transient images are undefined at the start of each execution. Imported resources start each
+ *        execution in the layout they were imported with: writes made to them outside of the graph are
+ *        waited for before they are accessed again, but must already be visible to reads in that layout.
+ *        Imported images are left in their final layout.
+ */
+class RenderGraph
+{
+  public:
+	enum class PassType
+	{
+		Graphics,
+		Compute,
+		Transfer
+	};
+
+	enum class ImageAccess
+	{
+		/// Color or depth stencil attachment, depending on the format. An attachment read is an input attachment.
+		Attachment,
+		/// Sampled in shaders, read only
+		Sampled,
+		/// Storage image
+		Storage,
+		/// Source or destination of transfer commands
+		Transfer
+	};
+
+	enum class BufferAccess
+	{
+		/// Uniform buffer, read only
+		Uniform,
+		/// Storage buffer
+		Storage,
+		/// Vertex buffer, read only
+		Vertex,
+		/// Index buffer, read only
+		Index,
+		/// Indirect draw or dispatch arguments, read only
+		Indirect,
+		/// Source or destination of transfer commands
+		Transfer
+	};
+
+	struct ImageHandle
+	{
+		uint32_t index{~0u};
+	};
+
+	struct BufferHandle
+	{
+		uint32_t index{~0u};
+	};
+
+	/**
+	 * @brief Description of a transient image, whose usage is deduced from its accesses
+	 */
+	struct ImageDesc
+	{
+		VkExtent2D extent{};
+
+		VkFormat format{VK_FORMAT_UNDEFINED};
+
+		VkSampleCountFlagBits samples{VK_SAMPLE_COUNT_1_BIT};
+	};
+
+	/**
+	 * @brief Records the commands of a pass
+	 * @param render_target The attachments of the pass, null if it has none
+	 */
+	using ExecuteFunc = std::function<void(CommandBuffer &command_buffer, RenderTarget *render_target)>;
+
+	class Pass
+	{
+	  public:
+		Pass(const std::string &name, PassType type, ExecuteFunc &&execute);
+
+		Pass &read(ImageHandle image, ImageAccess access);
+
+		Pass &write(ImageHandle image, ImageAccess access);
+
+		Pass &read(BufferHandle buffer, BufferAccess access);
+
+		Pass &write(BufferHandle buffer, BufferAccess access);
+
+		/**
+		 * @brief Keeps the pass even if nothing uses what it writes, e.g. if it reads data back to the host
+		 */
+		Pass &set_side_effects();
+
+		const std::string &get_name() const;
+
+	  private:
+		friend class RenderGraph;
+
+		template <typename Handle, typename Access>
+		struct Use
+		{
+			Handle handle;
+
+			Access access;
+
+			bool write;
+		};
+
+		std::string name;
+
+		PassType type;
+
+		ExecuteFunc execute;
+
+		bool side_effects{false};
+
+		std::vector<Use<ImageHandle, ImageAccess>> image_uses;
+
+		std::vector<Use<BufferHandle, BufferAccess>> buffer_uses;
+
+		/// Attachments of the pass, created when the graph is compiled
+		std::unique_ptr<RenderTarget> render_target;
+	};
+
+	/**
+	 * @brief Counts of the last compilation
+	 */
+	struct Statistics
+	{
+		uint32_t pass_count{0};
+
+		uint32_t culled_pass_count{0};
+
+		/// Number of pipeline barrier commands per execution
+		uint32_t barrier_batch_count{0};
+
+		/// Number of image barriers per execution
+		uint32_t image_barrier_count{0};
+
+		uint32_t transient_image_count{0};
+
+		/// Memory of the transient images once aliased
+		VkDeviceSize transient_memory_size{0};
+
+		/// Memory the transient images would need without aliasing
+		VkDeviceSize unaliased_memory_size{0};
+	};
+
+	RenderGraph(Device &device);
+
+	RenderGraph(const RenderGraph &) = delete;
+
+	RenderGraph(RenderGraph &&) = delete;
+
+	~RenderGraph();
+
+	RenderGraph &operator=(const RenderGraph &) = delete;
+
+	RenderGraph &operator=(RenderGraph &&) = delete;
+
+	/**
+	 * @brief Declares an image owned by the graph, which only lives during an execution
+	 */
+	ImageHandle create_image(const std::string &name, const ImageDesc &desc);
+
+	/**
+	 * @brief Declares an image owned by the caller, e.g. a swapchain image
+	 * @param image The image, which must have been created with the usage of its accesses
+	 * @param initial_layout Layout of the image at the start of an execution
+	 * @param final_layout Layout to leave the image in, VK_IMAGE_LAYOUT_UNDEFINED to leave it in the layout of its last access
+	 */
+	ImageHandle import_image(const std::string &name, core::Image &image, VkImageLayout initial_layout, VkImageLayout final_layout);
+
+	/**
+	 * @brief Declares the image of a view owned by the caller, e.g. an attachment of a RenderTarget
+	 */
+	ImageHandle import_image(const std::string &name, const core::ImageView &view, VkImageLayout initial_layout, VkImageLayout final_layout);
+
+	/**
+	 * @brief Declares a buffer owned by the caller
+	 */
+	BufferHandle import_buffer(const std::string &name, const core::Buffer &buffer);
+
+	/**
+	 * @brief Adds a pass, executed after the passes already added
+	 */
+	Pass &add_pass(const std::string &name, PassType type, ExecuteFunc &&execute);
+
+	/**
+	 * @brief Adds a graphics pass drawing a RenderPipeline on the attachments of the pass
+	 */
+	Pass &add_pass(const std::string &name, RenderPipeline &render_pipeline);
+
+	/**
+	 * @brief Culls the passes, creates the transient images and computes the barriers.
+	 *        Must be called again whenever a pass or a resource is declared.
+	 */
+	void compile();
+
+	/**
+	 * @brief Records the passes which were not culled, with their barriers
+	 */
+	void execute(CommandBuffer &command_buffer);
+
+	/**
+	 * @brief Removes all passes and resources. The transient images must not be in use anymore.
+	 */
+	void reset();
+
+	/**
+	 * @return The view of an image, valid once the graph is compiled
+	 */
+	core::ImageView &get_image_view(ImageHandle image);
+
+	const core::Buffer &get_buffer(BufferHandle buffer) const;
+
+	const Statistics &get_statistics() const;
+
+  private:
+	struct ImageResource
+	{
+		std::string name;
+
+		ImageDesc desc;
+
+		/// The imported image, null for transient images
+		core::Image *imported{nullptr};
+
+		VkImageLayout initial_layout{VK_IMAGE_LAYOUT_UNDEFINED};
+
+		VkImageLayout final_layout{VK_IMAGE_LAYOUT_UNDEFINED};
+
+		VkImageUsageFlags usage{0};
+
+		/// Transient image, bound to the memory of a block
+		std::unique_ptr<core::Image> transient;
+
+		std::unique_ptr<core::ImageView> view;
+
+		/// First and last passes using the image, in the order of the passes which were not culled
+		uint32_t first_pass{~0u};
+
+		uint32_t last_pass{0};
+
+		/// Transient image which used the memory of this one last, possibly itself
+		uint32_t alias_predecessor{~0u};
+	};
+
+	struct BufferResource
+	{
+		std::string name;
+
+		const core::Buffer *buffer{nullptr};
+	};
+
+	/// Memory shared by transient images whose lifetimes do not overlap
+	struct MemoryBlock
+	{
+		VkMemoryRequirements requirements{};
+
+		uint32_t last_pass{0};
+
+		std::vector<uint32_t> images;
+
+		VmaAllocation allocation{VK_NULL_HANDLE};
+	};
+
+	/// Barrier on an image, with its own stages
+	struct ImageBarrier
+	{
+		uint32_t image;
+
+		ImageMemoryBarrier barrier;
+	};
+
+	/// Barriers added to the command buffer together, and recorded with a single pipeline barrier command
+	struct BarrierBatch
+	{
+		/// Merges the dependencies of the buffers
+		GlobalMemoryBarrier memory_barrier{0, 0, 0, 0};
+
+		bool has_memory_barrier{false};
+
+		std::vector<ImageBarrier> image_barriers;
+	};
+
+	/// Synchronization state of a resource while the barriers are computed
+	struct ResourceState
+	{
+		VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+
+		/// Stages and accesses of the last write, or of the last layout transition
+		VkPipelineStageFlags write_stages{0};
+
+		VkAccessFlags write_access{0};
+
+		/// Stages reading the resource since the last write
+		VkPipelineStageFlags read_stages{0};
+
+		/// Stages and accesses the last write was made visible to
+		VkPipelineStageFlags visible_stages{0};
+
+		VkAccessFlags visible_access{0};
+	};
+
+	void cull_passes();
+
+	void create_transient_images();
+
+	void compute_barriers();
+
+	void destroy_transient_images();
+
+	void record_barriers(CommandBuffer &command_buffer, const BarrierBatch &batch) const;
+
+	Device &device;
+
+	std::vector<ImageResource> images;
+
+	std::vector<BufferResource> buffers;
+
+	std::vector<std::unique_ptr<Pass>> passes;
+
+	/// Indices of the passes which were not culled
+	std::vector<uint32_t> live_passes;
+
+	std::vector<MemoryBlock> memory_blocks;
+
+	/// Barriers before each live pass, and the transitions to the final layouts
+	std::vector<BarrierBatch> pass_barriers;
+
+	BarrierBatch final_barriers;
+
+	Statistics statistics;
+
+	bool compiled{false};
+};
+}        // namespace vkb
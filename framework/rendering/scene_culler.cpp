@@ -0,0 +1,405 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "scene_culler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+#include "common/helpers.h"
+#include "scene_graph/components/mesh.h"
+#include "scene_graph/components/transform.h"
+#include "scene_graph/node.h"
+
+namespace vkb
+{
+namespace
+{
+/// Objects per leaf, below which nodes are not split any further
+constexpr uint32_t max_leaf_object_count = 4;
+
+/// Deep enough for any hierarchy with median splits
+constexpr uint32_t max_traversal_depth = 64;
+
+constexpr uint32_t no_parent = ~0u;
+
+enum class Containment
+{
+	Outside,
+	Intersecting,
+	Inside
+};
+
+Containment classify(const Frustum &frustum, const glm::vec3 &min, const glm::vec3 &max)
+{
+	Containment containment = Containment::Inside;
+
+	for (auto &plane : frustum.planes)
+	{
+		// Corners of the box furthest along and against the plane normal
+		glm::vec3 positive{plane.x >= 0.0f ? max.x : min.x, plane.y >= 0.0f ? max.y : min.y, plane.z >= 0.0f ? max.z : min.z};
+		glm::vec3 negative{plane.x >= 0.0f ? min.x : max.x, plane.y >= 0.0f ? min.y : max.y, plane.z >= 0.0f ? min.z : max.z};
+
+		if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f)
+		{
+			return Containment::Outside;
+		}
+
+		if (glm::dot(glm::vec3(plane), negative) + plane.w < 0.0f)
+		{
+			containment = Containment::Intersecting;
+		}
+	}
+
+	return containment;
+}
+}        // namespace
+
+Frustum::Frustum(const glm::mat4 &view_proj)
+{
+	auto row = [&view_proj](int i) { return glm::vec4(view_proj[0][i], view_proj[1][i], view_proj[2][i], view_proj[3][i]); };
+
+	planes[0] = row(3) + row(0);
+	planes[1] = row(3) - row(0);
+	planes[2] = row(3) + row(1);
+	planes[3] = row(3) - row(1);
+	// Clip space depth ranges from 0 to w
+	planes[4] = row(2);
+	planes[5] = row(3) - row(2);
+
+	for (auto &plane : planes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+}
+
+SceneCuller::SceneCuller(const std::vector<sg::Mesh *> &meshes)
+{
+	for (auto mesh : meshes)
+	{
+		for (auto node : mesh->get_nodes())
+		{
+			Object object{};
+			object.node = node;
+			object.mesh = mesh;
+			update_object_bounds(object);
+
+			objects.push_back(object);
+		}
+	}
+
+	if (objects.empty())
+	{
+		return;
+	}
+
+	object_indices.resize(objects.size());
+	for (uint32_t i = 0; i < object_indices.size(); ++i)
+	{
+		object_indices[i] = i;
+	}
+
+	object_leaves.resize(objects.size());
+
+	nodes.emplace_back();
+	nodes[0].parent = no_parent;
+	build(0, 0, to_u32(objects.size()));
+
+	// Children always come after their parent
+	for (size_t i = nodes.size(); i > 0; --i)
+	{
+		refit(to_u32(i - 1));
+	}
+
+	dirty_marks.resize(nodes.size(), 0);
+}
+
+void SceneCuller::build(uint32_t node_index, uint32_t first_object, uint32_t object_count)
+{
+	nodes[node_index].first_object = first_object;
+	nodes[node_index].object_count = object_count;
+
+	if (object_count <= max_leaf_object_count)
+	{
+		nodes[node_index].left = 0;
+
+		for (uint32_t i = first_object; i < first_object + object_count; ++i)
+		{
+			object_leaves[object_indices[i]] = node_index;
+		}
+
+		return;
+	}
+
+	// Split at the median centroid along the largest axis of the centroid bounds
+	glm::vec3 centroid_min{std::numeric_limits<float>::max()};
+	glm::vec3 centroid_max{std::numeric_limits<float>::lowest()};
+
+	for (uint32_t i = first_object; i < first_object + object_count; ++i)
+	{
+		auto &object   = objects[object_indices[i]];
+		auto  centroid = (object.min + object.max) * 0.5f;
+
+		centroid_min = glm::min(centroid_min, centroid);
+		centroid_max = glm::max(centroid_max, centroid);
+	}
+
+	auto extent = centroid_max - centroid_min;
+
+	int axis = 0;
+	if (extent.y > extent[axis])
+	{
+		axis = 1;
+	}
+	if (extent.z > extent[axis])
+	{
+		axis = 2;
+	}
+
+	uint32_t left_count = object_count / 2;
+
+	auto begin = object_indices.begin() + first_object;
+	std::nth_element(begin, begin + left_count, begin + object_count, [this, axis](uint32_t a, uint32_t b) {
+		return objects[a].min[axis] + objects[a].max[axis] < objects[b].min[axis] + objects[b].max[axis];
+	});
+
+	uint32_t left = to_u32(nodes.size());
+	nodes.resize(nodes.size() + 2);
+
+	nodes[node_index].left = left;
+	nodes[left].parent     = node_index;
+	nodes[left + 1].parent = node_index;
+
+	build(left, first_object, left_count);
+	build(left + 1, first_object + left_count, object_count - left_count);
+}
+
+void SceneCuller::refit(uint32_t node_index)
+{
+	auto &node = nodes[node_index];
+
+	if (node.left != 0)
+	{
+		auto &left  = nodes[node.left];
+		auto &right = nodes[node.left + 1];
+
+		node.min = glm::min(left.min, right.min);
+		node.max = glm::max(left.max, right.max);
+		return;
+	}
+
+	node.min = glm::vec3{std::numeric_limits<float>::max()};
+	node.max = glm::vec3{std::numeric_limits<float>::lowest()};
+
+	for (uint32_t i = node.first_object; i < node.first_object + node.object_count; ++i)
+	{
+		auto &object = objects[object_indices[i]];
+
+		node.min = glm::min(node.min, object.min);
+		node.max = glm::max(node.max, object.max);
+	}
+}
+
+void SceneCuller::update_object_bounds(Object &object)
+{
+	auto &transform = object.node->get_transform();
+
+	object.transform_version = transform.get_world_matrix_version();
+
+	glm::mat4 world_matrix = transform.get_world_matrix();
+
+	auto &bounds = object.mesh->get_bounds();
+
+	// Meshes without vertices are reduced to their origin
+	if (bounds.get_min().x > bounds.get_max().x)
+	{
+		object.min = object.max = glm::vec3(world_matrix[3]);
+		return;
+	}
+
+	glm::vec3 center = (bounds.get_min() + bounds.get_max()) * 0.5f;
+	glm::vec3 extent = (bounds.get_max() - bounds.get_min()) * 0.5f;
+
+	// Extent of the transformed box along each world axis (Arvo)
+	glm::vec3 world_center = glm::vec3(world_matrix * glm::vec4(center, 1.0f));
+	glm::vec3 world_extent{0.0f};
+
+	for (int column = 0; column < 3; ++column)
+	{
+		world_extent += glm::abs(glm::vec3(world_matrix[column])) * extent[column];
+	}
+
+	object.min = world_center - world_extent;
+	object.max = world_center + world_extent;
+}
+
+size_t SceneCuller::update()
+{
+	dirty_nodes.clear();
+
+	size_t refitted_count = 0;
+
+	for (uint32_t i = 0; i < objects.size(); ++i)
+	{
+		auto &object = objects[i];
+
+		if (object.node->get_transform().get_world_matrix_version() == object.transform_version)
+		{
+			continue;
+		}
+
+		update_object_bounds(object);
+		++refitted_count;
+
+		// Mark the leaf and its ancestors, stopping at those already marked by another object
+		for (uint32_t node_index = object_leaves[i]; node_index != no_parent && !dirty_marks[node_index]; node_index = nodes[node_index].parent)
+		{
+			dirty_marks[node_index] = 1;
+			dirty_nodes.push_back(node_index);
+		}
+	}
+
+	// Refit children before their parents
+	std::sort(dirty_nodes.begin(), dirty_nodes.end(), std::greater<uint32_t>());
+
+	for (auto node_index : dirty_nodes)
+	{
+		refit(node_index);
+		dirty_marks[node_index] = 0;
+	}
+
+	return refitted_count;
+}
+
+void SceneCuller::cull(const Frustum &frustum, std::vector<uint32_t> &visible_objects) const
+{
+	if (nodes.empty())
+	{
+		return;
+	}
+
+	std::array<uint32_t, max_traversal_depth> stack;
+	uint32_t                                  stack_size = 0;
+
+	stack[stack_size++] = 0;
+
+	while (stack_size > 0)
+	{
+		auto &node = nodes[stack[--stack_size]];
+
+		auto containment = classify(frustum, node.min, node.max);
+
+		if (containment == Containment::Outside)
+		{
+			continue;
+		}
+
+		if (containment == Containment::Inside)
+		{
+			visible_objects.insert(visible_objects.end(),
+			                       object_indices.begin() + node.first_object,
+			                       object_indices.begin() + node.first_object + node.object_count);
+		}
+		else if (node.left != 0)
+		{
+			stack[stack_size++] = node.left;
+			stack[stack_size++] = node.left + 1;
+		}
+		else
+		{
+			for (uint32_t i = node.first_object; i < node.first_object + node.object_count; ++i)
+			{
+				auto &object = objects[object_indices[i]];
+
+				if (classify(frustum, object.min, object.max) != Containment::Outside)
+				{
+					visible_objects.push_back(object_indices[i]);
+				}
+			}
+		}
+	}
+}
+
+const SceneCuller::Object &SceneCuller::get_object(uint32_t index) const
+{
+	return objects[index];
+}
+
+size_t SceneCuller::get_object_count() const
+{
+	return objects.size();
+}
+
+uint32_t get_distance_sort_key(float distance)
+{
+	// The bits of non-negative IEEE 754 floats order like their values
+	distance = std::max(distance, 0.0f);
+
+	uint32_t key;
+	std::memcpy(&key, &distance, sizeof(key));
+	return key;
+}
+
+void radix_sort_keys(std::vector<uint64_t> &keys, std::vector<uint64_t> &scratch)
+{
+	if (keys.size() < 2)
+	{
+		return;
+	}
+
+	std::array<std::array<uint32_t, 256>, 4> histograms{};
+
+	for (auto key : keys)
+	{
+		for (uint32_t pass = 0; pass < 4; ++pass)
+		{
+			++histograms[pass][(key >> (32 + 8 * pass)) & 0xff];
+		}
+	}
+
+	scratch.resize(keys.size());
+
+	for (uint32_t pass = 0; pass < 4; ++pass)
+	{
+		auto    &histogram = histograms[pass];
+		uint32_t shift     = 32 + 8 * pass;
+
+		// All keys share the same byte, the pass would not reorder anything
+		if (histogram[(keys[0] >> shift) & 0xff] == keys.size())
+		{
+			continue;
+		}
+
+		std::array<uint32_t, 256> offsets;
+		uint32_t                  offset = 0;
+		for (uint32_t i = 0; i < 256; ++i)
+		{
+			offsets[i] = offset;
+			offset += histogram[i];
+		}
+
+		for (auto key : keys)
+		{
+			scratch[offsets[(key >> shift) & 0xff]++] = key;
+		}
+
+		keys.swap(scratch);
+	}
+}
+}        // namespace vkb
@@ -0,0 +1,147 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "common/error.h"
+
+VKBP_DISABLE_WARNINGS()
+#include "common/glm_common.h"
+VKBP_ENABLE_WARNINGS()
+
+namespace vkb
+{
+namespace sg
+{
+class Mesh;
+class Node;
+}        // namespace sg
+
+/**
+ * @brief View frustum as six inward facing planes
+ */
+struct Frustum
+{
+	/**
+	 * @brief Extracts the normalized planes of a Vulkan clip space transform, with depth ranging from 0 to w
+	 * See https://www.gamedevs.org/uploads/fast-extraction-viewing-frustum-planes-from-world-view-projection-matrix.pdf
+	 */
+	explicit Frustum(const glm::mat4 &view_proj);
+
+	std::array<glm::vec4, 6> planes;
+};
+
+/**
+ * @brief Bounding volume hierarchy over the (node, mesh) pairs of a scene, to frustum cull them on the CPU.
+ *
+ *        World bounds come from sg::Mesh::get_bounds and the node world matrices. update() only recomputes
+ *        the bounds of objects whose Transform changed, and refits their ancestors in the hierarchy.
+ *        The hierarchy is built once, so its quality degrades if objects move far from where they started.
+ */
+class SceneCuller
+{
+  public:
+	/**
+	 * @brief An instance of a mesh in the scene
+	 */
+	struct Object
+	{
+		sg::Node *node;
+
+		sg::Mesh *mesh;
+
+		glm::vec3 min;
+
+		glm::vec3 max;
+
+		uint32_t transform_version;
+	};
+
+	SceneCuller(const std::vector<sg::Mesh *> &meshes);
+
+	/**
+	 * @brief Refits the hierarchy to the objects whose transform changed since the last update
+	 * @return The number of objects which were refitted
+	 */
+	size_t update();
+
+	/**
+	 * @brief Appends the indices of the objects intersecting the frustum
+	 */
+	void cull(const Frustum &frustum, std::vector<uint32_t> &visible_objects) const;
+
+	const Object &get_object(uint32_t index) const;
+
+	size_t get_object_count() const;
+
+  private:
+	struct BVHNode
+	{
+		glm::vec3 min;
+
+		glm::vec3 max;
+
+		// Index of the left child, the right child follows it, or 0 for leaves
+		uint32_t left;
+
+		// Range of object_indices covered by the node and its descendants
+		uint32_t first_object;
+
+		uint32_t object_count;
+
+		uint32_t parent;
+	};
+
+	void build(uint32_t node_index, uint32_t first_object, uint32_t object_count);
+
+	void refit(uint32_t node_index);
+
+	void update_object_bounds(Object &object);
+
+	std::vector<Object> objects;
+
+	std::vector<BVHNode> nodes;
+
+	/// Objects ordered so that each node covers a contiguous range
+	std::vector<uint32_t> object_indices;
+
+	/// Leaf containing each object
+	std::vector<uint32_t> object_leaves;
+
+	/// Nodes to refit, kept to avoid reallocating every update
+	std::vector<uint32_t> dirty_nodes;
+
+	std::vector<uint8_t> dirty_marks;
+};
+
+/**
+ * @brief Sort key of a non-negative distance, whose bits order like the distance itself
+ */
+uint32_t get_distance_sort_key(float distance);
+
+/**
+ * @brief Stable LSD radix sort of 64-bit keys by their upper 32 bits, with the lower bits usually carrying
+ *        a payload index. Byte passes where all keys are equal are skipped.
+ * @param keys Keys to sort
+ * @param scratch Storage reused between calls
+ */
+void radix_sort_keys(std::vector<uint64_t> &keys, std::vector<uint64_t> &scratch);
+}        // namespace vkb
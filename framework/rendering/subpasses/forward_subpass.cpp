@@ -39,6 +39,11 @@ ForwardSubpass::ForwardSubpass(RenderContext &render_context, ShaderSource &&ver
 
 void ForwardSubpass::prepare()
 {
+	// The variants shared by sub meshes in bindless mode need the same lighting definitions
+	std::vector<std::string> bindless_definitions{"MAX_LIGHT_COUNT " + std::to_string(MAX_FORWARD_LIGHT_COUNT)};
+	bindless_definitions.insert(bindless_definitions.end(), light_type_definitions.begin(), light_type_definitions.end());
+	reset_bindless_variants(bindless_definitions);
+
 	auto &device = render_context.get_device();
 	for (auto &mesh : meshes)
 	{
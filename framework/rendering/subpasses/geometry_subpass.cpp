@@ -30,12 +30,59 @@
 
 namespace vkb
 {
+namespace
+{
+int32_t get_material_texture_index(const sg::Material &material, const std::string &name, const std::unordered_map<const sg::Texture *, int32_t> &texture_indices)
+{
+	auto texture_it = material.textures.find(name);
+
+	if (texture_it == material.textures.end())
+	{
+		return -1;
+	}
+
+	auto index_it = texture_indices.find(texture_it->second);
+
+	return index_it != texture_indices.end() ? index_it->second : -1;
+}
+
+/**
+ * @return Index of the bindless variant matching the vertex attribute formats of a submesh
+ */
+size_t get_vertex_format_index(const sg::SubMesh &sub_mesh)
+{
+	sg::VertexAttribute attribute;
+
+	size_t index = 0;
+
+	if (sub_mesh.get_attribute("position", attribute) && attribute.format == VK_FORMAT_R16G16B16A16_UNORM)
+	{
+		index |= 1;
+	}
+
+	if (sub_mesh.get_attribute("normal", attribute) && attribute.format == VK_FORMAT_R16G16_SNORM)
+	{
+		index |= 2;
+	}
+
+	return index;
+}
+}        // namespace
+
 GeometrySubpass::GeometrySubpass(RenderContext &render_context, ShaderSource &&vertex_source, ShaderSource &&fragment_source, sg::Scene &scene_, sg::Camera &camera) :
     Subpass{render_context, std::move(vertex_source), std::move(fragment_source)},
     meshes{scene_.get_components<sg::Mesh>()},
+    scene_culler{meshes},
     camera{camera},
-    scene{scene_}
+    scene{scene_},
+    material_textures{scene_.get_components<sg::Texture>()}
 {
+	for (size_t i = 0; i < material_textures.size(); ++i)
+	{
+		material_texture_indices.emplace(material_textures[i], static_cast<int32_t>(i));
+	}
+
+	reset_bindless_variants();
 }
 
 void GeometrySubpass::prepare()
@@ -53,59 +100,100 @@ void GeometrySubpass::prepare()
 	}
 }
 
-void GeometrySubpass::get_sorted_nodes(std::multimap<float, std::pair<sg::Node *, sg::SubMesh *>> &opaque_nodes, std::multimap<float, std::pair<sg::Node *, sg::SubMesh *>> &transparent_nodes)
+void GeometrySubpass::get_sorted_nodes(std::vector<std::pair<sg::Node *, sg::SubMesh *>> &opaque_nodes, std::vector<std::pair<sg::Node *, sg::SubMesh *>> &transparent_nodes)
 {
-	auto camera_transform = camera.get_node()->get_transform().get_world_matrix();
+	scene_culler.update();
 
-	for (auto &mesh : meshes)
+	visible_objects.clear();
+
+	if (frustum_culling)
 	{
-		for (auto &node : mesh->get_nodes())
+		Frustum frustum{camera.get_pre_rotation() * vkb::vulkan_style_projection(camera.get_projection()) * camera.get_view()};
+		scene_culler.cull(frustum, visible_objects);
+	}
+	else
+	{
+		for (uint32_t i = 0; i < scene_culler.get_object_count(); ++i)
 		{
-			auto node_transform = node->get_transform().get_world_matrix();
+			visible_objects.push_back(i);
+		}
+	}
 
-			const sg::AABB &mesh_bounds = mesh->get_bounds();
+	auto camera_position = glm::vec3(camera.get_node()->get_transform().get_world_matrix()[3]);
 
-			sg::AABB world_bounds{mesh_bounds.get_min(), mesh_bounds.get_max()};
-			world_bounds.transform(node_transform);
+	sort_candidates.clear();
+	opaque_keys.clear();
+	transparent_keys.clear();
 
-			float distance = glm::length(glm::vec3(camera_transform[3]) - world_bounds.get_center());
+	for (auto object_index : visible_objects)
+	{
+		auto &object = scene_culler.get_object(object_index);
+
+		float distance = glm::length(camera_position - (object.min + object.max) * 0.5f);
+
+		// The candidate index in the lower bits keeps the keys unique
+		uint64_t distance_key = static_cast<uint64_t>(get_distance_sort_key(distance)) << 32;
+
+		for (auto &sub_mesh : object.mesh->get_submeshes())
+		{
+			uint64_t key = distance_key | sort_candidates.size();
 
-			for (auto &sub_mesh : mesh->get_submeshes())
+			if (sub_mesh->get_material()->alpha_mode == sg::AlphaMode::Blend)
+			{
+				transparent_keys.push_back(key);
+			}
+			else
 			{
-				if (sub_mesh->get_material()->alpha_mode == sg::AlphaMode::Blend)
-				{
-					transparent_nodes.emplace(distance, std::make_pair(node, sub_mesh));
-				}
-				else
-				{
-					opaque_nodes.emplace(distance, std::make_pair(node, sub_mesh));
-				}
+				opaque_keys.push_back(key);
 			}
+
+			sort_candidates.emplace_back(object.node, sub_mesh);
 		}
 	}
+
+	radix_sort_keys(opaque_keys, sort_scratch);
+	radix_sort_keys(transparent_keys, sort_scratch);
+
+	opaque_nodes.reserve(opaque_nodes.size() + opaque_keys.size());
+	for (auto key : opaque_keys)
+	{
+		opaque_nodes.push_back(sort_candidates[static_cast<uint32_t>(key)]);
+	}
+
+	transparent_nodes.reserve(transparent_nodes.size() + transparent_keys.size());
+	for (auto key_it = transparent_keys.rbegin(); key_it != transparent_keys.rend(); ++key_it)
+	{
+		transparent_nodes.push_back(sort_candidates[static_cast<uint32_t>(*key_it)]);
+	}
 }
 
 void GeometrySubpass::draw(CommandBuffer &command_buffer)
 {
-	std::multimap<float, std::pair<sg::Node *, sg::SubMesh *>> opaque_nodes;
-	std::multimap<float, std::pair<sg::Node *, sg::SubMesh *>> transparent_nodes;
+	std::vector<std::pair<sg::Node *, sg::SubMesh *>> opaque_nodes;
+	std::vector<std::pair<sg::Node *, sg::SubMesh *>> transparent_nodes;
 
 	get_sorted_nodes(opaque_nodes, transparent_nodes);
 
+	// Material textures stay bound for the whole subpass, as all submeshes share the same set layout
+	if (bindless_materials)
+	{
+		bind_material_textures(command_buffer);
+	}
+
 	// Draw opaque objects in front-to-back order
 	{
 		ScopedDebugLabel opaque_debug_label{command_buffer, "Opaque objects"};
 
-		for (auto node_it = opaque_nodes.begin(); node_it != opaque_nodes.end(); node_it++)
+		for (auto &node : opaque_nodes)
 		{
-			update_uniform(command_buffer, *node_it->second.first, thread_index);
+			update_uniform(command_buffer, *node.first, thread_index);
 
 			// Invert the front face if the mesh was flipped
-			const auto &scale      = node_it->second.first->get_transform().get_scale();
+			const auto &scale      = node.first->get_transform().get_scale();
 			bool        flipped    = scale.x * scale.y * scale.z < 0;
 			VkFrontFace front_face = flipped ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE;
 
-			draw_submesh(command_buffer, *node_it->second.second, front_face);
+			draw_submesh(command_buffer, *node.second, front_face);
 		}
 	}
 
@@ -130,11 +218,11 @@ void GeometrySubpass::draw(CommandBuffer &command_buffer)
 	{
 		ScopedDebugLabel transparent_debug_label{command_buffer, "Transparent objects"};
 
-		for (auto node_it = transparent_nodes.rbegin(); node_it != transparent_nodes.rend(); node_it++)
+		for (auto &node : transparent_nodes)
 		{
-			update_uniform(command_buffer, *node_it->second.first, thread_index);
+			update_uniform(command_buffer, *node.first, thread_index);
 
-			draw_submesh(command_buffer, *node_it->second.second);
+			draw_submesh(command_buffer, *node.second);
 		}
 	}
 }
@@ -172,8 +260,10 @@ void GeometrySubpass::draw_submesh(CommandBuffer &command_buffer, sg::SubMesh &s
 	multisample_state.rasterization_samples = sample_count;
 	command_buffer.set_multisample_state(multisample_state);
 
-	auto &vert_shader_module = device.get_resource_cache().request_shader_module(VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), sub_mesh.get_shader_variant());
-	auto &frag_shader_module = device.get_resource_cache().request_shader_module(VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), sub_mesh.get_shader_variant());
+	auto &variant = get_shader_variant(sub_mesh);
+
+	auto &vert_shader_module = device.get_resource_cache().request_shader_module(VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), variant);
+	auto &frag_shader_module = device.get_resource_cache().request_shader_module(VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), variant);
 
 	std::vector<ShaderModule *> shader_modules{&vert_shader_module, &frag_shader_module};
 
@@ -181,25 +271,49 @@ void GeometrySubpass::draw_submesh(CommandBuffer &command_buffer, sg::SubMesh &s
 
 	command_buffer.bind_pipeline_layout(pipeline_layout);
 
-	if (pipeline_layout.get_push_constant_range_stage(sizeof(PBRMaterialUniform)) != 0)
+	auto push_constants_size = bindless_materials ? sizeof(BindlessMaterialUniform) : sizeof(PBRMaterialUniform);
+
+	if (pipeline_layout.get_push_constant_range_stage(to_u32(push_constants_size)) != 0)
 	{
 		prepare_push_constants(command_buffer, sub_mesh);
 	}
 
-	DescriptorSetLayout &descriptor_set_layout = pipeline_layout.get_descriptor_set_layout(0);
-
-	for (auto &texture : sub_mesh.get_material()->textures)
+	// In bindless mode the material textures are already bound
+	if (!bindless_materials)
 	{
-		if (auto layout_binding = descriptor_set_layout.get_layout_binding(texture.first))
+		DescriptorSetLayout &descriptor_set_layout = pipeline_layout.get_descriptor_set_layout(0);
+
+		for (auto &texture : sub_mesh.get_material()->textures)
 		{
-			command_buffer.bind_image(texture.second->get_image()->get_vk_image_view(),
-			                          texture.second->get_sampler()->vk_sampler,
-			                          0, layout_binding->binding, 0);
+			if (auto layout_binding = descriptor_set_layout.get_layout_binding(texture.first))
+			{
+				command_buffer.bind_image(texture.second->get_image()->get_vk_image_view(),
+				                          texture.second->get_sampler()->vk_sampler,
+				                          0, layout_binding->binding, 0);
+			}
 		}
 	}
 
+	sg::VertexAttribute position_attribute;
+
+	if (sub_mesh.get_attribute("position", position_attribute) && position_attribute.format == VK_FORMAT_R16G16B16A16_UNORM)
+	{
+		PositionDequantizationUniform dequantization;
+		dequantization.offset = glm::vec4(sub_mesh.position_offset, 0.0f);
+		dequantization.scale  = glm::vec4(sub_mesh.position_scale, 0.0f);
+
+		auto allocation = get_render_context().get_active_frame().allocate_buffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(PositionDequantizationUniform), thread_index);
+		allocation.update(dequantization);
+
+		command_buffer.bind_buffer(allocation.get_buffer(), allocation.get_offset(), allocation.get_size(), 0, 7, 0);
+	}
+
 	auto vertex_input_resources = pipeline_layout.get_resources(ShaderResourceType::Input, VK_SHADER_STAGE_VERTEX_BIT);
 
+	// Interleaved vertices are read from a single binding
+	VkDeviceSize interleaved_offset;
+	const auto  *interleaved_buffer = sub_mesh.get_vertex_buffer(sg::INTERLEAVED_VERTEX_BUFFER, interleaved_offset);
+
 	VertexInputState vertex_input_state;
 
 	for (auto &input_resource : vertex_input_resources)
@@ -211,16 +325,23 @@ void GeometrySubpass::draw_submesh(CommandBuffer &command_buffer, sg::SubMesh &s
 			continue;
 		}
 
+		uint32_t binding = interleaved_buffer ? 0 : input_resource.location;
+
 		VkVertexInputAttributeDescription vertex_attribute{};
-		vertex_attribute.binding  = input_resource.location;
+		vertex_attribute.binding  = binding;
 		vertex_attribute.format   = attribute.format;
 		vertex_attribute.location = input_resource.location;
 		vertex_attribute.offset   = attribute.offset;
 
 		vertex_input_state.attributes.push_back(vertex_attribute);
 
+		if (interleaved_buffer && !vertex_input_state.bindings.empty())
+		{
+			continue;
+		}
+
 		VkVertexInputBindingDescription vertex_binding{};
-		vertex_binding.binding = input_resource.location;
+		vertex_binding.binding = binding;
 		vertex_binding.stride  = attribute.stride;
 
 		vertex_input_state.bindings.push_back(vertex_binding);
@@ -228,18 +349,29 @@ void GeometrySubpass::draw_submesh(CommandBuffer &command_buffer, sg::SubMesh &s
 
 	command_buffer.set_vertex_input_state(vertex_input_state);
 
-	// Find submesh vertex buffers matching the shader input attribute names
-	for (auto &input_resource : vertex_input_resources)
+	if (interleaved_buffer)
 	{
-		const auto &buffer_iter = sub_mesh.vertex_buffers.find(input_resource.name);
+		std::vector<std::reference_wrapper<const core::Buffer>> buffers;
+		buffers.emplace_back(std::ref(*interleaved_buffer));
 
-		if (buffer_iter != sub_mesh.vertex_buffers.end())
+		command_buffer.bind_vertex_buffers(0, std::move(buffers), {interleaved_offset});
+	}
+	else
+	{
+		// Find submesh vertex buffers matching the shader input attribute names
+		for (auto &input_resource : vertex_input_resources)
 		{
-			std::vector<std::reference_wrapper<const core::Buffer>> buffers;
-			buffers.emplace_back(std::ref(buffer_iter->second));
+			VkDeviceSize offset;
+			const auto  *buffer = sub_mesh.get_vertex_buffer(input_resource.name, offset);
+
+			if (buffer != nullptr)
+			{
+				std::vector<std::reference_wrapper<const core::Buffer>> buffers;
+				buffers.emplace_back(std::ref(*buffer));
 
-			// Bind vertex buffers only for the attribute locations defined
-			command_buffer.bind_vertex_buffers(input_resource.location, std::move(buffers), {0});
+				// Bind vertex buffers only for the attribute locations defined
+				command_buffer.bind_vertex_buffers(input_resource.location, std::move(buffers), {offset});
+			}
 		}
 	}
 
@@ -281,6 +413,20 @@ void GeometrySubpass::prepare_push_constants(CommandBuffer &command_buffer, sg::
 {
 	auto pbr_material = dynamic_cast<const sg::PBRMaterial *>(sub_mesh.get_material());
 
+	if (bindless_materials)
+	{
+		BindlessMaterialUniform bindless_material_uniform{};
+		bindless_material_uniform.base_color_factor                = pbr_material->base_color_factor;
+		bindless_material_uniform.metallic_factor                  = pbr_material->metallic_factor;
+		bindless_material_uniform.roughness_factor                 = pbr_material->roughness_factor;
+		bindless_material_uniform.base_color_texture_index         = get_material_texture_index(*pbr_material, "base_color_texture", material_texture_indices);
+		bindless_material_uniform.normal_texture_index             = get_material_texture_index(*pbr_material, "normal_texture", material_texture_indices);
+		bindless_material_uniform.metallic_roughness_texture_index = get_material_texture_index(*pbr_material, "metallic_roughness_texture", material_texture_indices);
+
+		command_buffer.push_constants(bindless_material_uniform);
+		return;
+	}
+
 	PBRMaterialUniform pbr_material_uniform{};
 	pbr_material_uniform.base_color_factor = pbr_material->base_color_factor;
 	pbr_material_uniform.metallic_factor   = pbr_material->metallic_factor;
@@ -300,7 +446,8 @@ void GeometrySubpass::draw_submesh_command(CommandBuffer &command_buffer, sg::Su
 	if (sub_mesh.vertex_indices != 0)
 	{
 		// Bind index buffer of submesh
-		command_buffer.bind_index_buffer(*sub_mesh.index_buffer, sub_mesh.index_offset, sub_mesh.index_type);
+		VkDeviceSize index_offset;
+		command_buffer.bind_index_buffer(*sub_mesh.get_index_buffer(index_offset), index_offset, sub_mesh.index_type);
 
 		// Draw submesh using indexed data
 		command_buffer.draw_indexed(sub_mesh.vertex_indices, 1, 0, 0, 0);
@@ -312,8 +459,93 @@ void GeometrySubpass::draw_submesh_command(CommandBuffer &command_buffer, sg::Su
 	}
 }
 
+void GeometrySubpass::bind_material_textures(CommandBuffer &command_buffer)
+{
+	for (uint32_t i = 0; i < to_u32(material_textures.size()); ++i)
+	{
+		auto texture = material_textures[i];
+
+		command_buffer.bind_image(texture->get_image()->get_vk_image_view(),
+		                          texture->get_sampler()->vk_sampler,
+		                          1, 0, i);
+	}
+}
+
+const ShaderVariant &GeometrySubpass::get_shader_variant(const sg::SubMesh &sub_mesh) const
+{
+	return bindless_materials ? bindless_variants[get_vertex_format_index(sub_mesh)] : sub_mesh.get_shader_variant();
+}
+
+void GeometrySubpass::reset_bindless_variants(const std::vector<std::string> &definitions)
+{
+	for (size_t i = 0; i < bindless_variants.size(); ++i)
+	{
+		auto &variant = bindless_variants[i];
+
+		variant.clear();
+		variant.add_define("BINDLESS_MATERIALS");
+		variant.add_define("MATERIAL_TEXTURE_COUNT " + std::to_string(material_textures.size()));
+		variant.add_definitions(definitions);
+
+		// Same definitions as SubMesh::compute_shader_variant() for quantized vertex formats
+		if (i & 1)
+		{
+			variant.add_define("QUANTIZED_POSITION");
+		}
+
+		if (i & 2)
+		{
+			variant.add_define("OCTAHEDRAL_NORMAL");
+		}
+	}
+}
+
 void GeometrySubpass::set_thread_index(uint32_t index)
 {
 	thread_index = index;
 }
+
+void GeometrySubpass::set_bindless_materials(bool enable)
+{
+	if (enable)
+	{
+		auto &gpu    = render_context.get_device().get_gpu();
+		auto &limits = gpu.get_properties().limits;
+
+		auto texture_count = to_u32(material_textures.size());
+
+		if (texture_count == 0)
+		{
+			LOGW("Bindless materials not enabled: the scene has no textures");
+			enable = false;
+		}
+		else if (!gpu.get_requested_features().shaderSampledImageArrayDynamicIndexing)
+		{
+			LOGW("Bindless materials not enabled: shaderSampledImageArrayDynamicIndexing was not requested");
+			enable = false;
+		}
+		else if (texture_count > limits.maxPerStageDescriptorSamplers || texture_count > limits.maxPerStageDescriptorSampledImages)
+		{
+			LOGW("Bindless materials not enabled: {} textures exceed the per-stage descriptor limits", texture_count);
+			enable = false;
+		}
+	}
+
+	bindless_materials = enable;
+}
+
+bool GeometrySubpass::is_bindless_materials() const
+{
+	return bindless_materials;
+}
+
+void GeometrySubpass::set_frustum_culling(bool enable)
+{
+	frustum_culling = enable;
+}
+
+bool GeometrySubpass::is_frustum_culling() const
+{
+	return frustum_culling;
+}
 }        // namespace vkb
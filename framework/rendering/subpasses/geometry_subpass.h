@@ -17,12 +17,15 @@
 
 #pragma once
 
+#include <array>
+
 #include "common/error.h"
 
 VKBP_DISABLE_WARNINGS()
 #include "common/glm_common.h"
 VKBP_ENABLE_WARNINGS()
 
+#include "rendering/scene_culler.h"
 #include "rendering/subpass.h"
 
 namespace vkb
@@ -34,6 +37,7 @@ class Node;
 class Mesh;
 class SubMesh;
 class Camera;
+class Texture;
 }        // namespace sg
 
 /**
@@ -48,6 +52,16 @@ struct alignas(16) GlobalUniform
 	glm::vec3 camera_position;
 };
 
+/**
+ * @brief Uniform decoding the positions of submeshes with quantized positions (QUANTIZED_POSITION variant)
+ */
+struct alignas(16) PositionDequantizationUniform
+{
+	glm::vec4 offset;
+
+	glm::vec4 scale;
+};
+
 /**
  * @brief PBR material uniform for base shader
  */
@@ -60,6 +74,25 @@ struct PBRMaterialUniform
 	float roughness_factor;
 };
 
+/**
+ * @brief PBR material uniform for base shader in bindless mode,
+ *        texture indices point into the material texture array or are -1 if unused
+ */
+struct BindlessMaterialUniform
+{
+	glm::vec4 base_color_factor;
+
+	float metallic_factor;
+
+	float roughness_factor;
+
+	int32_t base_color_texture_index;
+
+	int32_t normal_texture_index;
+
+	int32_t metallic_roughness_texture_index;
+};
+
 /**
  * @brief This subpass is responsible for rendering a Scene
  */
@@ -90,6 +123,25 @@ class GeometrySubpass : public Subpass
 	 */
 	void set_thread_index(uint32_t index);
 
+	/**
+	 * @brief Places all scene textures in one descriptor array (set 1, binding 0) which is bound once per draw call
+	 *        recording, with texture indices passed per submesh through BindlessMaterialUniform push constants.
+	 *        The fragment shader must implement the BINDLESS_MATERIALS variant. If the device cannot index
+	 *        an array of that many textures, a warning is logged and the subpass keeps binding textures per submesh.
+	 * @param enable Whether to use bindless materials
+	 */
+	void set_bindless_materials(bool enable);
+
+	bool is_bindless_materials() const;
+
+	/**
+	 * @brief Skips the meshes outside of the camera frustum, tested against a hierarchy of their world bounds.
+	 *        Enabled by default.
+	 */
+	void set_frustum_culling(bool enable);
+
+	bool is_frustum_culling() const;
+
   protected:
 	virtual void update_uniform(CommandBuffer &command_buffer, sg::Node &node, size_t thread_index);
 
@@ -104,21 +156,68 @@ class GeometrySubpass : public Subpass
 	virtual void draw_submesh_command(CommandBuffer &command_buffer, sg::SubMesh &sub_mesh);
 
 	/**
-	 * @brief Sorts objects based on distance from camera and classifies them
-	 *        into opaque and transparent in the arrays provided
+	 * @brief Binds every scene texture to its element of the material texture array
+	 */
+	void bind_material_textures(CommandBuffer &command_buffer);
+
+	/**
+	 * @brief Rebuilds the bindless variants from the definitions of the geometry subpass, so that subclasses
+	 *        can add theirs in prepare() without duplicating them when prepared again
+	 * @param definitions Definitions of the subclass, added to every bindless variant
+	 */
+	void reset_bindless_variants(const std::vector<std::string> &definitions = {});
+
+	/**
+	 * @return The shader variant to draw a submesh with, which in bindless mode is shared by all submeshes
+	 *         with the same vertex format
+	 */
+	const ShaderVariant &get_shader_variant(const sg::SubMesh &sub_mesh) const;
+
+	/**
+	 * @brief Culls objects outside of the camera frustum, sorts the others based on distance from camera
+	 *        and classifies them into opaque and transparent in the arrays provided
+	 * @param opaque_nodes Opaque objects in front-to-back order
+	 * @param transparent_nodes Transparent objects in back-to-front order
 	 */
-	void get_sorted_nodes(std::multimap<float, std::pair<sg::Node *, sg::SubMesh *>> &opaque_nodes,
-	                      std::multimap<float, std::pair<sg::Node *, sg::SubMesh *>> &transparent_nodes);
+	void get_sorted_nodes(std::vector<std::pair<sg::Node *, sg::SubMesh *>> &opaque_nodes,
+	                      std::vector<std::pair<sg::Node *, sg::SubMesh *>> &transparent_nodes);
 
 	sg::Camera &camera;
 
 	std::vector<sg::Mesh *> meshes;
 
+	SceneCuller scene_culler;
+
 	sg::Scene &scene;
 
 	uint32_t thread_index{0};
 
 	vkb::RasterizationState base_rasterization_state{};
+
+	bool bindless_materials{false};
+
+	/// Scene textures in material texture array order
+	std::vector<sg::Texture *> material_textures;
+
+	std::unordered_map<const sg::Texture *, int32_t> material_texture_indices;
+
+	/// Variants used in bindless mode, so that the material texture set layout never changes. There is one
+	/// per vertex format, indexed by whether positions are quantized (1) and normals octahedral encoded (2).
+	std::array<ShaderVariant, 4> bindless_variants;
+
+	bool frustum_culling{true};
+
+  private:
+	/// Sorting storage, kept to avoid reallocating every frame
+	std::vector<uint32_t> visible_objects;
+
+	std::vector<std::pair<sg::Node *, sg::SubMesh *>> sort_candidates;
+
+	std::vector<uint64_t> opaque_keys;
+
+	std::vector<uint64_t> transparent_keys;
+
+	std::vector<uint64_t> sort_scratch;
 };
 
 }        // namespace vkb
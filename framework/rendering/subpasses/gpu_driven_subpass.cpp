@@ -0,0 +1,602 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/subpasses/gpu_driven_subpass.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "common/utils.h"
+#include "common/vk_common.h"
+#include "core/device.h"
+#include "rendering/render_context.h"
+#include "scene_graph/components/camera.h"
+#include "scene_graph/components/image.h"
+#include "scene_graph/components/material.h"
+#include "scene_graph/components/mesh.h"
+#include "scene_graph/components/pbr_material.h"
+#include "scene_graph/components/sub_mesh.h"
+#include "scene_graph/components/texture.h"
+#include "scene_graph/node.h"
+#include "scene_graph/scene.h"
+
+namespace vkb
+{
+namespace
+{
+/**
+ * @brief Gives host access to the geometry of submeshes. Buffers owned by a submesh are host visible,
+ *        and mapped until the reader is destroyed if they were not mapped already. Buffers shared between
+ *        submeshes are device local, and downloaded once through a staging buffer.
+ */
+class GeometryReader
+{
+  public:
+	GeometryReader(Device &device) :
+	    device{device}
+	{}
+
+	~GeometryReader()
+	{
+		for (auto buffer : mapped_buffers)
+		{
+			buffer->unmap();
+		}
+	}
+
+	/**
+	 * @return The data of a vertex attribute, or nullptr if the submesh does not have it
+	 */
+	const uint8_t *read_vertices(sg::SubMesh &sub_mesh, const std::string &name)
+	{
+		auto buffer_it = sub_mesh.vertex_buffers.find(name);
+		if (buffer_it != sub_mesh.vertex_buffers.end())
+		{
+			return map(buffer_it->second);
+		}
+
+		auto range_it = sub_mesh.vertex_buffer_ranges.find(name);
+		if (range_it != sub_mesh.vertex_buffer_ranges.end())
+		{
+			return download(*range_it->second.buffer) + range_it->second.offset;
+		}
+
+		return nullptr;
+	}
+
+	const uint8_t *read_indices(sg::SubMesh &sub_mesh)
+	{
+		if (sub_mesh.index_buffer)
+		{
+			return map(*sub_mesh.index_buffer) + sub_mesh.index_offset;
+		}
+
+		return download(*sub_mesh.index_buffer_range.buffer) + sub_mesh.index_buffer_range.offset + sub_mesh.index_offset;
+	}
+
+  private:
+	const uint8_t *map(core::Buffer &buffer)
+	{
+		if (buffer.get_data() == nullptr)
+		{
+			buffer.map();
+			mapped_buffers.push_back(&buffer);
+		}
+
+		return buffer.get_data();
+	}
+
+	const uint8_t *download(const core::Buffer &buffer)
+	{
+		auto download_it = downloads.find(&buffer);
+		if (download_it != downloads.end())
+		{
+			return download_it->second.data();
+		}
+
+		core::Buffer staging_buffer{device, buffer.get_size(), VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU};
+
+		auto &command_buffer = device.request_command_buffer();
+		command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		command_buffer.copy_buffer(buffer, staging_buffer, buffer.get_size());
+		command_buffer.end();
+
+		VkFence fence = device.request_fence();
+		VK_CHECK(device.get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0).submit(command_buffer, fence));
+		VK_CHECK(vkWaitForFences(device.get_handle(), 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max()));
+
+		// Host cached memory is not necessarily coherent
+		VK_CHECK(vmaInvalidateAllocation(device.get_memory_allocator(), staging_buffer.get_allocation(), 0, VK_WHOLE_SIZE));
+
+		auto &data = downloads[&buffer];
+		data.assign(staging_buffer.get_data(), staging_buffer.get_data() + buffer.get_size());
+
+		return data.data();
+	}
+
+	Device &device;
+
+	std::vector<core::Buffer *> mapped_buffers;
+
+	std::unordered_map<const core::Buffer *, std::vector<uint8_t>> downloads;
+};
+
+bool has_attribute_format(const sg::SubMesh &sub_mesh, const std::string &name, VkFormat format, bool required)
+{
+	sg::VertexAttribute attribute;
+	VkDeviceSize        offset;
+
+	if (!sub_mesh.get_attribute(name, attribute) || sub_mesh.get_vertex_buffer(name, offset) == nullptr)
+	{
+		return !required;
+	}
+
+	return attribute.format == format;
+}
+
+/**
+ * @brief Appends the values of a vertex attribute to data, or zeros if the submesh does not have it
+ */
+template <class T>
+void read_attribute(GeometryReader &reader, sg::SubMesh &sub_mesh, const std::string &name, std::vector<T> &data)
+{
+	sg::VertexAttribute attribute;
+
+	const uint8_t *vertex_data = sub_mesh.get_attribute(name, attribute) ? reader.read_vertices(sub_mesh, name) : nullptr;
+
+	if (vertex_data == nullptr)
+	{
+		data.resize(data.size() + sub_mesh.vertices_count, T{});
+		return;
+	}
+
+	uint32_t stride = attribute.stride != 0 ? attribute.stride : to_u32(sizeof(T));
+
+	for (uint32_t i = 0; i < sub_mesh.vertices_count; ++i)
+	{
+		T value;
+		std::memcpy(&value, vertex_data + attribute.offset + i * stride, sizeof(T));
+		data.push_back(value);
+	}
+}
+
+void read_indices(GeometryReader &reader, sg::SubMesh &sub_mesh, std::vector<uint32_t> &indices)
+{
+	const uint8_t *index_data = reader.read_indices(sub_mesh);
+
+	for (uint32_t i = 0; i < sub_mesh.vertex_indices; ++i)
+	{
+		if (sub_mesh.index_type == VK_INDEX_TYPE_UINT16)
+		{
+			uint16_t index;
+			std::memcpy(&index, index_data + i * sizeof(uint16_t), sizeof(uint16_t));
+			indices.push_back(index);
+		}
+		else
+		{
+			uint32_t index;
+			std::memcpy(&index, index_data + i * sizeof(uint32_t), sizeof(uint32_t));
+			indices.push_back(index);
+		}
+	}
+}
+
+template <class T>
+std::unique_ptr<core::Buffer> create_buffer(Device &device, const std::vector<T> &data, VkBufferUsageFlags usage, const std::string &name)
+{
+	auto buffer = std::make_unique<core::Buffer>(device, std::max<VkDeviceSize>(data.size() * sizeof(T), sizeof(T)), usage, VMA_MEMORY_USAGE_CPU_TO_GPU);
+	buffer->update(reinterpret_cast<const uint8_t *>(data.data()), data.size() * sizeof(T));
+	buffer->set_debug_name(name);
+	return buffer;
+}
+}        // namespace
+
+GPUDrivenSubpass::GPUDrivenSubpass(RenderContext &render_context, ShaderSource &&vertex_source, ShaderSource &&fragment_source, ShaderSource &&cull_source, sg::Scene &scene_, sg::Camera &camera) :
+    GeometrySubpass{render_context, std::move(vertex_source), std::move(fragment_source), scene_, camera},
+    cull_shader{std::move(cull_source)}
+{
+}
+
+void GPUDrivenSubpass::prepare()
+{
+	auto &device = render_context.get_device();
+
+	auto &gpu                = device.get_gpu();
+	auto &requested_features = gpu.get_requested_features();
+	auto &limits             = gpu.get_properties().limits;
+
+	draw_indirect_count          = device.is_enabled(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+	multi_draw_indirect          = requested_features.multiDrawIndirect;
+	draw_indirect_first_instance = requested_features.drawIndirectFirstInstance;
+
+	if (!draw_indirect_first_instance)
+	{
+		// Draws then cannot be compacted, as their instance is only known from their position in the buffer
+		LOGW("GPU-driven subpass: drawIndirectFirstInstance was not requested, instances are drawn one by one");
+		draw_indirect_count = false;
+		multi_draw_indirect = false;
+	}
+
+	auto texture_count = to_u32(material_textures.size());
+
+	material_texture_array = texture_count > 0;
+
+	if (material_texture_array && !requested_features.shaderSampledImageArrayDynamicIndexing)
+	{
+		LOGW("GPU-driven subpass: shaderSampledImageArrayDynamicIndexing was not requested, materials are drawn without textures");
+		material_texture_array = false;
+	}
+	else if (material_texture_array && (texture_count > limits.maxPerStageDescriptorSamplers || texture_count > limits.maxPerStageDescriptorSampledImages))
+	{
+		LOGW("GPU-driven subpass: {} textures exceed the per-stage descriptor limits, materials are drawn without textures", texture_count);
+		material_texture_array = false;
+	}
+
+	prepare_geometry();
+
+	variant.clear();
+	variant.add_definitions({"MAX_LIGHT_COUNT " + std::to_string(MAX_FORWARD_LIGHT_COUNT)});
+	variant.add_definitions(light_type_definitions);
+
+	if (material_texture_array)
+	{
+		variant.add_define("MATERIAL_TEXTURE_COUNT " + std::to_string(texture_count));
+	}
+
+	if (!draw_indirect_first_instance)
+	{
+		variant.add_define("INSTANCE_INDEX_PUSH_CONSTANT");
+	}
+
+	device.get_resource_cache().request_shader_module(VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), variant);
+	device.get_resource_cache().request_shader_module(VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), variant);
+	device.get_resource_cache().request_shader_module(VK_SHADER_STAGE_COMPUTE_BIT, cull_shader);
+}
+
+void GPUDrivenSubpass::prepare_geometry()
+{
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> normals;
+	std::vector<glm::vec2> texcoords;
+	std::vector<uint32_t>  indices;
+
+	// Location of the geometry of each submesh in the merged buffers
+	std::unordered_map<const sg::SubMesh *, std::pair<uint32_t, int32_t>> sub_mesh_offsets;
+
+	GeometryReader reader{render_context.get_device()};
+
+	for (auto &mesh : meshes)
+	{
+		for (auto &sub_mesh : mesh->get_submeshes())
+		{
+			VkDeviceSize index_offset;
+
+			if (sub_mesh->get_index_buffer(index_offset) == nullptr || sub_mesh->vertex_indices == 0 ||
+			    !has_attribute_format(*sub_mesh, "position", VK_FORMAT_R32G32B32_SFLOAT, true) ||
+			    !has_attribute_format(*sub_mesh, "normal", VK_FORMAT_R32G32B32_SFLOAT, false) ||
+			    !has_attribute_format(*sub_mesh, "texcoord_0", VK_FORMAT_R32G32_SFLOAT, false))
+			{
+				LOGW("GPU-driven subpass skips {}: only indexed float geometry is supported", sub_mesh->get_name());
+				continue;
+			}
+
+			sub_mesh_offsets[sub_mesh] = std::make_pair(to_u32(indices.size()), static_cast<int32_t>(positions.size()));
+
+			read_attribute(reader, *sub_mesh, "position", positions);
+			read_attribute(reader, *sub_mesh, "normal", normals);
+			read_attribute(reader, *sub_mesh, "texcoord_0", texcoords);
+			read_indices(reader, *sub_mesh, indices);
+		}
+	}
+
+	// Sort instances by pipeline state, so that each batch is a contiguous range drawn with one call
+	std::vector<std::pair<uint32_t, GPUDrivenInstance>> keyed_instances;
+	std::vector<std::pair<sg::Node *, const sg::AABB *>> keyed_sources;
+
+	for (auto &mesh : meshes)
+	{
+		for (auto &node : mesh->get_nodes())
+		{
+			const auto &scale   = node->get_transform().get_scale();
+			bool        flipped = scale.x * scale.y * scale.z < 0;
+
+			for (auto &sub_mesh : mesh->get_submeshes())
+			{
+				auto offset_it = sub_mesh_offsets.find(sub_mesh);
+				if (offset_it == sub_mesh_offsets.end())
+				{
+					continue;
+				}
+
+				auto material     = sub_mesh->get_material();
+				auto pbr_material = dynamic_cast<const sg::PBRMaterial *>(material);
+
+				GPUDrivenInstance instance{};
+				instance.base_color_factor        = pbr_material ? pbr_material->base_color_factor : glm::vec4(1.0f);
+				instance.first_index              = offset_it->second.first;
+				instance.index_count              = sub_mesh->vertex_indices;
+				instance.vertex_offset            = offset_it->second.second;
+				instance.base_color_texture_index = -1;
+
+				auto texture_it = material->textures.find("base_color_texture");
+				if (texture_it != material->textures.end())
+				{
+					auto index_it = material_texture_indices.find(texture_it->second);
+					if (index_it != material_texture_indices.end())
+					{
+						instance.base_color_texture_index = index_it->second;
+					}
+				}
+
+				uint32_t key = (material->alpha_mode == sg::AlphaMode::Blend ? 4 : 0) | (flipped ? 2 : 0) | (material->double_sided ? 1 : 0);
+
+				keyed_instances.emplace_back(key, instance);
+				keyed_sources.emplace_back(node, &mesh->get_bounds());
+			}
+		}
+	}
+
+	std::vector<size_t> order(keyed_instances.size());
+	for (size_t i = 0; i < order.size(); ++i)
+	{
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [&keyed_instances](size_t a, size_t b) { return keyed_instances[a].first < keyed_instances[b].first; });
+
+	instances.clear();
+	instance_nodes.clear();
+	instance_bounds.clear();
+	batches.clear();
+
+	uint32_t previous_key = ~0u;
+
+	for (auto i : order)
+	{
+		uint32_t key = keyed_instances[i].first;
+
+		if (key != previous_key)
+		{
+			previous_key = key;
+
+			Batch batch;
+			batch.first_instance = to_u32(instances.size());
+			batch.double_sided   = (key & 1) != 0;
+			batch.flipped        = (key & 2) != 0;
+			batch.blend          = (key & 4) != 0;
+			batches.push_back(batch);
+		}
+
+		batches.back().instance_count++;
+
+		instances.push_back(keyed_instances[i].second);
+		instances.back().batch_index          = to_u32(batches.size() - 1);
+		instances.back().batch_first_instance = batches.back().first_instance;
+
+		instance_nodes.push_back(keyed_sources[i].first);
+		instance_bounds.push_back(keyed_sources[i].second);
+	}
+
+	auto &device = render_context.get_device();
+
+	position_buffer = create_buffer(device, positions, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, "GPU-driven positions");
+	normal_buffer   = create_buffer(device, normals, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, "GPU-driven normals");
+	texcoord_buffer = create_buffer(device, texcoords, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, "GPU-driven texcoords");
+	index_buffer    = create_buffer(device, indices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, "GPU-driven indices");
+	instance_buffer = create_buffer(device, instances, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "GPU-driven instances");
+
+	update_instances();
+
+	LOGI("GPU-driven subpass: {} instances in {} batches, {} vertices, {} indices", instances.size(), batches.size(), positions.size(), indices.size());
+}
+
+void GPUDrivenSubpass::update_instances()
+{
+	for (size_t i = 0; i < instances.size(); ++i)
+	{
+		auto model = instance_nodes[i]->get_transform().get_world_matrix();
+
+		sg::AABB world_bounds{instance_bounds[i]->get_min(), instance_bounds[i]->get_max()};
+		world_bounds.transform(model);
+
+		auto center = world_bounds.get_center();
+
+		instances[i].model           = model;
+		instances[i].bounding_sphere = glm::vec4(center, glm::length(world_bounds.get_max() - center));
+	}
+
+	if (instance_buffer)
+	{
+		instance_buffer->update(reinterpret_cast<const uint8_t *>(instances.data()), instances.size() * sizeof(GPUDrivenInstance));
+	}
+}
+
+uint32_t GPUDrivenSubpass::get_instance_count() const
+{
+	return to_u32(instances.size());
+}
+
+void GPUDrivenSubpass::cull(CommandBuffer &command_buffer)
+{
+	if (instances.empty())
+	{
+		return;
+	}
+
+	auto &render_frame   = render_context.get_active_frame();
+	auto &resource_cache = command_buffer.get_device().get_resource_cache();
+
+	GPUDrivenUniform uniform{};
+	uniform.camera_view_proj = camera.get_pre_rotation() * vkb::vulkan_style_projection(camera.get_projection()) * camera.get_view();
+	uniform.camera_position  = glm::vec4(glm::vec3(glm::inverse(camera.get_view())[3]), 1.0f);
+	uniform.instance_count   = to_u32(instances.size());
+	uniform.compact_draws    = draw_indirect_count ? 1 : 0;
+	uniform.first_instance   = draw_indirect_first_instance ? 1 : 0;
+	Frustum frustum{uniform.camera_view_proj};
+	std::copy(frustum.planes.begin(), frustum.planes.end(), uniform.frustum_planes);
+
+	uniform_allocation = render_frame.allocate_buffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(GPUDrivenUniform), thread_index);
+	uniform_allocation.update(uniform);
+
+	const VkBufferUsageFlags indirect_usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+
+	draw_commands = render_frame.allocate_buffer(indirect_usage, instances.size() * sizeof(VkDrawIndexedIndirectCommand), thread_index);
+
+	// Counts are incremented by the culling shader
+	std::vector<uint32_t> counts(batches.size(), 0);
+	draw_counts = render_frame.allocate_buffer(indirect_usage, counts.size() * sizeof(uint32_t), thread_index);
+	draw_counts.update(reinterpret_cast<const uint8_t *>(counts.data()), counts.size() * sizeof(uint32_t));
+
+	auto &cull_module = resource_cache.request_shader_module(VK_SHADER_STAGE_COMPUTE_BIT, cull_shader);
+	command_buffer.bind_pipeline_layout(resource_cache.request_pipeline_layout({&cull_module}));
+
+	command_buffer.bind_buffer(*instance_buffer, 0, instance_buffer->get_size(), 0, 0, 0);
+	command_buffer.bind_buffer(uniform_allocation.get_buffer(), uniform_allocation.get_offset(), uniform_allocation.get_size(), 0, 1, 0);
+	command_buffer.bind_buffer(draw_commands.get_buffer(), draw_commands.get_offset(), draw_commands.get_size(), 0, 2, 0);
+	command_buffer.bind_buffer(draw_counts.get_buffer(), draw_counts.get_offset(), draw_counts.get_size(), 0, 3, 0);
+
+	command_buffer.dispatch((uniform.instance_count + 63) / 64, 1, 1);
+
+	BufferMemoryBarrier barrier{};
+	barrier.src_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	barrier.dst_stage_mask  = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+	barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dst_access_mask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+	command_buffer.add_buffer_memory_barrier(draw_commands.get_buffer(), draw_commands.get_offset(), draw_commands.get_size(), barrier);
+	command_buffer.add_buffer_memory_barrier(draw_counts.get_buffer(), draw_counts.get_offset(), draw_counts.get_size(), barrier);
+	command_buffer.flush_barriers();
+}
+
+void GPUDrivenSubpass::draw(CommandBuffer &command_buffer)
+{
+	if (instances.empty())
+	{
+		return;
+	}
+
+	if (draw_commands.empty())
+	{
+		LOGE("GPU-driven subpass drawn without culling, call cull() before the render pass");
+		return;
+	}
+
+	allocate_lights<ForwardLights>(scene.get_components<sg::Light>(), MAX_FORWARD_LIGHT_COUNT);
+	command_buffer.bind_lighting(get_lighting_state(), 0, 4);
+
+	auto &resource_cache = command_buffer.get_device().get_resource_cache();
+
+	auto &vert_shader_module = resource_cache.request_shader_module(VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), variant);
+	auto &frag_shader_module = resource_cache.request_shader_module(VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), variant);
+
+	auto &pipeline_layout = prepare_pipeline_layout(command_buffer, {&vert_shader_module, &frag_shader_module});
+	command_buffer.bind_pipeline_layout(pipeline_layout);
+
+	MultisampleState multisample_state{};
+	multisample_state.rasterization_samples = sample_count;
+	command_buffer.set_multisample_state(multisample_state);
+
+	// Positions, normals and texture coordinates are read from separate buffers
+	VertexInputState vertex_input_state;
+	vertex_input_state.bindings = {{0, to_u32(sizeof(glm::vec3)), VK_VERTEX_INPUT_RATE_VERTEX},
+	                               {1, to_u32(sizeof(glm::vec3)), VK_VERTEX_INPUT_RATE_VERTEX},
+	                               {2, to_u32(sizeof(glm::vec2)), VK_VERTEX_INPUT_RATE_VERTEX}};
+	vertex_input_state.attributes = {{0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0},
+	                                 {1, 1, VK_FORMAT_R32G32B32_SFLOAT, 0},
+	                                 {2, 2, VK_FORMAT_R32G32_SFLOAT, 0}};
+	command_buffer.set_vertex_input_state(vertex_input_state);
+
+	std::vector<std::reference_wrapper<const core::Buffer>> vertex_buffers{*position_buffer, *normal_buffer, *texcoord_buffer};
+	command_buffer.bind_vertex_buffers(0, std::move(vertex_buffers), {0, 0, 0});
+	command_buffer.bind_index_buffer(*index_buffer, 0, VK_INDEX_TYPE_UINT32);
+
+	command_buffer.bind_buffer(*instance_buffer, 0, instance_buffer->get_size(), 0, 0, 0);
+	command_buffer.bind_buffer(uniform_allocation.get_buffer(), uniform_allocation.get_offset(), uniform_allocation.get_size(), 0, 1, 0);
+
+	for (uint32_t i = 0; material_texture_array && i < to_u32(material_textures.size()); ++i)
+	{
+		command_buffer.bind_image(material_textures[i]->get_image()->get_vk_image_view(),
+		                          material_textures[i]->get_sampler()->vk_sampler,
+		                          0, 2, i);
+	}
+
+	for (uint32_t i = 0; i < to_u32(batches.size()); ++i)
+	{
+		draw_batch(command_buffer, batches[i], i);
+	}
+
+	// Allocations belong to the frame, cull() has to run again before the next draw
+	draw_commands = BufferAllocation{};
+	draw_counts   = BufferAllocation{};
+}
+
+void GPUDrivenSubpass::draw_batch(CommandBuffer &command_buffer, const Batch &batch, uint32_t batch_index)
+{
+	ScopedDebugLabel batch_debug_label{command_buffer, batch.blend ? "Transparent batch" : "Opaque batch"};
+
+	RasterizationState rasterization_state = base_rasterization_state;
+	rasterization_state.front_face         = batch.flipped ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+	if (batch.double_sided)
+	{
+		rasterization_state.cull_mode = VK_CULL_MODE_NONE;
+	}
+
+	command_buffer.set_rasterization_state(rasterization_state);
+
+	// Transparent instances are blended in instance order, since sorting would need to happen on the GPU
+	ColorBlendAttachmentState color_blend_attachment{};
+	if (batch.blend)
+	{
+		color_blend_attachment.blend_enable           = VK_TRUE;
+		color_blend_attachment.src_color_blend_factor = VK_BLEND_FACTOR_SRC_ALPHA;
+		color_blend_attachment.dst_color_blend_factor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		color_blend_attachment.src_alpha_blend_factor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	}
+
+	ColorBlendState color_blend_state{};
+	color_blend_state.attachments.resize(get_output_attachments().size(), color_blend_attachment);
+	command_buffer.set_color_blend_state(color_blend_state);
+
+	const uint32_t stride          = to_u32(sizeof(VkDrawIndexedIndirectCommand));
+	const auto     commands_offset = draw_commands.get_offset() + batch.first_instance * stride;
+
+	if (draw_indirect_count)
+	{
+		command_buffer.draw_indexed_indirect_count(draw_commands.get_buffer(), commands_offset,
+		                                           draw_counts.get_buffer(), draw_counts.get_offset() + batch_index * sizeof(uint32_t),
+		                                           batch.instance_count, stride);
+	}
+	else if (multi_draw_indirect)
+	{
+		command_buffer.draw_indexed_indirect(draw_commands.get_buffer(), commands_offset, batch.instance_count, stride);
+	}
+	else
+	{
+		for (uint32_t i = 0; i < batch.instance_count; ++i)
+		{
+			// Without drawIndirectFirstInstance the first instance of the commands is 0, the instance is pushed instead
+			if (!draw_indirect_first_instance)
+			{
+				command_buffer.push_constants(batch.first_instance + i);
+			}
+
+			command_buffer.draw_indexed_indirect(draw_commands.get_buffer(), commands_offset + i * stride, 1, stride);
+		}
+	}
+}
+}        // namespace vkb
@@ -0,0 +1,198 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "buffer_pool.h"
+#include "rendering/subpasses/forward_subpass.h"
+#include "scene_graph/components/aabb.h"
+
+namespace vkb
+{
+/**
+ * @brief Per-instance data of the GPU-driven subpass, one per (node, submesh) pair.
+ *        Matches the Instance struct of the gpu_driven shaders (std430).
+ */
+struct alignas(16) GPUDrivenInstance
+{
+	glm::mat4 model;
+
+	// xyz is the world space center, w the radius
+	glm::vec4 bounding_sphere;
+
+	glm::vec4 base_color_factor;
+
+	uint32_t first_index;
+
+	uint32_t index_count;
+
+	int32_t vertex_offset;
+
+	// Index into the material texture array, -1 if the material has no base color texture
+	int32_t base_color_texture_index;
+
+	uint32_t batch_index;
+
+	// Draws of a batch are written from the index of its first instance
+	uint32_t batch_first_instance;
+
+	uint32_t padding[2];
+};
+
+/**
+ * @brief Uniform shared by the culling and drawing shaders of the GPU-driven subpass
+ */
+struct alignas(16) GPUDrivenUniform
+{
+	glm::mat4 camera_view_proj;
+
+	glm::vec4 camera_position;
+
+	glm::vec4 frustum_planes[6];
+
+	uint32_t instance_count;
+
+	// Whether visible draws are compacted and counted, or written in place with an instance count of 0 if culled
+	uint32_t compact_draws;
+
+	// Whether draws index their instance with their first instance, which needs drawIndirectFirstInstance
+	uint32_t first_instance;
+};
+
+/**
+ * @brief Renders a Scene with a fixed number of indirect draws, independent of the number of objects.
+ *
+ *        On prepare, the geometry of all indexed submeshes is merged into shared vertex and index buffers,
+ *        and per-instance transforms, bounds and materials are uploaded once into a storage buffer.
+ *        Every frame cull() dispatches a compute shader which frustum culls the instances and writes
+ *        the draw commands, which draw() then consumes with vkCmdDrawIndexedIndirectCountKHR,
+ *        one call per batch of instances sharing the same rasterization and blend state.
+ *
+ *        Transforms are uploaded once, so the scene is expected to be static; call update_instances()
+ *        after moving nodes. Geometry in device local buffers shared between submeshes is read back once on prepare.
+ *        Without VK_KHR_draw_indirect_count, culled draws are written with an instance count of 0
+ *        and drawn with vkCmdDrawIndexedIndirect instead. Without drawIndirectFirstInstance, draws are
+ *        recorded one by one with the index of their instance pushed as a constant. Material textures are
+ *        only sampled if shaderSampledImageArrayDynamicIndexing was requested.
+ */
+class GPUDrivenSubpass : public GeometrySubpass
+{
+  public:
+	/**
+	 * @brief Constructs a GPU-driven subpass for forward rendering
+	 * @param render_context Render context
+	 * @param vertex_shader Vertex shader source
+	 * @param fragment_shader Fragment shader source
+	 * @param cull_shader Compute shader source writing the draw commands
+	 * @param scene Scene to render on this subpass
+	 * @param camera Camera used to look at the scene
+	 */
+	GPUDrivenSubpass(RenderContext &render_context, ShaderSource &&vertex_shader, ShaderSource &&fragment_shader, ShaderSource &&cull_shader, sg::Scene &scene, sg::Camera &camera);
+
+	virtual ~GPUDrivenSubpass() = default;
+
+	virtual void prepare() override;
+
+	/**
+	 * @brief Record the culling dispatch which writes the draw commands of the frame,
+	 *        must be called outside of the render pass and before draw()
+	 */
+	void cull(CommandBuffer &command_buffer);
+
+	/**
+	 * @brief Record the indirect draw commands
+	 */
+	virtual void draw(CommandBuffer &command_buffer) override;
+
+	/**
+	 * @brief Uploads the transforms and bounds of all instances again
+	 */
+	void update_instances();
+
+	/**
+	 * @return The number of instances, i.e. the maximum number of draws
+	 */
+	uint32_t get_instance_count() const;
+
+  private:
+	/**
+	 * @brief A range of instances drawn with the same pipeline state
+	 */
+	struct Batch
+	{
+		uint32_t first_instance{0};
+
+		uint32_t instance_count{0};
+
+		bool double_sided{false};
+
+		bool flipped{false};
+
+		bool blend{false};
+	};
+
+	/**
+	 * @brief Merges the geometry of all submeshes and creates the instances
+	 */
+	void prepare_geometry();
+
+	void draw_batch(CommandBuffer &command_buffer, const Batch &batch, uint32_t batch_index);
+
+	ShaderSource cull_shader;
+
+	ShaderVariant variant;
+
+	/// Instances sorted by batch
+	std::vector<GPUDrivenInstance> instances;
+
+	/// Node of each instance, to update transforms
+	std::vector<sg::Node *> instance_nodes;
+
+	/// Local bounds of each instance
+	std::vector<const sg::AABB *> instance_bounds;
+
+	std::vector<Batch> batches;
+
+	std::unique_ptr<core::Buffer> position_buffer;
+
+	std::unique_ptr<core::Buffer> normal_buffer;
+
+	std::unique_ptr<core::Buffer> texcoord_buffer;
+
+	std::unique_ptr<core::Buffer> index_buffer;
+
+	std::unique_ptr<core::Buffer> instance_buffer;
+
+	bool draw_indirect_count{false};
+
+	bool multi_draw_indirect{false};
+
+	/// Without it draws are recorded one by one, with their instance index in a push constant
+	bool draw_indirect_first_instance{false};
+
+	/// Whether the scene textures are bound as an array indexed per instance, which needs shaderSampledImageArrayDynamicIndexing
+	bool material_texture_array{false};
+
+	/// Per-frame allocations written by cull() and read by draw()
+	BufferAllocation uniform_allocation;
+
+	BufferAllocation draw_commands;
+
+	BufferAllocation draw_counts;
+};
+
+}        // namespace vkb
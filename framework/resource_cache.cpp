@@ -17,6 +17,11 @@
 
 #include "resource_cache.h"
 
+#include <algorithm>
+#include <thread>
+
+#include <ctpl_stl.h>
+
 #include "common/resource_caching.h"
 #include "core/device.h"
 
@@ -24,20 +29,213 @@ namespace vkb
 {
 namespace
 {
+/// Upper bound of the buckets of an index, also used for resource types without a limit
+constexpr std::size_t max_bucket_count = 16384;
+
+/**
+ * @brief Sizes an index for about one resource per bucket once it reaches its limit
+ */
+std::size_t get_bucket_count(std::size_t limit)
+{
+	if (limit == 0)
+	{
+		return max_bucket_count;
+	}
+
+	std::size_t bucket_count = ResourceCache::ResourceIndex<DescriptorSet>::default_bucket_count;
+	while (bucket_count < limit && bucket_count < max_bucket_count)
+	{
+		bucket_count *= 2;
+	}
+
+	return bucket_count;
+}
+
 template <class T, class... A>
-T &request_resource(Device &device, ResourceRecord &recorder, std::mutex &resource_mutex, std::unordered_map<std::size_t, T> &resources, A &... args)
+T &request_resource(Device &device, ResourceRecord &recorder, std::mutex &resource_mutex, std::unordered_map<std::size_t, T> &resources, ResourceCache::ResourceIndex<T> &index, A &... args)
 {
+	std::size_t hash{0U};
+	hash_param(hash, args...);
+
+	if (auto resource = index.find(hash))
+	{
+		return *resource;
+	}
+
 	std::lock_guard<std::mutex> guard(resource_mutex);
 
+	// Another thread may have inserted it while we were waiting for the lock
+	if (auto resource = index.find(hash))
+	{
+		return *resource;
+	}
+
 	auto &res = request_resource(device, &recorder, resources, args...);
 
+	index.publish(hash, res);
+
 	return res;
 }
+
+/**
+ * @brief Creates a pipeline outside of any lock, then inserts it into the cache and publishes it
+ *        to the lock-free index. Whoever waits on the pending future for this hash is released after.
+ */
+template <class T>
+T *build_pipeline(Device &device, ResourceRecord &recorder, std::mutex &resource_mutex, std::unordered_map<std::size_t, T> &resources,
+                  ResourceCache::PipelineRequests<T> &requests, std::size_t hash, VkPipelineCache pipeline_cache, PipelineState &pipeline_state)
+{
+	const char *res_type = typeid(T).name();
+
+	LOGD("Building cache object ({}) {:#x}", res_type, hash);
+
+	try
+	{
+		T resource(device, pipeline_cache, pipeline_state);
+
+		std::lock_guard<std::mutex> guard(resource_mutex);
+
+		auto res_ins_it = resources.emplace(hash, std::move(resource));
+
+		if (!res_ins_it.second)
+		{
+			throw std::runtime_error{std::string{"Insertion error for cache object ("} + res_type + ")"};
+		}
+
+		auto &pipeline = res_ins_it.first->second;
+
+		RecordHelper<T, VkPipelineCache, PipelineState> record_helper;
+
+		size_t index = record_helper.record(recorder, pipeline_cache, pipeline_state);
+		record_helper.index(recorder, index, pipeline);
+
+		requests.index.publish(hash, pipeline);
+		requests.pending.erase(hash);
+
+		return &pipeline;
+	}
+	catch (const std::exception &e)
+	{
+		LOGE("Creation error for cache object ({}): {}", res_type, e.what());
+
+		std::lock_guard<std::mutex> guard(resource_mutex);
+		requests.pending.erase(hash);
+
+		throw;
+	}
+}
+
+/**
+ * @brief Starts a new generation for one resource type and evicts its least recently used resources
+ *        above the limit. They are unlinked from the index first, so that no new lookup can find them,
+ *        then kept alive until the GPU completed the last generation which used them.
+ */
+template <class T>
+void evict(std::mutex &resource_mutex, std::unordered_map<std::size_t, T> &resources, ResourceCache::ResourceIndex<T> &index,
+           std::list<std::pair<std::uint64_t, T>> &retired, std::size_t limit, std::uint64_t generation)
+{
+	std::lock_guard<std::mutex> guard(resource_mutex);
+
+	index.set_generation(generation);
+
+	if (limit == 0 || resources.size() <= limit)
+	{
+		return;
+	}
+
+	// Resources used in the current generation are never evicted, so the limit may be exceeded for a frame
+	auto hashes = index.find_least_recently_used(resources.size() - limit, generation);
+
+	for (auto hash : hashes)
+	{
+		auto last_used = index.erase(hash);
+
+		auto res_it = resources.find(hash);
+		retired.emplace_back(last_used, std::move(res_it->second));
+		resources.erase(res_it);
+	}
+
+	LOGD("Evicted {} cache objects ({})", hashes.size(), typeid(T).name());
+}
+
+template <class T>
+std::shared_future<T *> make_ready_future(T *pipeline)
+{
+	std::promise<T *> ready;
+	ready.set_value(pipeline);
+	return ready.get_future().share();
+}
+
+/**
+ * @brief Starts the creation of a pipeline missing from the lock-free index, unless somebody already did.
+ *        The lock is only held to check the index again (another thread may have just published it)
+ *        and to register the pending request, never while the pipeline is being created.
+ * @param workers If not null, the pipeline is built on the workers, otherwise on the calling thread
+ * @return A future which resolves to the cached pipeline
+ */
+template <class T>
+std::shared_future<T *> request_pipeline(Device &device, ResourceRecord &recorder, std::mutex &resource_mutex, std::unordered_map<std::size_t, T> &resources,
+                                         ResourceCache::PipelineRequests<T> &requests, ctpl::thread_pool *workers, std::size_t hash, VkPipelineCache pipeline_cache, const PipelineState &pipeline_state)
+{
+	auto creation = std::make_shared<std::promise<T *>>();
+
+	std::shared_future<T *> future;
+
+	{
+		std::lock_guard<std::mutex> guard(resource_mutex);
+
+		if (auto pipeline = requests.index.find(hash))
+		{
+			return make_ready_future(pipeline);
+		}
+
+		auto pending_it = requests.pending.find(hash);
+
+		if (pending_it != requests.pending.end())
+		{
+			return pending_it->second;
+		}
+
+		future = creation->get_future().share();
+
+		requests.pending.emplace(hash, future);
+	}
+
+	auto build = [&device, &recorder, &resource_mutex, &resources, &requests, hash, pipeline_cache, state = PipelineState{pipeline_state}, creation](size_t) mutable {
+		try
+		{
+			creation->set_value(build_pipeline(device, recorder, resource_mutex, resources, requests, hash, pipeline_cache, state));
+		}
+		catch (...)
+		{
+			creation->set_exception(std::current_exception());
+		}
+	};
+
+	if (workers)
+	{
+		workers->push(std::move(build));
+	}
+	else
+	{
+		build(0);
+	}
+
+	return future;
+}
 }        // namespace
 
 ResourceCache::ResourceCache(Device &device) :
     device{device}
 {
+	// Sizes the indices of the bounded resource types for the default limits
+	set_limits(limits);
+}
+
+ResourceCache::~ResourceCache()
+{
+	// Let in-flight pipeline builds finish before the cache they write to is destroyed
+	pipeline_workers.reset();
 }
 
 void ResourceCache::warmup(const std::vector<uint8_t> &data)
@@ -60,55 +258,171 @@ void ResourceCache::set_pipeline_cache(VkPipelineCache new_pipeline_cache)
 ShaderModule &ResourceCache::request_shader_module(VkShaderStageFlagBits stage, const ShaderSource &glsl_source, const ShaderVariant &shader_variant)
 {
 	std::string entry_point{"main"};
-	return request_resource(device, recorder, shader_module_mutex, state.shader_modules, stage, glsl_source, entry_point, shader_variant);
+	return request_resource(device, recorder, shader_module_mutex, state.shader_modules, shader_module_index, stage, glsl_source, entry_point, shader_variant);
 }
 
 PipelineLayout &ResourceCache::request_pipeline_layout(const std::vector<ShaderModule *> &shader_modules)
 {
-	return request_resource(device, recorder, pipeline_layout_mutex, state.pipeline_layouts, shader_modules);
+	return request_resource(device, recorder, pipeline_layout_mutex, state.pipeline_layouts, pipeline_layout_index, shader_modules);
 }
 
 DescriptorSetLayout &ResourceCache::request_descriptor_set_layout(const uint32_t                     set_index,
                                                                   const std::vector<ShaderModule *> &shader_modules,
                                                                   const std::vector<ShaderResource> &set_resources)
 {
-	return request_resource(device, recorder, descriptor_set_layout_mutex, state.descriptor_set_layouts, set_index, shader_modules, set_resources);
+	return request_resource(device, recorder, descriptor_set_layout_mutex, state.descriptor_set_layouts, descriptor_set_layout_index, set_index, shader_modules, set_resources);
 }
 
 GraphicsPipeline &ResourceCache::request_graphics_pipeline(PipelineState &pipeline_state)
 {
-	return request_resource(device, recorder, graphics_pipeline_mutex, state.graphics_pipelines, pipeline_cache, pipeline_state);
+	std::size_t hash{0U};
+	hash_param(hash, pipeline_cache, pipeline_state);
+
+	if (auto pipeline = graphics_pipeline_requests.index.find(hash))
+	{
+		return *pipeline;
+	}
+
+	return *request_pipeline(device, recorder, graphics_pipeline_mutex, state.graphics_pipelines, graphics_pipeline_requests, nullptr, hash, pipeline_cache, pipeline_state).get();
 }
 
 ComputePipeline &ResourceCache::request_compute_pipeline(PipelineState &pipeline_state)
 {
-	return request_resource(device, recorder, compute_pipeline_mutex, state.compute_pipelines, pipeline_cache, pipeline_state);
+	std::size_t hash{0U};
+	hash_param(hash, pipeline_cache, pipeline_state);
+
+	if (auto pipeline = compute_pipeline_requests.index.find(hash))
+	{
+		return *pipeline;
+	}
+
+	return *request_pipeline(device, recorder, compute_pipeline_mutex, state.compute_pipelines, compute_pipeline_requests, nullptr, hash, pipeline_cache, pipeline_state).get();
+}
+
+std::shared_future<GraphicsPipeline *> ResourceCache::request_graphics_pipeline_async(const PipelineState &pipeline_state)
+{
+	std::size_t hash{0U};
+	hash_param(hash, pipeline_cache, pipeline_state);
+
+	if (auto pipeline = graphics_pipeline_requests.index.find(hash))
+	{
+		return make_ready_future(pipeline);
+	}
+
+	return request_pipeline(device, recorder, graphics_pipeline_mutex, state.graphics_pipelines, graphics_pipeline_requests, &get_pipeline_workers(), hash, pipeline_cache, pipeline_state);
+}
+
+std::shared_future<ComputePipeline *> ResourceCache::request_compute_pipeline_async(const PipelineState &pipeline_state)
+{
+	std::size_t hash{0U};
+	hash_param(hash, pipeline_cache, pipeline_state);
+
+	if (auto pipeline = compute_pipeline_requests.index.find(hash))
+	{
+		return make_ready_future(pipeline);
+	}
+
+	return request_pipeline(device, recorder, compute_pipeline_mutex, state.compute_pipelines, compute_pipeline_requests, &get_pipeline_workers(), hash, pipeline_cache, pipeline_state);
+}
+
+bool ResourceCache::is_graphics_pipeline_ready(const PipelineState &pipeline_state) const
+{
+	std::size_t hash{0U};
+	hash_param(hash, pipeline_cache, pipeline_state);
+
+	return graphics_pipeline_requests.index.find(hash) != nullptr;
+}
+
+bool ResourceCache::is_compute_pipeline_ready(const PipelineState &pipeline_state) const
+{
+	std::size_t hash{0U};
+	hash_param(hash, pipeline_cache, pipeline_state);
+
+	return compute_pipeline_requests.index.find(hash) != nullptr;
+}
+
+ctpl::thread_pool &ResourceCache::get_pipeline_workers()
+{
+	std::call_once(pipeline_workers_flag, [this]() {
+		// Pipelines are compiled on threads of their own rather than by the JobSystem: a compilation is a
+		// driver call which cannot be split and may take many milliseconds, and would hold a worker that the
+		// jobs of a frame wait for. Compilations become rare once the first frames are drawn, so at most two
+		// threads let a few of them overlap without competing with the job system for the cores.
+		auto thread_count = std::min(2u, std::max(1u, std::thread::hardware_concurrency() / 4));
+
+		pipeline_workers = std::make_unique<ctpl::thread_pool>(thread_count);
+	});
+
+	return *pipeline_workers;
 }
 
 DescriptorSet &ResourceCache::request_descriptor_set(DescriptorSetLayout &descriptor_set_layout, const BindingMap<VkDescriptorBufferInfo> &buffer_infos, const BindingMap<VkDescriptorImageInfo> &image_infos)
 {
-	auto &descriptor_pool = request_resource(device, recorder, descriptor_set_mutex, state.descriptor_pools, descriptor_set_layout);
-	return request_resource(device, recorder, descriptor_set_mutex, state.descriptor_sets, descriptor_set_layout, descriptor_pool, buffer_infos, image_infos);
+	// Unlike the pools of render frames, which are reset in bulk, eviction frees the sets of the cache one by one
+	const uint32_t                    pool_size  = DescriptorPool::MAX_SETS_PER_POOL;
+	const VkDescriptorPoolCreateFlags pool_flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+
+	auto &descriptor_pool = request_resource(device, recorder, descriptor_set_mutex, state.descriptor_pools, descriptor_pool_index, descriptor_set_layout, pool_size, pool_flags);
+	return request_resource(device, recorder, descriptor_set_mutex, state.descriptor_sets, descriptor_set_index, descriptor_set_layout, descriptor_pool, buffer_infos, image_infos);
 }
 
 RenderPass &ResourceCache::request_render_pass(const std::vector<Attachment> &attachments, const std::vector<LoadStoreInfo> &load_store_infos, const std::vector<SubpassInfo> &subpasses)
 {
-	return request_resource(device, recorder, render_pass_mutex, state.render_passes, attachments, load_store_infos, subpasses);
+	return request_resource(device, recorder, render_pass_mutex, state.render_passes, render_pass_index, attachments, load_store_infos, subpasses);
 }
 
 Framebuffer &ResourceCache::request_framebuffer(const RenderTarget &render_target, const RenderPass &render_pass)
 {
-	return request_resource(device, recorder, framebuffer_mutex, state.framebuffers, render_target, render_pass);
+	return request_resource(device, recorder, framebuffer_mutex, state.framebuffers, framebuffer_index, render_target, render_pass);
 }
 
 void ResourceCache::clear_pipelines()
 {
+	// Wait for pipelines still being built, they would otherwise be inserted after the clear
+	std::vector<std::shared_future<GraphicsPipeline *>> graphics_pending;
+	std::vector<std::shared_future<ComputePipeline *>>  compute_pending;
+	{
+		std::lock_guard<std::mutex> graphics_guard(graphics_pipeline_mutex);
+		std::lock_guard<std::mutex> compute_guard(compute_pipeline_mutex);
+
+		for (auto &pending : graphics_pipeline_requests.pending)
+		{
+			graphics_pending.push_back(pending.second);
+		}
+
+		for (auto &pending : compute_pipeline_requests.pending)
+		{
+			compute_pending.push_back(pending.second);
+		}
+	}
+
+	for (auto &pending : graphics_pending)
+	{
+		pending.wait();
+	}
+
+	for (auto &pending : compute_pending)
+	{
+		pending.wait();
+	}
+
+	std::lock_guard<std::mutex> graphics_guard(graphics_pipeline_mutex);
+	std::lock_guard<std::mutex> compute_guard(compute_pipeline_mutex);
+
+	graphics_pipeline_requests.index.clear();
+	compute_pipeline_requests.index.clear();
+
 	state.graphics_pipelines.clear();
 	state.compute_pipelines.clear();
+
+	retired_graphics_pipelines.clear();
+	retired_compute_pipelines.clear();
 }
 
 void ResourceCache::update_descriptor_sets(const std::vector<core::ImageView> &old_views, const std::vector<core::ImageView> &new_views)
 {
+	std::lock_guard<std::mutex> guard(descriptor_set_mutex);
+
 	// Find descriptor sets referring to the old image view
 	std::vector<VkWriteDescriptorSet> set_updates;
 	std::set<size_t>                  matches;
@@ -190,15 +504,42 @@ void ResourceCache::update_descriptor_sets(const std::vector<core::ImageView> &o
 		// Add (key, resource) to the cache
 		state.descriptor_sets.emplace(new_key, std::move(descriptor_set));
 	}
+
+	// Rekeyed descriptor sets were moved, so the index has to be rebuilt
+	if (!matches.empty())
+	{
+		descriptor_set_index.clear();
+
+		for (auto &kd_pair : state.descriptor_sets)
+		{
+			descriptor_set_index.publish(kd_pair.first, kd_pair.second);
+		}
+	}
 }
 
 void ResourceCache::clear_framebuffers()
 {
+	std::lock_guard<std::mutex> guard(framebuffer_mutex);
+
+	framebuffer_index.clear();
+
 	state.framebuffers.clear();
+
+	retired_framebuffers.clear();
 }
 
 void ResourceCache::clear()
 {
+	shader_module_index.clear();
+	pipeline_layout_index.clear();
+	descriptor_set_index.clear();
+	descriptor_pool_index.clear();
+	descriptor_set_layout_index.clear();
+	render_pass_index.clear();
+
+	// Their pools are destroyed below, which frees the descriptor sets as well
+	retired_descriptor_sets.clear();
+
 	state.shader_modules.clear();
 	state.pipeline_layouts.clear();
 	state.descriptor_sets.clear();
@@ -212,4 +553,71 @@ const ResourceCacheState &ResourceCache::get_internal_state() const
 {
 	return state;
 }
+
+void ResourceCache::set_limits(const ResourceCacheLimits &new_limits)
+{
+	limits = new_limits;
+
+	// Pipelines may still be published by the workers
+	{
+		std::lock_guard<std::mutex> guard(graphics_pipeline_mutex);
+		graphics_pipeline_requests.index.rehash(get_bucket_count(limits.graphics_pipelines));
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(compute_pipeline_mutex);
+		compute_pipeline_requests.index.rehash(get_bucket_count(limits.compute_pipelines));
+	}
+
+	descriptor_set_index.rehash(get_bucket_count(limits.descriptor_sets));
+	framebuffer_index.rehash(get_bucket_count(limits.framebuffers));
+}
+
+const ResourceCacheLimits &ResourceCache::get_limits() const
+{
+	return limits;
+}
+
+std::uint64_t ResourceCache::begin_frame(std::uint64_t completed_generation)
+{
+	++generation;
+
+	evict(graphics_pipeline_mutex, state.graphics_pipelines, graphics_pipeline_requests.index, retired_graphics_pipelines, limits.graphics_pipelines, generation);
+	evict(compute_pipeline_mutex, state.compute_pipelines, compute_pipeline_requests.index, retired_compute_pipelines, limits.compute_pipelines, generation);
+	evict(descriptor_set_mutex, state.descriptor_sets, descriptor_set_index, retired_descriptor_sets, limits.descriptor_sets, generation);
+	evict(framebuffer_mutex, state.framebuffers, framebuffer_index, retired_framebuffers, limits.framebuffers, generation);
+
+	release_retired(completed_generation);
+
+	return generation;
+}
+
+std::uint64_t ResourceCache::get_generation() const
+{
+	return generation;
+}
+
+void ResourceCache::release_retired(std::uint64_t completed_generation)
+{
+	auto is_complete = [completed_generation](const auto &retired) {
+		return retired.first <= completed_generation;
+	};
+
+	retired_graphics_pipelines.remove_if(is_complete);
+	retired_compute_pipelines.remove_if(is_complete);
+	retired_framebuffers.remove_if(is_complete);
+
+	// Descriptor sets are owned by their pool, so they have to be given back explicitly
+	std::lock_guard<std::mutex> guard(descriptor_set_mutex);
+
+	retired_descriptor_sets.remove_if([&is_complete](const std::pair<std::uint64_t, DescriptorSet> &retired) {
+		if (!is_complete(retired))
+		{
+			return false;
+		}
+
+		retired.second.get_descriptor_pool().free(retired.second.get_handle());
+		return true;
+	});
+}
 }        // namespace vkb
@@ -17,6 +17,14 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -30,6 +38,11 @@
 #include "resource_record.h"
 #include "resource_replay.h"
 
+namespace ctpl
+{
+class thread_pool;
+}
+
 namespace vkb
 {
 class Device;
@@ -64,6 +77,23 @@ struct ResourceCacheState
 	std::unordered_map<std::size_t, Framebuffer> framebuffers;
 };
 
+/**
+ * @brief Maximum number of resident resources of each type the cache may hold.
+ *        Least recently used resources above a limit are evicted when a frame begins.
+ *        A limit of 0 means unlimited. The defaults are well above what a sample uses in a frame,
+ *        so that only resources left behind by resizes or scene changes get evicted.
+ */
+struct ResourceCacheLimits
+{
+	std::size_t graphics_pipelines{1024};
+
+	std::size_t compute_pipelines{256};
+
+	std::size_t descriptor_sets{8192};
+
+	std::size_t framebuffers{64};
+};
+
 /**
  * @brief Cache all sorts of Vulkan objects specific to a Vulkan device.
  * Supports serialization and deserialization of cached resources.
@@ -74,13 +104,237 @@ struct ResourceCacheState
  * The resource cache is also linked with ResourceRecord and ResourceReplay. Replay can warm-up
  * the cache on app startup by creating all necessary objects.
  * The cache holds pointers to objects and has a mapping from such pointers to hashes.
- * It can only be destroyed in bulk, single elements cannot be removed.
+ * It is destroyed in bulk, except for pipelines, descriptor sets and framebuffers which can be
+ * bounded with ResourceCacheLimits. Each frame is a new generation: resources remember the last
+ * generation which requested them, and those evicted are only destroyed once the GPU completed it.
+ *
+ * Lookups of resources which are already cached are lock-free, see ResourceIndex. A miss takes
+ * the lock of its resource type to check again and insert the new object.
+ *
+ * Pipelines can also be requested asynchronously, in which case they are built on background
+ * workers. Pipeline creation never happens while holding a cache lock.
  */
 class ResourceCache
 {
   public:
+	/**
+	 * @brief Read-mostly index from hashes to cached resources, so that cache hits never take a lock.
+	 *        Each bucket is a singly linked list whose links are only ever replaced with release semantics,
+	 *        therefore readers can walk it while a writer inserts or erases. Erased nodes are kept alive
+	 *        until the next generation starts, so a lookup must not span a frame boundary.
+	 *        Every lookup marks the resource as used in the current generation, which drives eviction.
+	 *        Writers must be externally synchronized, and clearing or rehashing must not race with lookups.
+	 */
+	template <class T>
+	class ResourceIndex
+	{
+	  public:
+		static constexpr std::size_t default_bucket_count = 256;
+
+		explicit ResourceIndex(std::size_t bucket_count = default_bucket_count)
+		{
+			allocate_buckets(bucket_count);
+		}
+
+		T *find(std::size_t hash) const
+		{
+			for (auto node = buckets[hash % bucket_count].load(std::memory_order_acquire); node != nullptr; node = node->next.load(std::memory_order_acquire))
+			{
+				if (node->hash == hash)
+				{
+					// Only write when the generation changed, so repeated hits within a frame do not bounce the cache line
+					auto current = generation.load(std::memory_order_relaxed);
+					if (node->last_used.load(std::memory_order_relaxed) != current)
+					{
+						node->last_used.store(current, std::memory_order_relaxed);
+					}
+
+					return node->resource;
+				}
+			}
+
+			return nullptr;
+		}
+
+		void publish(std::size_t hash, T &resource)
+		{
+			auto &bucket = buckets[hash % bucket_count];
+
+			auto node = std::make_unique<Node>(hash, resource, bucket.load(std::memory_order_relaxed), generation.load(std::memory_order_relaxed));
+
+			bucket.store(node.get(), std::memory_order_release);
+
+			nodes.emplace(hash, std::move(node));
+		}
+
+		/**
+		 * @brief Unlinks a resource from the index. The resource itself is not touched.
+		 * @return The generation in which the resource was last used
+		 */
+		std::uint64_t erase(std::size_t hash)
+		{
+			auto node_it = nodes.find(hash);
+			assert(node_it != nodes.end() && "Erasing a resource which is not in the index");
+
+			auto *node = node_it->second.get();
+
+			std::atomic<Node *> *link = &buckets[hash % bucket_count];
+			while (link->load(std::memory_order_relaxed) != node)
+			{
+				link = &link->load(std::memory_order_relaxed)->next;
+			}
+			link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+
+			auto last_used = node->last_used.load(std::memory_order_relaxed);
+
+			unlinked.push_back(std::move(node_it->second));
+			nodes.erase(node_it);
+
+			return last_used;
+		}
+
+		/**
+		 * @brief Finds the least recently used resources
+		 * @param count Maximum number of resources to return
+		 * @param before_generation Only resources not used since this generation are returned
+		 * @return The hashes of the resources, in no particular order
+		 */
+		std::vector<std::size_t> find_least_recently_used(std::size_t count, std::uint64_t before_generation) const
+		{
+			std::vector<std::pair<std::uint64_t, std::size_t>> candidates;
+
+			for (auto &node_it : nodes)
+			{
+				auto last_used = node_it.second->last_used.load(std::memory_order_relaxed);
+				if (last_used < before_generation)
+				{
+					candidates.emplace_back(last_used, node_it.first);
+				}
+			}
+
+			count = std::min(count, candidates.size());
+			std::nth_element(candidates.begin(), candidates.begin() + count, candidates.end());
+
+			std::vector<std::size_t> hashes(count);
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				hashes[i] = candidates[i].second;
+			}
+
+			return hashes;
+		}
+
+		/**
+		 * @brief Starts a new generation, releasing the nodes erased during the previous one
+		 */
+		void set_generation(std::uint64_t new_generation)
+		{
+			generation.store(new_generation, std::memory_order_relaxed);
+
+			unlinked.clear();
+		}
+
+		std::size_t size() const
+		{
+			return nodes.size();
+		}
+
+		void clear()
+		{
+			for (std::size_t i = 0; i < bucket_count; ++i)
+			{
+				buckets[i].store(nullptr, std::memory_order_relaxed);
+			}
+
+			nodes.clear();
+			unlinked.clear();
+		}
+
+		/**
+		 * @brief Relinks the resources into a new number of buckets, to keep the chains short
+		 *        for the number of resources the index is expected to hold
+		 */
+		void rehash(std::size_t new_bucket_count)
+		{
+			if (new_bucket_count == bucket_count)
+			{
+				return;
+			}
+
+			allocate_buckets(new_bucket_count);
+
+			for (auto &node_it : nodes)
+			{
+				auto &bucket = buckets[node_it.first % bucket_count];
+
+				node_it.second->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				bucket.store(node_it.second.get(), std::memory_order_relaxed);
+			}
+		}
+
+		std::size_t get_bucket_count() const
+		{
+			return bucket_count;
+		}
+
+	  private:
+		struct Node
+		{
+			Node(std::size_t hash, T &resource, Node *next, std::uint64_t last_used) :
+			    hash{hash},
+			    resource{&resource},
+			    next{next},
+			    last_used{last_used}
+			{}
+
+			const std::size_t hash;
+
+			T *const resource;
+
+			std::atomic<Node *> next;
+
+			std::atomic<std::uint64_t> last_used;
+		};
+
+		void allocate_buckets(std::size_t new_bucket_count)
+		{
+			bucket_count = std::max<std::size_t>(new_bucket_count, 1);
+			buckets      = std::make_unique<std::atomic<Node *>[]>(bucket_count);
+
+			for (std::size_t i = 0; i < bucket_count; ++i)
+			{
+				buckets[i].store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+		std::size_t bucket_count{0};
+
+		std::unique_ptr<std::atomic<Node *>[]> buckets;
+
+		std::unordered_map<std::size_t, std::unique_ptr<Node>> nodes;
+
+		/// Nodes erased in the current generation, which concurrent lookups may still be walking
+		std::vector<std::unique_ptr<Node>> unlinked;
+
+		std::atomic<std::uint64_t> generation{0};
+	};
+
+	/**
+	 * @brief Pipelines which are built, or being built, for one pipeline type
+	 */
+	template <class T>
+	struct PipelineRequests
+	{
+		ResourceIndex<T> index;
+
+		/// Futures of pipelines being created, so that concurrent requests for the same state wait instead of building it twice
+		std::unordered_map<std::size_t, std::shared_future<T *>> pending;
+	};
+
 	ResourceCache(Device &device);
 
+	~ResourceCache();
+
 	ResourceCache(const ResourceCache &) = delete;
 
 	ResourceCache(ResourceCache &&) = delete;
@@ -107,6 +361,32 @@ class ResourceCache
 
 	ComputePipeline &request_compute_pipeline(PipelineState &pipeline_state);
 
+	/**
+	 * @brief Requests a graphics pipeline without waiting for it to be created.
+	 *        If it is not cached yet, it is built on a background worker.
+	 * @param pipeline_state The state of the pipeline, copied so it can be changed right after the call
+	 * @return A future which resolves to the cached pipeline
+	 */
+	std::shared_future<GraphicsPipeline *> request_graphics_pipeline_async(const PipelineState &pipeline_state);
+
+	/**
+	 * @brief Requests a compute pipeline without waiting for it to be created.
+	 *        If it is not cached yet, it is built on a background worker.
+	 * @param pipeline_state The state of the pipeline, copied so it can be changed right after the call
+	 * @return A future which resolves to the cached pipeline
+	 */
+	std::shared_future<ComputePipeline *> request_compute_pipeline_async(const PipelineState &pipeline_state);
+
+	/**
+	 * @return Whether a graphics pipeline for the given state is built, so requesting it will not block
+	 */
+	bool is_graphics_pipeline_ready(const PipelineState &pipeline_state) const;
+
+	/**
+	 * @return Whether a compute pipeline for the given state is built, so requesting it will not block
+	 */
+	bool is_compute_pipeline_ready(const PipelineState &pipeline_state) const;
+
 	DescriptorSet &request_descriptor_set(DescriptorSetLayout &                     descriptor_set_layout,
 	                                      const BindingMap<VkDescriptorBufferInfo> &buffer_infos,
 	                                      const BindingMap<VkDescriptorImageInfo> & image_infos);
@@ -129,6 +409,28 @@ class ResourceCache
 
 	void clear();
 
+	/**
+	 * @brief Sets the limits, and sizes the indices of the bounded resource types for them.
+	 *        Must not be called while other threads are requesting resources.
+	 */
+	void set_limits(const ResourceCacheLimits &new_limits);
+
+	const ResourceCacheLimits &get_limits() const;
+
+	/**
+	 * @brief Starts a new generation, evicting the least recently used resources above the limits
+	 *        and destroying evicted resources which the GPU no longer uses.
+	 *        Must not be called while other threads are requesting resources.
+	 * @param completed_generation Every generation up to this one finished executing on the GPU
+	 * @return The new generation, to be used by the frame which is beginning
+	 */
+	std::uint64_t begin_frame(std::uint64_t completed_generation);
+
+	/**
+	 * @return The generation of the current frame
+	 */
+	std::uint64_t get_generation() const;
+
 	const ResourceCacheState &get_internal_state() const;
 
   private:
@@ -142,6 +444,42 @@ class ResourceCache
 
 	ResourceCacheState state;
 
+	ResourceIndex<ShaderModule> shader_module_index;
+
+	ResourceIndex<PipelineLayout> pipeline_layout_index;
+
+	ResourceIndex<DescriptorSetLayout> descriptor_set_layout_index;
+
+	ResourceIndex<DescriptorPool> descriptor_pool_index;
+
+	ResourceIndex<RenderPass> render_pass_index;
+
+	ResourceIndex<DescriptorSet> descriptor_set_index;
+
+	ResourceIndex<Framebuffer> framebuffer_index;
+
+	PipelineRequests<GraphicsPipeline> graphics_pipeline_requests;
+
+	PipelineRequests<ComputePipeline> compute_pipeline_requests;
+
+	ResourceCacheLimits limits;
+
+	std::uint64_t generation{0};
+
+	/// Evicted resources, with the last generation which used them, waiting for the GPU to complete it
+	std::list<std::pair<std::uint64_t, GraphicsPipeline>> retired_graphics_pipelines;
+
+	std::list<std::pair<std::uint64_t, ComputePipeline>> retired_compute_pipelines;
+
+	std::list<std::pair<std::uint64_t, DescriptorSet>> retired_descriptor_sets;
+
+	std::list<std::pair<std::uint64_t, Framebuffer>> retired_framebuffers;
+
+	/// Background workers building asynchronously requested pipelines, created on first use
+	std::unique_ptr<ctpl::thread_pool> pipeline_workers;
+
+	std::once_flag pipeline_workers_flag;
+
 	std::mutex descriptor_set_mutex;
 
 	std::mutex pipeline_layout_mutex;
@@ -157,5 +495,9 @@ class ResourceCache
 	std::mutex compute_pipeline_mutex;
 
 	std::mutex framebuffer_mutex;
+
+	ctpl::thread_pool &get_pipeline_workers();
+
+	void release_retired(std::uint64_t completed_generation);
 };
 }        // namespace vkb
@@ -0,0 +1,286 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "scene_cache.h"
+
+#include <cstring>
+#include <fstream>
+
+#include "common/helpers.h"
+#include "common/logging.h"
+#include "platform/filesystem.h"
+
+namespace vkb
+{
+namespace
+{
+constexpr uint32_t file_magic   = 0x43424b56;        // "VKBC"
+constexpr uint32_t file_version = 4;
+
+/// Alignment of the blob and of every range in it
+constexpr uint64_t data_alignment = 16;
+
+struct FileHeader
+{
+	uint32_t magic;
+
+	uint32_t version;
+
+	uint64_t address;
+
+	uint64_t check;
+
+	uint64_t table_size;
+
+	uint64_t blob_size;
+};
+
+uint64_t align_data(uint64_t offset)
+{
+	return (offset + data_alignment - 1) & ~(data_alignment - 1);
+}
+
+std::string get_filename(uint64_t address)
+{
+	return fmt::format("scene_cache_{:016x}.bin", address);
+}
+
+bool is_valid_range(const SceneCache::DataRange &range, uint64_t blob_size)
+{
+	return range.offset <= blob_size && range.size <= blob_size - range.offset;
+}
+
+/**
+ * @brief Reads the number of elements of an array of the table, and fails the stream if the rest of the table
+ *        is too small to hold that many, so that a corrupted count never makes the array huge
+ * @param min_element_size Size an element takes in the table at least
+ */
+size_t read_count(std::istringstream &is, uint64_t table_size, size_t min_element_size)
+{
+	size_t count{0};
+	read(is, count);
+
+	auto position = is ? static_cast<uint64_t>(is.tellg()) : table_size;
+
+	if (count > (table_size - position) / min_element_size)
+	{
+		is.setstate(std::ios::failbit);
+		return 0;
+	}
+
+	return count;
+}
+
+void read_string(std::istringstream &is, uint64_t table_size, std::string &value)
+{
+	value.resize(read_count(is, table_size, 1));
+	is.read(&value[0], value.size());
+}
+
+template <class T>
+void read_vector(std::istringstream &is, uint64_t table_size, std::vector<T> &value)
+{
+	value.resize(read_count(is, table_size, sizeof(T)));
+	is.read(reinterpret_cast<char *>(value.data()), value.size() * sizeof(T));
+}
+}        // namespace
+
+SceneCache::Key SceneCache::make_key(const std::string &file_name, uint64_t source_hash, const std::string &configuration)
+{
+	Fnv1a address_hash{0xcbf29ce484222325ull};
+	address_hash.add(file_version);
+	address_hash.add(file_name);
+	address_hash.add(configuration);
+
+	Fnv1a check_hash{0x84222325cbf29ce4ull};
+	check_hash.add(file_version);
+	check_hash.add(file_name);
+	check_hash.add(configuration);
+	check_hash.add(&source_hash, sizeof(source_hash));
+
+	return {address_hash.get(), check_hash.get()};
+}
+
+bool SceneCache::load(const Key &key)
+{
+	std::vector<uint8_t> file;
+
+	try
+	{
+		file = fs::read_temp(get_filename(key.address));
+	}
+	catch (const std::exception &)
+	{
+		// No cache yet
+		return false;
+	}
+
+	FileHeader header{};
+
+	bool valid = file.size() >= sizeof(header);
+
+	if (valid)
+	{
+		std::memcpy(&header, file.data(), sizeof(header));
+
+		valid = header.magic == file_magic &&
+		        header.version == file_version &&
+		        header.address == key.address &&
+		        header.check == key.check &&
+		        header.table_size <= file.size() - sizeof(header) &&
+		        header.blob_size <= file.size() &&
+		        file.size() == align_data(sizeof(header) + header.table_size) + header.blob_size;
+	}
+
+	if (!valid)
+	{
+		LOGI("Scene cache {} is out of date", get_filename(key.address));
+		return false;
+	}
+
+	std::istringstream is{std::string{file.begin() + sizeof(header), file.begin() + sizeof(header) + header.table_size}};
+
+	// Every count is read before its array is allocated, and checked against the table size
+	auto table_size = header.table_size;
+
+	images.resize(read_count(is, table_size, sizeof(size_t)));
+
+	for (auto &image : images)
+	{
+		read_string(is, table_size, image.name);
+		read(is, image.format);
+		read_vector(is, table_size, image.mipmaps);
+		read(is, image.data);
+		valid = valid && is_valid_range(image.data, header.blob_size);
+	}
+
+	primitives.resize(read_count(is, table_size, sizeof(size_t)));
+
+	for (auto &primitive : primitives)
+	{
+		primitive.vertex_buffers.resize(read_count(is, table_size, sizeof(size_t)));
+
+		for (auto &vertex_buffer : primitive.vertex_buffers)
+		{
+			read_string(is, table_size, vertex_buffer.name);
+			read(is, vertex_buffer.data);
+			valid = valid && is_valid_range(vertex_buffer.data, header.blob_size);
+		}
+
+		primitive.attributes.resize(read_count(is, table_size, sizeof(size_t)));
+
+		for (auto &attribute : primitive.attributes)
+		{
+			read_string(is, table_size, attribute.name);
+			read(is, attribute.attribute);
+		}
+
+		read(is, primitive.vertices_count, primitive.vertex_indices, primitive.index_type, primitive.indices,
+		     primitive.position_offset, primitive.position_scale);
+		valid = valid && is_valid_range(primitive.indices, header.blob_size);
+	}
+
+	if (!is || !valid)
+	{
+		LOGW("Ignoring corrupted scene cache {}", get_filename(key.address));
+
+		images.clear();
+		primitives.clear();
+
+		return false;
+	}
+
+	data        = std::move(file);
+	blob_offset = align_data(sizeof(header) + header.table_size);
+
+	return true;
+}
+
+void SceneCache::save(const Key &key) const
+{
+	std::ostringstream os;
+
+	write(os, images.size());
+
+	for (auto &image : images)
+	{
+		write(os, image.name, image.format, image.mipmaps, image.data);
+	}
+
+	write(os, primitives.size());
+
+	for (auto &primitive : primitives)
+	{
+		write(os, primitive.vertex_buffers.size());
+
+		for (auto &vertex_buffer : primitive.vertex_buffers)
+		{
+			write(os, vertex_buffer.name, vertex_buffer.data);
+		}
+
+		write(os, primitive.attributes.size());
+
+		for (auto &attribute : primitive.attributes)
+		{
+			write(os, attribute.name, attribute.attribute);
+		}
+
+		write(os, primitive.vertices_count, primitive.vertex_indices, primitive.index_type, primitive.indices,
+		      primitive.position_offset, primitive.position_scale);
+	}
+
+	auto table = os.str();
+
+	uint64_t blob_size = data.size() - blob_offset;
+
+	FileHeader header{file_magic, file_version, key.address, key.check, table.size(), blob_size};
+
+	// The blob is written straight from memory, as it can be hundreds of megabytes
+	std::ofstream file{fs::path::get(fs::path::Type::Temp) + get_filename(key.address), std::ios::binary | std::ios::trunc};
+
+	std::vector<char> padding(align_data(sizeof(header) + table.size()) - sizeof(header) - table.size(), 0);
+
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	file.write(table.data(), table.size());
+	file.write(padding.data(), padding.size());
+	file.write(reinterpret_cast<const char *>(data.data() + blob_offset), blob_size);
+
+	if (!file)
+	{
+		LOGW("Could not write scene cache {}", get_filename(key.address));
+	}
+}
+
+SceneCache::DataRange SceneCache::add_data(const uint8_t *new_data, size_t size)
+{
+	DataRange range{align_data(data.size() - blob_offset), size};
+
+	data.resize(blob_offset + range.offset + size);
+
+	if (size > 0)
+	{
+		std::memcpy(data.data() + blob_offset + range.offset, new_data, size);
+	}
+
+	return range;
+}
+
+const uint8_t *SceneCache::get_data(const DataRange &range) const
+{
+	return data.data() + blob_offset + range.offset;
+}
+}        // namespace vkb
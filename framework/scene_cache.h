@@ -0,0 +1,150 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "scene_graph/components/image.h"
+#include "scene_graph/components/sub_mesh.h"
+
+namespace vkb
+{
+/**
+ * @brief Binary cache of the data a GLTFLoader derives from a glTF file: the images decoded with their final
+ *        mip chains, and the vertex and index data of every primitive as laid out for the GPU.
+ *
+ *        A cache file is a small table describing the images and primitives, followed by a single blob
+ *        holding their data at 16 byte aligned offsets. Loading reads the file in one go and the data is
+ *        uploaded straight out of the blob, so loading is dominated by I/O.
+ *
+ *        There is one file per glTF file and loader configuration, stored in the temporary directory.
+ *        It is replaced when the glTF file, its buffers or its image files change, which is detected from
+ *        their sizes and modification times so that checking the cache does not read them.
+ */
+class SceneCache
+{
+  public:
+	/**
+	 * @brief Key of a cache file: the address names the file, the check validates its content
+	 */
+	struct Key
+	{
+		uint64_t address{0};
+
+		uint64_t check{0};
+	};
+
+	/**
+	 * @brief A range of the data blob
+	 */
+	struct DataRange
+	{
+		uint64_t offset{0};
+
+		uint64_t size{0};
+	};
+
+	struct Image
+	{
+		std::string name;
+
+		VkFormat format{VK_FORMAT_UNDEFINED};
+
+		std::vector<sg::Mipmap> mipmaps;
+
+		DataRange data;
+	};
+
+	struct VertexBuffer
+	{
+		std::string name;
+
+		DataRange data;
+	};
+
+	struct VertexAttribute
+	{
+		std::string name;
+
+		sg::VertexAttribute attribute;
+	};
+
+	struct Primitive
+	{
+		std::vector<VertexBuffer> vertex_buffers;
+
+		std::vector<VertexAttribute> attributes;
+
+		uint32_t vertices_count{0};
+
+		uint32_t vertex_indices{0};
+
+		VkIndexType index_type{VK_INDEX_TYPE_UINT16};
+
+		DataRange indices;
+
+		glm::vec3 position_offset{0.0f};
+
+		glm::vec3 position_scale{1.0f};
+	};
+
+	/**
+	 * @brief Creates the key of a glTF file
+	 * @param file_name Name of the glTF file
+	 * @param source_hash Hash identifying the version of the glTF file and of the files it references
+	 * @param configuration Description of the loader options that change the cached data
+	 */
+	static Key make_key(const std::string &file_name, uint64_t source_hash, const std::string &configuration);
+
+	/**
+	 * @brief Reads the cache file of a key
+	 * @return True if a valid file was found, false otherwise
+	 */
+	bool load(const Key &key);
+
+	/**
+	 * @brief Writes the cache file of a key, replacing any previous version
+	 */
+	void save(const Key &key) const;
+
+	/**
+	 * @brief Appends data to the blob
+	 * @return The range of the blob the data was copied to
+	 */
+	DataRange add_data(const uint8_t *data, size_t size);
+
+	/**
+	 * @return A pointer to the data of a range of the blob
+	 */
+	const uint8_t *get_data(const DataRange &range) const;
+
+	std::vector<Image> images;
+
+	/// Primitives of all meshes, in the order of the meshes and of their primitives
+	std::vector<Primitive> primitives;
+
+  private:
+	/// The blob, or the content of the cache file once loaded
+	std::vector<uint8_t> data;
+
+	/// Offset of the blob in data
+	size_t blob_offset{0};
+};
+}        // namespace vkb
@@ -17,16 +17,19 @@
 
 #include "image.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <mutex>
 
 #include "common/error.h"
 
 VKBP_DISABLE_WARNINGS()
-#define STB_IMAGE_RESIZE_IMPLEMENTATION
-#include <stb_image_resize.h>
+#include "common/glm_common.h"
 VKBP_ENABLE_WARNINGS()
 
 #include "common/utils.h"
+#include "job_system.h"
 #include "platform/filesystem.h"
 #include "scene_graph/components/image/astc.h"
 #include "scene_graph/components/image/ktx.h"
@@ -36,6 +39,179 @@ namespace vkb
 {
 namespace sg
 {
+namespace
+{
+/// Levels with fewer texels are downsampled on the calling thread
+constexpr uint32_t parallel_mipmap_texel_count = 256 * 256;
+
+/// Approximate number of texels downsampled by each job
+constexpr uint32_t mipmap_batch_texel_count = 64 * 1024;
+
+/**
+ * @brief Texels of a level covering a texel of the next level along one axis, with their weights
+ */
+struct FilterTaps
+{
+	std::array<uint32_t, 3> indices;
+
+	std::array<float, 3> weights;
+
+	uint32_t count;
+};
+
+/**
+ * @brief Computes the box filter taps of each texel of the next level along one axis. Odd sizes use three taps
+ *        so that each texel covers exactly (2n + 1) / n texels of the previous level, and no texel is skipped.
+ */
+std::vector<FilterTaps> get_filter_taps(uint32_t size, uint32_t next_size)
+{
+	std::vector<FilterTaps> taps(next_size);
+
+	for (uint32_t i = 0; i < next_size; ++i)
+	{
+		if (size == 1)
+		{
+			taps[i] = {{0, 0, 0}, {1.0f, 0.0f, 0.0f}, 1};
+		}
+		else if (size % 2 == 0)
+		{
+			taps[i] = {{2 * i, 2 * i + 1, 0}, {0.5f, 0.5f, 0.0f}, 2};
+		}
+		else
+		{
+			float n = static_cast<float>(next_size);
+			float x = static_cast<float>(i);
+			taps[i] = {{2 * i, 2 * i + 1, 2 * i + 2}, {(n - x) / (2.0f * n + 1.0f), n / (2.0f * n + 1.0f), (x + 1.0f) / (2.0f * n + 1.0f)}, 3};
+		}
+	}
+
+	return taps;
+}
+
+float srgb_to_linear(float value)
+{
+	return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+/**
+ * @brief Tables converting between 8-bit sRGB and linear values
+ */
+struct SrgbTables
+{
+	SrgbTables()
+	{
+		for (uint32_t i = 0; i < 256; ++i)
+		{
+			to_linear[i] = srgb_to_linear(i / 255.0f);
+		}
+
+		for (uint32_t i = 0; i < 255; ++i)
+		{
+			thresholds[i] = srgb_to_linear((i + 0.5f) / 255.0f);
+		}
+	}
+
+	uint8_t to_srgb(float value) const
+	{
+		return static_cast<uint8_t>(std::upper_bound(thresholds.begin(), thresholds.end(), value) - thresholds.begin());
+	}
+
+	std::array<float, 256> to_linear;
+
+	/// Linear value halfway between two consecutive sRGB values, so that the result rounds in sRGB space
+	std::array<float, 255> thresholds;
+};
+
+const SrgbTables &get_srgb_tables()
+{
+	static const SrgbTables tables;
+	return tables;
+}
+
+bool is_srgb_rgba8(VkFormat format)
+{
+	return format == VK_FORMAT_R8G8B8A8_SRGB ||
+	       format == VK_FORMAT_B8G8R8A8_SRGB ||
+	       format == VK_FORMAT_A8B8G8R8_SRGB_PACK32;
+}
+
+/**
+ * @brief Box filters rows [first_row, last_row) of the next level from the RGBA8 texels of a level.
+ *        Color channels of sRGB images are averaged in linear space, alpha is always linear.
+ */
+void downsample_rows(const uint8_t *src, uint32_t src_width, uint8_t *dst, uint32_t dst_width,
+                     const std::vector<FilterTaps> &x_taps, const std::vector<FilterTaps> &y_taps,
+                     uint32_t first_row, uint32_t last_row, bool srgb)
+{
+	const SrgbTables *tables = srgb ? &get_srgb_tables() : nullptr;
+
+	// Texels of the source rows converted to float once, reused by every texel of a destination row
+	std::vector<glm::vec4> row(src_width);
+	std::vector<glm::vec4> sum(dst_width);
+
+	auto decode = [tables](const uint8_t *texel) {
+		if (tables)
+		{
+			return glm::vec4(tables->to_linear[texel[0]], tables->to_linear[texel[1]], tables->to_linear[texel[2]], texel[3] / 255.0f);
+		}
+		return glm::vec4(texel[0], texel[1], texel[2], texel[3]) / 255.0f;
+	};
+
+	for (uint32_t y = first_row; y < last_row; ++y)
+	{
+		std::fill(sum.begin(), sum.end(), glm::vec4(0.0f));
+
+		auto &y_tap = y_taps[y];
+
+		for (uint32_t j = 0; j < y_tap.count; ++j)
+		{
+			const uint8_t *src_row = src + static_cast<size_t>(y_tap.indices[j]) * src_width * 4;
+
+			for (uint32_t x = 0; x < src_width; ++x)
+			{
+				row[x] = decode(src_row + x * 4);
+			}
+
+			for (uint32_t x = 0; x < dst_width; ++x)
+			{
+				auto &x_tap = x_taps[x];
+
+				glm::vec4 value{0.0f};
+				for (uint32_t i = 0; i < x_tap.count; ++i)
+				{
+					value += row[x_tap.indices[i]] * x_tap.weights[i];
+				}
+
+				sum[x] += value * y_tap.weights[j];
+			}
+		}
+
+		uint8_t *dst_row = dst + static_cast<size_t>(y) * dst_width * 4;
+
+		for (uint32_t x = 0; x < dst_width; ++x)
+		{
+			glm::vec4 value = glm::clamp(sum[x], 0.0f, 1.0f);
+			uint8_t  *texel = dst_row + x * 4;
+
+			if (tables)
+			{
+				texel[0] = tables->to_srgb(value.r);
+				texel[1] = tables->to_srgb(value.g);
+				texel[2] = tables->to_srgb(value.b);
+			}
+			else
+			{
+				texel[0] = static_cast<uint8_t>(value.r * 255.0f + 0.5f);
+				texel[1] = static_cast<uint8_t>(value.g * 255.0f + 0.5f);
+				texel[2] = static_cast<uint8_t>(value.b * 255.0f + 0.5f);
+			}
+
+			texel[3] = static_cast<uint8_t>(value.a * 255.0f + 0.5f);
+		}
+	}
+}
+}        // namespace
+
 bool is_astc(const VkFormat format)
 {
 	return (format == VK_FORMAT_ASTC_4x4_UNORM_BLOCK ||
@@ -236,7 +412,7 @@ Mipmap &Image::get_mipmap(const size_t index)
 	return mipmaps[index];
 }
 
-void Image::generate_mipmaps()
+void Image::generate_mipmaps(JobSystem *job_system)
 {
 	assert(mipmaps.size() == 1 && "Mipmaps already generated");
 
@@ -245,40 +421,58 @@ void Image::generate_mipmaps()
 		return;        // Do not generate again
 	}
 
-	auto extent      = get_extent();
-	auto next_width  = std::max<uint32_t>(1u, extent.width / 2);
-	auto next_height = std::max<uint32_t>(1u, extent.height / 2);
-	auto channels    = 4;
-	auto next_size   = next_width * next_height * channels;
+	const uint32_t channels = 4;
+
+	// Lay out the whole chain first, so that the data is allocated once
+	auto extent = get_extent();
+	auto offset = data.size();
 
-	while (true)
+	while (extent.width > 1 || extent.height > 1)
 	{
-		// Make space for next mipmap
-		auto old_size = to_u32(data.size());
-		data.resize(old_size + next_size);
+		extent = {std::max<uint32_t>(1u, extent.width / 2), std::max<uint32_t>(1u, extent.height / 2), 1u};
 
-		auto &prev_mipmap = mipmaps.back();
-		// Update mipmaps
 		Mipmap next_mipmap{};
-		next_mipmap.level  = prev_mipmap.level + 1;
-		next_mipmap.offset = old_size;
-		next_mipmap.extent = {next_width, next_height, 1u};
+		next_mipmap.level  = mipmaps.back().level + 1;
+		next_mipmap.offset = to_u32(offset);
+		next_mipmap.extent = extent;
 
-		// Fill next mipmap memory
-		stbir_resize_uint8(data.data() + prev_mipmap.offset, prev_mipmap.extent.width, prev_mipmap.extent.height, 0,
-		                   data.data() + next_mipmap.offset, next_mipmap.extent.width, next_mipmap.extent.height, 0, channels);
+		mipmaps.push_back(next_mipmap);
 
-		mipmaps.emplace_back(std::move(next_mipmap));
+		offset += static_cast<size_t>(extent.width) * extent.height * channels;
+	}
+
+	data.resize(offset);
+
+	bool srgb = is_srgb_rgba8(format);
+
+	for (size_t i = 1; i < mipmaps.size(); ++i)
+	{
+		auto &prev_mipmap = mipmaps[i - 1];
+		auto &mipmap      = mipmaps[i];
 
-		// Next mipmap values
-		next_width  = std::max<uint32_t>(1u, next_width / 2);
-		next_height = std::max<uint32_t>(1u, next_height / 2);
-		next_size   = next_width * next_height * channels;
+		auto x_taps = get_filter_taps(prev_mipmap.extent.width, mipmap.extent.width);
+		auto y_taps = get_filter_taps(prev_mipmap.extent.height, mipmap.extent.height);
 
-		if (next_width == 1 && next_height == 1)
+		const uint8_t *src = data.data() + prev_mipmap.offset;
+		uint8_t       *dst = data.data() + mipmap.offset;
+
+		auto downsample = [&](size_t first_row, size_t last_row, size_t) {
+			downsample_rows(src, prev_mipmap.extent.width, dst, mipmap.extent.width, x_taps, y_taps, to_u32(first_row), to_u32(last_row), srgb);
+		};
+
+		uint32_t height = mipmap.extent.height;
+
+		if (!job_system || mipmap.extent.width * height < parallel_mipmap_texel_count)
 		{
-			break;
+			downsample(0, height, 0);
+			continue;
 		}
+
+		// Bands of rows are independent, each level depends on the previous one though. Waiting from
+		// a job, e.g. an image decode of the loader, runs other jobs rather than blocking the worker.
+		uint32_t band_height = std::max(1u, mipmap_batch_texel_count / mipmap.extent.width);
+
+		job_system->wait(job_system->parallel_for(height, band_height, downsample));
 	}
 }
 
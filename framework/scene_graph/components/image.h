@@ -30,6 +30,8 @@
 
 namespace vkb
 {
+class JobSystem;
+
 namespace sg
 {
 /**
@@ -92,7 +94,11 @@ class Image : public Component
 
 	const std::vector<std::vector<VkDeviceSize>> &get_offsets() const;
 
-	void generate_mipmaps();
+	/**
+	 * @brief Generates the mip chain from the first level
+	 * @param job_system If not null, the rows of large levels are downsampled by jobs of the job system
+	 */
+	void generate_mipmaps(JobSystem *job_system = nullptr);
 
 	void create_vk_image(Device const &device, VkImageViewType image_view_type = VK_IMAGE_VIEW_TYPE_2D, VkImageCreateFlags flags = 0);
 
@@ -54,6 +54,39 @@ bool SubMesh::get_attribute(const std::string &attribute_name, VertexAttribute &
 	return true;
 }
 
+const core::Buffer *SubMesh::get_vertex_buffer(const std::string &name, VkDeviceSize &offset) const
+{
+	auto buffer_it = vertex_buffers.find(name);
+
+	if (buffer_it != vertex_buffers.end())
+	{
+		offset = 0;
+		return &buffer_it->second;
+	}
+
+	auto range_it = vertex_buffer_ranges.find(name);
+
+	if (range_it != vertex_buffer_ranges.end())
+	{
+		offset = range_it->second.offset;
+		return range_it->second.buffer.get();
+	}
+
+	return nullptr;
+}
+
+const core::Buffer *SubMesh::get_index_buffer(VkDeviceSize &offset) const
+{
+	if (index_buffer)
+	{
+		offset = index_offset;
+		return index_buffer.get();
+	}
+
+	offset = index_buffer_range.offset + index_offset;
+	return index_buffer_range.buffer.get();
+}
+
 void SubMesh::set_material(const Material &new_material)
 {
 	material = &new_material;
@@ -92,6 +125,19 @@ void SubMesh::compute_shader_variant()
 		std::transform(attrib_name.begin(), attrib_name.end(), attrib_name.begin(), ::toupper);
 		shader_variant.add_define("HAS_" + attrib_name);
 	}
+
+	// Quantized attributes are recognized by their format
+	VertexAttribute attribute;
+
+	if (get_attribute("position", attribute) && attribute.format == VK_FORMAT_R16G16B16A16_UNORM)
+	{
+		shader_variant.add_define("QUANTIZED_POSITION");
+	}
+
+	if (get_attribute("normal", attribute) && attribute.format == VK_FORMAT_R16G16_SNORM)
+	{
+		shader_variant.add_define("OCTAHEDRAL_NORMAL");
+	}
 }
 
 ShaderVariant &SubMesh::get_mut_shader_variant()
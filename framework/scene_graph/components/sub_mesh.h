@@ -23,6 +23,12 @@
 #include <unordered_map>
 #include <vector>
 
+#include "common/error.h"
+
+VKBP_DISABLE_WARNINGS()
+#include "common/glm_common.h"
+VKBP_ENABLE_WARNINGS()
+
 #include "common/vk_common.h"
 #include "core/buffer.h"
 #include "core/shader_module.h"
@@ -34,6 +40,9 @@ namespace sg
 {
 class Material;
 
+/// Name of the vertex buffer holding all attributes of a submesh with interleaved vertices
+constexpr const char *INTERLEAVED_VERTEX_BUFFER = "interleaved";
+
 struct VertexAttribute
 {
 	VkFormat format = VK_FORMAT_UNDEFINED;
@@ -43,6 +52,18 @@ struct VertexAttribute
 	std::uint32_t offset = 0;
 };
 
+/**
+ * @brief A range of a buffer shared between several submeshes
+ */
+struct BufferRange
+{
+	std::shared_ptr<core::Buffer> buffer;
+
+	VkDeviceSize offset = 0;
+
+	VkDeviceSize size = 0;
+};
+
 class SubMesh : public Component
 {
   public:
@@ -64,6 +85,32 @@ class SubMesh : public Component
 
 	std::unique_ptr<core::Buffer> index_buffer;
 
+	/// Vertex attributes suballocated from buffers shared with other submeshes, used instead of vertex_buffers
+	std::unordered_map<std::string, BufferRange> vertex_buffer_ranges;
+
+	/// Indices suballocated from a buffer shared with other submeshes, used instead of index_buffer
+	BufferRange index_buffer_range;
+
+	/// Decodes positions stored as normalized values: position = position_offset + position_scale * stored position
+	glm::vec3 position_offset{0.0f};
+
+	glm::vec3 position_scale{1.0f};
+
+	/**
+	 * @brief Finds the buffer holding a vertex attribute, whether it is owned by the submesh or shared
+	 * @param name Name of the vertex attribute
+	 * @param offset Set to the offset in bytes of the attribute data in the buffer
+	 * @return The buffer, or nullptr if the submesh has no data for the attribute
+	 */
+	const core::Buffer *get_vertex_buffer(const std::string &name, VkDeviceSize &offset) const;
+
+	/**
+	 * @brief Finds the buffer holding the indices, whether it is owned by the submesh or shared
+	 * @param offset Set to the offset in bytes of the first index in the buffer, index_offset included
+	 * @return The buffer, or nullptr if the submesh has no indices
+	 */
+	const core::Buffer *get_index_buffer(VkDeviceSize &offset) const;
+
 	void set_attribute(const std::string &name, const VertexAttribute &attribute);
 
 	bool get_attribute(const std::string &name, VertexAttribute &attribute) const;
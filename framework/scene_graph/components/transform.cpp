@@ -104,7 +104,24 @@ glm::mat4 Transform::get_world_matrix()
 
 void Transform::invalidate_world_matrix()
 {
+	// Descendants were invalidated with this transform and cannot have been updated since
+	if (update_world_matrix)
+	{
+		return;
+	}
+
 	update_world_matrix = true;
+	++world_matrix_version;
+
+	for (auto child : node.get_children())
+	{
+		child->get_transform().invalidate_world_matrix();
+	}
+}
+
+uint32_t Transform::get_world_matrix_version() const
+{
+	return world_matrix_version;
 }
 
 void Transform::update_world_transform()
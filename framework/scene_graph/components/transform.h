@@ -69,10 +69,17 @@ class Transform : public Component
 	/**
 	 * @brief Marks the world transform invalid if any of
 	 *        the local transform are changed or the parent
-	 *        world transform has changed.
+	 *        world transform has changed. Children are
+	 *        invalidated as well.
 	 */
 	void invalidate_world_matrix();
 
+	/**
+	 * @brief Incremented every time the world transform is invalidated,
+	 *        so that changes can be detected without recomputing it
+	 */
+	uint32_t get_world_matrix_version() const;
+
   private:
 	Node &node;
 
@@ -86,6 +93,8 @@ class Transform : public Component
 
 	bool update_world_matrix = false;
 
+	uint32_t world_matrix_version = 0;
+
 	void update_world_transform();
 };
 
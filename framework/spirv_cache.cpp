@@ -0,0 +1,358 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "spirv_cache.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "common/helpers.h"
+#include "common/logging.h"
+#include "platform/filesystem.h"
+
+namespace vkb
+{
+namespace
+{
+constexpr uint32_t    entry_magic   = 0x53424b56;        // "VKBS"
+constexpr uint32_t    entry_version = 1;
+constexpr uint32_t    spirv_magic   = 0x07230203;
+constexpr const char *index_file    = "spirv_cache.index";
+
+struct EntryHeader
+{
+	uint32_t magic;
+
+	uint32_t version;
+
+	uint64_t address;
+
+	uint64_t check;
+
+	uint64_t word_count;
+};
+
+std::string get_entry_filename(uint64_t address)
+{
+	return fmt::format("spirv_cache_{:016x}.spv", address);
+}
+}        // namespace
+
+constexpr uint64_t SpirvCache::default_size_limit;
+constexpr uint32_t SpirvCache::index_flush_interval;
+
+SpirvCache::SpirvCache(uint64_t size_limit) :
+    size_limit{size_limit}
+{
+}
+
+SpirvCache::Key SpirvCache::make_key(const std::string &             compiler_version,
+                                     uint32_t                        stage,
+                                     const std::vector<uint8_t> &    glsl_source,
+                                     const std::string &             entry_point,
+                                     const std::string &             preamble,
+                                     const std::vector<std::string> &processes,
+                                     uint32_t                        target_language,
+                                     uint32_t                        target_language_version)
+{
+	// Same material hashed from two different offset bases
+	Fnv1a address_hash{0xcbf29ce484222325ull};
+	Fnv1a check_hash{0x84222325cbf29ce4ull};
+
+	for (auto *hash : {&address_hash, &check_hash})
+	{
+		hash->add(entry_version);
+		hash->add(compiler_version);
+		hash->add(stage);
+		hash->add(target_language);
+		hash->add(target_language_version);
+		hash->add(entry_point);
+		hash->add(preamble);
+
+		for (auto &process : processes)
+		{
+			hash->add(process);
+		}
+
+		uint64_t source_size = glsl_source.size();
+		hash->add(&source_size, sizeof(source_size));
+		hash->add(glsl_source.data(), glsl_source.size());
+	}
+
+	return {address_hash.get(), check_hash.get()};
+}
+
+bool SpirvCache::load(const Key &key, std::vector<uint32_t> &spirv)
+{
+	std::lock_guard<std::mutex> guard(mutex);
+
+	load_index();
+
+	auto entry = find_entry(key.address);
+
+	if (entry == entries.end())
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> data;
+
+	try
+	{
+		data = fs::read_temp(get_entry_filename(key.address));
+	}
+	catch (const std::exception &)
+	{
+		remove_entry(entry);
+		return false;
+	}
+
+	EntryHeader header{};
+
+	bool valid = data.size() >= sizeof(header);
+
+	if (valid)
+	{
+		std::memcpy(&header, data.data(), sizeof(header));
+
+		// Compared to the file size by division, so that a corrupt word count cannot overflow
+		auto payload_size = data.size() - sizeof(header);
+
+		valid = header.magic == entry_magic &&
+		        header.version == entry_version &&
+		        header.address == key.address &&
+		        header.check == key.check &&
+		        header.word_count > 0 &&
+		        payload_size % sizeof(uint32_t) == 0 &&
+		        header.word_count == payload_size / sizeof(uint32_t);
+	}
+
+	if (valid)
+	{
+		spirv.resize(static_cast<size_t>(header.word_count));
+		std::memcpy(spirv.data(), data.data() + sizeof(header), spirv.size() * sizeof(uint32_t));
+
+		valid = spirv.front() == spirv_magic;
+	}
+
+	if (!valid)
+	{
+		LOGW("Discarding invalid SPIR-V cache entry {}", get_entry_filename(key.address));
+
+		spirv.clear();
+		remove_entry(entry);
+
+		return false;
+	}
+
+	// Mark as most recently used
+	entries.splice(entries.end(), entries, entry);
+	index_dirty = true;
+
+	return true;
+}
+
+void SpirvCache::store(const Key &key, const std::vector<uint32_t> &spirv)
+{
+	if (spirv.empty())
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(mutex);
+
+	load_index();
+
+	EntryHeader header{entry_magic, entry_version, key.address, key.check, static_cast<uint64_t>(spirv.size())};
+
+	std::vector<uint8_t> data(sizeof(header) + spirv.size() * sizeof(uint32_t));
+	std::memcpy(data.data(), &header, sizeof(header));
+	std::memcpy(data.data() + sizeof(header), spirv.data(), spirv.size() * sizeof(uint32_t));
+
+	try
+	{
+		fs::write_temp(data, get_entry_filename(key.address));
+	}
+	catch (const std::exception &e)
+	{
+		LOGW("Could not write SPIR-V cache entry: {}", e.what());
+		return;
+	}
+
+	auto entry = find_entry(key.address);
+
+	if (entry != entries.end())
+	{
+		total_size -= entry->size;
+		entries.erase(entry);
+	}
+
+	entries.push_back({key.address, static_cast<uint64_t>(data.size())});
+	total_size += data.size();
+
+	evict();
+
+	index_dirty = true;
+
+	if (++unsaved_store_count >= index_flush_interval)
+	{
+		save_index();
+	}
+}
+
+void SpirvCache::set_size_limit(uint64_t new_size_limit)
+{
+	std::lock_guard<std::mutex> guard(mutex);
+
+	size_limit = new_size_limit;
+
+	if (index_loaded)
+	{
+		evict();
+		save_index();
+	}
+}
+
+void SpirvCache::flush()
+{
+	std::lock_guard<std::mutex> guard(mutex);
+
+	if (index_dirty)
+	{
+		save_index();
+	}
+}
+
+void SpirvCache::clear()
+{
+	std::lock_guard<std::mutex> guard(mutex);
+
+	load_index();
+
+	while (!entries.empty())
+	{
+		remove_entry(entries.begin());
+	}
+
+	save_index();
+}
+
+void SpirvCache::load_index()
+{
+	if (index_loaded)
+	{
+		return;
+	}
+
+	index_loaded = true;
+
+	std::vector<uint8_t> data;
+
+	try
+	{
+		data = fs::read_temp(index_file);
+	}
+	catch (const std::exception &)
+	{
+		// No cache yet
+		return;
+	}
+
+	std::istringstream is{std::string{data.begin(), data.end()}};
+
+	uint32_t magic{0};
+	uint32_t version{0};
+	read(is, magic, version);
+
+	if (!is || magic != entry_magic || version != entry_version)
+	{
+		LOGW("Ignoring SPIR-V cache index with unknown format");
+		return;
+	}
+
+	// The entry count is only trusted if the index is large enough to hold that many entries
+	std::size_t entry_count{0};
+	read(is, entry_count);
+
+	if (!is || entry_count > (data.size() - static_cast<size_t>(is.tellg())) / sizeof(Entry))
+	{
+		LOGW("Ignoring truncated SPIR-V cache index");
+		return;
+	}
+
+	std::vector<Entry> stored_entries(entry_count);
+	is.read(reinterpret_cast<char *>(stored_entries.data()), entry_count * sizeof(Entry));
+
+	if (!is)
+	{
+		LOGW("Ignoring truncated SPIR-V cache index");
+		return;
+	}
+
+	for (auto &entry : stored_entries)
+	{
+		entries.push_back(entry);
+		total_size += entry.size;
+	}
+}
+
+void SpirvCache::save_index()
+{
+	index_dirty         = false;
+	unsaved_store_count = 0;
+
+	std::ostringstream os;
+
+	write(os, entry_magic, entry_version);
+	write(os, std::vector<Entry>{entries.begin(), entries.end()});
+
+	auto                 index = os.str();
+	std::vector<uint8_t> data{index.begin(), index.end()};
+
+	try
+	{
+		fs::write_temp(data, index_file);
+	}
+	catch (const std::exception &e)
+	{
+		LOGW("Could not write SPIR-V cache index: {}", e.what());
+	}
+}
+
+void SpirvCache::evict()
+{
+	while (total_size > size_limit && !entries.empty())
+	{
+		remove_entry(entries.begin());
+	}
+}
+
+std::list<SpirvCache::Entry>::iterator SpirvCache::find_entry(uint64_t address)
+{
+	return std::find_if(entries.begin(), entries.end(), [address](const Entry &entry) { return entry.address == address; });
+}
+
+void SpirvCache::remove_entry(std::list<Entry>::iterator entry)
+{
+	std::remove((fs::path::get(fs::path::Type::Temp) + get_entry_filename(entry->address)).c_str());
+
+	total_size -= entry->size;
+	entries.erase(entry);
+
+	index_dirty = true;
+}
+}        // namespace vkb
@@ -0,0 +1,138 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vkb
+{
+/**
+ * @brief Persistent cache of compiled SPIR-V, stored in the temporary directory.
+ *        Entries are addressed by a hash of everything that affects compilation
+ *        (compiler version, expanded source, variant preamble and processes, stage,
+ *        entry point and target environment), so an edited shader or an updated
+ *        compiler never hits a stale entry.
+ *        The least recently used entries are evicted once the size limit is exceeded.
+ *        The index of the entries is written in batches, and on flush().
+ */
+class SpirvCache
+{
+  public:
+	/**
+	 * @brief Key material of a cache entry, hashed twice with independent seeds:
+	 *        once to address the entry and once to validate it on load
+	 */
+	struct Key
+	{
+		uint64_t address{0};
+
+		uint64_t check{0};
+	};
+
+	static constexpr uint64_t default_size_limit = 64 * 1024 * 1024;
+
+	/// Number of stores after which the index is written, without waiting for flush()
+	static constexpr uint32_t index_flush_interval = 32;
+
+	SpirvCache(uint64_t size_limit = default_size_limit);
+
+	SpirvCache(const SpirvCache &) = delete;
+
+	SpirvCache(SpirvCache &&) = delete;
+
+	SpirvCache &operator=(const SpirvCache &) = delete;
+
+	SpirvCache &operator=(SpirvCache &&) = delete;
+
+	/**
+	 * @brief Creates the key of a compilation from all of its inputs
+	 * @param compiler_version Version of the compiler, so that an updated compiler does not reuse old binaries
+	 */
+	static Key make_key(const std::string &             compiler_version,
+	                    uint32_t                        stage,
+	                    const std::vector<uint8_t> &    glsl_source,
+	                    const std::string &             entry_point,
+	                    const std::string &             preamble,
+	                    const std::vector<std::string> &processes,
+	                    uint32_t                        target_language,
+	                    uint32_t                        target_language_version);
+
+	/**
+	 * @brief Loads a cached SPIR-V binary
+	 * @param key The key of the compilation
+	 * @param[out] spirv The cached SPIR-V code
+	 * @return True if a valid entry was found, false otherwise
+	 */
+	bool load(const Key &key, std::vector<uint32_t> &spirv);
+
+	/**
+	 * @brief Stores a SPIR-V binary, evicting old entries if the cache grows over its size limit
+	 */
+	void store(const Key &key, const std::vector<uint32_t> &spirv);
+
+	void set_size_limit(uint64_t size_limit);
+
+	/**
+	 * @brief Writes the index if it changed since it was last written
+	 */
+	void flush();
+
+	/**
+	 * @brief Removes every entry from the cache, in memory and on disk
+	 */
+	void clear();
+
+  private:
+	struct Entry
+	{
+		uint64_t address;
+
+		uint64_t size;
+	};
+
+	std::mutex mutex;
+
+	uint64_t size_limit;
+
+	uint64_t total_size{0};
+
+	bool index_loaded{false};
+
+	/// Whether the entries changed since the index was last written
+	bool index_dirty{false};
+
+	uint32_t unsaved_store_count{0};
+
+	/// Entries ordered from least to most recently used
+	std::list<Entry> entries;
+
+	void load_index();
+
+	void save_index();
+
+	void evict();
+
+	std::list<Entry>::iterator find_entry(uint64_t address);
+
+	void remove_entry(std::list<Entry>::iterator entry);
+};
+}        // namespace vkb
@@ -0,0 +1,481 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "staging_ring.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "common/logging.h"
+#include "core/device.h"
+#include "core/image.h"
+#include "core/image_view.h"
+#include "timer.h"
+
+namespace vkb
+{
+namespace
+{
+// Image copies must start on a multiple of the texel block size, which is at most 16 bytes for the formats loaded by sg::Image
+constexpr VkDeviceSize IMAGE_OFFSET_ALIGNMENT = 16;
+}        // namespace
+
+StagingRing::StagingRing(const Device &device, VkDeviceSize slot_size, uint32_t slot_count, bool use_transfer_queue) :
+    device{device},
+    graphics_queue{device.get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0)},
+    copy_queue{&graphics_queue},
+    slot_size{slot_size}
+{
+	assert(slot_size > 0 && slot_count > 0);
+
+	if (use_transfer_queue)
+	{
+		const auto &queue_families = device.get_gpu().get_queue_family_properties();
+
+		for (uint32_t i = 0; i < to_u32(queue_families.size()); ++i)
+		{
+			const auto &family      = queue_families[i];
+			const auto &granularity = family.minImageTransferGranularity;
+
+			// Mip levels can be smaller than a coarser transfer granularity
+			if ((family.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(family.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) &&
+			    family.queueCount > 0 && granularity.width == 1 && granularity.height == 1 && granularity.depth == 1)
+			{
+				copy_queue = &device.get_queue(i, 0);
+				break;
+			}
+		}
+
+		if (!is_using_transfer_queue())
+		{
+			LOGI("No suitable dedicated transfer queue, uploading on the graphics queue");
+		}
+	}
+
+	VkCommandPoolCreateInfo command_pool_info{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+	command_pool_info.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	command_pool_info.queueFamilyIndex = copy_queue->get_family_index();
+	VK_CHECK(vkCreateCommandPool(device.get_handle(), &command_pool_info, nullptr, &command_pool));
+
+	if (is_using_transfer_queue())
+	{
+		command_pool_info.queueFamilyIndex = graphics_queue.get_family_index();
+		VK_CHECK(vkCreateCommandPool(device.get_handle(), &command_pool_info, nullptr, &acquire_command_pool));
+	}
+
+	VkCommandBufferAllocateInfo allocate_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+	allocate_info.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocate_info.commandBufferCount = 1;
+
+	VkFenceCreateInfo     fence_info{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+	VkSemaphoreCreateInfo semaphore_info{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+
+	slots.resize(slot_count);
+
+	for (uint32_t i = 0; i < slot_count; ++i)
+	{
+		auto &slot = slots[i];
+
+		slot.buffer = std::make_unique<core::Buffer>(device,
+		                                             slot_size,
+		                                             VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		                                             VMA_MEMORY_USAGE_CPU_ONLY);
+		slot.buffer->set_debug_name(fmt::format("staging ring slot #{}", i));
+
+		allocate_info.commandPool = command_pool;
+		VK_CHECK(vkAllocateCommandBuffers(device.get_handle(), &allocate_info, &slot.command_buffer));
+
+		VK_CHECK(vkCreateFence(device.get_handle(), &fence_info, nullptr, &slot.fence));
+
+		if (is_using_transfer_queue())
+		{
+			allocate_info.commandPool = acquire_command_pool;
+			VK_CHECK(vkAllocateCommandBuffers(device.get_handle(), &allocate_info, &slot.acquire_command_buffer));
+
+			VK_CHECK(vkCreateSemaphore(device.get_handle(), &semaphore_info, nullptr, &slot.semaphore));
+		}
+	}
+}
+
+StagingRing::~StagingRing()
+{
+	for (auto &slot : slots)
+	{
+		wait(slot);
+
+		vkDestroyFence(device.get_handle(), slot.fence, nullptr);
+
+		if (slot.semaphore != VK_NULL_HANDLE)
+		{
+			vkDestroySemaphore(device.get_handle(), slot.semaphore, nullptr);
+		}
+	}
+
+	// Destroying the pools frees their command buffers
+	vkDestroyCommandPool(device.get_handle(), command_pool, nullptr);
+
+	if (acquire_command_pool != VK_NULL_HANDLE)
+	{
+		vkDestroyCommandPool(device.get_handle(), acquire_command_pool, nullptr);
+	}
+}
+
+void StagingRing::copy_to_buffer(const uint8_t *data, VkDeviceSize size, const core::Buffer &dst_buffer, VkDeviceSize dst_offset)
+{
+	assert(dst_offset + size <= dst_buffer.get_size());
+
+	VkDeviceSize copied = 0;
+
+	while (copied < size)
+	{
+		auto &slot = acquire_slot();
+
+		VkDeviceSize chunk_size = std::min(size - copied, slot_size - slot.used);
+
+		slot.buffer->update(data + copied, static_cast<size_t>(chunk_size), static_cast<size_t>(slot.used));
+
+		VkBufferCopy region{slot.used, dst_offset + copied, chunk_size};
+
+		auto copies_it = std::find_if(slot.buffer_copies.begin(), slot.buffer_copies.end(),
+		                              [&dst_buffer](const std::pair<const core::Buffer *, std::vector<VkBufferCopy>> &copies) { return copies.first == &dst_buffer; });
+
+		if (copies_it == slot.buffer_copies.end())
+		{
+			slot.buffer_copies.emplace_back(&dst_buffer, std::vector<VkBufferCopy>{region});
+		}
+		else
+		{
+			// Consecutive uploads into a buffer are usually contiguous on both sides, and merge into one region
+			auto &last = copies_it->second.back();
+
+			if (last.srcOffset + last.size == region.srcOffset && last.dstOffset + last.size == region.dstOffset)
+			{
+				last.size += region.size;
+			}
+			else
+			{
+				copies_it->second.push_back(region);
+			}
+		}
+
+		slot.used += chunk_size;
+		copied += chunk_size;
+
+		if (slot.used == slot_size)
+		{
+			submit();
+		}
+	}
+
+	uploaded_size += size;
+}
+
+void StagingRing::copy_to_image(const uint8_t *data, VkDeviceSize size, const core::ImageView &image_view, std::vector<VkBufferImageCopy> regions)
+{
+	const core::Buffer *src_buffer = nullptr;
+	VkDeviceSize        src_offset = 0;
+
+	bool large = size > slot_size;
+
+	if (large)
+	{
+		auto &slot = acquire_slot();
+
+		auto large_buffer = std::make_unique<core::Buffer>(device,
+		                                                   size,
+		                                                   VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		                                                   VMA_MEMORY_USAGE_CPU_ONLY);
+		large_buffer->update(data, static_cast<size_t>(size));
+
+		src_buffer = large_buffer.get();
+
+		slot.large_buffers.push_back(std::move(large_buffer));
+	}
+	else
+	{
+		auto *slot = &acquire_slot();
+
+		src_offset = (slot->used + IMAGE_OFFSET_ALIGNMENT - 1) & ~(IMAGE_OFFSET_ALIGNMENT - 1);
+
+		if (src_offset + size > slot_size)
+		{
+			submit();
+
+			slot       = &acquire_slot();
+			src_offset = 0;
+		}
+
+		slot->buffer->update(data, static_cast<size_t>(size), static_cast<size_t>(src_offset));
+		slot->used = src_offset + size;
+
+		src_buffer = slot->buffer.get();
+	}
+
+	for (auto &region : regions)
+	{
+		region.bufferOffset += src_offset;
+	}
+
+	slots[current_slot].image_copies.push_back({&image_view, src_buffer, std::move(regions)});
+
+	uploaded_size += size;
+
+	// Submit right away, so that the temporary buffer is released as soon as possible
+	if (large || slots[current_slot].used == slot_size)
+	{
+		submit();
+	}
+}
+
+void StagingRing::submit()
+{
+	auto &slot = slots[current_slot];
+
+	if (slot.buffer_copies.empty() && slot.image_copies.empty())
+	{
+		return;
+	}
+
+	slot.buffer->flush();
+
+	VkCommandBufferBeginInfo begin_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	VK_CHECK(vkBeginCommandBuffer(slot.command_buffer, &begin_info));
+
+	if (!slot.image_copies.empty())
+	{
+		std::vector<VkImageMemoryBarrier> image_barriers;
+		image_barriers.reserve(slot.image_copies.size());
+
+		for (auto &image_copy : slot.image_copies)
+		{
+			VkImageMemoryBarrier image_barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+			image_barrier.srcAccessMask       = 0;
+			image_barrier.dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+			image_barrier.oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED;
+			image_barrier.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			image_barrier.image               = image_copy.image_view->get_image().get_handle();
+			image_barrier.subresourceRange    = image_copy.image_view->get_subresource_range();
+
+			image_barriers.push_back(image_barrier);
+		}
+
+		vkCmdPipelineBarrier(slot.command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		                     0, nullptr, 0, nullptr, to_u32(image_barriers.size()), image_barriers.data());
+	}
+
+	for (auto &copies : slot.buffer_copies)
+	{
+		vkCmdCopyBuffer(slot.command_buffer, slot.buffer->get_handle(), copies.first->get_handle(), to_u32(copies.second.size()), copies.second.data());
+	}
+
+	for (auto &image_copy : slot.image_copies)
+	{
+		vkCmdCopyBufferToImage(slot.command_buffer, image_copy.src_buffer->get_handle(), image_copy.image_view->get_image().get_handle(),
+		                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, to_u32(image_copy.regions.size()), image_copy.regions.data());
+	}
+
+	record_post_copy_barriers(slot.command_buffer, slot, false);
+
+	VK_CHECK(vkEndCommandBuffer(slot.command_buffer));
+
+	VkSubmitInfo submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+	submit_info.commandBufferCount = 1;
+	submit_info.pCommandBuffers    = &slot.command_buffer;
+
+	if (!is_using_transfer_queue())
+	{
+		submit_graphics(slot, submit_info);
+	}
+	else
+	{
+		submit_info.signalSemaphoreCount = 1;
+		submit_info.pSignalSemaphores    = &slot.semaphore;
+
+		VK_CHECK(copy_queue->submit({submit_info}, VK_NULL_HANDLE));
+
+		VK_CHECK(vkBeginCommandBuffer(slot.acquire_command_buffer, &begin_info));
+		record_post_copy_barriers(slot.acquire_command_buffer, slot, true);
+		VK_CHECK(vkEndCommandBuffer(slot.acquire_command_buffer));
+
+		VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+		VkSubmitInfo acquire_submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+		acquire_submit_info.waitSemaphoreCount = 1;
+		acquire_submit_info.pWaitSemaphores    = &slot.semaphore;
+		acquire_submit_info.pWaitDstStageMask  = &wait_stage;
+		acquire_submit_info.commandBufferCount = 1;
+		acquire_submit_info.pCommandBuffers    = &slot.acquire_command_buffer;
+
+		// Completing the acquire submission implies the copies it waited for completed
+		submit_graphics(slot, acquire_submit_info);
+	}
+
+	slot.in_flight = true;
+	slot.buffer_copies.clear();
+	slot.image_copies.clear();
+
+	++submission_count;
+
+	current_slot = (current_slot + 1) % to_u32(slots.size());
+}
+
+void StagingRing::finish()
+{
+	submit();
+
+	for (auto &slot : slots)
+	{
+		wait(slot);
+	}
+}
+
+bool StagingRing::is_using_transfer_queue() const
+{
+	return copy_queue != &graphics_queue;
+}
+
+VkDeviceSize StagingRing::get_uploaded_size() const
+{
+	return uploaded_size;
+}
+
+uint32_t StagingRing::get_submission_count() const
+{
+	return submission_count;
+}
+
+double StagingRing::get_wait_time() const
+{
+	return wait_time;
+}
+
+StagingRing::Slot &StagingRing::acquire_slot()
+{
+	auto &slot = slots[current_slot];
+
+	wait(slot);
+
+	return slot;
+}
+
+void StagingRing::submit_graphics(Slot &slot, const VkSubmitInfo &submit_info)
+{
+	if (device.has_queue_timelines())
+	{
+		slot.ticket = device.get_queue_timeline(graphics_queue).submit({submit_info});
+	}
+	else
+	{
+		VK_CHECK(vkResetFences(device.get_handle(), 1, &slot.fence));
+		VK_CHECK(graphics_queue.submit({submit_info}, slot.fence));
+	}
+}
+
+void StagingRing::wait(Slot &slot)
+{
+	if (!slot.in_flight)
+	{
+		return;
+	}
+
+	Timer timer;
+	timer.start();
+
+	if (slot.ticket.queue)
+	{
+		VK_CHECK(device.get_queue_timeline(*slot.ticket.queue).wait(slot.ticket.value));
+	}
+	else
+	{
+		VK_CHECK(vkWaitForFences(device.get_handle(), 1, &slot.fence, VK_TRUE, std::numeric_limits<uint64_t>::max()));
+	}
+
+	wait_time += timer.stop();
+
+	slot.in_flight = false;
+	slot.used      = 0;
+	slot.large_buffers.clear();
+}
+
+void StagingRing::record_post_copy_barriers(VkCommandBuffer command_buffer, const Slot &slot, bool acquire) const
+{
+	bool transfer_ownership = is_using_transfer_queue();
+
+	uint32_t src_queue_family = transfer_ownership ? copy_queue->get_family_index() : VK_QUEUE_FAMILY_IGNORED;
+	uint32_t dst_queue_family = transfer_ownership ? graphics_queue.get_family_index() : VK_QUEUE_FAMILY_IGNORED;
+
+	// The release half of an ownership transfer makes the writes available, and the acquire half makes them visible
+	VkAccessFlags src_access_mask = acquire ? 0 : VK_ACCESS_TRANSFER_WRITE_BIT;
+	VkAccessFlags dst_access_mask = transfer_ownership && !acquire ? 0 : VK_ACCESS_MEMORY_READ_BIT;
+
+	VkPipelineStageFlags src_stage_mask = acquire ? VK_PIPELINE_STAGE_ALL_COMMANDS_BIT : VK_PIPELINE_STAGE_TRANSFER_BIT;
+	VkPipelineStageFlags dst_stage_mask = transfer_ownership && !acquire ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+	std::vector<VkBufferMemoryBarrier> buffer_barriers;
+	buffer_barriers.reserve(slot.buffer_copies.size());
+
+	for (auto &copies : slot.buffer_copies)
+	{
+		VkDeviceSize begin = std::numeric_limits<VkDeviceSize>::max();
+		VkDeviceSize end   = 0;
+
+		for (auto &region : copies.second)
+		{
+			begin = std::min(begin, region.dstOffset);
+			end   = std::max(end, region.dstOffset + region.size);
+		}
+
+		VkBufferMemoryBarrier buffer_barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+		buffer_barrier.srcAccessMask       = src_access_mask;
+		buffer_barrier.dstAccessMask       = dst_access_mask;
+		buffer_barrier.srcQueueFamilyIndex = src_queue_family;
+		buffer_barrier.dstQueueFamilyIndex = dst_queue_family;
+		buffer_barrier.buffer              = copies.first->get_handle();
+		buffer_barrier.offset              = begin;
+		buffer_barrier.size                = end - begin;
+
+		buffer_barriers.push_back(buffer_barrier);
+	}
+
+	std::vector<VkImageMemoryBarrier> image_barriers;
+	image_barriers.reserve(slot.image_copies.size());
+
+	for (auto &image_copy : slot.image_copies)
+	{
+		VkImageMemoryBarrier image_barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+		image_barrier.srcAccessMask       = src_access_mask;
+		image_barrier.dstAccessMask       = dst_access_mask;
+		image_barrier.oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		image_barrier.newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		image_barrier.srcQueueFamilyIndex = src_queue_family;
+		image_barrier.dstQueueFamilyIndex = dst_queue_family;
+		image_barrier.image               = image_copy.image_view->get_image().get_handle();
+		image_barrier.subresourceRange    = image_copy.image_view->get_subresource_range();
+
+		image_barriers.push_back(image_barrier);
+	}
+
+	vkCmdPipelineBarrier(command_buffer, src_stage_mask, dst_stage_mask, 0,
+	                     0, nullptr,
+	                     to_u32(buffer_barriers.size()), buffer_barriers.data(),
+	                     to_u32(image_barriers.size()), image_barriers.data());
+}
+}        // namespace vkb
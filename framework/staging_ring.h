@@ -0,0 +1,211 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/helpers.h"
+#include "common/vk_common.h"
+#include "core/buffer.h"
+#include "queue_timeline.h"
+
+namespace vkb
+{
+class Device;
+class Queue;
+
+namespace core
+{
+class ImageView;
+}
+
+/**
+ * @brief Uploads data to device local memory through a fixed set of host visible staging slots.
+ *
+ *        Data is written into the current slot and the copies out of it are batched until the slot is full,
+ *        then submitted together in one command buffer. The next slot is reused only once the copies reading
+ *        it completed, so the host fills one slot while the device copies out of the others, and the staging
+ *        memory stays bounded however much data is uploaded.
+ *
+ *        Uploads are made visible to any later command on the graphics queue. When a dedicated transfer queue
+ *        is used, the copies run on it and the ownership of the resources is then transferred to the graphics
+ *        queue family, which requires resources created with VK_SHARING_MODE_EXCLUSIVE.
+ */
+class StagingRing
+{
+  public:
+	static constexpr VkDeviceSize DEFAULT_SLOT_SIZE = 16 * 1024 * 1024;
+
+	/**
+	 * @param device A valid Vulkan device
+	 * @param slot_size Size in bytes of each staging slot
+	 * @param slot_count Number of slots, i.e. the number of submissions which can be in flight
+	 * @param use_transfer_queue Whether to copy on a dedicated transfer queue, if the device has a suitable one
+	 */
+	StagingRing(const Device &device, VkDeviceSize slot_size = DEFAULT_SLOT_SIZE, uint32_t slot_count = 3, bool use_transfer_queue = false);
+
+	StagingRing(const StagingRing &) = delete;
+
+	StagingRing(StagingRing &&) = delete;
+
+	/**
+	 * @brief Waits for the copies in flight, pending copies which were not submitted are dropped
+	 */
+	~StagingRing();
+
+	StagingRing &operator=(const StagingRing &) = delete;
+
+	StagingRing &operator=(StagingRing &&) = delete;
+
+	/**
+	 * @brief Stages data to be copied into a buffer, which must have been created with VK_BUFFER_USAGE_TRANSFER_DST_BIT.
+	 *        Data larger than a slot is split across several slots.
+	 * @param data Data to copy
+	 * @param size Number of bytes to copy
+	 * @param dst_buffer Buffer to copy into, which must stay alive until finish() returns
+	 * @param dst_offset Offset in bytes into the destination buffer
+	 */
+	void copy_to_buffer(const uint8_t *data, VkDeviceSize size, const core::Buffer &dst_buffer, VkDeviceSize dst_offset);
+
+	/**
+	 * @brief Stages the whole content of an image, which is transitioned from an undefined layout
+	 *        to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL. Data larger than a slot goes through a temporary buffer.
+	 * @param data Data of all the regions
+	 * @param size Number of bytes to copy
+	 * @param image_view View covering the subresources to upload, which must stay alive until finish() returns
+	 * @param regions Copy regions, with buffer offsets relative to data
+	 */
+	void copy_to_image(const uint8_t *data, VkDeviceSize size, const core::ImageView &image_view, std::vector<VkBufferImageCopy> regions);
+
+	/**
+	 * @brief Submits the copies staged in the current slot and moves to the next one
+	 */
+	void submit();
+
+	/**
+	 * @brief Submits the pending copies and waits until all of them completed
+	 */
+	void finish();
+
+	/**
+	 * @return Whether copies run on a dedicated transfer queue
+	 */
+	bool is_using_transfer_queue() const;
+
+	/**
+	 * @return The number of bytes staged since the ring was created
+	 */
+	VkDeviceSize get_uploaded_size() const;
+
+	/**
+	 * @return The number of batches submitted since the ring was created
+	 */
+	uint32_t get_submission_count() const;
+
+	/**
+	 * @return The time in seconds the host spent waiting for slots to be free again
+	 */
+	double get_wait_time() const;
+
+  private:
+	struct ImageCopy
+	{
+		const core::ImageView *image_view;
+
+		const core::Buffer *src_buffer;
+
+		std::vector<VkBufferImageCopy> regions;
+	};
+
+	struct Slot
+	{
+		std::unique_ptr<core::Buffer> buffer;
+
+		/// Bytes of the slot written since it was last submitted
+		VkDeviceSize used{0};
+
+		/// Copies into buffers, grouped by destination buffer
+		std::vector<std::pair<const core::Buffer *, std::vector<VkBufferCopy>>> buffer_copies;
+
+		std::vector<ImageCopy> image_copies;
+
+		/// Staging buffers of uploads too large for the slot, released once the slot is reused
+		std::vector<std::unique_ptr<core::Buffer>> large_buffers;
+
+		/// Records the copies, on the transfer queue if one is used
+		VkCommandBuffer command_buffer{VK_NULL_HANDLE};
+
+		/// Acquires the ownership of the resources on the graphics queue, when a transfer queue is used
+		VkCommandBuffer acquire_command_buffer{VK_NULL_HANDLE};
+
+		/// Signaled by the copies and waited by the acquire command buffer
+		VkSemaphore semaphore{VK_NULL_HANDLE};
+
+		/// Signaled once the last submission of the slot completed
+		VkFence fence{VK_NULL_HANDLE};
+
+		/// Last submission of the slot, used in place of the fence if the device has queue timelines
+		TimelineTicket ticket;
+
+		bool in_flight{false};
+	};
+
+	/**
+	 * @brief Returns the current slot, waiting for its previous submission if it is still in flight
+	 */
+	Slot &acquire_slot();
+
+	/**
+	 * @brief Submits the last commands of a slot to the graphics queue, whose completion frees the slot
+	 */
+	void submit_graphics(Slot &slot, const VkSubmitInfo &submit_info);
+
+	void wait(Slot &slot);
+
+	/**
+	 * @brief Records the barriers making the copies of a slot visible, or the release and acquire halves
+	 *        of the ownership transfer when a transfer queue is used
+	 */
+	void record_post_copy_barriers(VkCommandBuffer command_buffer, const Slot &slot, bool acquire) const;
+
+	const Device &device;
+
+	const Queue &graphics_queue;
+
+	/// Queue the copies are submitted to, either the graphics queue or a dedicated transfer queue
+	const Queue *copy_queue;
+
+	VkCommandPool command_pool{VK_NULL_HANDLE};
+
+	VkCommandPool acquire_command_pool{VK_NULL_HANDLE};
+
+	VkDeviceSize slot_size;
+
+	std::vector<Slot> slots;
+
+	uint32_t current_slot{0};
+
+	VkDeviceSize uploaded_size{0};
+
+	uint32_t submission_count{0};
+
+	double wait_time{0.0};
+};
+}        // namespace vkb
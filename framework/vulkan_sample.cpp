@@ -47,6 +47,9 @@ namespace vkb
 {
 VulkanSample::~VulkanSample()
 {
+	// Runs the jobs left while the objects they may use still exist
+	job_system.reset();
+
 	if (device)
 	{
 		device->wait_idle();
@@ -54,6 +57,7 @@ VulkanSample::~VulkanSample()
 
 	scene.reset();
 
+	timestamp_pool.reset();
 	stats.reset();
 	gui.reset();
 	render_context.reset();
@@ -87,6 +91,8 @@ bool VulkanSample::prepare(Platform &platform)
 
 	LOGI("Initializing Vulkan sample");
 
+	job_system = std::make_unique<JobSystem>();
+
 	bool headless = platform.get_window().get_window_mode() == Window::Mode::Headless;
 
 	VkResult result = volkInitialize();
@@ -131,7 +137,7 @@ bool VulkanSample::prepare(Platform &platform)
 
 	// Getting a valid vulkan surface from the platform
 	surface = platform.get_window().create_surface(*instance);
-	if (!surface)
+	if (!surface && !headless)
 	{
 		throw std::runtime_error("Failed to create window surface.");
 	}
@@ -148,6 +154,28 @@ bool VulkanSample::prepare(Platform &platform)
 	// Request sample required GPU features
 	request_gpu_features(gpu);
 
+	if (timeline_sync && instance->is_enabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME))
+	{
+		// The feature struct comes back with the supported features, which are thus requested
+		auto &timeline_semaphore_features = gpu.request_extension_features<VkPhysicalDeviceTimelineSemaphoreFeaturesKHR>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR);
+
+		if (timeline_semaphore_features.timelineSemaphore)
+		{
+			add_device_extension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME, /*optional=*/true);
+		}
+	}
+
+	if (synchronization_2 && instance->is_enabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME))
+	{
+		auto &synchronization_2_features = gpu.request_extension_features<VkPhysicalDeviceSynchronization2FeaturesKHR>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR);
+
+		// Command buffers record their barriers with VK_KHR_synchronization2 once the extension is enabled
+		if (synchronization_2_features.synchronization2)
+		{
+			add_device_extension(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME, /*optional=*/true);
+		}
+	}
+
 	// Creating vulkan device, specifying the swapchain extension always
 	if (!headless || instance->is_enabled(VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME))
 	{
@@ -158,6 +186,11 @@ bool VulkanSample::prepare(Platform &platform)
 			add_device_extension(VK_KHR_DISPLAY_SWAPCHAIN_EXTENSION_NAME, /*optional=*/true);
 		}
 	}
+	else
+	{
+		// Offscreen images are transitioned to the present layout like swapchain images
+		add_device_extension(VK_KHR_SWAPCHAIN_EXTENSION_NAME, /*optional=*/true);
+	}
 
 #ifdef VKB_VULKAN_DEBUG
 	if (!debug_utils)
@@ -199,6 +232,18 @@ bool VulkanSample::prepare(Platform &platform)
 		device = std::make_unique<vkb::Device>(gpu, surface, std::move(debug_utils), get_device_extensions());
 	}
 
+	if (timeline_sync)
+	{
+		if (device->is_enabled(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME))
+		{
+			device->create_queue_timelines();
+		}
+		else
+		{
+			LOGW("Timeline semaphores are not supported, synchronizing with fences");
+		}
+	}
+
 	create_render_context(platform);
 	prepare_render_context();
 
@@ -299,28 +344,114 @@ void VulkanSample::update_gui(float delta_time)
 
 void VulkanSample::update(float delta_time)
 {
+	frame_timer.tick<Timer::Milliseconds>();
+
 	update_scene(delta_time);
 
 	update_gui(delta_time);
 
+	auto update_time = frame_timer.tick<Timer::Milliseconds>();
+
 	auto &command_buffer = render_context->begin();
 
 	// Collect the performance data for the sample graphs
 	update_stats(delta_time);
 
+	auto wait_time = frame_timer.tick<Timer::Milliseconds>();
+
 	command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 	stats->begin_sampling(command_buffer);
 
+	if (frame_timings_enabled)
+	{
+		begin_gpu_timing(command_buffer);
+	}
+
 	draw(command_buffer, render_context->get_active_frame().get_render_target());
 
+	if (frame_timings_enabled)
+	{
+		end_gpu_timing(command_buffer);
+	}
+
 	stats->end_sampling(command_buffer);
 	command_buffer.end();
 
+	auto record_time = frame_timer.tick<Timer::Milliseconds>();
+
 	render_context->submit(command_buffer);
 
+	auto submit_time = frame_timer.tick<Timer::Milliseconds>();
+
+	if (frame_timings_enabled)
+	{
+		frame_timings.wait   = static_cast<float>(wait_time);
+		frame_timings.update = static_cast<float>(update_time);
+		frame_timings.record = static_cast<float>(record_time);
+		frame_timings.submit = static_cast<float>(submit_time);
+		++timed_frame_count;
+	}
+
 	platform->on_post_draw(get_render_context());
 }
 
+void VulkanSample::begin_gpu_timing(CommandBuffer &command_buffer)
+{
+	frame_timings.frame_number = timed_frame_count;
+	frame_timings.has_gpu_time = false;
+
+	auto &queue = device->get_suitable_graphics_queue();
+	if (!device->get_gpu().get_properties().limits.timestampComputeAndGraphics || queue.get_properties().timestampValidBits == 0)
+	{
+		return;
+	}
+
+	// The number of render frames only changes while the device is idle
+	auto frame_count = to_u32(render_context->get_render_frames().size());
+	if (timestamp_frame_numbers.size() != frame_count)
+	{
+		VkQueryPoolCreateInfo query_pool_info{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+		query_pool_info.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+		query_pool_info.queryCount = frame_count * 2;
+
+		timestamp_pool = std::make_unique<QueryPool>(*device, query_pool_info);
+		timestamp_frame_numbers.assign(frame_count, ~0u);
+	}
+
+	uint32_t frame_index = render_context->get_active_frame_index();
+
+	// The render frame was waited for in RenderContext::begin(), so its timestamps are available
+	if (timestamp_frame_numbers[frame_index] != ~0u)
+	{
+		std::array<uint64_t, 2> timestamps;
+
+		VkResult result = timestamp_pool->get_results(frame_index * 2, 2, sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		if (result == VK_SUCCESS)
+		{
+			uint32_t valid_bits = queue.get_properties().timestampValidBits;
+			uint64_t mask       = valid_bits < 64 ? (uint64_t{1} << valid_bits) - 1 : ~uint64_t{0};
+			uint64_t ticks      = (timestamps[1] - timestamps[0]) & mask;
+
+			frame_timings.has_gpu_time     = true;
+			frame_timings.gpu_frame_number = timestamp_frame_numbers[frame_index];
+			frame_timings.gpu              = static_cast<float>(ticks) * device->get_gpu().get_properties().limits.timestampPeriod * 0.000001f;
+		}
+	}
+
+	command_buffer.reset_query_pool(*timestamp_pool, frame_index * 2, 2);
+	command_buffer.write_timestamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, *timestamp_pool, frame_index * 2);
+
+	timestamp_frame_numbers[frame_index] = timed_frame_count;
+}
+
+void VulkanSample::end_gpu_timing(CommandBuffer &command_buffer)
+{
+	if (timestamp_pool)
+	{
+		command_buffer.write_timestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, *timestamp_pool, render_context->get_active_frame_index() * 2 + 1);
+	}
+}
+
 void VulkanSample::draw(CommandBuffer &command_buffer, RenderTarget &render_target)
 {
 	auto &views = render_target.get_views();
@@ -336,12 +467,12 @@ void VulkanSample::draw(CommandBuffer &command_buffer, RenderTarget &render_targ
 		memory_barrier.src_stage_mask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 		memory_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
-		command_buffer.image_memory_barrier(views[0], memory_barrier);
+		command_buffer.add_image_memory_barrier(views[0], memory_barrier);
 
 		// Skip 1 as it is handled later as a depth-stencil attachment
 		for (size_t i = 2; i < views.size(); ++i)
 		{
-			command_buffer.image_memory_barrier(views[i], memory_barrier);
+			command_buffer.add_image_memory_barrier(views[i], memory_barrier);
 		}
 	}
 
@@ -354,9 +485,12 @@ void VulkanSample::draw(CommandBuffer &command_buffer, RenderTarget &render_targ
 		memory_barrier.src_stage_mask  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
 		memory_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
 
-		command_buffer.image_memory_barrier(views[1], memory_barrier);
+		command_buffer.add_image_memory_barrier(views[1], memory_barrier);
 	}
 
+	// Samples may record the render pass directly on the handle
+	command_buffer.flush_barriers();
+
 	draw_renderpass(command_buffer, render_target);
 
 	{
@@ -462,6 +596,20 @@ void VulkanSample::input_event(const InputEvent &input_event)
 	}
 }
 
+void VulkanSample::set_frame_timings_enabled(bool enable)
+{
+	frame_timings_enabled = enable;
+
+	frame_timings     = {};
+	timed_frame_count = 0;
+	std::fill(timestamp_frame_numbers.begin(), timestamp_frame_numbers.end(), ~0u);
+}
+
+const FrameTimings &VulkanSample::get_frame_timings() const
+{
+	return frame_timings;
+}
+
 void VulkanSample::finish()
 {
 	Application::finish();
@@ -499,6 +647,18 @@ void VulkanSample::update_debug_window()
 	                                                    to_string(render_context->get_swapchain().get_format()) + " (" +
 	                                                        to_string(get_bits_per_pixel(render_context->get_swapchain().get_format())) + "bpp)");
 
+	// The last frame keeps the counts of its command buffers until it is reused
+	auto &last_frame         = *render_context->get_render_frames()[render_context->get_active_frame_index()];
+	auto  barrier_statistics = last_frame.get_barrier_statistics();
+
+	get_debug_info().insert<field::Static, std::string>("pipeline_barriers",
+	                                                    fmt::format("{} ({} image, {} buffer, {} memory barriers{})",
+	                                                                barrier_statistics.pipeline_barrier_count,
+	                                                                barrier_statistics.image_barrier_count,
+	                                                                barrier_statistics.buffer_barrier_count,
+	                                                                barrier_statistics.memory_barrier_count,
+	                                                                device->is_enabled(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME) ? ", synchronization2" : ""));
+
 	if (scene != nullptr)
 	{
 		get_debug_info().insert<field::Static, uint32_t>("mesh_count",
@@ -536,6 +696,28 @@ void VulkanSample::set_viewport_and_scissor(vkb::CommandBuffer &command_buffer,
 void VulkanSample::load_scene(const std::string &path)
 {
 	GLTFLoader loader{*device};
+	loader.set_geometry_streaming(true);
+	loader.set_dedicated_transfer_queue(scene_transfer_queue);
+	loader.set_scene_cache(scene_cache);
+	loader.set_job_system(job_system.get());
+
+	if (scene_mesh_optimization)
+	{
+		GLTFLoader::MeshOptimization mesh_optimization;
+		mesh_optimization.vertex_cache = true;
+		mesh_optimization.overdraw     = true;
+		loader.set_mesh_optimization(mesh_optimization);
+	}
+
+	if (scene_vertex_quantization)
+	{
+		GLTFLoader::VertexLayout vertex_layout;
+		vertex_layout.interleaved         = true;
+		vertex_layout.quantized_positions = true;
+		vertex_layout.octahedral_normals  = true;
+		vertex_layout.half_texcoords      = true;
+		loader.set_vertex_layout(vertex_layout);
+	}
 
 	scene = loader.read_scene_from_file(path);
 
@@ -546,6 +728,12 @@ void VulkanSample::load_scene(const std::string &path)
 	}
 }
 
+JobSystem &VulkanSample::get_job_system()
+{
+	assert(job_system && "Job system was not created");
+	return *job_system;
+}
+
 VkSurfaceKHR VulkanSample::get_surface()
 {
 	return surface;
@@ -20,7 +20,9 @@
 #include "common/utils.h"
 #include "common/vk_common.h"
 #include "core/instance.h"
+#include "core/query_pool.h"
 #include "gui.h"
+#include "job_system.h"
 #include "platform/application.h"
 #include "rendering/render_context.h"
 #include "rendering/render_pipeline.h"
@@ -99,6 +101,36 @@ namespace vkb
  * - Core classes: Classes in vkb::core wrap Vulkan objects for indexing and hashing.
  */
 
+/**
+ * @brief Durations of the stages of a frame rendered by VulkanSample::update(), in milliseconds
+ */
+struct FrameTimings
+{
+	/// Number of the frame the CPU timings belong to, counted from when timings were enabled, or ~0 before any
+	uint32_t frame_number{~0u};
+
+	/// Waiting for the render frame to be available and acquiring the swapchain image
+	float wait{0.0f};
+
+	/// Updating the scene and the GUI
+	float update{0.0f};
+
+	/// Recording the command buffer
+	float record{0.0f};
+
+	/// Submitting and presenting
+	float submit{0.0f};
+
+	/// Whether the GPU timing of an earlier frame has been resolved this frame
+	bool has_gpu_time{false};
+
+	/// GPU results are only available once the frame completed, some frames later
+	uint32_t gpu_frame_number{0};
+
+	/// Time between the start and the end of the command buffer execution
+	float gpu{0.0f};
+};
+
 class VulkanSample : public Application
 {
   public:
@@ -145,6 +177,13 @@ class VulkanSample : public Application
 
 	Device &get_device();
 
+	/**
+	 * @brief The job system of the sample, created in prepare(), which parallel work such as loading, culling
+	 *        or command recording should be scheduled on. To record with the thread index given to jobs,
+	 *        the render context must be prepared with JobSystem::get_thread_count() threads.
+	 */
+	JobSystem &get_job_system();
+
 	RenderContext &get_render_context();
 
 	void set_render_pipeline(RenderPipeline &&render_pipeline);
@@ -157,6 +196,17 @@ class VulkanSample : public Application
 
 	bool has_scene();
 
+	/**
+	 * @brief Measures the CPU stages of each frame, and its GPU execution with timestamp queries if supported.
+	 *        Only frames rendered through VulkanSample::update() are measured. Enabling restarts the frame numbers.
+	 */
+	void set_frame_timings_enabled(bool enable);
+
+	/**
+	 * @return The timings of the last frame, valid if frame timings are enabled
+	 */
+	const FrameTimings &get_frame_timings() const;
+
   protected:
 	/**
 	 * @brief The Vulkan instance
@@ -187,6 +237,11 @@ class VulkanSample : public Application
 
 	std::unique_ptr<Stats> stats{nullptr};
 
+	/**
+	 * @brief Workers shared by the framework and the sample, instead of threads of their own
+	 */
+	std::unique_ptr<JobSystem> job_system{nullptr};
+
 	/**
 	 * @brief Update scene
 	 * @param delta_time
@@ -326,6 +381,64 @@ class VulkanSample : public Application
 		high_priority_graphics_queue = enable;
 	}
 
+	/**
+	 * @brief Sets whether or not frames and uploads should be synchronized with a timeline semaphore per queue
+	 * rather than with fences, if the GPU supports VK_KHR_timeline_semaphore.
+	 * Needs to be called before prepare().
+	 */
+	void set_timeline_sync_enable(bool enable)
+	{
+		timeline_sync = enable;
+	}
+
+	/**
+	 * @brief Sets whether or not command buffers should record their barriers with VK_KHR_synchronization2,
+	 * if the GPU supports it. Needs to be called before prepare().
+	 */
+	void set_synchronization_2_enable(bool enable)
+	{
+		synchronization_2 = enable;
+	}
+
+	/**
+	 * @brief Sets whether or not load_scene() should store vertices interleaved, with quantized positions,
+	 * octahedral encoded normals and half float texture coordinates. The subpasses drawing the scene must
+	 * implement the QUANTIZED_POSITION and OCTAHEDRAL_NORMAL shader variants, as base.vert does.
+	 * Needs to be called before load_scene().
+	 */
+	void set_scene_vertex_quantization_enable(bool enable)
+	{
+		scene_vertex_quantization = enable;
+	}
+
+	/**
+	 * @brief Sets whether or not load_scene() should copy the images and geometry of scenes on a dedicated
+	 * transfer queue, if the GPU has one, instead of the graphics queue. Needs to be called before load_scene().
+	 */
+	void set_scene_transfer_queue_enable(bool enable)
+	{
+		scene_transfer_queue = enable;
+	}
+
+	/**
+	 * @brief Sets whether or not load_scene() should reorder the triangles and vertices of scenes for the
+	 * post-transform vertex cache and to reduce overdraw, logging the vertex cache efficiency of each primitive.
+	 * Needs to be called before load_scene().
+	 */
+	void set_scene_mesh_optimization_enable(bool enable)
+	{
+		scene_mesh_optimization = enable;
+	}
+
+	/**
+	 * @brief Sets whether or not load_scene() should store the decoded images and processed geometry of scenes in
+	 * a binary cache in the temporary directory, and load them from it on the next runs. Needs to be called before load_scene().
+	 */
+	void set_scene_cache_enable(bool enable)
+	{
+		scene_cache = enable;
+	}
+
   private:
 	/** @brief Set of device extensions to be enabled for this example and whether they are optional (must be set in the derived constructor) */
 	std::unordered_map<const char *, bool> device_extensions;
@@ -338,5 +451,48 @@ class VulkanSample : public Application
 
 	/** @brief Whether or not we want a high priority graphics queue. */
 	bool high_priority_graphics_queue{false};
+
+	/** @brief Whether or not we want queue timelines in place of fences. */
+	bool timeline_sync{false};
+
+	/** @brief Whether or not we want barriers recorded with VK_KHR_synchronization2. */
+	bool synchronization_2{false};
+
+	/** @brief Whether or not we want scenes loaded with interleaved, quantized vertices. */
+	bool scene_vertex_quantization{false};
+
+	/** @brief Whether or not we want scenes uploaded on a dedicated transfer queue. */
+	bool scene_transfer_queue{false};
+
+	/** @brief Whether or not we want the triangles of scenes reordered for the vertex cache and overdraw. */
+	bool scene_mesh_optimization{false};
+
+	/** @brief Whether or not we want scenes loaded from and stored in a binary scene cache. */
+	bool scene_cache{false};
+
+	/**
+	 * @brief Reads the GPU timing of the frame previously rendered with the active render frame,
+	 *        then writes the timestamp starting the current one
+	 */
+	void begin_gpu_timing(CommandBuffer &command_buffer);
+
+	/**
+	 * @brief Writes the timestamp ending the current frame
+	 */
+	void end_gpu_timing(CommandBuffer &command_buffer);
+
+	bool frame_timings_enabled{false};
+
+	FrameTimings frame_timings{};
+
+	uint32_t timed_frame_count{0};
+
+	Timer frame_timer;
+
+	/** @brief Two timestamp queries per render frame, surrounding its command buffer */
+	std::unique_ptr<QueryPool> timestamp_pool;
+
+	/** @brief Number of the frame whose timestamps are pending in each render frame, or ~0 */
+	std::vector<uint32_t> timestamp_frame_numbers;
 };
 }        // namespace vkb
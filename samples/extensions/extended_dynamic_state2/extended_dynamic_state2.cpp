@@ -887,9 +887,10 @@ void ExtendedDynamicState2::draw_from_scene(VkCommandBuffer command_buffer, std:
 {
 	for (int i = 0; i < scene_node.size(); ++i)
 	{
-		const auto &vertex_buffer_pos    = scene_node[i].sub_mesh->vertex_buffers.at("position");
-		const auto &vertex_buffer_normal = scene_node[i].sub_mesh->vertex_buffers.at("normal");
-		auto       &index_buffer         = scene_node[i].sub_mesh->index_buffer;
+		VkDeviceSize offsets[3];
+		const auto  *vertex_buffer_pos    = scene_node[i].sub_mesh->get_vertex_buffer("position", offsets[0]);
+		const auto  *vertex_buffer_normal = scene_node[i].sub_mesh->get_vertex_buffer("normal", offsets[1]);
+		const auto  *index_buffer         = scene_node[i].sub_mesh->get_index_buffer(offsets[2]);
 
 		if (scene_node[i].name != "Geosphere")
 		{
@@ -915,10 +916,9 @@ void ExtendedDynamicState2::draw_from_scene(VkCommandBuffer command_buffer, std:
 		                   sizeof(push_const_block),
 		                   &push_const_block);
 
-		VkDeviceSize offsets[1] = {0};
-		vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffer_pos.get(), offsets);
-		vkCmdBindVertexBuffers(command_buffer, 1, 1, vertex_buffer_normal.get(), offsets);
-		vkCmdBindIndexBuffer(command_buffer, index_buffer->get_handle(), 0, scene_node[i].sub_mesh->index_type);
+		vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffer_pos->get(), &offsets[0]);
+		vkCmdBindVertexBuffers(command_buffer, 1, 1, vertex_buffer_normal->get(), &offsets[1]);
+		vkCmdBindIndexBuffer(command_buffer, index_buffer->get_handle(), offsets[2], scene_node[i].sub_mesh->index_type);
 
 		vkCmdDrawIndexed(command_buffer, scene_node[i].sub_mesh->vertex_indices, 1, 0, 0, 0);
 	}
@@ -1647,7 +1647,7 @@ void GpuDispatch::update(float delta_time)
 
             cmd_buf.end();
 
-            auto present_semaphore = frame.request_semaphore();
+            auto present_semaphore = get_render_context().request_present_semaphore();
 
             VkPipelineStageFlags stage_masks[] = { VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT };
             auto submit_info = vkb::initializers::submit_info();
@@ -201,6 +201,9 @@ void GpuDrawDispatch::prepare_render_context()
         {VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR},
     });
 
+    // The GUI and the examples create a framebuffer per frame from its render target, so keep one frame per image
+    get_render_context().request_frames_in_flight(0);
+
     get_render_context().prepare(1, [this](vkb::core::Image &&swapchain_image) { return create_render_target(std::move(swapchain_image)); });
 
     get_render_context().update_swapchain(std::set<VkImageUsageFlagBits>({
@@ -18,6 +18,7 @@
 /*
  * Basic example for VK_EXT_mesh_shader there is only a mesh shader and a fragment shader.
  * The mesh shader creates the vertices for a single triangle.
+ * Optionally draws a model with vkb::MeshletRenderer, which culls meshlets in a task shader.
  */
 
 #include "mesh_shading.h"
@@ -40,6 +41,7 @@ MeshShading::~MeshShading()
 {
 	if (device)
 	{
+		meshlet_renderer.reset();
 		vkDestroyPipeline(get_device().get_handle(), pipeline, nullptr);
 		vkDestroyPipelineLayout(get_device().get_handle(), pipeline_layout, nullptr);
 		vkDestroyDescriptorSetLayout(get_device().get_handle(), descriptor_set_layout, nullptr);
@@ -53,6 +55,7 @@ void MeshShading::request_gpu_features(vkb::PhysicalDevice &gpu)
 	auto &meshFeatures = gpu.request_extension_features<VkPhysicalDeviceMeshShaderFeaturesEXT>(
 	    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT);
 	meshFeatures.meshShader = VK_TRUE;
+	meshFeatures.taskShader = VK_TRUE;
 }
 
 /*
@@ -87,14 +90,22 @@ void MeshShading::build_command_buffers()
 		VkRect2D scissor = vkb::initializers::rect2D(static_cast<int32_t>(width), static_cast<int32_t>(height), 0, 0);
 		vkCmdSetScissor(draw_cmd_buffers[i], 0, 1, &scissor);
 
-		vkCmdBindDescriptorSets(draw_cmd_buffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1, &descriptor_set, 0, nullptr);
-		vkCmdBindPipeline(draw_cmd_buffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
-
-		// Mesh shaders need the vkCmdDrawMeshTasksExt
-		uint32_t num_workgroups_x = 1;
-		uint32_t num_workgroups_y = 1;
-		uint32_t num_workgroups_z = 1;
-		vkCmdDrawMeshTasksEXT(draw_cmd_buffers[i], num_workgroups_x, num_workgroups_y, num_workgroups_z);
+		if (show_model)
+		{
+			// One set of resources per command buffer, as they are recorded once
+			meshlet_renderer->draw(draw_cmd_buffers[i], static_cast<uint32_t>(i));
+		}
+		else
+		{
+			vkCmdBindDescriptorSets(draw_cmd_buffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1, &descriptor_set, 0, nullptr);
+			vkCmdBindPipeline(draw_cmd_buffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+
+			// Mesh shaders need the vkCmdDrawMeshTasksExt
+			uint32_t num_workgroups_x = 1;
+			uint32_t num_workgroups_y = 1;
+			uint32_t num_workgroups_z = 1;
+			vkCmdDrawMeshTasksEXT(draw_cmd_buffers[i], num_workgroups_x, num_workgroups_y, num_workgroups_z);
+		}
 
 		draw_ui(draw_cmd_buffers[i]);
 
@@ -111,6 +122,14 @@ bool MeshShading::prepare(vkb::Platform &platform)
 		return false;
 	}
 
+	camera.type = vkb::CameraType::LookAt;
+	camera.set_perspective(60.0f, static_cast<float>(width) / static_cast<float>(height), 256.0f, 0.1f);
+	camera.set_translation(glm::vec3(0.0f, -0.25f, -5.0f));
+	camera.set_rotation(glm::vec3(-32.0f, 20.0f, 0.0f));
+
+	model            = load_model("scenes/teapot.gltf", 0, true);
+	meshlet_renderer = std::make_unique<vkb::MeshletRenderer>(get_device(), *model, render_pass, pipeline_cache, vkb::to_u32(draw_cmd_buffers.size()));
+
 	prepare_pipelines();
 	build_command_buffers();
 
@@ -121,6 +140,12 @@ bool MeshShading::prepare(vkb::Platform &platform)
 void MeshShading::draw()
 {
 	ApiVulkanSample::prepare_frame();
+
+	if (show_model)
+	{
+		meshlet_renderer->update(current_buffer, glm::mat4(1.0f), camera.matrices.view, camera.matrices.perspective);
+	}
+
 	submit_info.commandBufferCount = 1;
 	submit_info.pCommandBuffers    = &draw_cmd_buffers[current_buffer];
 
@@ -128,6 +153,12 @@ void MeshShading::draw()
 	VK_CHECK(vkQueueSubmit(queue, 1, &submit_info, VK_NULL_HANDLE));
 
 	ApiVulkanSample::submit_frame();
+
+	// submit_frame() waits for the queue to be idle, so the counters of this frame are available
+	if (show_model)
+	{
+		meshlet_statistics = meshlet_renderer->read_statistics(current_buffer);
+	}
 }
 
 void MeshShading::prepare_pipelines()
@@ -238,6 +269,31 @@ void MeshShading::render(float delta_time)
 	draw();
 }
 
+void MeshShading::on_update_ui_overlay(vkb::Drawer &drawer)
+{
+	if (drawer.header("Settings"))
+	{
+		if (drawer.checkbox("Draw model", &show_model))
+		{
+			build_command_buffers();
+		}
+
+		if (show_model)
+		{
+			drawer.checkbox("Frustum culling", &meshlet_renderer->frustum_culling);
+			drawer.checkbox("Cone culling", &meshlet_renderer->cone_culling);
+		}
+	}
+
+	if (show_model && drawer.header("Statistics"))
+	{
+		drawer.text("Meshlets: %d", meshlet_renderer->get_meshlet_count());
+		drawer.text("Visible: %d", meshlet_statistics.visible);
+		drawer.text("Frustum culled: %d", meshlet_statistics.frustum_culled);
+		drawer.text("Cone culled: %d", meshlet_statistics.cone_culled);
+	}
+}
+
 std::unique_ptr<vkb::VulkanSample> create_mesh_shading()
 {
 	return std::make_unique<MeshShading>();
@@ -18,12 +18,14 @@
 /*
  * Basic example for VK_EXT_mesh_shader there is only a mesh shader and a fragment shader.
  * The mesh shader creates the vertices for a single triangle.
+ * Optionally draws a model with vkb::MeshletRenderer, which culls meshlets in a task shader.
  */
 
 #pragma once
 
 #include "api_vulkan_sample.h"
 #include "glsl_compiler.h"
+#include "meshlet_renderer.h"
 
 class MeshShading : public ApiVulkanSample
 {
@@ -33,6 +35,12 @@ class MeshShading : public ApiVulkanSample
 	VkDescriptorSet       descriptor_set;
 	VkDescriptorSetLayout descriptor_set_layout;
 
+	// Model drawn as meshlets instead of the triangle
+	bool                                  show_model = false;
+	std::unique_ptr<vkb::sg::SubMesh>     model;
+	std::unique_ptr<vkb::MeshletRenderer> meshlet_renderer;
+	vkb::MeshletRenderer::Statistics      meshlet_statistics;
+
 	MeshShading();
 	~MeshShading() override;
 
@@ -43,6 +51,7 @@ class MeshShading : public ApiVulkanSample
 	void draw();
 	bool prepare(vkb::Platform &platform) override;
 	void render(float delta_time) override;
+	void on_update_ui_overlay(vkb::Drawer &drawer) override;
 };
 
 std::unique_ptr<vkb::VulkanSample> create_mesh_shading();
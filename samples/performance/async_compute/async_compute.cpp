@@ -211,6 +211,10 @@ bool AsyncComputeSample::prepare(vkb::Platform &platform)
 	// Set setup_queues() for details.
 	set_high_priority_graphics_queue_enable(true);
 
+	// Frames submit to several queues. Submissions made through the render context are then waited for
+	// on the last value of each queue's timeline, rather than on a fence each.
+	set_timeline_sync_enable(true);
+
 	if (!VulkanSample::prepare(platform))
 	{
 		return false;
@@ -468,7 +472,7 @@ VkSemaphore AsyncComputeSample::render_swapchain(VkSemaphore post_semaphore)
 	compute_post_semaphore = render_context->request_semaphore_with_ownership();
 
 	const VkSemaphore signal_semaphores[] = {
-	    render_context->request_semaphore(),
+	    render_context->request_present_semaphore(),
 	    hdr_wait_semaphores[forward_render_target_index],
 	    compute_post_semaphore,
 	};
@@ -492,7 +496,7 @@ VkSemaphore AsyncComputeSample::render_swapchain(VkSemaphore post_semaphore)
 	info.commandBufferCount   = 1;
 	info.pCommandBuffers      = &command_buffer.get_handle();
 
-	queue.submit({info}, render_context->get_active_frame().request_fence());
+	render_context->submit_frame(queue, info);
 	render_context->release_owned_semaphore(wait_semaphores[1]);
 	return signal_semaphores[0];
 }
@@ -635,7 +639,7 @@ VkSemaphore AsyncComputeSample::render_compute_post(VkSemaphore wait_graphics_se
 		render_context->release_owned_semaphore(wait_present_semaphore);
 	}
 
-	queue.submit({info}, VK_NULL_HANDLE);
+	render_context->submit_frame(queue, info);
 	return signal_semaphore;
 }
 
@@ -18,7 +18,9 @@
 #include "command_buffer_usage.h"
 
 #include <algorithm>
+#include <chrono>
 #include <numeric>
+#include <thread>
 
 #include "core/device.h"
 #include "core/pipeline_layout.h"
@@ -118,6 +120,12 @@ void CommandBufferUsage::update(float delta_time)
 
 	auto &render_context = get_render_context();
 
+	if (gui_benchmark_cache_hits)
+	{
+		gui_benchmark_cache_hits = false;
+		benchmark_cache_hits();
+	}
+
 	update_scene(delta_time);
 
 	update_gui(delta_time);
@@ -140,7 +148,7 @@ void CommandBufferUsage::update(float delta_time)
 void CommandBufferUsage::draw_gui()
 {
 	const bool landscape = camera->get_aspect_ratio() > 1.0f;
-	uint32_t   lines     = landscape ? 3 : 5;
+	uint32_t   lines     = landscape ? 4 : 6;
 
 	const auto &subpass = static_cast<ForwardSubpassSecondary *>(render_pipeline->get_active_subpass().get());
 
@@ -169,10 +177,78 @@ void CommandBufferUsage::draw_gui()
 			    ImGui::SameLine();
 		    }
 		    ImGui::RadioButton("Reset pool", &gui_command_buffer_reset_mode, static_cast<int>(vkb::CommandBuffer::ResetMode::ResetPool));
+
+		    if (ImGui::Button("Benchmark cache hits"))
+		    {
+			    gui_benchmark_cache_hits = true;
+		    }
 	    },
 	    /* lines = */ lines);
 }
 
+void CommandBufferUsage::benchmark_cache_hits()
+{
+	auto &resource_cache = device->get_resource_cache();
+
+	// Collect the keys of everything the scene has already put in the cache, so that every
+	// request below is a hit and only the lookup path is measured
+	std::vector<vkb::PipelineState>               pipeline_states;
+	std::vector<std::vector<vkb::ShaderModule *>> shader_module_sets;
+	for (auto &it : resource_cache.get_internal_state().graphics_pipelines)
+	{
+		pipeline_states.push_back(it.second.get_state());
+	}
+	for (auto &it : resource_cache.get_internal_state().pipeline_layouts)
+	{
+		shader_module_sets.push_back(it.second.get_shader_modules());
+	}
+
+	if (pipeline_states.empty())
+	{
+		LOGW("Cache hit benchmark skipped, no graphics pipelines have been created yet");
+		return;
+	}
+
+	const uint32_t iterations = 10000;
+
+	for (uint32_t thread_count = 1; thread_count <= 16; thread_count *= 2)
+	{
+		std::vector<std::thread> threads;
+		threads.reserve(thread_count);
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		for (uint32_t t = 0; t < thread_count; t++)
+		{
+			threads.emplace_back([&resource_cache, pipeline_states, &shader_module_sets, iterations]() mutable {
+				for (uint32_t i = 0; i < iterations; i++)
+				{
+					for (auto &pipeline_state : pipeline_states)
+					{
+						resource_cache.request_graphics_pipeline(pipeline_state);
+					}
+					for (auto &shader_modules : shader_module_sets)
+					{
+						resource_cache.request_pipeline_layout(shader_modules);
+					}
+				}
+			});
+		}
+
+		for (auto &thread : threads)
+		{
+			thread.join();
+		}
+
+		auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+
+		// Each thread performs the same number of requests, so wall time per request on one
+		// thread stays flat when lookups scale and grows with the thread count when they contend
+		const double requests_per_thread = static_cast<double>(iterations) * (pipeline_states.size() + shader_module_sets.size());
+		LOGI("Cache hit benchmark: {:2} thread(s), {:.1f} ns per request per thread", thread_count, elapsed / requests_per_thread);
+	}
+}
+
 void CommandBufferUsage::render(vkb::CommandBuffer &primary_command_buffer)
 {
 	if (render_pipeline)
@@ -288,27 +364,15 @@ vkb::CommandBuffer *CommandBufferUsage::ForwardSubpassSecondary::record_draw_sec
 
 void CommandBufferUsage::ForwardSubpassSecondary::draw(vkb::CommandBuffer &primary_command_buffer)
 {
-	std::multimap<float, std::pair<vkb::sg::Node *, vkb::sg::SubMesh *>> opaque_nodes;
-
-	std::multimap<float, std::pair<vkb::sg::Node *, vkb::sg::SubMesh *>> transparent_nodes;
-
-	get_sorted_nodes(opaque_nodes, transparent_nodes);
-
-	// Sort opaque objects in front-to-back order
+	// Opaque objects are sorted front-to-back and transparent objects back-to-front
 	// Note: sorting objects does not help on PowerVR, so it can be avoided to save CPU cycles
 	std::vector<std::pair<vkb::sg::Node *, vkb::sg::SubMesh *>> sorted_opaque_nodes;
-	for (auto node_it = opaque_nodes.begin(); node_it != opaque_nodes.end(); node_it++)
-	{
-		sorted_opaque_nodes.push_back(node_it->second);
-	}
-	const auto opaque_submeshes = vkb::to_u32(sorted_opaque_nodes.size());
 
-	// Sort transparent objects in back-to-front order
 	std::vector<std::pair<vkb::sg::Node *, vkb::sg::SubMesh *>> sorted_transparent_nodes;
-	for (auto node_it = transparent_nodes.rbegin(); node_it != transparent_nodes.rend(); node_it++)
-	{
-		sorted_transparent_nodes.push_back(node_it->second);
-	}
+
+	get_sorted_nodes(sorted_opaque_nodes, sorted_transparent_nodes);
+
+	const auto opaque_submeshes = vkb::to_u32(sorted_opaque_nodes.size());
 	const auto transparent_submeshes = vkb::to_u32(sorted_transparent_nodes.size());
 
 	allocate_lights<vkb::ForwardLights>(scene.get_components<vkb::sg::Light>(), MAX_FORWARD_LIGHT_COUNT);
@@ -132,6 +132,12 @@ class CommandBufferUsage : public vkb::VulkanSample
 
 	void draw_gui() override;
 
+	/**
+	 * @brief Replays the resource cache lookups made while drawing the scene from 1 to 16 threads
+	 *        and logs the average cost of a cache hit for each thread count
+	 */
+	void benchmark_cache_hits();
+
 	int gui_secondary_cmd_buf_count{0};
 
 	uint32_t max_secondary_command_buffer_count{100};
@@ -142,6 +148,8 @@ class CommandBufferUsage : public vkb::VulkanSample
 
 	bool gui_multi_threading{false};
 
+	bool gui_benchmark_cache_hits{false};
+
 	const uint32_t MIN_THREAD_COUNT{4};
 
 	uint32_t max_thread_count{0};
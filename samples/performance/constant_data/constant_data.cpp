@@ -490,7 +490,8 @@ void ConstantData::BufferArraySubpass::draw_submesh_command(vkb::CommandBuffer &
 	if (sub_mesh.vertex_indices != 0)
 	{
 		// Bind index buffer of submesh
-		command_buffer.bind_index_buffer(*sub_mesh.index_buffer, sub_mesh.index_offset, sub_mesh.index_type);
+		VkDeviceSize index_offset;
+		command_buffer.bind_index_buffer(*sub_mesh.get_index_buffer(index_offset), index_offset, sub_mesh.index_type);
 
 		command_buffer.draw_indexed(sub_mesh.vertex_indices, 1, 0, 0, instance_index++);
 	}
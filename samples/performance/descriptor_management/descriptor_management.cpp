@@ -34,6 +34,12 @@ DescriptorManagement::DescriptorManagement()
 
 	config.insert<vkb::IntSetting>(1, descriptor_caching.value, 1);
 	config.insert<vkb::IntSetting>(1, buffer_allocation.value, 1);
+
+	// Descriptor sets can be written from flat payloads if available
+	add_device_extension(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME, true);
+
+	// Compact vertices, drawn with the quantized variants of base.vert with and without bindless materials
+	set_scene_vertex_quantization_enable(true);
 }
 
 bool DescriptorManagement::prepare(vkb::Platform &platform)
@@ -52,9 +58,10 @@ bool DescriptorManagement::prepare(vkb::Platform &platform)
 
 	vkb::ShaderSource vert_shader("base.vert");
 	vkb::ShaderSource frag_shader("base.frag");
-	auto              scene_subpass   = std::make_unique<vkb::ForwardSubpass>(get_render_context(), std::move(vert_shader), std::move(frag_shader), *scene, *camera);
+	auto              subpass         = std::make_unique<vkb::ForwardSubpass>(get_render_context(), std::move(vert_shader), std::move(frag_shader), *scene, *camera);
 	auto              render_pipeline = vkb::RenderPipeline();
-	render_pipeline.add_subpass(std::move(scene_subpass));
+	scene_subpass                     = subpass.get();
+	render_pipeline.add_subpass(std::move(subpass));
 	set_render_pipeline(std::move(render_pipeline));
 
 	// Add a GUI with the stats you want to monitor
@@ -64,6 +71,15 @@ bool DescriptorManagement::prepare(vkb::Platform &platform)
 	return true;
 }
 
+void DescriptorManagement::request_gpu_features(vkb::PhysicalDevice &gpu)
+{
+	// Bindless materials index the material texture array with push constant values
+	if (gpu.get_features().shaderSampledImageArrayDynamicIndexing)
+	{
+		gpu.get_mutable_requested_features().shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+	}
+}
+
 void DescriptorManagement::update(float delta_time)
 {
 	update_scene(delta_time);
@@ -89,6 +105,20 @@ void DescriptorManagement::update(float delta_time)
 
 	render_context.get_active_frame().set_descriptor_management_strategy(descriptor_management_strategy);
 
+	auto descriptor_update_strategy = (descriptor_update_templates.value == 0) ?
+	                                      vkb::DescriptorUpdateStrategy::WriteDescriptorSets :
+	                                      vkb::DescriptorUpdateStrategy::UseUpdateTemplates;
+
+	render_context.get_active_frame().set_descriptor_update_strategy(descriptor_update_strategy);
+
+	if ((bindless_materials.value == 1) != scene_subpass->is_bindless_materials())
+	{
+		scene_subpass->set_bindless_materials(bindless_materials.value == 1);
+
+		// Revert the option if the device does not support it
+		bindless_materials.value = scene_subpass->is_bindless_materials() ? 1 : 0;
+	}
+
 	command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 	stats->begin_sampling(command_buffer);
 
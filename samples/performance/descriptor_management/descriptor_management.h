@@ -18,6 +18,7 @@
 #pragma once
 
 #include "rendering/render_pipeline.h"
+#include "rendering/subpasses/geometry_subpass.h"
 #include "scene_graph/components/perspective_camera.h"
 #include "vulkan_sample.h"
 
@@ -32,6 +33,8 @@ class DescriptorManagement : public vkb::VulkanSample
 
 	virtual void update(float delta_time) override;
 
+	virtual void request_gpu_features(vkb::PhysicalDevice &gpu) override;
+
   private:
 	/**
 	  * @brief Struct that contains radio button labeling and the value
@@ -54,10 +57,22 @@ class DescriptorManagement : public vkb::VulkanSample
 	    {"Disabled", "Enabled"},
 	    0};
 
-	std::vector<RadioButtonGroup *> radio_buttons = {&descriptor_caching, &buffer_allocation};
+	RadioButtonGroup descriptor_update_templates{
+	    "Descriptor update templates",
+	    {"Disabled", "Enabled"},
+	    0};
+
+	RadioButtonGroup bindless_materials{
+	    "Bindless materials",
+	    {"Disabled", "Enabled"},
+	    0};
+
+	std::vector<RadioButtonGroup *> radio_buttons = {&descriptor_caching, &buffer_allocation, &descriptor_update_templates, &bindless_materials};
 
 	vkb::sg::PerspectiveCamera *camera{nullptr};
 
+	vkb::GeometrySubpass *scene_subpass{nullptr};
+
 	virtual void draw_gui() override;
 };
 
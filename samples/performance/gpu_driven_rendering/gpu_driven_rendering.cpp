@@ -0,0 +1,141 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gpu_driven_rendering.h"
+
+#include "common/vk_common.h"
+#include "gltf_loader.h"
+#include "gui.h"
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+#include "rendering/subpasses/forward_subpass.h"
+#include "stats/stats.h"
+
+GPUDrivenRendering::GPUDrivenRendering()
+{
+	auto &config = get_configuration();
+
+	config.insert<vkb::IntSetting>(0, gpu_driven, 0);
+	config.insert<vkb::IntSetting>(1, gpu_driven, 1);
+
+	// Without it, culled draws are still issued with an instance count of 0
+	add_device_extension(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME, true);
+
+	// Once draws are no longer CPU bound, vertex processing of the merged geometry is what remains
+	set_scene_mesh_optimization_enable(true);
+
+	// The optimized geometry is cached, so that only the first run pays for the optimization
+	set_scene_cache_enable(true);
+}
+
+void GPUDrivenRendering::request_gpu_features(vkb::PhysicalDevice &gpu)
+{
+	auto &requested_features = gpu.get_mutable_requested_features();
+
+	if (gpu.get_features().multiDrawIndirect)
+	{
+		requested_features.multiDrawIndirect = VK_TRUE;
+	}
+
+	// Draws find their instance from their first instance
+	if (gpu.get_features().drawIndirectFirstInstance)
+	{
+		requested_features.drawIndirectFirstInstance = VK_TRUE;
+	}
+
+	// Material textures are indexed with a per-draw value
+	if (gpu.get_features().shaderSampledImageArrayDynamicIndexing)
+	{
+		requested_features.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+	}
+}
+
+bool GPUDrivenRendering::prepare(vkb::Platform &platform)
+{
+	if (!VulkanSample::prepare(platform))
+	{
+		return false;
+	}
+
+	// A draw call intensive scene, where recording draws dominates the CPU frame time
+	load_scene("scenes/bonza/Bonza4X.gltf");
+
+	auto &camera_node = vkb::add_free_camera(*scene, "main_camera", get_render_context().get_surface_extent());
+	camera            = dynamic_cast<vkb::sg::PerspectiveCamera *>(&camera_node.get_component<vkb::sg::Camera>());
+
+	vkb::ShaderSource vert_shader("base.vert");
+	vkb::ShaderSource frag_shader("base.frag");
+	cpu_render_pipeline = std::make_unique<vkb::RenderPipeline>();
+	cpu_render_pipeline->add_subpass(std::make_unique<vkb::ForwardSubpass>(get_render_context(), std::move(vert_shader), std::move(frag_shader), *scene, *camera));
+
+	vkb::ShaderSource gpu_driven_vert_shader("gpu_driven/gpu_driven.vert");
+	vkb::ShaderSource gpu_driven_frag_shader("gpu_driven/gpu_driven.frag");
+	vkb::ShaderSource cull_shader("gpu_driven/cull.comp");
+	auto              subpass = std::make_unique<vkb::GPUDrivenSubpass>(get_render_context(), std::move(gpu_driven_vert_shader), std::move(gpu_driven_frag_shader), std::move(cull_shader), *scene, *camera);
+	gpu_driven_subpass        = subpass.get();
+	gpu_render_pipeline       = std::make_unique<vkb::RenderPipeline>();
+	gpu_render_pipeline->add_subpass(std::move(subpass));
+
+	stats->request_stats({vkb::StatIndex::frame_times});
+	gui = std::make_unique<vkb::Gui>(*this, platform.get_window(), stats.get());
+
+	return true;
+}
+
+void GPUDrivenRendering::draw(vkb::CommandBuffer &command_buffer, vkb::RenderTarget &render_target)
+{
+	// The draw commands are written by a compute dispatch, which cannot be recorded inside the render pass
+	if (gpu_driven)
+	{
+		gpu_driven_subpass->cull(command_buffer);
+	}
+
+	VulkanSample::draw(command_buffer, render_target);
+}
+
+void GPUDrivenRendering::render(vkb::CommandBuffer &command_buffer)
+{
+	auto &render_pipeline = gpu_driven ? *gpu_render_pipeline : *cpu_render_pipeline;
+
+	render_pipeline.draw(command_buffer, get_render_context().get_active_frame().get_render_target());
+}
+
+void GPUDrivenRendering::draw_gui()
+{
+	bool     landscape = camera->get_aspect_ratio() > 1.0f;
+	uint32_t lines     = landscape ? 2 : 3;
+
+	gui->show_options_window(
+	    /* body = */ [&]() {
+		    ImGui::RadioButton("CPU draws", &gpu_driven, 0);
+		    if (landscape)
+		    {
+			    ImGui::SameLine();
+		    }
+		    ImGui::RadioButton("GPU-driven", &gpu_driven, 1);
+
+		    ImGui::Text("Instances: %u, indirect draw count: %s",
+		                gpu_driven_subpass->get_instance_count(),
+		                get_device().is_enabled(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) ? "yes" : "no");
+	    },
+	    /* lines = */ lines);
+}
+
+std::unique_ptr<vkb::VulkanSample> create_gpu_driven_rendering()
+{
+	return std::make_unique<GPUDrivenRendering>();
+}
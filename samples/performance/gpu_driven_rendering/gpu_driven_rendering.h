@@ -0,0 +1,58 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "rendering/render_pipeline.h"
+#include "rendering/subpasses/gpu_driven_subpass.h"
+#include "scene_graph/components/perspective_camera.h"
+#include "vulkan_sample.h"
+
+/**
+ * @brief Compares recording one draw per object on the CPU with culling and
+ *        generating the draws on the GPU, with a fixed number of indirect draw calls
+ */
+class GPUDrivenRendering : public vkb::VulkanSample
+{
+  public:
+	GPUDrivenRendering();
+
+	virtual ~GPUDrivenRendering() = default;
+
+	virtual bool prepare(vkb::Platform &platform) override;
+
+	virtual void request_gpu_features(vkb::PhysicalDevice &gpu) override;
+
+	virtual void draw(vkb::CommandBuffer &command_buffer, vkb::RenderTarget &render_target) override;
+
+	virtual void render(vkb::CommandBuffer &command_buffer) override;
+
+  private:
+	vkb::sg::PerspectiveCamera *camera{nullptr};
+
+	std::unique_ptr<vkb::RenderPipeline> cpu_render_pipeline;
+
+	std::unique_ptr<vkb::RenderPipeline> gpu_render_pipeline;
+
+	vkb::GPUDrivenSubpass *gpu_driven_subpass{nullptr};
+
+	int gpu_driven{1};
+
+	virtual void draw_gui() override;
+};
+
+std::unique_ptr<vkb::VulkanSample> create_gpu_driven_rendering();
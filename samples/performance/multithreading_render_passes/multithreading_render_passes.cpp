@@ -184,11 +184,6 @@ std::vector<vkb::CommandBuffer *> MultithreadingRenderPasses::record_command_buf
 	auto use_multithreading = multithreading_mode != static_cast<int>(MultithreadingMode::None);
 	shadow_subpass->set_thread_index(use_multithreading ? 1 : 0);
 
-	if (use_multithreading && thread_pool.size() < 1)
-	{
-		thread_pool.resize(1);
-	}
-
 	switch (multithreading_mode)
 	{
 		case static_cast<int>(MultithreadingMode::PrimaryCommandBuffers):
@@ -220,9 +215,9 @@ void MultithreadingRenderPasses::record_separate_primary_command_buffers(std::ve
 	                                                                                        VK_COMMAND_BUFFER_LEVEL_PRIMARY,
 	                                                                                        1);
 
-	// Recording shadow command buffer
-	auto shadow_buffer_future = thread_pool.push(
-	    [this, &shadow_command_buffer](size_t thread_id) {
+	// Recording shadow command buffer, the job keeps thread index 1 whichever thread runs it as nothing else uses it
+	auto shadow_buffer_job = get_job_system().schedule(
+	    [this, &shadow_command_buffer](size_t) {
 		    shadow_command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 		    draw_shadow_pass(shadow_command_buffer);
 		    shadow_command_buffer.end();
@@ -237,7 +232,7 @@ void MultithreadingRenderPasses::record_separate_primary_command_buffers(std::ve
 	command_buffers.push_back(&main_command_buffer);
 
 	// Wait for recording
-	shadow_buffer_future.get();
+	get_job_system().wait(shadow_buffer_job);
 }
 
 void MultithreadingRenderPasses::record_separate_secondary_command_buffers(std::vector<vkb::CommandBuffer *> &command_buffers, vkb::CommandBuffer &main_command_buffer)
@@ -267,9 +262,9 @@ void MultithreadingRenderPasses::record_separate_secondary_command_buffers(std::
 	auto &scene_render_pass   = main_command_buffer.get_render_pass(scene_render_target, main_render_pipeline->get_load_store(), main_render_pipeline->get_subpasses());
 	auto &scene_framebuffer   = get_device().get_resource_cache().request_framebuffer(scene_render_target, scene_render_pass);
 
-	// Recording shadow command buffer
-	auto shadow_buffer_future = thread_pool.push(
-	    [this, &shadow_command_buffer, &shadow_render_pass, &shadow_framebuffer](size_t thread_id) {
+	// Recording shadow command buffer, the job keeps thread index 1 whichever thread runs it as nothing else uses it
+	auto shadow_buffer_job = get_job_system().schedule(
+	    [this, &shadow_command_buffer, &shadow_render_pass, &shadow_framebuffer](size_t) {
 		    shadow_command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT, &shadow_render_pass, &shadow_framebuffer, 0);
 		    draw_shadow_pass(shadow_command_buffer);
 		    shadow_command_buffer.end();
@@ -285,7 +280,7 @@ void MultithreadingRenderPasses::record_separate_secondary_command_buffers(std::
 	scene_command_buffer.end();
 
 	// Wait for recording
-	shadow_buffer_future.get();
+	get_job_system().wait(shadow_buffer_job);
 
 	// Recording main command buffer
 	main_command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
@@ -17,14 +17,18 @@
 
 #include "pipeline_cache.h"
 
+#include <chrono>
+
 #include <imgui_internal.h>
 
 #include "common/logging.h"
+#include "common/resource_caching.h"
 #include "core/device.h"
 #include "gui.h"
 #include "platform/filesystem.h"
 #include "platform/platform.h"
 #include "rendering/subpasses/forward_subpass.h"
+#include "scene_graph/components/mesh.h"
 #include "scene_graph/node.h"
 #include "stats/stats.h"
 
@@ -167,8 +171,24 @@ void PipelineCache::draw_gui()
 		    {
 			    ImGui::Text("Pipeline rebuild frame time: N/A");
 		    }
+
+		    if (ImGui::Button("Benchmark Hashing", button_size))
+		    {
+			    benchmark_hashing_next_frame = true;
+		    }
+
+		    ImGui::SameLine();
+
+		    if (incremental_hash_ns_per_draw > 0.0f)
+		    {
+			    ImGui::Text("Per draw: %.0f ns incremental, %.0f ns full rehash", incremental_hash_ns_per_draw, full_hash_ns_per_draw);
+		    }
+		    else
+		    {
+			    ImGui::Text("Per draw: N/A");
+		    }
 	    },
-	    /* lines = */ 2);
+	    /* lines = */ 3);
 }
 
 void PipelineCache::update(float delta_time)
@@ -179,9 +199,118 @@ void PipelineCache::update(float delta_time)
 		record_frame_time_next_frame    = false;
 	}
 
+	if (benchmark_hashing_next_frame)
+	{
+		benchmark_pipeline_state_hashing();
+		benchmark_hashing_next_frame = false;
+	}
+
 	VulkanSample::update(delta_time);
 }
 
+void PipelineCache::benchmark_pipeline_state_hashing()
+{
+	auto &resource_cache = device->get_resource_cache();
+
+	// The pipelines drawn by the scene, with their layouts requested again to set them on a state
+	std::vector<std::pair<vkb::PipelineLayout *, vkb::PipelineState>> draw_states;
+	for (auto &it : resource_cache.get_internal_state().graphics_pipelines)
+	{
+		auto &pipeline_state  = it.second.get_state();
+		auto &pipeline_layout = resource_cache.request_pipeline_layout(pipeline_state.get_pipeline_layout().get_shader_modules());
+		draw_states.emplace_back(&pipeline_layout, pipeline_state);
+	}
+
+	if (draw_states.empty())
+	{
+		LOGW("Pipeline state hashing benchmark skipped, no graphics pipelines have been created yet");
+		return;
+	}
+
+	size_t draw_count = 0;
+	for (auto mesh : scene->get_components<vkb::sg::Mesh>())
+	{
+		draw_count += mesh->get_nodes().size() * mesh->get_submeshes().size();
+	}
+
+	// Hashing every sub-state on each flush, as the pipeline state hash did before it was incremental
+	auto full_rehash = [](const vkb::PipelineState &pipeline_state) {
+		std::size_t result = 0;
+
+		vkb::hash_combine(result, pipeline_state.get_pipeline_layout().get_handle());
+		for (auto shader_module : pipeline_state.get_pipeline_layout().get_shader_modules())
+		{
+			vkb::hash_combine(result, shader_module->get_id());
+		}
+		vkb::hash_combine(result, pipeline_state.get_render_pass()->get_handle());
+		vkb::hash_combine(result, std::hash<vkb::SpecializationConstantState>{}(pipeline_state.get_specialization_constant_state()));
+		vkb::hash_combine(result, pipeline_state.get_subpass_index());
+		vkb::hash_combine(result, pipeline_state.get_vertex_input_state());
+		vkb::hash_combine(result, pipeline_state.get_input_assembly_state());
+		vkb::hash_combine(result, pipeline_state.get_viewport_state());
+		vkb::hash_combine(result, pipeline_state.get_rasterization_state());
+		vkb::hash_combine(result, pipeline_state.get_multisample_state());
+		vkb::hash_combine(result, pipeline_state.get_depth_stencil_state());
+		vkb::hash_combine(result, pipeline_state.get_color_blend_state());
+
+		return result;
+	};
+
+	auto incremental_hash = [](const vkb::PipelineState &pipeline_state) {
+		return std::hash<vkb::PipelineState>{}(pipeline_state);
+	};
+
+	const size_t frame_count = 100;
+
+	// Each draw sets the sub-states of its pipeline as a subpass would, then hashes the state as a flush would.
+	// Both runs pay for the setters, so the difference between them is the cost of walking every sub-state.
+	auto measure = [&](auto hash_function) {
+		vkb::PipelineState pipeline_state;
+		std::size_t        checksum = 0;
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		for (size_t frame = 0; frame < frame_count; ++frame)
+		{
+			for (size_t draw = 0; draw < draw_count; ++draw)
+			{
+				auto &draw_state = draw_states[draw % draw_states.size()];
+				auto &source     = draw_state.second;
+
+				pipeline_state.set_pipeline_layout(*draw_state.first);
+				pipeline_state.set_render_pass(*source.get_render_pass());
+				pipeline_state.set_subpass_index(source.get_subpass_index());
+				pipeline_state.set_vertex_input_state(source.get_vertex_input_state());
+				pipeline_state.set_input_assembly_state(source.get_input_assembly_state());
+				pipeline_state.set_viewport_state(source.get_viewport_state());
+				pipeline_state.set_rasterization_state(source.get_rasterization_state());
+				pipeline_state.set_multisample_state(source.get_multisample_state());
+				pipeline_state.set_depth_stencil_state(source.get_depth_stencil_state());
+				pipeline_state.set_color_blend_state(source.get_color_blend_state());
+
+				if (pipeline_state.is_dirty())
+				{
+					checksum ^= hash_function(pipeline_state);
+					pipeline_state.clear_dirty();
+				}
+			}
+		}
+
+		auto elapsed = std::chrono::duration<float, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+
+		// Keep the checksum observable so the hashing is not optimized away
+		LOGD("Pipeline state hashing checksum {:#x}", checksum);
+
+		return elapsed / static_cast<float>(frame_count * draw_count);
+	};
+
+	incremental_hash_ns_per_draw = measure(incremental_hash);
+	full_hash_ns_per_draw        = measure(full_rehash);
+
+	LOGI("Pipeline state hashing over {} draws: {:.0f} ns per draw incremental, {:.0f} ns per draw full rehash",
+	     draw_count, incremental_hash_ns_per_draw, full_hash_ns_per_draw);
+}
+
 std::unique_ptr<vkb::VulkanSample> create_pipeline_cache()
 {
 	return std::make_unique<PipelineCache>();
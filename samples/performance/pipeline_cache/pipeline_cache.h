@@ -50,6 +50,18 @@ class PipelineCache : public vkb::VulkanSample
 
 	float rebuild_pipelines_frame_time_ms{0.0f};
 
+	bool benchmark_hashing_next_frame{false};
+
+	float incremental_hash_ns_per_draw{0.0f};
+
+	float full_hash_ns_per_draw{0.0f};
+
+	/**
+	 * @brief Replays the pipeline state changes of one draw per submesh of the scene, and measures
+	 *        the CPU cost per draw of hashing the state incrementally and of rehashing every sub-state
+	 */
+	void benchmark_pipeline_state_hashing();
+
 	virtual void draw_gui() override;
 };
 
@@ -53,6 +53,9 @@ Subpasses::Subpasses()
 
 std::unique_ptr<vkb::RenderTarget> Subpasses::create_render_target(vkb::core::Image &&swapchain_image)
 {
+	// The graphs use the images of the render targets being replaced, which are still alive
+	render_graphs.clear();
+
 	auto &device = swapchain_image.get_device();
 	auto &extent = swapchain_image.get_extent();
 
@@ -104,6 +107,10 @@ void Subpasses::prepare_render_context()
 
 bool Subpasses::prepare(vkb::Platform &platform)
 {
+	// The barriers the render graph records between the render passes then keep their own stages,
+	// rather than all waiting for the union of the depth and color attachment stages
+	set_synchronization_2_enable(true);
+
 	if (!VulkanSample::prepare(platform))
 	{
 		return false;
@@ -276,8 +283,15 @@ void Subpasses::draw_gui()
 
 			    ImGui::PopID();
 		    }
+
+		    if (configs[Config::RenderTechnique].value == 1 && !render_graphs.empty() && render_graphs[0])
+		    {
+			    auto &statistics = render_graphs[0]->get_statistics();
+			    ImGui::Text("Render graph: %u passes, %u barriers, %u image barriers",
+			                statistics.pass_count, statistics.barrier_batch_count, statistics.image_barrier_count);
+		    }
 	    },
-	    /* lines = */ vkb::to_u32(lines));
+	    /* lines = */ vkb::to_u32(lines + 1));
 }
 
 std::unique_ptr<vkb::RenderPipeline> Subpasses::create_one_renderpass_two_subpasses()
@@ -389,41 +403,58 @@ void Subpasses::draw_subpasses(vkb::CommandBuffer &command_buffer, vkb::RenderTa
 
 void Subpasses::draw_renderpasses(vkb::CommandBuffer &command_buffer, vkb::RenderTarget &render_target)
 {
-	// First render pass (no gui)
-	draw_pipeline(command_buffer, render_target, *geometry_render_pipeline);
+	auto image_index = get_render_context().get_active_image_index();
 
-	// Memory barriers needed
-	for (size_t i = 1; i < render_target.get_views().size(); ++i)
+	if (image_index >= render_graphs.size())
 	{
-		auto &view = render_target.get_views()[i];
-
-		vkb::ImageMemoryBarrier barrier;
-
-		if (i == 1)
-		{
-			barrier.old_layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-			barrier.new_layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
-
-			barrier.src_stage_mask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-			barrier.src_access_mask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-		}
-		else
-		{
-			barrier.old_layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-			barrier.new_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-			barrier.src_stage_mask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-			barrier.src_access_mask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		}
+		render_graphs.resize(image_index + 1);
+	}
 
-		barrier.dst_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-		barrier.dst_access_mask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+	auto &render_graph = render_graphs[image_index];
 
-		command_buffer.image_memory_barrier(view, barrier);
+	if (!render_graph)
+	{
+		render_graph = create_render_graph(render_target);
 	}
 
-	// Second render pass
-	draw_pipeline(command_buffer, render_target, *lighting_render_pipeline, gui.get());
+	// Records both render passes, with the barriers between them
+	render_graph->execute(command_buffer);
+}
+
+std::unique_ptr<vkb::RenderGraph> Subpasses::create_render_graph(vkb::RenderTarget &render_target)
+{
+	auto render_graph = std::make_unique<vkb::RenderGraph>(get_device());
+
+	auto &views = render_target.get_views();
+
+	// VulkanSample::draw() transitions the images to their attachment layouts, and the swapchain image from there
+	auto swapchain = render_graph->import_image("Swapchain", views[0], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+	auto depth     = render_graph->import_image("Depth", views[1], VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_UNDEFINED);
+	auto albedo    = render_graph->import_image("Albedo", views[2], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_UNDEFINED);
+	auto normal    = render_graph->import_image("Normal", views[3], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_UNDEFINED);
+
+	// Attachments are declared in the order of the render target, which the pipelines refer to
+	auto &geometry_pass = render_graph->add_pass("Geometry", vkb::RenderGraph::PassType::Graphics,
+	                                             [this](vkb::CommandBuffer &command_buffer, vkb::RenderTarget *pass_target) {
+		                                             draw_pipeline(command_buffer, *pass_target, *geometry_render_pipeline);
+	                                             });
+	geometry_pass.write(swapchain, vkb::RenderGraph::ImageAccess::Attachment);
+	geometry_pass.write(depth, vkb::RenderGraph::ImageAccess::Attachment);
+	geometry_pass.write(albedo, vkb::RenderGraph::ImageAccess::Attachment);
+	geometry_pass.write(normal, vkb::RenderGraph::ImageAccess::Attachment);
+
+	auto &lighting_pass = render_graph->add_pass("Lighting", vkb::RenderGraph::PassType::Graphics,
+	                                             [this](vkb::CommandBuffer &command_buffer, vkb::RenderTarget *pass_target) {
+		                                             draw_pipeline(command_buffer, *pass_target, *lighting_render_pipeline, gui.get());
+	                                             });
+	lighting_pass.write(swapchain, vkb::RenderGraph::ImageAccess::Attachment);
+	lighting_pass.read(depth, vkb::RenderGraph::ImageAccess::Attachment);
+	lighting_pass.read(albedo, vkb::RenderGraph::ImageAccess::Attachment);
+	lighting_pass.read(normal, vkb::RenderGraph::ImageAccess::Attachment);
+
+	render_graph->compile();
+
+	return render_graph;
 }
 
 void Subpasses::draw_renderpass(vkb::CommandBuffer &command_buffer, vkb::RenderTarget &render_target)
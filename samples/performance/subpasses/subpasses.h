@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "rendering/render_graph.h"
 #include "rendering/render_pipeline.h"
 #include "scene_graph/components/perspective_camera.h"
 #include "vulkan_sample.h"
@@ -75,6 +76,12 @@ class Subpasses : public vkb::VulkanSample
 	 */
 	void draw_renderpasses(vkb::CommandBuffer &command_buffer, vkb::RenderTarget &render_target);
 
+	/**
+	 * @return A render graph running the geometry and lighting render passes on the images of a render target,
+	 *         which computes the barriers between them
+	 */
+	std::unique_ptr<vkb::RenderGraph> create_render_graph(vkb::RenderTarget &render_target);
+
 	std::unique_ptr<vkb::RenderTarget> create_render_target(vkb::core::Image &&swapchain_image);
 
 	/// Good pipeline with two subpasses within one render pass
@@ -86,6 +93,9 @@ class Subpasses : public vkb::VulkanSample
 	/// 2. Bad pipeline with a lighting subpass in the second render pass
 	std::unique_ptr<vkb::RenderPipeline> lighting_render_pipeline{};
 
+	/// Graphs of the two render passes for each swapchain image, built on first use
+	std::vector<std::unique_ptr<vkb::RenderGraph>> render_graphs;
+
 	vkb::sg::PerspectiveCamera *camera{};
 
 	/**
@@ -18,7 +18,9 @@
 
 precision highp float;
 
-#ifdef HAS_BASE_COLOR_TEXTURE
+#ifdef BINDLESS_MATERIALS
+layout(set = 1, binding = 0) uniform sampler2D material_textures[MATERIAL_TEXTURE_COUNT];
+#elif defined(HAS_BASE_COLOR_TEXTURE)
 layout(set = 0, binding = 0) uniform sampler2D base_color_texture;
 #endif
 
@@ -43,6 +45,12 @@ layout(push_constant, std430) uniform PBRMaterialUniform
 	vec4  base_color_factor;
 	float metallic_factor;
 	float roughness_factor;
+#ifdef BINDLESS_MATERIALS
+	// Indices into material_textures, -1 if the material has no such texture
+	int base_color_texture_index;
+	int normal_texture_index;
+	int metallic_roughness_texture_index;
+#endif
 }
 pbr_material_uniform;
 
@@ -83,7 +91,17 @@ void main(void)
 
 	vec4 base_color = vec4(1.0, 0.0, 0.0, 1.0);
 
-#ifdef HAS_BASE_COLOR_TEXTURE
+#ifdef BINDLESS_MATERIALS
+	// The index is the same for the whole draw, so it is dynamically uniform
+	if (pbr_material_uniform.base_color_texture_index >= 0)
+	{
+		base_color = texture(material_textures[pbr_material_uniform.base_color_texture_index], in_uv);
+	}
+	else
+	{
+		base_color = pbr_material_uniform.base_color_factor;
+	}
+#elif defined(HAS_BASE_COLOR_TEXTURE)
 	base_color = texture(base_color_texture, in_uv);
 #else
 	base_color = pbr_material_uniform.base_color_factor;
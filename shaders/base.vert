@@ -16,9 +16,17 @@
  * limitations under the License.
  */
 
+#ifdef QUANTIZED_POSITION
+layout(location = 0) in vec4 position;
+#else
 layout(location = 0) in vec3 position;
+#endif
 layout(location = 1) in vec2 texcoord_0;
+#ifdef OCTAHEDRAL_NORMAL
+layout(location = 2) in vec2 normal;
+#else
 layout(location = 2) in vec3 normal;
+#endif
 
 layout(set = 0, binding = 1) uniform GlobalUniform {
     mat4 model;
@@ -26,17 +34,48 @@ layout(set = 0, binding = 1) uniform GlobalUniform {
     vec3 camera_position;
 } global_uniform;
 
+#ifdef QUANTIZED_POSITION
+layout(set = 0, binding = 7) uniform PositionDequantization {
+    vec4 offset;
+    vec4 scale;
+} position_dequantization;
+#endif
+
 layout (location = 0) out vec4 o_pos;
 layout (location = 1) out vec2 o_uv;
 layout (location = 2) out vec3 o_normal;
 
+#ifdef OCTAHEDRAL_NORMAL
+vec3 decode_octahedral_normal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+    {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+#endif
+
 void main(void)
 {
-    o_pos = global_uniform.model * vec4(position, 1.0);
+#ifdef QUANTIZED_POSITION
+    vec3 object_position = position_dequantization.offset.xyz + position.xyz * position_dequantization.scale.xyz;
+#else
+    vec3 object_position = position;
+#endif
+
+#ifdef OCTAHEDRAL_NORMAL
+    vec3 object_normal = decode_octahedral_normal(normal);
+#else
+    vec3 object_normal = normal;
+#endif
+
+    o_pos = global_uniform.model * vec4(object_position, 1.0);
 
     o_uv = texcoord_0;
 
-    o_normal = mat3(global_uniform.model) * normal;
+    o_normal = mat3(global_uniform.model) * object_normal;
 
     gl_Position = global_uniform.view_proj * o_pos;
 }
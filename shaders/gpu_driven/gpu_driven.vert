@@ -0,0 +1,59 @@
+#version 450
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 texcoord_0;
+
+#include "gpu_driven/gpu_driven_common.h"
+
+layout(location = 0) out vec4 o_pos;
+layout(location = 1) out vec2 o_uv;
+layout(location = 2) out vec3 o_normal;
+layout(location = 3) flat out vec4 o_base_color_factor;
+layout(location = 4) flat out int o_base_color_texture_index;
+
+#ifdef INSTANCE_INDEX_PUSH_CONSTANT
+// Draws are recorded one by one when indirect draws cannot have a first instance
+layout(push_constant) uniform PushConstants
+{
+	uint instance_index;
+}
+push_constants;
+#endif
+
+void main(void)
+{
+	// Each draw has a single instance, whose index is the first instance written by the culling shader
+#ifdef INSTANCE_INDEX_PUSH_CONSTANT
+	Instance instance = instances[push_constants.instance_index];
+#else
+	Instance instance = instances[gl_InstanceIndex];
+#endif
+
+	o_pos = instance.model * vec4(position, 1.0);
+
+	o_uv = texcoord_0;
+
+	o_normal = mat3(instance.model) * normal;
+
+	o_base_color_factor        = instance.base_color_factor;
+	o_base_color_texture_index = instance.base_color_texture_index;
+
+	gl_Position = global_uniform.view_proj * o_pos;
+}
@@ -0,0 +1,48 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Must match GPUDrivenInstance and GPUDrivenUniform in gpu_driven_subpass.h
+
+struct Instance
+{
+	mat4 model;
+	vec4 bounding_sphere;
+	vec4 base_color_factor;
+	uint first_index;
+	uint index_count;
+	int  vertex_offset;
+	int  base_color_texture_index;
+	uint batch_index;
+	uint batch_first_instance;
+	uint padding[2];
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer InstanceBuffer
+{
+	Instance instances[];
+};
+
+layout(set = 0, binding = 1) uniform GPUDrivenUniform
+{
+	mat4 view_proj;
+	vec4 camera_position;
+	vec4 frustum_planes[6];
+	uint instance_count;
+	uint compact_draws;
+	uint first_instance;
+}
+global_uniform;
@@ -0,0 +1,30 @@
+#version 450
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+layout(location = 0) in vec3 in_normal;
+layout(location = 1) in vec3 in_color;
+
+layout(location = 0) out vec4 out_color;
+
+void main()
+{
+	// Light at the camera
+	float diffuse = max(abs(normalize(in_normal).z), 0.2);
+
+	out_color = vec4(in_color * diffuse, 1.0);
+}
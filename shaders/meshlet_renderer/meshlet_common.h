@@ -0,0 +1,37 @@
+/* Copyright (c) 2023, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Meshlets tested by a task shader workgroup, must match task_workgroup_size in meshlet_renderer.cpp
+#define TASK_WORKGROUP_SIZE 32
+
+layout(set = 0, binding = 0) uniform Uniforms
+{
+	mat4 model_view_projection;
+	mat4 model_view;
+	vec4 frustum_planes[6];
+	vec4 camera_position;
+	uint meshlet_count;
+	uint frustum_culling;
+	uint cone_culling;
+}
+uniforms;
+
+// Visible meshlets of a task shader workgroup, one mesh shader workgroup is launched per entry
+struct TaskPayload
+{
+	uint meshlet_indices[TASK_WORKGROUP_SIZE];
+};